@@ -3447,6 +3447,36 @@ typedef struct stats_info_response_msg {
 	time_t   bf_when_last_cycle;
 	uint32_t bf_active;
 
+	uint64_t assoc_mgr_assoc_lookups;
+	uint64_t assoc_mgr_qos_lookups;
+	uint64_t assoc_mgr_user_lookups;
+	uint64_t assoc_mgr_wckey_lookups;
+
+	uint32_t rpc_compress_size;
+	uint16_t *rpc_compress_type_id;
+	uint32_t *rpc_compress_cnt;
+	uint32_t *rpc_compress_skipped;
+	uint64_t *rpc_compress_raw_bytes;
+	uint64_t *rpc_compress_wire_bytes;
+	uint64_t *rpc_compress_time;
+	uint32_t *rpc_decompress_cnt;
+	uint64_t *rpc_decompress_time;
+
+	uint64_t conn_pool_connects;
+	uint64_t conn_pool_reused;
+	uint64_t conn_pool_stale;
+	uint64_t conn_pool_expired;
+	uint64_t conn_pool_retries;
+
+	uint64_t auth_cache_hits;
+	uint64_t auth_cache_misses;
+	uint64_t auth_cache_evictions;
+
+	uint64_t buf_allocs;
+	uint64_t buf_reused;
+	uint64_t buf_grown_in_place;
+	uint64_t buf_reallocs;
+
 	uint32_t rpc_type_size;
 	uint16_t *rpc_type_id;
 	uint32_t *rpc_type_cnt;
@@ -332,6 +332,7 @@ typedef enum {
 	ESLURMD_CPU_LAYOUT_ERROR,
 	ESLURMD_TOO_MANY_RPCS,
 	ESLURMD_STEPD_PROXY_FAILED,
+	ESLURMD_BCAST_BLOCK_NOT_CACHED,
 
 	/* socket specific Slurm communications error */
 	ESLURM_PROTOCOL_INCOMPLETE_PACKET = 5003,
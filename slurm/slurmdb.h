@@ -295,6 +295,7 @@ typedef enum {
 #define DB_CONN_FLAG_CLUSTER_DEL SLURM_BIT(0)
 #define DB_CONN_FLAG_ROLLBACK SLURM_BIT(1)
 #define DB_CONN_FLAG_FEDUPDATE SLURM_BIT(2)
+#define DB_CONN_FLAG_REPLICA SLURM_BIT(3) /* read-only replica connection */
 
 #define DEFAULT_SLURMDBD_AUTHTYPE "auth/munge"
 //#define DEFAULT_SLURMDBD_JOB_PURGE	12
@@ -366,6 +367,9 @@ typedef struct {
 	char *serializer_plugins; /* SerializerPlugins */
 	char *storage_loc; /* database name		*/
 	char *storage_pass_script;
+	char *storage_replica_host; /* comma separated read-only replicas */
+	uint32_t storage_replica_max_lag; /* max seconds a replica may be
+					   * behind to be used for reads */
 	char *storage_user;
 	uint16_t syslog_debug; /* output to both logfile and syslog*/
 	uint16_t track_wckey; /* Whether or not to track wckey*/
@@ -1044,6 +1048,80 @@ typedef struct {
 	char    *work_dir;
 } slurmdb_job_rec_t;
 
+/*
+ * Columns that can be requested with slurmdb_jobs_get_columns(). Each maps
+ * to the slurmdb_job_rec_t member of the same name. The column names (as
+ * given by slurmdb_job_col_2_str()) are what is sent over the wire so new
+ * columns can be added anywhere in this list.
+ */
+typedef enum {
+	SLURMDB_JOB_COL_ACCOUNT,
+	SLURMDB_JOB_COL_ADMIN_COMMENT,
+	SLURMDB_JOB_COL_ALLOC_NODES,
+	SLURMDB_JOB_COL_ARRAY_JOB_ID,
+	SLURMDB_JOB_COL_ARRAY_MAX_TASKS,
+	SLURMDB_JOB_COL_ARRAY_TASK_ID,
+	SLURMDB_JOB_COL_ARRAY_TASK_STR,
+	SLURMDB_JOB_COL_ASSOCID,
+	SLURMDB_JOB_COL_CONSTRAINTS,
+	SLURMDB_JOB_COL_CONTAINER,
+	SLURMDB_JOB_COL_DB_INDEX,
+	SLURMDB_JOB_COL_DERIVED_EC,
+	SLURMDB_JOB_COL_DERIVED_ES,
+	SLURMDB_JOB_COL_ELAPSED,
+	SLURMDB_JOB_COL_ELIGIBLE,
+	SLURMDB_JOB_COL_END,
+	SLURMDB_JOB_COL_EXITCODE,
+	SLURMDB_JOB_COL_EXTRA,
+	SLURMDB_JOB_COL_FAILED_NODE,
+	SLURMDB_JOB_COL_FLAGS,
+	SLURMDB_JOB_COL_GID,
+	SLURMDB_JOB_COL_HET_JOB_ID,
+	SLURMDB_JOB_COL_HET_JOB_OFFSET,
+	SLURMDB_JOB_COL_JOBID,
+	SLURMDB_JOB_COL_JOBNAME,
+	SLURMDB_JOB_COL_LICENSES,
+	SLURMDB_JOB_COL_MCS_LABEL,
+	SLURMDB_JOB_COL_NODES,
+	SLURMDB_JOB_COL_PARTITION,
+	SLURMDB_JOB_COL_PRIORITY,
+	SLURMDB_JOB_COL_QOSID,
+	SLURMDB_JOB_COL_REQ_CPUS,
+	SLURMDB_JOB_COL_REQ_MEM,
+	SLURMDB_JOB_COL_REQUID,
+	SLURMDB_JOB_COL_RESTART_CNT,
+	SLURMDB_JOB_COL_RESVID,
+	SLURMDB_JOB_COL_SLUID,
+	SLURMDB_JOB_COL_START,
+	SLURMDB_JOB_COL_STATE,
+	SLURMDB_JOB_COL_STATE_REASON_PREV,
+	SLURMDB_JOB_COL_SUBMIT,
+	SLURMDB_JOB_COL_SUBMIT_LINE,
+	SLURMDB_JOB_COL_SUSPENDED,
+	SLURMDB_JOB_COL_SYSTEM_COMMENT,
+	SLURMDB_JOB_COL_TIMELIMIT,
+	SLURMDB_JOB_COL_TRES_ALLOC,
+	SLURMDB_JOB_COL_TRES_REQ,
+	SLURMDB_JOB_COL_UID,
+	SLURMDB_JOB_COL_USER,
+	SLURMDB_JOB_COL_WCKEY,
+	SLURMDB_JOB_COL_WCKEYID,
+	SLURMDB_JOB_COL_WORK_DIR,
+	SLURMDB_JOB_COL_CNT /* Must be last */
+} slurmdb_job_col_t;
+
+/*
+ * Columnar (one array per field) representation of the job records of a
+ * single cluster. Only the columns requested are filled in, every other
+ * entry is NULL. Numeric columns live in num[], string columns in str[].
+ */
+typedef struct {
+	char *cluster;
+	uint64_t *num[SLURMDB_JOB_COL_CNT];
+	uint32_t rec_cnt; /* number of entries in each column */
+	char **str[SLURMDB_JOB_COL_CNT];
+} slurmdb_job_columns_t;
+
 typedef struct {
 	uint32_t accrue_cnt;    /* Count of how many jobs I have accuring prio
 				 * (DON'T PACK for state file) */
@@ -1875,6 +1953,32 @@ extern list_t *slurmdb_job_modify(void *db_conn,
  */
 extern list_t *slurmdb_jobs_get(void *db_conn, slurmdb_job_cond_t *job_cond);
 
+/*
+ * get a projection of job records from the storage in columnar form
+ * IN:  job_cond - format_list holds the names of the columns wanted (see
+ *      slurmdb_job_col_t), JOBCOND_FLAG_NO_STEP and JOBCOND_FLAG_NO_TRUNC
+ *      must be set
+ * returns List of slurmdb_job_columns_t *, one per cluster
+ * note List needs to be freed with slurm_list_destroy() when called
+ */
+extern list_t *slurmdb_jobs_get_columns(void *db_conn,
+					slurmdb_job_cond_t *job_cond);
+
+/*
+ * get job records from the storage a piece at a time, so the first ones can be
+ * handled before the whole result has been read
+ * IN:  job_cond
+ * IN:  callback - called with a List of slurmdb_job_rec_t * for each piece, it
+ *      may take records off the List, the rest are freed when it returns.
+ *      A non-zero return stops the query.
+ * IN:  arg - passed to callback
+ * RET: SLURM_SUCCESS, ESLURM_NOT_SUPPORTED if this can't be done (callback was
+ *      never called, use slurmdb_jobs_get() instead) or an error code
+ */
+extern int slurmdb_jobs_get_stream(void *db_conn, slurmdb_job_cond_t *job_cond,
+				   int (*callback)(list_t *job_list, void *arg),
+				   void *arg);
+
 /*
  * Fix runaway jobs
  * IN: jobs, a list of all the runaway jobs
@@ -2049,6 +2153,7 @@ extern void slurmdb_destroy_assoc_rec(void *object);
 extern void slurmdb_destroy_event_rec(void *object);
 extern void slurmdb_destroy_instance_rec(void *object);
 extern void slurmdb_destroy_job_rec(void *object);
+extern void slurmdb_destroy_job_columns(void *object);
 extern void slurmdb_free_qos_rec_members(slurmdb_qos_rec_t *qos);
 extern void slurmdb_destroy_qos_rec(void *object);
 extern void slurmdb_destroy_reservation_rec(void *object);
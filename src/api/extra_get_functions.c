@@ -290,6 +290,12 @@ extern list_t *slurmdb_config_get_keypairs(const slurmdbd_conf_t *slurmdbd_conf)
 	add_key_pair(my_list, "StoragePort", "%u",
 		     slurm_conf.accounting_storage_port);
 
+	add_key_pair(my_list, "StorageReplicaHost", "%s",
+		     slurmdbd_conf->storage_replica_host);
+
+	add_key_pair(my_list, "StorageReplicaMaxLag", "%u secs",
+		     slurmdbd_conf->storage_replica_max_lag);
+
 	add_key_pair(my_list, "StorageType", "%s",
 		     slurm_conf.accounting_storage_type);
 
@@ -69,6 +69,36 @@ extern list_t *slurmdb_jobs_get(void *db_conn, slurmdb_job_cond_t *job_cond)
 	return jobacct_storage_g_get_jobs_cond(db_conn, db_api_uid, job_cond);
 }
 
+/*
+ * get a projection of job info from the storage
+ * returns List of slurmdb_job_columns_t *
+ * note List needs to be freed when called
+ */
+extern list_t *slurmdb_jobs_get_columns(void *db_conn,
+					slurmdb_job_cond_t *job_cond)
+{
+	if (db_api_uid == -1)
+		db_api_uid = getuid();
+
+	return jobacct_storage_g_get_jobs_columns(db_conn, db_api_uid,
+						  job_cond);
+}
+
+/*
+ * get info from the storage a piece at a time
+ * callback is called with a List of slurmdb_job_rec_t * for each piece
+ */
+extern int slurmdb_jobs_get_stream(void *db_conn, slurmdb_job_cond_t *job_cond,
+				   int (*callback)(list_t *job_list, void *arg),
+				   void *arg)
+{
+	if (db_api_uid == -1)
+		db_api_uid = getuid();
+
+	return jobacct_storage_g_get_jobs_stream(db_conn, db_api_uid, job_cond,
+						 callback, arg);
+}
+
 /*
  * Fix runaway jobs
  * IN: jobs, a list of all the runaway jobs
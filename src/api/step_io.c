@@ -68,6 +68,7 @@
 struct io_buf {
 	int ref_count;
 	uint32_t length;
+	uint32_t size; /* bytes allocated for data */
 	void *data;
 	io_hdr_t header;
 };
@@ -367,6 +368,26 @@ static int _server_read(eio_obj_t *obj, list_t *objs)
 			s->in_msg = NULL;
 			return SLURM_SUCCESS;
 		}
+		if (s->header.length > SLURM_IO_MAX_MSG_LEN_LARGE) {
+			error("%s: fd %d message length of %u exceeds maximum of %u",
+			      __func__, obj->fd, s->header.length,
+			      SLURM_IO_MAX_MSG_LEN_LARGE);
+			if (s->cio->sls)
+				step_launch_notify_io_failure(s->cio->sls,
+							      s->node_id);
+			_shutdown_and_close(obj);
+			s->in_eof = true;
+			s->out_eof = true;
+			list_enqueue(s->cio->free_outgoing, s->in_msg);
+			s->in_msg = NULL;
+			return SLURM_SUCCESS;
+		}
+		/* 26.11 and newer slurmstepd send frames above the default */
+		if (s->header.length > s->in_msg->size) {
+			s->in_msg->size = s->header.length;
+			xrealloc_nz(s->in_msg->data, s->in_msg->size +
+				    IO_HDR_PACKET_BYTES + 1);
+		}
 		s->in_remaining = s->header.length;
 		s->in_msg->length = s->header.length;
 		s->in_msg->header = s->header;
@@ -995,6 +1016,7 @@ _alloc_io_buf(void)
 
 	buf->ref_count = 0;
 	buf->length = 0;
+	buf->size = SLURM_IO_MAX_MSG_LEN;
 	/* The following "+ 1" is just temporary so I can stick a \0 at
 	   the end and do a printf of the data pointer */
 	buf->data = xmalloc(SLURM_IO_MAX_MSG_LEN + IO_HDR_PACKET_BYTES + 1);
@@ -1646,6 +1646,13 @@ static int _launch_tasks(slurm_step_ctx_t *ctx,
 	else
 		msg.protocol_version = SLURM_PROTOCOL_VERSION;
 
+	/*
+	 * compress_threshold requires compress/lz4 on every node, so the
+	 * slurmds can decompress large environments without asking first.
+	 */
+	if (slurm_msg_compress_enabled())
+		msg.flags |= SLURM_MSG_COMPRESS_OK;
+
 	ret_list = slurm_send_recv_msgs(nodelist, &msg, timeout);
 	if (ret_list == NULL) {
 		error("slurm_send_recv_msgs failed miserably: %m");
@@ -44,6 +44,7 @@
 #include <stdlib.h>
 #include <ctype.h>
 
+#include "src/common/atomic.h"
 #include "src/common/slurmdbd_pack.h"
 #include "src/common/state_save.h"
 #include "src/common/uid.h"
@@ -62,6 +63,21 @@ typedef struct {
 	list_t *ret_list;
 } find_coord_t;
 
+typedef struct assoc_mgr_index_ent {
+	void *rec;
+	struct assoc_mgr_index_ent *next;
+} assoc_mgr_index_ent_t;
+
+/*
+ * Hash index into one of the assoc_mgr lists. Records are hashed on
+ * rec_key() and protected by the same lock as the list they are in.
+ */
+typedef struct {
+	assoc_mgr_lock_datatype_t entity; /* table, for lookup counters */
+	assoc_mgr_index_ent_t **hash;
+	uint32_t (*rec_key)(void *rec);
+} assoc_mgr_index_t;
+
 typedef struct {
 	bool locked;
 	bool relative;
@@ -132,6 +148,51 @@ static slurmdb_assoc_rec_t **assoc_hash_id = NULL;
 static slurmdb_assoc_rec_t **assoc_hash = NULL;
 static int *assoc_mgr_tres_old_pos = NULL;
 
+static uint32_t _qos_id_key(void *x);
+static uint32_t _qos_name_key(void *x);
+static uint32_t _user_uid_key(void *x);
+static uint32_t _user_name_key(void *x);
+static uint32_t _wckey_id_key(void *x);
+static uint32_t _wckey_uid_key(void *x);
+static uint32_t _wckey_user_key(void *x);
+
+static assoc_mgr_index_t qos_id_index = {
+	.entity = QOS_LOCK,
+	.rec_key = _qos_id_key,
+};
+static assoc_mgr_index_t qos_name_index = {
+	.entity = QOS_LOCK,
+	.rec_key = _qos_name_key,
+};
+static assoc_mgr_index_t user_uid_index = {
+	.entity = USER_LOCK,
+	.rec_key = _user_uid_key,
+};
+static assoc_mgr_index_t user_name_index = {
+	.entity = USER_LOCK,
+	.rec_key = _user_name_key,
+};
+static assoc_mgr_index_t wckey_id_index = {
+	.entity = WCKEY_LOCK,
+	.rec_key = _wckey_id_key,
+};
+static assoc_mgr_index_t wckey_uid_index = {
+	.entity = WCKEY_LOCK,
+	.rec_key = _wckey_uid_key,
+};
+static assoc_mgr_index_t wckey_user_index = {
+	.entity = WCKEY_LOCK,
+	.rec_key = _wckey_user_key,
+};
+
+#ifndef __STDC_NO_ATOMICS__
+static atomic_uint64_t lookup_cnt[ASSOC_MGR_ENTITY_COUNT];
+#define _inc_lookup_cnt(entity) \
+	(void) atomic_uint64_increment(lookup_cnt[entity])
+#else
+#define _inc_lookup_cnt(entity)
+#endif
+
 static uint32_t _get_children_level_shares(slurmdb_assoc_rec_t *assoc);
 static void _reset_children_usages(list_t *children_list);
 
@@ -211,6 +272,8 @@ static slurmdb_assoc_rec_t *_find_assoc_rec_id(uint32_t assoc_id,
 {
 	slurmdb_assoc_rec_t *assoc;
 
+	_inc_lookup_cnt(ASSOC_LOCK);
+
 	if (!assoc_hash_id) {
 		debug2("%s: no associations added yet", __func__);
 		return NULL;
@@ -274,6 +337,8 @@ static slurmdb_assoc_rec_t *_find_assoc_rec(
 	if (assoc->id)
 		return _find_assoc_rec_id(assoc->id, assoc->cluster);
 
+	_inc_lookup_cnt(ASSOC_LOCK);
+
 	if (!assoc_hash) {
 		debug2("%s: no associations added yet", __func__);
 		return NULL;
@@ -387,6 +452,235 @@ static void _delete_assoc_hash(slurmdb_assoc_rec_t *assoc)
 		*assoc_pptr = assoc_ptr->assoc_next;
 }
 
+static uint32_t _qos_id_key(void *x)
+{
+	slurmdb_qos_rec_t *qos = x;
+
+	return qos->id;
+}
+
+static uint32_t _qos_name_key(void *x)
+{
+	slurmdb_qos_rec_t *qos = x;
+
+	return _get_str_inx(qos->name);
+}
+
+static uint32_t _user_uid_key(void *x)
+{
+	slurmdb_user_rec_t *user = x;
+
+	return user->uid;
+}
+
+static uint32_t _user_name_key(void *x)
+{
+	slurmdb_user_rec_t *user = x;
+
+	return _get_str_inx(user->name);
+}
+
+static uint32_t _wckey_id_key(void *x)
+{
+	slurmdb_wckey_rec_t *wckey = x;
+
+	return wckey->id;
+}
+
+static uint32_t _wckey_uid_key(void *x)
+{
+	slurmdb_wckey_rec_t *wckey = x;
+
+	return (wckey->uid + _get_str_inx(wckey->name));
+}
+
+static uint32_t _wckey_user_key(void *x)
+{
+	slurmdb_wckey_rec_t *wckey = x;
+
+	return (_get_str_inx(wckey->user) + _get_str_inx(wckey->name));
+}
+
+static assoc_mgr_index_ent_t **_index_bucket(assoc_mgr_index_t *index,
+					     void *rec)
+{
+	return &index->hash[index->rec_key(rec) % ASSOC_HASH_SIZE];
+}
+
+static void _index_add(assoc_mgr_index_t *index, void *rec)
+{
+	assoc_mgr_index_ent_t **ent_pptr;
+
+	if (!index->hash)
+		index->hash = xcalloc(ASSOC_HASH_SIZE, sizeof(*index->hash));
+
+	/*
+	 * Append so a lookup returns the same record list_find_first() on the
+	 * list would have.
+	 */
+	ent_pptr = _index_bucket(index, rec);
+	while (*ent_pptr)
+		ent_pptr = &(*ent_pptr)->next;
+
+	*ent_pptr = xmalloc(sizeof(**ent_pptr));
+	(*ent_pptr)->rec = rec;
+}
+
+static bool _index_unlink(assoc_mgr_index_ent_t **ent_pptr, void *rec)
+{
+	assoc_mgr_index_ent_t *ent;
+
+	for (; (ent = *ent_pptr); ent_pptr = &ent->next) {
+		if (ent->rec != rec)
+			continue;
+		*ent_pptr = ent->next;
+		xfree(ent);
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Remove rec from the index. This needs to happen before any field rec is
+ * hashed on changes, otherwise we have to search the whole table for it.
+ */
+static void _index_remove(assoc_mgr_index_t *index, void *rec)
+{
+	if (!index->hash)
+		return;
+
+	if (_index_unlink(_index_bucket(index, rec), rec))
+		return;
+
+	for (int i = 0; i < ASSOC_HASH_SIZE; i++) {
+		if (_index_unlink(&index->hash[i], rec)) {
+			debug2("%s: record %p was hashed on a stale key",
+			       __func__, rec);
+			return;
+		}
+	}
+}
+
+static void _index_free(assoc_mgr_index_t *index)
+{
+	if (!index->hash)
+		return;
+
+	for (int i = 0; i < ASSOC_HASH_SIZE; i++) {
+		assoc_mgr_index_ent_t *ent = index->hash[i];
+
+		while (ent) {
+			assoc_mgr_index_ent_t *next = ent->next;
+
+			xfree(ent);
+			ent = next;
+		}
+	}
+	xfree(index->hash);
+}
+
+static int _foreach_index_add(void *x, void *arg)
+{
+	_index_add(arg, x);
+	return 0;
+}
+
+static void _index_rebuild(assoc_mgr_index_t *index, list_t *list)
+{
+	_index_free(index);
+
+	if (list)
+		(void) list_for_each_ro(list, _foreach_index_add, index);
+}
+
+/*
+ * Find the first record hashed on the same key as key_rec for which
+ * match(rec, match_key) returns true.
+ */
+static void *_index_find(assoc_mgr_index_t *index, void *key_rec,
+			 ListFindF match, void *match_key)
+{
+	_inc_lookup_cnt(index->entity);
+
+	if (!index->hash)
+		return NULL;
+
+	for (assoc_mgr_index_ent_t *ent = *_index_bucket(index, key_rec); ent;
+	     ent = ent->next) {
+		if (match(ent->rec, match_key))
+			return ent->rec;
+	}
+
+	return NULL;
+}
+
+/* QOS_LOCK write lock needs to be held. */
+static void _qos_index_add(slurmdb_qos_rec_t *qos)
+{
+	_index_add(&qos_id_index, qos);
+	_index_add(&qos_name_index, qos);
+}
+
+/* QOS_LOCK write lock needs to be held. */
+static void _qos_index_remove(slurmdb_qos_rec_t *qos)
+{
+	_index_remove(&qos_id_index, qos);
+	_index_remove(&qos_name_index, qos);
+}
+
+/* QOS_LOCK write lock needs to be held. */
+static void _qos_index_rebuild(void)
+{
+	_index_rebuild(&qos_id_index, assoc_mgr_qos_list);
+	_index_rebuild(&qos_name_index, assoc_mgr_qos_list);
+}
+
+/* USER_LOCK write lock needs to be held. */
+static void _user_index_add(slurmdb_user_rec_t *user)
+{
+	_index_add(&user_uid_index, user);
+	_index_add(&user_name_index, user);
+}
+
+/* USER_LOCK write lock needs to be held. */
+static void _user_index_remove(slurmdb_user_rec_t *user)
+{
+	_index_remove(&user_uid_index, user);
+	_index_remove(&user_name_index, user);
+}
+
+/* USER_LOCK write lock needs to be held. */
+static void _user_index_rebuild(void)
+{
+	_index_rebuild(&user_uid_index, assoc_mgr_user_list);
+	_index_rebuild(&user_name_index, assoc_mgr_user_list);
+}
+
+/* WCKEY_LOCK write lock needs to be held. */
+static void _wckey_index_add(slurmdb_wckey_rec_t *wckey)
+{
+	_index_add(&wckey_id_index, wckey);
+	_index_add(&wckey_uid_index, wckey);
+	_index_add(&wckey_user_index, wckey);
+}
+
+/* WCKEY_LOCK write lock needs to be held. */
+static void _wckey_index_remove(slurmdb_wckey_rec_t *wckey)
+{
+	_index_remove(&wckey_id_index, wckey);
+	_index_remove(&wckey_uid_index, wckey);
+	_index_remove(&wckey_user_index, wckey);
+}
+
+/* WCKEY_LOCK write lock needs to be held. */
+static void _wckey_index_rebuild(void)
+{
+	_index_rebuild(&wckey_id_index, assoc_mgr_wckey_list);
+	_index_rebuild(&wckey_uid_index, assoc_mgr_wckey_list);
+	_index_rebuild(&wckey_user_index, assoc_mgr_wckey_list);
+}
+
 
 static void _normalize_assoc_shares_fair_tree(
 	slurmdb_assoc_rec_t *assoc)
@@ -618,14 +912,19 @@ static int _foreach_rename_user_wckey(void *x, void *arg)
 	if (xstrcmp(user->old_name, wckey->user))
 		return 0;
 
+	_wckey_index_remove(wckey);
 	xfree(wckey->user);
 	wckey->user = xstrdup(user->name);
 	wckey->uid = user->uid;
+	_wckey_index_add(wckey);
 	debug3("changing wckey %d", wckey->id);
 	return 0;
 }
 
-/* Locks should be in place before calling this. */
+/*
+ * Locks should be in place before calling this.
+ * The user has to be out of the user indexes as both name and uid change.
+ */
 static int _change_user_name(slurmdb_user_rec_t *user)
 {
 	int rc = SLURM_SUCCESS;
@@ -764,6 +1063,48 @@ static int _list_find_user(void *x, void *key)
 	return 0;
 }
 
+/* USER_LOCK read lock needs to be held. */
+static slurmdb_user_rec_t *_find_user_uid(uint32_t uid)
+{
+	slurmdb_user_rec_t key = { .uid = uid };
+
+	return _index_find(&user_uid_index, &key, _list_find_uid, &uid);
+}
+
+/*
+ * Same match as _list_find_user() on assoc_mgr_user_list.
+ * USER_LOCK read lock needs to be held.
+ */
+static slurmdb_user_rec_t *_find_user_rec(slurmdb_user_rec_t *user)
+{
+	if (user->uid != NO_VAL)
+		return _find_user_uid(user->uid);
+
+	return _index_find(&user_name_index, user, _list_find_user, user);
+}
+
+static int _list_find_coord_user(void *x, void *key)
+{
+	slurmdb_user_rec_t *user = x;
+
+	if (!user->coord_accts || !list_count(user->coord_accts))
+		return 0;
+
+	return _list_find_user(x, key);
+}
+
+/*
+ * Same as _find_user_rec() but only return users in assoc_mgr_coord_list.
+ * USER_LOCK read lock needs to be held.
+ */
+static slurmdb_user_rec_t *_find_coord_rec(slurmdb_user_rec_t *user)
+{
+	assoc_mgr_index_t *index = (user->uid != NO_VAL) ?
+		&user_uid_index : &user_name_index;
+
+	return _index_find(index, user, _list_find_coord_user, user);
+}
+
 static int _list_find_coord(void *x, void *key)
 {
 	slurmdb_user_rec_t *user = x;
@@ -797,8 +1138,7 @@ static void _set_user_default_acct(slurmdb_assoc_rec_t *assoc,
 	/* set up the default if this is it */
 	if ((assoc->is_def == 1) && (assoc->uid != NO_VAL)) {
 		if (!user)
-			user = list_find_first(assoc_mgr_user_list,
-					       _list_find_uid, &assoc->uid);
+			user = _find_user_uid(assoc->uid);
 
 		if (!user)
 			return;
@@ -824,8 +1164,7 @@ static void _clear_user_default_acct(slurmdb_assoc_rec_t *assoc)
 
 	/* set up the default if this is it */
 	if ((assoc->is_def == 0) && (assoc->uid != NO_VAL)) {
-		slurmdb_user_rec_t *user = list_find_first(
-			assoc_mgr_user_list, _list_find_uid, &assoc->uid);
+		slurmdb_user_rec_t *user = _find_user_uid(assoc->uid);
 
 		if (!user)
 			return;
@@ -852,8 +1191,7 @@ static void _set_user_default_wckey(slurmdb_wckey_rec_t *wckey,
 	/* set up the default if this is it */
 	if ((wckey->is_def == 1) && (wckey->uid != NO_VAL)) {
 		if (!user)
-			user = list_find_first(assoc_mgr_user_list,
-					       _list_find_uid, &wckey->uid);
+			user = _find_user_uid(wckey->uid);
 
 		if (!user)
 			return;
@@ -874,9 +1212,7 @@ static void _clear_user_default_wckey(slurmdb_wckey_rec_t *wckey)
 	xassert(assoc_mgr_user_list);
 
 	if ((wckey->is_def == 1) && (wckey->uid != NO_VAL)) {
-		slurmdb_user_rec_t *user = list_find_first(assoc_mgr_user_list,
-							   _list_find_uid,
-							   &wckey->uid);
+		slurmdb_user_rec_t *user = _find_user_uid(wckey->uid);
 
 		if (!user)
 			return;
@@ -955,8 +1291,7 @@ static uid_t _uid_from_user_cache(char *username)
 	if (!assoc_mgr_user_list)
 		return NO_VAL;
 
-	user_rec = list_find_first(assoc_mgr_user_list, _list_find_user,
-				   &lookup);
+	user_rec = _find_user_rec(&lookup);
 	if (user_rec)
 		return user_rec->uid;
 
@@ -1906,23 +2241,25 @@ static int _get_assoc_mgr_qos_list(void *db_conn, int enforce)
 	new_list = NULL;
 
 	_post_qos_list(assoc_mgr_qos_list);
+	_qos_index_rebuild();
 
 	assoc_mgr_unlock(&locks);
 
 	return SLURM_SUCCESS;
 }
 
-/* Used to remove soon to be defunct user pointers from assoc list */
+/*
+ * Used to remove defunct user pointers from assoc list. The new user list has
+ * to be in place and indexed already.
+ */
 static int _foreach_update_assoc_cached_user_rec(void *x, void *arg)
 {
 	slurmdb_assoc_rec_t *assoc = x;
-	list_t *new_user_list = arg;
 	slurmdb_user_rec_t *user = NULL;
 
 	if (assoc->user_rec) {
-		if (new_user_list)
-			user = list_find_first(new_user_list, _list_find_uid,
-					       &assoc->uid);
+		if (assoc_mgr_user_list)
+			user = _find_user_uid(assoc->uid);
 		/*
 		 * If the user is NULL then the association is likely to be
 		 * removed soon by assoc_mgr_refresh_lists(), thus why this is a
@@ -1951,16 +2288,16 @@ static int _get_assoc_mgr_user_list(void *db_conn, int enforce)
 
 	assoc_mgr_lock(&locks);
 
-	if (assoc_mgr_assoc_list)
-		list_for_each(assoc_mgr_assoc_list,
-			      _foreach_update_assoc_cached_user_rec,
-			      current_users);
-
 	FREE_NULL_LIST(assoc_mgr_user_list);
 	FREE_NULL_LIST(assoc_mgr_coord_list);
 	assoc_mgr_user_list = current_users;
 
 	if (!assoc_mgr_user_list) {
+		_user_index_rebuild();
+		if (assoc_mgr_assoc_list)
+			list_for_each(assoc_mgr_assoc_list,
+				      _foreach_update_assoc_cached_user_rec,
+				      NULL);
 		assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_ASSOCS) {
 			error("%s: no list was made.", __func__);
@@ -1971,6 +2308,11 @@ static int _get_assoc_mgr_user_list(void *db_conn, int enforce)
 	}
 
 	_post_user_list(assoc_mgr_user_list);
+	_user_index_rebuild();
+
+	if (assoc_mgr_assoc_list)
+		list_for_each(assoc_mgr_assoc_list,
+			      _foreach_update_assoc_cached_user_rec, NULL);
 
 	assoc_mgr_unlock(&locks);
 	return SLURM_SUCCESS;
@@ -2006,6 +2348,7 @@ static int _get_assoc_mgr_wckey_list(void *db_conn, int enforce)
 		/* create list so we don't keep calling this if there
 		   isn't anything there */
 		assoc_mgr_wckey_list = list_create(slurmdb_destroy_wckey_rec);
+		_wckey_index_rebuild();
 		assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_WCKEYS) {
 			error("%s: no list was made.", __func__);
@@ -2018,6 +2361,7 @@ static int _get_assoc_mgr_wckey_list(void *db_conn, int enforce)
 	}
 
 	_post_wckey_list(assoc_mgr_wckey_list);
+	_wckey_index_rebuild();
 
 	assoc_mgr_unlock(&locks);
 
@@ -2202,6 +2546,7 @@ static int _refresh_assoc_mgr_qos_list(void *db_conn, int enforce)
 	}
 
 	assoc_mgr_qos_list = current_qos;
+	_qos_index_rebuild();
 
 	assoc_mgr_unlock(&locks);
 
@@ -2232,14 +2577,14 @@ static int _refresh_assoc_mgr_user_list(void *db_conn, int enforce)
 
 	assoc_mgr_lock(&locks);
 
-	if (assoc_mgr_assoc_list)
-		list_for_each(assoc_mgr_assoc_list,
-			      _foreach_update_assoc_cached_user_rec,
-			      current_users);
-
 	FREE_NULL_LIST(assoc_mgr_user_list);
 
 	assoc_mgr_user_list = current_users;
+	_user_index_rebuild();
+
+	if (assoc_mgr_assoc_list)
+		list_for_each(assoc_mgr_assoc_list,
+			      _foreach_update_assoc_cached_user_rec, NULL);
 
 	assoc_mgr_unlock(&locks);
 
@@ -2274,12 +2619,15 @@ static int _refresh_assoc_wckey_list(void *db_conn, int enforce)
 		return SLURM_ERROR;
 	}
 
+	assoc_mgr_lock(&locks);
+
+	/* Needs the user lock to set the default wckeys */
 	_post_wckey_list(current_wckeys);
 
-	assoc_mgr_lock(&locks);
 	FREE_NULL_LIST(assoc_mgr_wckey_list);
 
 	assoc_mgr_wckey_list = current_wckeys;
+	_wckey_index_rebuild();
 	assoc_mgr_unlock(&locks);
 
 	return SLURM_SUCCESS;
@@ -2406,6 +2754,10 @@ extern int assoc_mgr_fini(bool save_state)
 	assoc_mgr_user_list = NULL;
 	assoc_mgr_wckey_list = NULL;
 
+	_qos_index_rebuild();
+	_user_index_rebuild();
+	_wckey_index_rebuild();
+
 	assoc_mgr_root_assoc = NULL;
 
 	if (_running_cache())
@@ -2442,8 +2794,7 @@ static slurmdb_admin_level_t _get_admin_level_internal(void *db_conn,
 		return SLURMDB_ADMIN_NOTSET;
 	}
 
-	found_user = list_find_first_ro(assoc_mgr_user_list,
-					_list_find_uid, &uid);
+	found_user = _find_user_uid(uid);
 
 	if (found_user)
 		level = found_user->admin_level;
@@ -3097,6 +3448,13 @@ extern int assoc_mgr_fill_in_assoc(void *db_conn,
 	return SLURM_SUCCESS;
 }
 
+extern slurmdb_assoc_rec_t *assoc_mgr_find_assoc_id(uint32_t assoc_id)
+{
+	xassert(verify_assoc_lock(ASSOC_LOCK, READ_LOCK));
+
+	return _find_assoc_rec_id(assoc_id, slurm_conf.cluster_name);
+}
+
 extern int assoc_mgr_fill_in_user(void *db_conn, slurmdb_user_rec_t *user,
 				  int enforce,
 				  slurmdb_user_rec_t **user_pptr,
@@ -3129,8 +3487,7 @@ extern int assoc_mgr_fill_in_user(void *db_conn, slurmdb_user_rec_t *user,
 		return SLURM_SUCCESS;
 	}
 
-	if (!(found_user = list_find_first_ro(assoc_mgr_user_list,
-					      _list_find_user, user))) {
+	if (!(found_user = _find_user_rec(user))) {
 		if (!locked)
 			assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_ASSOCS)
@@ -3185,6 +3542,35 @@ static int _list_find_qos(void *x, void *key)
 	return 0;
 }
 
+/* QOS_LOCK read lock needs to be held. */
+static slurmdb_qos_rec_t *_find_qos_id(uint32_t qos_id)
+{
+	slurmdb_qos_rec_t key = { .id = qos_id };
+
+	return _index_find(&qos_id_index, &key, slurmdb_find_qos_in_list,
+			   &qos_id);
+}
+
+/*
+ * Same match as _list_find_qos() on assoc_mgr_qos_list. QOS_LOCK read lock
+ * needs to be held.
+ */
+static slurmdb_qos_rec_t *_find_qos_rec(slurmdb_qos_rec_t *qos)
+{
+	slurmdb_qos_rec_t *id_qos, *name_qos;
+
+	id_qos = _find_qos_id(qos->id);
+	if (!qos->name)
+		return id_qos;
+
+	name_qos = _index_find(&qos_name_index, qos, _list_find_qos, qos);
+	if (!id_qos || !name_qos || (id_qos == name_qos))
+		return id_qos ? id_qos : name_qos;
+
+	/* The id and name are of different QOS, the first one listed wins */
+	return list_find_first_ro(assoc_mgr_qos_list, _list_find_qos, qos);
+}
+
 extern int assoc_mgr_fill_in_qos(void *db_conn, slurmdb_qos_rec_t *qos,
 				 int enforce,
 				 slurmdb_qos_rec_t **qos_pptr, bool locked)
@@ -3223,7 +3609,7 @@ extern int assoc_mgr_fill_in_qos(void *db_conn, slurmdb_qos_rec_t *qos,
 		return SLURM_SUCCESS;
 	}
 
-	found_qos = list_find_first_ro(assoc_mgr_qos_list, _list_find_qos, qos);
+	found_qos = _find_qos_rec(qos);
 
 	if (!found_qos) {
 		if (!locked)
@@ -3366,6 +3752,28 @@ static int _list_find_wckey(void *x, void *key)
 	return 1;
 }
 
+/*
+ * Same match as _list_find_wckey() on assoc_mgr_wckey_list.
+ * WCKEY_LOCK read lock needs to be held.
+ */
+static slurmdb_wckey_rec_t *_find_wckey_rec(slurmdb_wckey_rec_t *wckey)
+{
+	if (wckey->id)
+		return _index_find(&wckey_id_index, wckey, _list_find_wckey,
+				   wckey);
+
+	/* Without a name any wckey of the user matches, nothing to hash on */
+	if (wckey->name && (wckey->uid != NO_VAL))
+		return _index_find(&wckey_uid_index, wckey, _list_find_wckey,
+				   wckey);
+	if (wckey->name && wckey->user)
+		return _index_find(&wckey_user_index, wckey, _list_find_wckey,
+				   wckey);
+
+	return list_find_first_ro(assoc_mgr_wckey_list, _list_find_wckey,
+				  wckey);
+}
+
 extern int assoc_mgr_fill_in_wckey(void *db_conn, slurmdb_wckey_rec_t *wckey,
 				   int enforce,
 				   slurmdb_wckey_rec_t **wckey_pptr,
@@ -3456,8 +3864,7 @@ extern int assoc_mgr_fill_in_wckey(void *db_conn, slurmdb_wckey_rec_t *wckey,
 
 	xassert(verify_assoc_lock(WCKEY_LOCK, READ_LOCK));
 
-	ret_wckey = list_find_first_ro(assoc_mgr_wckey_list, _list_find_wckey,
-				    wckey);
+	ret_wckey = _find_wckey_rec(wckey);
 
 	if (!ret_wckey) {
 		if (!locked)
@@ -3542,8 +3949,7 @@ extern list_t *assoc_mgr_user_acct_coords(void *db_conn, char *user_name)
 		return NULL;
 	}
 
-	user = list_find_first_ro(assoc_mgr_coord_list,
-				  _list_find_user, &req_user);
+	user = _find_coord_rec(&req_user);
 
 	if (user && user->coord_accts)
 		ret_list = slurmdb_list_copy_coord(user->coord_accts);
@@ -3559,6 +3965,7 @@ extern bool assoc_mgr_is_user_acct_coord(void *db_conn,
 					 bool is_locked)
 {
 	slurmdb_user_rec_t * found_user = NULL;
+	slurmdb_user_rec_t req_user = { .uid = uid };
 	assoc_mgr_lock_t locks = { .user = READ_LOCK };
 	bool found = false;
 
@@ -3574,8 +3981,7 @@ extern bool assoc_mgr_is_user_acct_coord(void *db_conn,
 		return false;
 	}
 
-	found_user = list_find_first_ro(assoc_mgr_coord_list,
-					_list_find_uid, &uid);
+	found_user = _find_coord_rec(&req_user);
 
 	found = assoc_mgr_is_user_acct_coord_user_rec(found_user, acct_name);
 
@@ -4723,8 +5129,16 @@ extern int assoc_mgr_update_wckeys(slurmdb_update_object_t *update, bool locked)
 			continue;
 		}
 
-		rec = list_find_first_ro(assoc_mgr_wckey_list,
-					 _list_find_wckey_update, object);
+		if (object->id)
+			rec = _index_find(&wckey_id_index, object,
+					  _list_find_wckey_update, object);
+		else if (object->name)
+			rec = _index_find(&wckey_uid_index, object,
+					  _list_find_wckey_update, object);
+		else
+			rec = list_find_first_ro(assoc_mgr_wckey_list,
+						 _list_find_wckey_update,
+						 object);
 
 		//info("%d WCKEY %u", update->type, object->id);
 		switch(update->type) {
@@ -4773,6 +5187,7 @@ extern int assoc_mgr_update_wckeys(slurmdb_update_object_t *update, bool locked)
 			else
 				object->is_def = 0;
 			list_append(assoc_mgr_wckey_list, object);
+			_wckey_index_add(object);
 			object = NULL;
 			break;
 		case SLURMDB_REMOVE_WCKEY:
@@ -4782,6 +5197,7 @@ extern int assoc_mgr_update_wckeys(slurmdb_update_object_t *update, bool locked)
 			}
 			if (rec->is_def == 1)
 				_clear_user_default_wckey(rec);
+			_wckey_index_remove(rec);
 			list_delete_ptr(assoc_mgr_wckey_list, rec);
 			break;
 		default:
@@ -4827,10 +5243,10 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 
 	while ((object = list_pop(update->objects))) {
 		char *name = object->old_name ? object->old_name : object->name;
+		slurmdb_user_rec_t key = { .name = name };
 
-		rec = list_find_first_ro(assoc_mgr_user_list,
-					 _list_find_user_case,
-				      name);
+		rec = _index_find(&user_name_index, &key, _list_find_user_case,
+				  name);
 
 		//info("%d user %s", update->type, object->name);
 		switch(update->type) {
@@ -4850,11 +5266,13 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 					      rec->name);
 					break;
 				}
+				_user_index_remove(rec);
 				xfree(rec->old_name);
 				rec->old_name = rec->name;
 				rec->name = object->name;
 				object->name = NULL;
 				rc = _change_user_name(rec);
+				_user_index_add(rec);
 			}
 
 			if (object->default_acct) {
@@ -4886,6 +5304,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 			} else
 				object->uid = pw_uid;
 			list_append(assoc_mgr_user_list, object);
+			_user_index_add(object);
 			_handle_new_user_coord(object);
 			object = NULL;
 			break;
@@ -4896,6 +5315,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 			}
 			list_delete_first(assoc_mgr_coord_list,
 					  slurm_find_ptr_in_list, rec);
+			_user_index_remove(rec);
 			list_delete_ptr(assoc_mgr_user_list, rec);
 			break;
 		case SLURMDB_ADD_COORD:
@@ -5023,8 +5443,7 @@ extern int assoc_mgr_update_qos(slurmdb_update_object_t *update, bool locked)
 		bool update_jobs = false;
 		bool relative = false;
 
-		rec = list_find_first_ro(assoc_mgr_qos_list,
-				      slurmdb_find_qos_in_list, &object->id);
+		rec = _find_qos_id(object->id);
 
 		//info("%d qos %s", update->type, object->name);
 		switch(update->type) {
@@ -5044,6 +5463,7 @@ extern int assoc_mgr_update_qos(slurmdb_update_object_t *update, bool locked)
 				assoc_mgr_set_qos_tres_cnt(object);
 
 			list_append(assoc_mgr_qos_list, object);
+			_qos_index_add(object);
 /* 			char *tmp = get_qos_complete_str_bitstr( */
 /* 				assoc_mgr_qos_list, */
 /* 				object->preempt_bitstr); */
@@ -5354,11 +5774,14 @@ extern int assoc_mgr_update_qos(slurmdb_update_object_t *update, bool locked)
 				if (!remove_list)
 					remove_list = list_create(
 						slurmdb_destroy_qos_rec);
+				_qos_index_remove(rec);
 				list_remove_first(assoc_mgr_qos_list,
 						  slurm_find_ptr_in_list, rec);
 				list_append(remove_list, rec);
-			} else
+			} else {
+				_qos_index_remove(rec);
 				list_delete_ptr(assoc_mgr_qos_list, rec);
+			}
 
 			/* Remove this qos from preempt lists */
 			list_for_each_ro(assoc_mgr_qos_list,
@@ -6243,8 +6666,7 @@ extern int load_qos_usage(void)
 		safe_unpackstr(&tmp_str, buffer);
 		safe_unpack32(&grp_used_wall, buffer);
 
-		qos = list_find_first_ro(assoc_mgr_qos_list,
-					 slurmdb_find_qos_in_list, &qos_id);
+		qos = _find_qos_id(qos_id);
 		if (qos) {
 			qos->usage->grp_used_wall = grp_used_wall;
 			qos->usage->usage_raw = usage_raw;
@@ -6418,6 +6840,7 @@ extern int load_assoc_mgr_state(void)
 			FREE_NULL_LIST(assoc_mgr_user_list);
 			assoc_mgr_user_list = msg->my_list;
 			_post_user_list(assoc_mgr_user_list);
+			_user_index_rebuild();
 			debug("Recovered %u users",
 			      list_count(assoc_mgr_user_list));
 			msg->my_list = NULL;
@@ -6457,6 +6880,7 @@ extern int load_assoc_mgr_state(void)
 			FREE_NULL_LIST(assoc_mgr_qos_list);
 			assoc_mgr_qos_list = msg->my_list;
 			_post_qos_list(assoc_mgr_qos_list);
+			_qos_index_rebuild();
 			debug("Recovered %u qos",
 			      list_count(assoc_mgr_qos_list));
 			msg->my_list = NULL;
@@ -6473,6 +6897,7 @@ extern int load_assoc_mgr_state(void)
 			}
 			FREE_NULL_LIST(assoc_mgr_wckey_list);
 			assoc_mgr_wckey_list = msg->my_list;
+			_wckey_index_rebuild();
 			debug("Recovered %u wckeys",
 			      list_count(assoc_mgr_wckey_list));
 			msg->my_list = NULL;
@@ -6610,7 +7035,9 @@ static int _each_wckey_set_uid(void *x, void *arg)
 	if ((wckey->uid != NO_VAL) || xstrcmp(wckey->user, user->name))
 		return 0;
 
+	_wckey_index_remove(wckey);
 	wckey->uid = user->uid;
+	_wckey_index_add(wckey);
 	if (wckey->is_def)
 		_set_user_default_wckey(wckey, user);
 
@@ -6638,7 +7065,7 @@ extern void assoc_mgr_set_uid(uid_t uid, char *username)
 		return;
 	}
 
-	if (list_find_first_ro(assoc_mgr_user_list, _list_find_uid, &uid)) {
+	if (_find_user_uid(uid)) {
 		debug2("%s: uid=%u already known", __func__, uid);
 		assoc_mgr_unlock(&read_lock);
 		return;
@@ -6652,8 +7079,7 @@ extern void assoc_mgr_set_uid(uid_t uid, char *username)
 		return;
 	}
 
-	if (!(user = list_find_first(assoc_mgr_user_list, _list_find_user,
-				     &lookup))) {
+	if (!(user = _find_user_rec(&lookup))) {
 		debug2("%s: user %s not in assoc_mgr_user_list",
 		       __func__, username);
 		assoc_mgr_unlock(&write_locks);
@@ -6662,7 +7088,9 @@ extern void assoc_mgr_set_uid(uid_t uid, char *username)
 
 	debug2("%s: adding mapping for user %s uid %u",
 	       __func__, username, uid);
+	_user_index_remove(user);
 	user->uid = uid;
+	_user_index_add(user);
 
 	if (assoc_mgr_assoc_list)
 		list_for_each(assoc_mgr_assoc_list, _each_assoc_set_uid, user);
@@ -6713,7 +7141,9 @@ static int _for_each_wckey_missing_uids(void *x, void *arg)
 		       __func__, object->user);
 	} else {
 		bool *uid_set = arg;
+		_wckey_index_remove(object);
 		object->uid = pw_uid;
+		_wckey_index_add(object);
 		debug3("%s: found uid %u for user %s",
 		       __func__, pw_uid, object->name);
 		if (uid_set)
@@ -6738,7 +7168,9 @@ static int _for_each_user_missing_uids(void *x, void *arg)
 		bool *uid_set = arg;
 		debug3("%s: found uid %u for user %s",
 		       __func__, pw_uid, object->name);
+		_user_index_remove(object);
 		object->uid = pw_uid;
+		_user_index_add(object);
 		if (uid_set)
 			*uid_set = true;
 	}
@@ -7619,8 +8051,7 @@ extern bool assoc_mgr_check_coord_qos(char *cluster_name, char *account,
 
 	/* check if coord_name is coord of account name */
 
-	if ((user = list_find_first_ro(assoc_mgr_coord_list,
-				       _list_find_user, &req_user))) {
+	if ((user = _find_coord_rec(&req_user))) {
 		if (list_find_first(user->coord_accts,
 				    assoc_mgr_find_coord_in_user,
 				    account)) {
@@ -7703,3 +8134,22 @@ extern bool assoc_mgr_tree_has_user_coord(slurmdb_assoc_rec_t *assoc,
 
 	return rc;
 }
+
+extern void assoc_mgr_get_lookup_stats(uint64_t *lookups)
+{
+	for (int i = 0; i < ASSOC_MGR_ENTITY_COUNT; i++) {
+#ifndef __STDC_NO_ATOMICS__
+		lookups[i] = atomic_uint64_get(lookup_cnt[i]);
+#else
+		lookups[i] = 0;
+#endif
+	}
+}
+
+extern void assoc_mgr_reset_lookup_stats(void)
+{
+#ifndef __STDC_NO_ATOMICS__
+	for (int i = 0; i < ASSOC_MGR_ENTITY_COUNT; i++)
+		(void) atomic_uint64_set_zero(lookup_cnt[i]);
+#endif
+}
@@ -210,6 +210,15 @@ extern int assoc_mgr_fill_in_assoc(void *db_conn,
 				   slurmdb_assoc_rec_t **assoc_pptr,
 				   bool locked);
 
+/*
+ * Find an association in the cache by id.
+ * NOTE: READ lock on associations must be held while calling this and for as
+ *	 long as the returned pointer is used.
+ * IN: assoc_id - id of the association
+ * RET: pointer to the cached association or NULL if not found. DO NOT FREE.
+ */
+extern slurmdb_assoc_rec_t *assoc_mgr_find_assoc_id(uint32_t assoc_id);
+
 /*
  * get info from the storage
  * IN/OUT:  user - slurmdb_user_rec_t with the name set of the user.
@@ -660,4 +669,15 @@ extern bool assoc_mgr_check_coord_qos(char *cluster_name, char *account,
  */
 extern bool assoc_mgr_tree_has_user_coord(slurmdb_assoc_rec_t *assoc,
 					  bool locked);
+
+/*
+ * Get the number of hashed lookups done in each assoc_mgr table since the last
+ * reset. Counts are always 0 if built without C11 atomics.
+ * OUT lookups - array of ASSOC_MGR_ENTITY_COUNT elements indexed by
+ *		 assoc_mgr_lock_datatype_t
+ */
+extern void assoc_mgr_get_lookup_stats(uint64_t *lookups);
+
+/* Zero the counters returned by assoc_mgr_get_lookup_stats() */
+extern void assoc_mgr_reset_lookup_stats(void);
 #endif /* _SLURM_ASSOC_MGR_H */
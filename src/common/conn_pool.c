@@ -0,0 +1,330 @@
+/*****************************************************************************\
+ *  conn_pool.c - reuse connections to slurmd between RPCs
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/common/conn_pool.h"
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/read_config.h"
+#include "src/common/run_in_daemon.h"
+#include "src/common/util-net.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#define MAGIC_CONN_POOL_ENT 0x3a1c0d2e
+
+/* Max number of idle connections kept across all peers */
+#define CONN_POOL_MAX_IDLE 1024
+/* Max number of idle connections kept to a single peer */
+#define CONN_POOL_MAX_IDLE_PEER 4
+
+typedef struct {
+	int magic; /* MAGIC_CONN_POOL_ENT */
+	slurm_addr_t addr;
+	conn_t *conn;
+	time_t last_used;
+} conn_pool_ent_t;
+
+typedef struct {
+	const slurm_addr_t *addr;
+	time_t now;
+	int peer_cnt;
+} foreach_expire_args_t;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static time_t config_update = (time_t) -1;
+static int idle_timeout = 0;
+/* list of conn_pool_ent_t with least recently used at the front */
+static list_t *idle_conns = NULL;
+static conn_pool_stats_t stats = { 0 };
+
+static void _free_ent(void *x)
+{
+	conn_pool_ent_t *ent = x;
+
+	if (!ent)
+		return;
+
+	xassert(ent->magic == MAGIC_CONN_POOL_ENT);
+	ent->magic = ~MAGIC_CONN_POOL_ENT;
+	FREE_NULL_CONN(ent->conn);
+	xfree(ent);
+}
+
+/* Load CommunicationParameters=conn_pool_idle_timeout. Caller holds lock. */
+static void _load_config(void)
+{
+	char *tmp_ptr;
+
+	if (config_update == slurm_conf.last_update)
+		return;
+
+	idle_timeout = 0;
+	if (running_in_daemon() &&
+	    (tmp_ptr = xstrcasestr(slurm_conf.comm_params,
+				   "conn_pool_idle_timeout="))) {
+		long tmp_val = strtol(tmp_ptr + 23, NULL, 10);
+
+		if ((tmp_val > 0) && (tmp_val <= INFINITE16))
+			idle_timeout = tmp_val;
+		else
+			error("CommunicationParameters option conn_pool_idle_timeout=%ld is invalid, ignored",
+			      tmp_val);
+	}
+
+	if (!idle_timeout && idle_conns && list_count(idle_conns))
+		log_flag(NET, "%s: connection pool disabled, closing %d idle connections",
+			 __func__, list_count(idle_conns));
+	if (!idle_timeout)
+		FREE_NULL_LIST(idle_conns);
+
+	config_update = slurm_conf.last_update;
+}
+
+extern bool conn_pool_enabled(void)
+{
+	return (conn_pool_idle_timeout() > 0);
+}
+
+extern int conn_pool_idle_timeout(void)
+{
+	int timeout;
+
+	slurm_mutex_lock(&pool_lock);
+	_load_config();
+	timeout = idle_timeout;
+	slurm_mutex_unlock(&pool_lock);
+
+	return timeout;
+}
+
+static bool _same_addr(const slurm_addr_t *a, const slurm_addr_t *b)
+{
+	if (a->ss_family != b->ss_family)
+		return false;
+
+	if (a->ss_family == AF_INET) {
+		const struct sockaddr_in *a4 = (const struct sockaddr_in *) a;
+		const struct sockaddr_in *b4 = (const struct sockaddr_in *) b;
+
+		return ((a4->sin_port == b4->sin_port) &&
+			(a4->sin_addr.s_addr == b4->sin_addr.s_addr));
+	} else if (a->ss_family == AF_INET6) {
+		const struct sockaddr_in6 *a6 = (const struct sockaddr_in6 *) a;
+		const struct sockaddr_in6 *b6 = (const struct sockaddr_in6 *) b;
+
+		return ((a6->sin6_port == b6->sin6_port) &&
+			!memcmp(&a6->sin6_addr, &b6->sin6_addr,
+				sizeof(a6->sin6_addr)));
+	}
+
+	return false;
+}
+
+/*
+ * Check that the peer has not closed an idle connection. Nothing is sent by
+ * the peer while idle, so anything readable is EOF, an error or junk.
+ */
+static bool _is_healthy(conn_t *conn)
+{
+	struct pollfd pfd = {
+		.fd = conn_g_get_fd(conn),
+		.events = POLLIN,
+	};
+
+	if (pfd.fd < 0)
+		return false;
+
+	if (conn_g_peek(conn))
+		return false;
+
+	return (poll(&pfd, 1, 0) == 0);
+}
+
+/* Release expired connections and count the idle ones to args->addr */
+static int _foreach_expire(void *x, void *arg)
+{
+	conn_pool_ent_t *ent = x;
+	foreach_expire_args_t *args = arg;
+
+	xassert(ent->magic == MAGIC_CONN_POOL_ENT);
+
+	if ((args->now - ent->last_used) >= idle_timeout) {
+		stats.expired++;
+		return 1;
+	}
+
+	if (args->addr && _same_addr(&ent->addr, args->addr))
+		args->peer_cnt++;
+
+	return 0;
+}
+
+static int _find_addr(void *x, void *key)
+{
+	conn_pool_ent_t *ent = x;
+
+	return _same_addr(&ent->addr, key);
+}
+
+extern conn_t *conn_pool_get(const slurm_addr_t *addr)
+{
+	conn_pool_ent_t *ent;
+	conn_t *conn = NULL;
+	foreach_expire_args_t args = {
+		.now = time(NULL),
+	};
+
+	slurm_mutex_lock(&pool_lock);
+	_load_config();
+
+	if (!idle_timeout)
+		goto done;
+
+	if (idle_conns)
+		(void) list_delete_all(idle_conns, _foreach_expire, &args);
+
+	while (!conn && idle_conns &&
+	       (ent = list_remove_first(idle_conns, _find_addr,
+					(void *) addr))) {
+		if (_is_healthy(ent->conn)) {
+			SWAP(conn, ent->conn);
+			stats.reused++;
+		} else {
+			log_flag(NET, "%s: [%pA] discarding idle connection closed by peer",
+				 __func__, addr);
+			stats.stale++;
+		}
+
+		_free_ent(ent);
+	}
+
+	if (!conn)
+		stats.connects++;
+
+done:
+	slurm_mutex_unlock(&pool_lock);
+
+	if (conn)
+		log_flag(NET, "%s: [%pA] reusing idle connection on fd %d",
+			 __func__, addr, conn_g_get_fd(conn));
+
+	return conn;
+}
+
+extern void conn_pool_put(const slurm_addr_t *addr, conn_t *conn)
+{
+	conn_pool_ent_t *ent = NULL;
+	foreach_expire_args_t args = {
+		.addr = addr,
+		.now = time(NULL),
+	};
+
+	slurm_mutex_lock(&pool_lock);
+	_load_config();
+
+	if (!idle_timeout)
+		goto done;
+
+	if (!idle_conns)
+		idle_conns = list_create(_free_ent);
+
+	(void) list_delete_all(idle_conns, _foreach_expire, &args);
+
+	if (args.peer_cnt >= CONN_POOL_MAX_IDLE_PEER) {
+		log_flag(NET, "%s: [%pA] already have %d idle connections, closing fd %d",
+			 __func__, addr, args.peer_cnt, conn_g_get_fd(conn));
+		goto done;
+	}
+
+	/* Least recently used connection makes room */
+	if (list_count(idle_conns) >= CONN_POOL_MAX_IDLE)
+		_free_ent(list_pop(idle_conns));
+
+	ent = xmalloc(sizeof(*ent));
+	*ent = (conn_pool_ent_t) {
+		.magic = MAGIC_CONN_POOL_ENT,
+		.addr = *addr,
+		.conn = conn,
+		.last_used = args.now,
+	};
+	conn = NULL;
+
+	list_append(idle_conns, ent);
+
+	log_flag(NET, "%s: [%pA] keeping idle connection on fd %d",
+		 __func__, addr, conn_g_get_fd(ent->conn));
+
+done:
+	slurm_mutex_unlock(&pool_lock);
+
+	FREE_NULL_CONN(conn);
+}
+
+extern void conn_pool_count_retry(void)
+{
+	slurm_mutex_lock(&pool_lock);
+	stats.retries++;
+	/* Replaced by a new connection */
+	stats.connects++;
+	slurm_mutex_unlock(&pool_lock);
+}
+
+extern void conn_pool_flush(void)
+{
+	slurm_mutex_lock(&pool_lock);
+	FREE_NULL_LIST(idle_conns);
+	slurm_mutex_unlock(&pool_lock);
+}
+
+extern void conn_pool_stats_get(conn_pool_stats_t *stats_ptr)
+{
+	slurm_mutex_lock(&pool_lock);
+	*stats_ptr = stats;
+	slurm_mutex_unlock(&pool_lock);
+}
+
+extern void conn_pool_stats_reset(void)
+{
+	slurm_mutex_lock(&pool_lock);
+	stats = (conn_pool_stats_t) { 0 };
+	slurm_mutex_unlock(&pool_lock);
+}
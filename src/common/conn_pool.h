@@ -0,0 +1,95 @@
+/*****************************************************************************\
+ *  conn_pool.h - reuse connections to slurmd between RPCs
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _CONN_POOL_H
+#define _CONN_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "src/common/slurm_protocol_defs.h"
+#include "src/interfaces/conn.h"
+
+/* Connection pool counters */
+typedef struct {
+	uint64_t connects; /* new connections opened while pool enabled */
+	uint64_t reused; /* idle connections handed out instead of connecting */
+	uint64_t stale; /* idle connections closed by the peer before reuse */
+	uint64_t expired; /* idle connections closed after idle timeout */
+	uint64_t retries; /* reused connections that failed and were replaced */
+} conn_pool_stats_t;
+
+/*
+ * Check if connections are pooled by this process, as configured by
+ * CommunicationParameters=conn_pool_idle_timeout=#.
+ * RET true if idle connections are kept for reuse
+ */
+extern bool conn_pool_enabled(void);
+
+/*
+ * Seconds an idle connection is kept for reuse
+ * RET idle timeout or 0 if pooling is disabled
+ */
+extern int conn_pool_idle_timeout(void);
+
+/*
+ * Take an idle connection to addr out of the pool
+ * Connections closed by the peer or idle for too long are released.
+ * IN addr - address of peer
+ * RET connection or NULL if none available (counted as a new connect)
+ */
+extern conn_t *conn_pool_get(const slurm_addr_t *addr);
+
+/*
+ * Return connection to the pool after the peer agreed to keep it open
+ * Connection is released if the pool is disabled or full.
+ * IN addr - address of peer
+ * IN conn - connection with no outstanding RPC (ownership is taken)
+ */
+extern void conn_pool_put(const slurm_addr_t *addr, conn_t *conn);
+
+/* Count a reused connection that failed being replaced by a new one */
+extern void conn_pool_count_retry(void);
+
+/* Release all idle connections */
+extern void conn_pool_flush(void);
+
+/* Get copy of connection pool counters */
+extern void conn_pool_stats_get(conn_pool_stats_t *stats);
+
+/* Reset connection pool counters */
+extern void conn_pool_stats_reset(void);
+
+#endif
@@ -60,6 +60,10 @@
 
 #include "src/interfaces/conn.h"
 
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 /*
  * Define slurm-specific aliases for use by plugins, see slurm_xlator.h
  * for details.
@@ -92,6 +96,13 @@ struct eio_handle_components {
 	list_t *obj_list;
 	list_t *new_objs;
 	list_t *del_objs;
+#ifdef HAVE_EPOLL
+	int epfd;		/* -1 when falling back to poll() */
+	uint32_t pass;		/* mainloop iteration counter */
+	uint32_t next_reg_id;	/* next eio_obj_t.reg_id to hand out */
+	struct eio_epoll_fd *reg; /* registrations indexed by fd */
+	int reg_cnt;		/* size of reg */
+#endif
 };
 
 typedef struct {
@@ -100,6 +111,40 @@ typedef struct {
 	struct pollfd *pfds;
 } foreach_pollfd_t;
 
+#ifdef HAVE_EPOLL
+/*
+ * Registrations persist across mainloop iterations so that an object whose
+ * interest does not change costs no system call. Every registration is
+ * EPOLLONESHOT, so only fds which fired (or whose interest changed) are
+ * re-armed, which keeps the semantics of level-triggered poll().
+ */
+#define EIO_EPOLL_WAKEUP UINT64_MAX
+
+typedef struct eio_epoll_fd {
+	uint32_t armed;		/* epoll events armed, 0 if disarmed */
+	uint32_t gen;		/* bumped whenever the registration is reset */
+	uint32_t owner;		/* reg_id of object that registered the fd */
+	uint32_t pass;		/* last pass in which an object wanted the fd */
+	short want;		/* poll events wanted by objects this pass */
+	short revents;		/* poll events gathered this pass */
+	bool registered;	/* fd was added to the epoll set */
+	bool always_ready;	/* epoll refuses fd, e.g. a regular file */
+} eio_epoll_fd_t;
+
+typedef struct {
+	eio_obj_t *obj;
+	int fd;
+	short events;
+} eio_epoll_obj_t;
+
+typedef struct {
+	eio_handle_t *eio;
+	eio_epoll_obj_t *objs;
+	int obj_cnt;
+	int obj_max;
+} foreach_epoll_t;
+#endif
+
 /* Function prototypes */
 
 static int _poll_internal(struct pollfd *pfds, unsigned int nfds,
@@ -111,12 +156,20 @@ static void _poll_dispatch(struct pollfd *pfds, unsigned int nfds,
 			   list_t *del_objs);
 static void _poll_handle_event(short revents, eio_obj_t *obj, list_t *objList,
 			       list_t *del_objs);
+static time_t _get_shutdown_time(eio_handle_t *eio);
+static bool _shutdown_expired(eio_handle_t *eio);
+#ifdef HAVE_EPOLL
+static int _epoll_mainloop(eio_handle_t *eio);
+#endif
 
 eio_handle_t *eio_handle_create(uint16_t shutdown_wait)
 {
 	eio_handle_t *eio = xmalloc(sizeof(*eio));
 
 	eio->magic = EIO_MAGIC;
+#ifdef HAVE_EPOLL
+	eio->epfd = -1;
+#endif
 
 	if (pipe2(eio->fds, O_CLOEXEC) < 0) {
 		error("%s: pipe: %m", __func__);
@@ -135,6 +188,25 @@ eio_handle_t *eio_handle_create(uint16_t shutdown_wait)
 	if (shutdown_wait > 0)
 		eio->shutdown_wait = shutdown_wait;
 
+#ifdef HAVE_EPOLL
+	if ((eio->epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+		debug("%s: epoll_create1: %m, falling back to poll()",
+		      __func__);
+	} else {
+		struct epoll_event ev = {
+			.events = EPOLLIN,
+			.data.u64 = EIO_EPOLL_WAKEUP,
+		};
+
+		if (epoll_ctl(eio->epfd, EPOLL_CTL_ADD, eio->fds[0], &ev)) {
+			debug("%s: epoll_ctl: %m, falling back to poll()",
+			      __func__);
+			close(eio->epfd);
+			eio->epfd = -1;
+		}
+	}
+#endif
+
 	return eio;
 }
 
@@ -144,6 +216,11 @@ void eio_handle_destroy(eio_handle_t *eio)
 	xassert(eio->magic == EIO_MAGIC);
 	close(eio->fds[0]);
 	close(eio->fds[1]);
+#ifdef HAVE_EPOLL
+	if (eio->epfd >= 0)
+		close(eio->epfd);
+	xfree(eio->reg);
+#endif
 	FREE_NULL_LIST(eio->obj_list);
 	FREE_NULL_LIST(eio->new_objs);
 	FREE_NULL_LIST(eio->del_objs);
@@ -304,6 +381,11 @@ int eio_handle_mainloop(eio_handle_t *eio)
 	xassert (eio != NULL);
 	xassert (eio->magic == EIO_MAGIC);
 
+#ifdef HAVE_EPOLL
+	if (eio->epfd >= 0)
+		return _epoll_mainloop(eio);
+#endif
+
 	while (1) {
 		/* Alloc memory for pfds and map if needed */
 		n = list_count(eio->obj_list);
@@ -333,9 +415,7 @@ int eio_handle_mainloop(eio_handle_t *eio)
 		xassert(nfds <= maxnfds + 1);
 
 		/* Get shutdown_time to pass to _poll_internal */
-		slurm_mutex_lock(&eio->shutdown_mutex);
-		shutdown_time = eio->shutdown_time;
-		slurm_mutex_unlock(&eio->shutdown_mutex);
+		shutdown_time = _get_shutdown_time(eio);
 
 		if (_poll_internal(pollfds, nfds, map, shutdown_time) < 0)
 			goto error;
@@ -347,15 +427,8 @@ int eio_handle_mainloop(eio_handle_t *eio)
 		_poll_dispatch(pollfds, nfds - 1, map, eio->obj_list,
 			       eio->del_objs);
 
-		slurm_mutex_lock(&eio->shutdown_mutex);
-		shutdown_time = eio->shutdown_time;
-		slurm_mutex_unlock(&eio->shutdown_mutex);
-		if (shutdown_time &&
-		    (difftime(time(NULL), shutdown_time)>=eio->shutdown_wait)) {
-			error("%s: Abandoning IO %d secs after job shutdown initiated",
-			      __func__, eio->shutdown_wait);
+		if (_shutdown_expired(eio))
 			break;
-		}
 
 		/*
 		 * Close and remove all expired eio objects at every wakeup.
@@ -374,6 +447,31 @@ done:
 	return retval;
 }
 
+static time_t _get_shutdown_time(eio_handle_t *eio)
+{
+	time_t shutdown_time;
+
+	slurm_mutex_lock(&eio->shutdown_mutex);
+	shutdown_time = eio->shutdown_time;
+	slurm_mutex_unlock(&eio->shutdown_mutex);
+
+	return shutdown_time;
+}
+
+static bool _shutdown_expired(eio_handle_t *eio)
+{
+	time_t shutdown_time = _get_shutdown_time(eio);
+
+	if (shutdown_time &&
+	    (difftime(time(NULL), shutdown_time) >= eio->shutdown_wait)) {
+		error("%s: Abandoning IO %d secs after job shutdown initiated",
+		      __func__, eio->shutdown_wait);
+		return true;
+	}
+
+	return false;
+}
+
 static bool _peek_internal(eio_obj_t *map[], unsigned int obj_cnt)
 {
 	bool data_on_any_conn = false;
@@ -563,6 +661,321 @@ end:
 	}
 }
 
+#ifdef HAVE_EPOLL
+static uint32_t _poll_to_epoll(short events)
+{
+	uint32_t ev = 0;
+
+	if (events & POLLIN)
+		ev |= EPOLLIN;
+	if (events & POLLOUT)
+		ev |= EPOLLOUT;
+	if (events & POLLRDHUP)
+		ev |= EPOLLRDHUP;
+
+	return ev;
+}
+
+static short _epoll_to_poll(uint32_t ev)
+{
+	short revents = 0;
+
+	if (ev & EPOLLIN)
+		revents |= POLLIN;
+	if (ev & EPOLLOUT)
+		revents |= POLLOUT;
+	if (ev & EPOLLRDHUP)
+		revents |= POLLRDHUP;
+	if (ev & EPOLLHUP)
+		revents |= POLLHUP;
+	if (ev & EPOLLERR)
+		revents |= POLLERR;
+
+	return revents;
+}
+
+static eio_epoll_fd_t *_epoll_reg(eio_handle_t *eio, int fd)
+{
+	if (fd >= eio->reg_cnt) {
+		int cnt = MAX(fd + 1, eio->reg_cnt * 2);
+
+		xrecalloc(eio->reg, cnt, sizeof(*eio->reg));
+		eio->reg_cnt = cnt;
+	}
+
+	return &eio->reg[fd];
+}
+
+static void _epoll_reset(eio_handle_t *eio, int fd, eio_epoll_fd_t *reg)
+{
+	/*
+	 * The fd may have been closed and reused since it was registered. A
+	 * stale registration for the old file is auto-removed by the kernel
+	 * once the file is closed, so failures here are expected and harmless.
+	 */
+	if (reg->registered)
+		(void) epoll_ctl(eio->epfd, EPOLL_CTL_DEL, fd, NULL);
+
+	reg->registered = false;
+	reg->always_ready = false;
+	reg->armed = 0;
+	reg->gen++;
+}
+
+static int _foreach_epoll_setup(void *x, void *arg)
+{
+	eio_obj_t *obj = x;
+	foreach_epoll_t *args = arg;
+	eio_handle_t *eio = args->eio;
+	eio_epoll_obj_t *eobj;
+	eio_epoll_fd_t *reg;
+	bool readable, writable;
+	short events;
+
+	writable = _is_writable(obj);
+	readable = _is_readable(obj);
+	if (writable && readable)
+		events = POLLOUT | POLLIN | POLLHUP | POLLRDHUP;
+	else if (readable)
+		events = POLLIN | POLLRDHUP;
+	else if (writable)
+		events = POLLOUT | POLLHUP;
+	else
+		return 0;
+
+	if (!obj->reg_id) {
+		if (!++eio->next_reg_id)
+			eio->next_reg_id++;
+		obj->reg_id = eio->next_reg_id;
+	}
+
+	if (args->obj_cnt >= args->obj_max) {
+		args->obj_max = MAX(64, args->obj_max * 2);
+		xrecalloc(args->objs, args->obj_max, sizeof(*args->objs));
+	}
+	eobj = &args->objs[args->obj_cnt++];
+	eobj->obj = obj;
+	eobj->fd = obj->fd;
+	eobj->events = events;
+
+	/* Same as poll(), negative fds are never reported ready */
+	if (obj->fd < 0)
+		return 0;
+
+	reg = _epoll_reg(eio, obj->fd);
+	if (reg->pass != eio->pass) {
+		reg->pass = eio->pass;
+		reg->want = 0;
+		reg->revents = 0;
+
+		/* Another object now owns this fd number */
+		if (reg->owner != obj->reg_id) {
+			_epoll_reset(eio, obj->fd, reg);
+			reg->owner = obj->reg_id;
+		}
+	}
+	reg->want |= events;
+
+	return 0;
+}
+
+/*
+ * Bring the kernel registration of fd in line with what the objects want.
+ * RET true if the fd must be dispatched without waiting on epoll.
+ */
+static bool _epoll_sync(eio_handle_t *eio, int fd, eio_epoll_fd_t *reg)
+{
+	struct epoll_event ev = {
+		.events = _poll_to_epoll(reg->want) | EPOLLONESHOT,
+		.data.u64 = (((uint64_t) reg->gen) << 32) | (uint32_t) fd,
+	};
+	int rc, op;
+
+	if (reg->always_ready) {
+		reg->revents = reg->want & (POLLIN | POLLOUT);
+		return true;
+	}
+
+	if (reg->armed == ev.events)
+		return false;
+
+	op = reg->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+	if ((rc = epoll_ctl(eio->epfd, op, fd, &ev))) {
+		if ((errno == ENOENT) && (op == EPOLL_CTL_MOD))
+			rc = epoll_ctl(eio->epfd, EPOLL_CTL_ADD, fd, &ev);
+		else if ((errno == EEXIST) && (op == EPOLL_CTL_ADD))
+			rc = epoll_ctl(eio->epfd, EPOLL_CTL_MOD, fd, &ev);
+	}
+
+	if (!rc) {
+		reg->registered = true;
+		reg->armed = ev.events;
+		return false;
+	}
+
+	reg->registered = false;
+	reg->armed = 0;
+
+	if (errno == EPERM) {
+		/* Regular files and such are always ready under poll() */
+		reg->always_ready = true;
+		reg->revents = reg->want & (POLLIN | POLLOUT);
+	} else {
+		if (errno != EBADF)
+			error("%s: epoll_ctl(%d): %m", __func__, fd);
+		reg->revents = POLLNVAL;
+	}
+
+	return true;
+}
+
+static int _epoll_internal(eio_handle_t *eio, foreach_epoll_t *args,
+			   struct epoll_event **events, int *max_events,
+			   bool *wakeup)
+{
+	bool ready = false;
+	int n, timeout;
+
+	*wakeup = false;
+
+	for (int i = 0; i < args->obj_cnt; i++) {
+		eio_epoll_obj_t *eobj = &args->objs[i];
+		eio_epoll_fd_t *reg;
+
+		if (eobj->obj->conn &&
+		    (eobj->obj->data_on_conn = conn_g_peek(eobj->obj->conn)))
+			ready = true;
+
+		if (eobj->fd < 0)
+			continue;
+
+		/* Only sync each fd once per pass */
+		reg = &eio->reg[eobj->fd];
+		if (reg->owner != eobj->obj->reg_id)
+			continue;
+		if (_epoll_sync(eio, eobj->fd, reg))
+			ready = true;
+	}
+
+	if (ready)
+		timeout = 0;
+	else if (_get_shutdown_time(eio))
+		timeout = 1000;	/* Return every 1000 msec during shutdown */
+	else
+		timeout = 60000;
+
+	if (*max_events < (args->obj_cnt + 1)) {
+		*max_events = args->obj_cnt + 1;
+		xrecalloc(*events, *max_events, sizeof(**events));
+	}
+
+	while ((n = epoll_wait(eio->epfd, *events, *max_events, timeout)) < 0) {
+		switch (errno) {
+		case EINTR:
+			return 0;
+		case EAGAIN:
+			continue;
+		default:
+			error("epoll_wait: %m");
+			return -1;
+		}
+	}
+
+	for (int i = 0; i < n; i++) {
+		struct epoll_event *ev = &(*events)[i];
+		int fd = (int) (ev->data.u64 & UINT32_MAX);
+		uint32_t gen = (uint32_t) (ev->data.u64 >> 32);
+		eio_epoll_fd_t *reg;
+
+		if (ev->data.u64 == EIO_EPOLL_WAKEUP) {
+			*wakeup = true;
+			continue;
+		}
+
+		if (fd >= eio->reg_cnt)
+			continue;
+		reg = &eio->reg[fd];
+		if (reg->gen != gen)
+			continue;
+
+		/* ONESHOT has disarmed the fd */
+		reg->armed = 0;
+
+		/* Nobody wants the fd anymore, it gets re-armed on demand */
+		if (reg->pass != eio->pass)
+			continue;
+
+		reg->revents |= _epoll_to_poll(ev->events);
+	}
+
+	return n;
+}
+
+static void _epoll_dispatch(eio_handle_t *eio, foreach_epoll_t *args)
+{
+	for (int i = 0; i < args->obj_cnt; i++) {
+		eio_epoll_obj_t *eobj = &args->objs[i];
+		short revents = 0;
+
+		if (eobj->fd >= 0)
+			revents = eio->reg[eobj->fd].revents &
+				  (eobj->events | POLLERR | POLLNVAL | POLLHUP);
+
+		if (revents || eobj->obj->data_on_conn)
+			_poll_handle_event(revents, eobj->obj, eio->obj_list,
+					   eio->del_objs);
+	}
+}
+
+static int _epoll_mainloop(eio_handle_t *eio)
+{
+	int retval = 0, max_events = 0;
+	struct epoll_event *events = NULL;
+	foreach_epoll_t args = { .eio = eio };
+	bool wakeup;
+	time_t now;
+
+	while (1) {
+		eio->pass++;
+		args.obj_cnt = 0;
+
+		debug4("eio: handling events for %d objects",
+		       list_count(eio->obj_list));
+		list_for_each(eio->obj_list, _foreach_epoll_setup, &args);
+		if (!args.obj_cnt)
+			goto done;
+
+		if (_epoll_internal(eio, &args, &events, &max_events,
+				    &wakeup) < 0)
+			goto error;
+
+		/* See if we've been told to shut down by eio_signal_shutdown */
+		if (wakeup)
+			_eio_wakeup_handler(eio);
+
+		_epoll_dispatch(eio, &args);
+
+		if (_shutdown_expired(eio))
+			break;
+
+		/*
+		 * Close and remove all expired eio objects at every wakeup.
+		 */
+		now = time(NULL);
+		list_delete_all(eio->del_objs, _close_eio_socket, &now);
+	}
+
+error:
+	retval = -1;
+done:
+	now = 0;
+	list_delete_all(eio->del_objs, _close_eio_socket, &now);
+	xfree(events);
+	xfree(args.objs);
+	return retval;
+}
+#endif
+
 static struct io_operations *_ops_copy(struct io_operations *ops)
 {
 	struct io_operations *ret = xmalloc(sizeof(*ops));
@@ -74,6 +74,7 @@ struct eio_obj {
 	struct io_operations *ops;        /* pointer to ops struct for obj   */
 	bool shutdown;
 	time_t close_time; /* time we marked this to be closed */
+	uint32_t reg_id;   /* eio internal, identifies fd registrations */
 };
 
 eio_handle_t *eio_handle_create(uint16_t);
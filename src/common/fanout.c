@@ -0,0 +1,615 @@
+/*****************************************************************************\
+ *  fanout.c - send RPCs to many nodes over conmgr connections
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "slurm/slurm_errno.h"
+
+#include "src/common/fanout.h"
+#include "src/common/forward.h"
+#include "src/common/hostlist.h"
+#include "src/common/macros.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/conmgr/conmgr.h"
+
+#define MAGIC_FANOUT 0x2ab1d0f3
+#define MAGIC_FANOUT_REQ 0x2ab1d0f4
+
+/*
+ * Max number of fanout connections open at once across all callers. Requests
+ * past this wait in pending_reqs until another connection finishes.
+ */
+#define FANOUT_MAX_ACTIVE 256
+
+/* Seconds between attempts to connect when the connection was refused */
+#define FANOUT_RETRY_DELAY 1
+
+typedef struct {
+	int magic; /* MAGIC_FANOUT */
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	slurm_msg_t *msg;
+	fanout_flags_t flags;
+	int tree_depth;
+	int timeout; /* milliseconds */
+	conmgr_timeouts_t timeouts;
+	/* number of requests not yet finished - protected by mutex */
+	int pending;
+	/* list of ret_data_info_t - protected by mutex */
+	list_t *ret_list;
+} fanout_t;
+
+typedef struct {
+	int magic; /* MAGIC_FANOUT_REQ */
+	fanout_t *fanout;
+	/* node currently being sent to */
+	char *name;
+	slurm_addr_t addr;
+	/* first attempt to connect to name */
+	time_t start;
+	/* nodes that name was asked to forward to */
+	hostlist_t *hl;
+	int fwd_cnt;
+	/* RPC was sent with FANOUT_FLAG_NO_REPLY */
+	bool sent;
+	/* error from the response (if any) */
+	int rc;
+	/* responses received or NULL if no response */
+	list_t *ret_list;
+} fanout_req_t;
+
+static pthread_mutex_t active_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int active_cnt = 0;
+static list_t *pending_reqs = NULL;
+
+static void *_on_connection(conmgr_callback_args_t conmgr_args, void *arg);
+static int _on_msg(conmgr_callback_args_t conmgr_args, slurm_msg_t *msg,
+		   int unpack_rc, void *arg);
+static void _on_finish(conmgr_callback_args_t conmgr_args, void *arg);
+
+static const conmgr_events_t events = {
+	.on_connection = _on_connection,
+	.on_msg = _on_msg,
+	.on_finish = _on_finish,
+	.on_connect_failed = _on_finish,
+};
+
+extern bool fanout_enabled(void)
+{
+	static pthread_mutex_t config_mutex = PTHREAD_MUTEX_INITIALIZER;
+	static time_t config_update = (time_t) -1;
+	static bool enable = false;
+	bool enabled;
+
+	/* Called from any agent or RPC thread */
+	slurm_mutex_lock(&config_mutex);
+	if (config_update != slurm_conf.last_update) {
+		enable = (xstrcasestr(slurm_conf.slurmctld_params,
+				      "enable_async_fanout"));
+		config_update = slurm_conf.last_update;
+	}
+	enabled = enable;
+	slurm_mutex_unlock(&config_mutex);
+
+	/* New connections will not be processed while quiesced */
+	return (enabled && conmgr_enabled() && !conmgr_is_quiesced());
+}
+
+static fanout_req_t *_new_req(fanout_t *fanout, hostlist_t *hl)
+{
+	fanout_req_t *req = xmalloc(sizeof(*req));
+
+	*req = (fanout_req_t) {
+		.magic = MAGIC_FANOUT_REQ,
+		.fanout = fanout,
+		.hl = hl,
+	};
+
+	slurm_mutex_lock(&fanout->mutex);
+	fanout->pending++;
+	slurm_mutex_unlock(&fanout->mutex);
+
+	return req;
+}
+
+static void _add_failed(fanout_t *fanout, char *name, int err)
+{
+	slurm_mutex_lock(&fanout->mutex);
+	mark_as_failed_forward(&fanout->ret_list, name, err);
+	slurm_mutex_unlock(&fanout->mutex);
+}
+
+/* Mark the head and every node it was going to forward to as failed */
+static void _fail_req(fanout_req_t *req, int err)
+{
+	char *name = NULL;
+
+	if (req->name) {
+		_add_failed(req->fanout, req->name, err);
+		xfree(req->name);
+	}
+
+	while ((name = hostlist_shift(req->hl))) {
+		_add_failed(req->fanout, name, err);
+		free(name);
+	}
+}
+
+/*
+ * Release request and its connection slot
+ * RET next request to start with the released slot or NULL
+ */
+static fanout_req_t *_finish_req(fanout_req_t *req)
+{
+	fanout_t *fanout = req->fanout;
+	fanout_req_t *next = NULL;
+
+	xassert(req->magic == MAGIC_FANOUT_REQ);
+	xassert(!req->ret_list);
+
+	FREE_NULL_HOSTLIST(req->hl);
+	xfree(req->name);
+	req->magic = ~MAGIC_FANOUT_REQ;
+	xfree(req);
+
+	/* fanout may be released by the caller once pending is 0 */
+	slurm_mutex_lock(&fanout->mutex);
+	xassert(fanout->magic == MAGIC_FANOUT);
+	fanout->pending--;
+	xassert(fanout->pending >= 0);
+	slurm_cond_broadcast(&fanout->cond);
+	slurm_mutex_unlock(&fanout->mutex);
+
+	slurm_mutex_lock(&active_mutex);
+	if (!pending_reqs || !(next = list_pop(pending_reqs)))
+		active_cnt--;
+	slurm_mutex_unlock(&active_mutex);
+
+	return next;
+}
+
+static int _get_addr(fanout_req_t *req)
+{
+	slurm_msg_t *msg = req->fanout->msg;
+
+	if ((msg->flags & SLURM_PACK_ADDRS) &&
+	    msg->forward.alias_addrs.node_addrs) {
+		hostlist_t *hl =
+			hostlist_create(msg->forward.alias_addrs.node_list);
+		int n = hostlist_find(hl, req->name);
+
+		hostlist_destroy(hl);
+
+		if (n < 0) {
+			error("%s: can't find address for host %s in alias_addrs",
+			      __func__, req->name);
+			return SLURM_UNKNOWN_FORWARD_ADDR;
+		}
+
+		req->addr = msg->forward.alias_addrs.node_addrs[n];
+	} else if (slurm_conf_get_addr(req->name, &req->addr, msg->flags)) {
+		error("%s: can't find address for host %s, check slurm.conf",
+		      __func__, req->name);
+		return SLURM_UNKNOWN_FORWARD_ADDR;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+static int _connect(fanout_req_t *req)
+{
+	int rc;
+
+	log_flag(NET, "%s: connecting to %s with %d nodes to forward to",
+		 __func__, req->name, hostlist_count(req->hl));
+
+	if ((rc = conmgr_create_connect_socket(CON_TYPE_RPC,
+					       CON_FLAG_RPC_RECV_RESPONSE,
+					       &req->addr, sizeof(req->addr),
+					       &events, req->fanout->msg->tls_cert,
+					       req))) {
+		log_flag(NET, "%s: connect to %s failed: %s",
+			 __func__, req->name, slurm_strerror(rc));
+	}
+
+	return rc;
+}
+
+/* RET true if request has an active connection */
+static bool _start_req(fanout_req_t *req)
+{
+	int rc;
+
+	xassert(req->magic == MAGIC_FANOUT_REQ);
+
+	if (!req->name) {
+		char *name = hostlist_shift(req->hl);
+
+		if (!name)
+			return false;
+
+		req->name = xstrdup(name);
+		free(name);
+
+		if ((rc = _get_addr(req))) {
+			/* Address is only needed for head of tree */
+			_fail_req(req, rc);
+			return false;
+		}
+
+		req->start = time(NULL);
+	}
+
+	if (_connect(req)) {
+		_fail_req(req, SLURM_COMMUNICATIONS_CONNECTION_ERROR);
+		return false;
+	}
+
+	return true;
+}
+
+/* Start request and any queued requests handed a freed connection slot */
+static void _run_reqs(fanout_req_t *req)
+{
+	while (req && !_start_req(req))
+		req = _finish_req(req);
+}
+
+static void _queue_req(fanout_req_t *req)
+{
+	slurm_mutex_lock(&active_mutex);
+	if (active_cnt >= FANOUT_MAX_ACTIVE) {
+		if (!pending_reqs)
+			pending_reqs = list_create(NULL);
+		list_append(pending_reqs, req);
+		req = NULL;
+	} else {
+		active_cnt++;
+	}
+	slurm_mutex_unlock(&active_mutex);
+
+	_run_reqs(req);
+}
+
+/*
+ * Send to every node left in req->hl directly. Same as start_msg_tree()
+ * abandoning a tree whose head failed to forward.
+ */
+static void _split_req(fanout_req_t *req)
+{
+	char *name = NULL;
+
+	while ((name = hostlist_shift(req->hl))) {
+		_queue_req(_new_req(req->fanout, hostlist_create(name)));
+		free(name);
+	}
+}
+
+static void _retry_connect(conmgr_callback_args_t conmgr_args, void *arg)
+{
+	fanout_req_t *req = arg;
+
+	xassert(req->magic == MAGIC_FANOUT_REQ);
+
+	if (conmgr_args.status == CONMGR_WORK_STATUS_CANCELLED) {
+		_fail_req(req, SLURM_SHUTTING_DOWN);
+		_run_reqs(_finish_req(req));
+		return;
+	}
+
+	if (!_start_req(req))
+		_run_reqs(_finish_req(req));
+}
+
+static void _on_sent(conmgr_callback_args_t conmgr_args, void *arg)
+{
+	fanout_req_t *req = arg;
+
+	xassert(req->magic == MAGIC_FANOUT_REQ);
+
+	if ((conmgr_args.status != CONMGR_WORK_STATUS_CANCELLED) &&
+	    !conmgr_args.status_code)
+		req->sent = true;
+
+	conmgr_queue_close_fd(conmgr_args.con);
+}
+
+static void *_on_connection(conmgr_callback_args_t conmgr_args, void *arg)
+{
+	fanout_req_t *req = arg;
+	fanout_t *fanout = req->fanout;
+	conmgr_fd_ref_t *ref = conmgr_fd_new_ref(conmgr_args.con);
+	slurm_msg_t msg;
+	int rc;
+
+	xassert(req->magic == MAGIC_FANOUT_REQ);
+
+	(void) conmgr_con_set_timeouts(ref, &fanout->timeouts, __func__);
+
+	/* based on _fwd_tree_thread() */
+	slurm_msg_t_init(&msg);
+	msg.msg_type = fanout->msg->msg_type;
+	msg.flags = fanout->msg->flags;
+	msg.data = fanout->msg->data;
+	msg.protocol_version = fanout->msg->protocol_version;
+	if (fanout->msg->restrict_uid_set)
+		slurm_msg_set_r_uid(&msg, fanout->msg->restrict_uid);
+
+	msg.forward.tree_width = fanout->msg->forward.tree_width;
+	msg.forward.tree_depth = fanout->tree_depth;
+	msg.forward.timeout = fanout->timeout;
+	if ((msg.forward.cnt = hostlist_count(req->hl))) {
+		msg.forward.nodelist = hostlist_ranged_string_xmalloc(req->hl);
+		if (msg.flags & SLURM_PACK_ADDRS)
+			msg.forward.alias_addrs =
+				fanout->msg->forward.alias_addrs;
+	}
+	req->fwd_cnt = msg.forward.cnt;
+
+	if (msg.forward.nodelist)
+		debug3("Fanout sending to %s along with %s",
+		       req->name, msg.forward.nodelist);
+	else
+		debug3("Fanout sending to %s", req->name);
+
+	if ((rc = conmgr_queue_write_msg(conmgr_args.con, &msg))) {
+		log_flag(NET, "%s: [%s] sending %s to %s failed: %s",
+			 __func__, conmgr_fd_get_name(conmgr_args.con),
+			 rpc_num2string(msg.msg_type), req->name,
+			 slurm_strerror(rc));
+		conmgr_queue_close_fd(conmgr_args.con);
+	} else if (fanout->flags & FANOUT_FLAG_NO_REPLY) {
+		conmgr_add_work_con_write_complete_fifo(conmgr_args.con,
+							_on_sent, req);
+	}
+
+	xfree(msg.forward.nodelist);
+	CONMGR_CON_UNLINK(ref);
+
+	return req;
+}
+
+static int _set_node_name(void *x, void *arg)
+{
+	ret_data_info_t *ret_data_info = x;
+
+	if (!ret_data_info->node_name)
+		ret_data_info->node_name = xstrdup(arg);
+
+	return SLURM_SUCCESS;
+}
+
+static int _on_msg(conmgr_callback_args_t conmgr_args, slurm_msg_t *msg,
+		   int unpack_rc, void *arg)
+{
+	fanout_req_t *req = arg;
+	ret_data_info_t *ret_data_info = NULL;
+
+	xassert(req->magic == MAGIC_FANOUT_REQ);
+
+	if (unpack_rc || req->ret_list) {
+		if (unpack_rc)
+			req->rc = unpack_rc;
+		else
+			error("%s: [%s] ignoring extra %s response from %s",
+			      __func__, conmgr_fd_get_name(conmgr_args.con),
+			      rpc_num2string(msg->msg_type), req->name);
+		slurm_free_msg(msg);
+		conmgr_queue_close_fd(conmgr_args.con);
+		return SLURM_SUCCESS;
+	}
+
+	/* based on slurm_send_addr_recv_msgs() */
+	if (!(req->ret_list = msg->ret_list))
+		req->ret_list = list_create(destroy_data_info);
+	msg->ret_list = NULL;
+
+	ret_data_info = xmalloc(sizeof(*ret_data_info));
+	ret_data_info->type = msg->msg_type;
+	ret_data_info->data = msg->data;
+	msg->data = NULL;
+	list_push(req->ret_list, ret_data_info);
+
+	(void) list_for_each(req->ret_list, _set_node_name, req->name);
+
+	slurm_free_msg(msg);
+	conmgr_queue_close_fd(conmgr_args.con);
+
+	return SLURM_SUCCESS;
+}
+
+static int _delete_responded(void *x, void *arg)
+{
+	ret_data_info_t *ret_data_info = x;
+	hostlist_t *hl = arg;
+
+	(void) hostlist_delete_host(hl, ret_data_info->node_name);
+
+	return SLURM_SUCCESS;
+}
+
+static void _on_finish(conmgr_callback_args_t conmgr_args, void *arg)
+{
+	fanout_req_t *req = arg;
+	fanout_t *fanout = req->fanout;
+	conmgr_fd_ref_t *ref = conmgr_fd_new_ref(conmgr_args.con);
+	int rc = (req->rc ? req->rc : conmgr_args.status_code);
+
+	xassert(req->magic == MAGIC_FANOUT_REQ);
+
+	/* fanout->timeouts may be released once this request finishes */
+	(void) conmgr_con_set_timeouts(ref, NULL, __func__);
+	CONMGR_CON_UNLINK(ref);
+
+	if (req->ret_list) {
+		int ret_cnt = list_count(req->ret_list);
+
+		/* based on _fwd_tree_thread() */
+		if (ret_cnt <= req->fwd_cnt) {
+			error("%s: %s failed to forward the message, expecting %d ret got only %d",
+			      __func__, req->name, (req->fwd_cnt + 1),
+			      ret_cnt);
+			(void) list_for_each(req->ret_list, _delete_responded,
+					     req->hl);
+			_split_req(req);
+		}
+
+		slurm_mutex_lock(&fanout->mutex);
+		list_transfer(fanout->ret_list, req->ret_list);
+		slurm_mutex_unlock(&fanout->mutex);
+		FREE_NULL_LIST(req->ret_list);
+	} else if (req->sent) {
+		ret_data_info_t *ret_data_info = xmalloc(sizeof(*ret_data_info));
+		return_code_msg_t *rc_msg = xmalloc(sizeof(*rc_msg));
+
+		rc_msg->return_code = SLURM_SUCCESS;
+		ret_data_info->type = RESPONSE_SLURM_RC;
+		ret_data_info->data = rc_msg;
+		ret_data_info->node_name = xstrdup(req->name);
+
+		slurm_mutex_lock(&fanout->mutex);
+		list_append(fanout->ret_list, ret_data_info);
+		slurm_mutex_unlock(&fanout->mutex);
+	} else if ((rc == ECONNREFUSED) &&
+		   (conmgr_args.status != CONMGR_WORK_STATUS_CANCELLED) &&
+		   ((time(NULL) - req->start) <
+		    MIN(slurm_conf.msg_timeout, 10))) {
+		/*
+		 * Same as slurm_send_addr_recv_msgs() to better survive
+		 * slurmd restarts. The connection slot is kept while waiting.
+		 */
+		log_flag(NET, "%s: Connection refused by %s, retrying...",
+			 __func__, req->name);
+		conmgr_add_work_delayed_fifo(_retry_connect, req,
+					     FANOUT_RETRY_DELAY, 0);
+		return;
+	} else {
+		log_flag(NET, "%s: %s failed: %s",
+			 __func__, req->name, slurm_strerror(rc));
+
+		/*
+		 * Same error as slurm_send_addr_recv_msgs(). Abandon tree and
+		 * send to the rest of the nodes directly.
+		 */
+		_add_failed(fanout, req->name,
+			    SLURM_COMMUNICATIONS_CONNECTION_ERROR);
+		_split_req(req);
+	}
+
+	_run_reqs(_finish_req(req));
+}
+
+extern list_t *fanout_send_msgs(hostlist_t **sp_hl, int hl_count,
+				slurm_msg_t *msg, int tree_depth, int timeout,
+				fanout_flags_t flags)
+{
+	fanout_t fanout = {
+		.magic = MAGIC_FANOUT,
+		.msg = msg,
+		.flags = flags,
+		.tree_depth = tree_depth,
+		.timeout = timeout,
+	};
+
+	xassert(msg);
+
+	if (fanout.timeout <= 0)
+		fanout.timeout = slurm_conf.msg_timeout * MSEC_IN_SEC;
+
+	fanout.timeouts.read = (timespec_t) {
+		.tv_sec = (fanout.timeout / MSEC_IN_SEC),
+		.tv_nsec = ((fanout.timeout % MSEC_IN_SEC) * NSEC_IN_MSEC),
+	};
+	conmgr_timeouts_init_default(&fanout.timeouts);
+
+	slurm_mutex_init(&fanout.mutex);
+	slurm_cond_init(&fanout.cond, NULL);
+	fanout.ret_list = list_create(destroy_data_info);
+
+	log_flag(NET, "%s: sending %s to %d trees with timeout %dms",
+		 __func__, rpc_num2string(msg->msg_type), hl_count,
+		 fanout.timeout);
+
+	for (int j = 0; j < hl_count; j++) {
+		_queue_req(_new_req(&fanout, sp_hl[j]));
+		sp_hl[j] = NULL;
+	}
+
+	slurm_mutex_lock(&fanout.mutex);
+	while (fanout.pending > 0)
+		slurm_cond_wait(&fanout.cond, &fanout.mutex);
+	slurm_mutex_unlock(&fanout.mutex);
+
+	log_flag(NET, "%s: got %d responses for %s",
+		 __func__, list_count(fanout.ret_list),
+		 rpc_num2string(msg->msg_type));
+
+	slurm_mutex_destroy(&fanout.mutex);
+	slurm_cond_destroy(&fanout.cond);
+	fanout.magic = ~MAGIC_FANOUT;
+
+	return fanout.ret_list;
+}
+
+extern list_t *fanout_send_msgs_direct(hostlist_t *hl, slurm_msg_t *msg,
+				       int timeout, fanout_flags_t flags)
+{
+	hostlist_t *copy = hostlist_copy(hl);
+	hostlist_t **sp_hl;
+	list_t *ret_list;
+	char *name = NULL;
+	int count = 0;
+
+	hostlist_uniq(copy);
+	sp_hl = xcalloc(hostlist_count(copy), sizeof(*sp_hl));
+
+	while ((name = hostlist_shift(copy))) {
+		sp_hl[count++] = hostlist_create(name);
+		free(name);
+	}
+
+	ret_list = fanout_send_msgs(sp_hl, count, msg, 0, timeout, flags);
+
+	xfree(sp_hl);
+	hostlist_destroy(copy);
+
+	return ret_list;
+}
@@ -0,0 +1,91 @@
+/*****************************************************************************\
+ *  fanout.h - send RPCs to many nodes over conmgr connections
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _FANOUT_H
+#define _FANOUT_H
+
+#include "src/common/hostlist.h"
+#include "src/common/list.h"
+#include "src/common/slurm_protocol_defs.h"
+
+typedef enum {
+	FANOUT_FLAG_NONE = 0,
+	/* Close each connection once the RPC is sent instead of waiting */
+	FANOUT_FLAG_NO_REPLY = SLURM_BIT(0),
+} fanout_flags_t;
+
+/*
+ * Check if RPCs can be fanned out over conmgr connections
+ * RET true if SlurmctldParameters=enable_async_fanout and conmgr is running
+ */
+extern bool fanout_enabled(void);
+
+/*
+ * Send msg to the head of every hostlist, asking each head to forward msg to
+ * the rest of its hostlist, and wait for all of the responses.
+ *
+ * Every connection is driven by conmgr, so the number of outstanding RPCs is
+ * not bound to the number of threads. A head which can not be reached is
+ * retried while its connection is refused (same as
+ * slurm_send_addr_recv_msgs()) and the rest of its hostlist is then sent to
+ * directly (same as start_msg_tree()).
+ *
+ * IN sp_hl - array of hostlists to send msg to (consumed and set to NULL)
+ * IN hl_count - number of hostlists in sp_hl
+ * IN msg - message to send
+ * IN tree_depth - depth of the forwarding tree
+ * IN timeout - milliseconds to wait for each response
+ * IN flags - FANOUT_FLAG_* flags
+ * RET list of ret_data_info_t with an entry for every node
+ * WARNING: never call from conmgr work as it blocks until all RPCs complete
+ */
+extern list_t *fanout_send_msgs(hostlist_t **sp_hl, int hl_count,
+				slurm_msg_t *msg, int tree_depth, int timeout,
+				fanout_flags_t flags);
+
+/*
+ * Send msg directly to every node in hl without forwarding
+ * IN hl - hostlist of nodes to send msg to (not modified)
+ * IN msg - message to send
+ * IN timeout - milliseconds to wait for each response
+ * IN flags - FANOUT_FLAG_* flags
+ * RET list of ret_data_info_t with an entry for every node
+ *	Nodes sent msg with FANOUT_FLAG_NO_REPLY get a RESPONSE_SLURM_RC entry.
+ * WARNING: never call from conmgr work as it blocks until all RPCs complete
+ */
+extern list_t *fanout_send_msgs_direct(hostlist_t *hl, slurm_msg_t *msg,
+				       int timeout, fanout_flags_t flags);
+
+#endif
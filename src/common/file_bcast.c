@@ -63,11 +63,13 @@
 #include "src/common/slurm_protocol_defs.h"
 #include "src/common/slurm_protocol_socket.h"
 #include "src/common/slurm_time.h"
+#include "src/common/threadpool.h"
 #include "src/common/timers.h"
 #include "src/common/uid.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 #include "src/interfaces/compress.h"
+#include "src/interfaces/hash.h"
 
 /*
  * This should likely be detected at build time, but I have not
@@ -77,6 +79,30 @@
 #define DEFAULT_THREADS 8
 /* These can be huge messages, so only run MAX_THREADS at one time */
 #define MAX_THREADS 64
+/* Most blocks sent down the tree before waiting on the oldest one */
+#define MAX_PIPELINE 64
+/* Smaller blocks are not worth an extra round trip to ask node caches */
+#define MIN_CACHED_BLOCK (64 * 1024)
+
+typedef struct {
+	pthread_t tid; /* thread sending msg, 0 if none */
+	struct bcast_parameters *params;
+	file_bcast_msg_t msg;
+	char *buffer; /* data of msg */
+	int rc; /* worst return code of all nodes */
+	uint32_t cache_hits; /* nodes that had this block in their cache */
+	uint64_t usec; /* time until every node replied */
+} bcast_block_t;
+
+typedef struct {
+	uint32_t blocks;
+	uint32_t window; /* most blocks in flight */
+	uint64_t bytes; /* uncompressed bytes sent to each node */
+	uint64_t cached_bytes; /* uncompressed bytes read from node caches */
+	uint64_t usec_min;
+	uint64_t usec_max;
+	uint64_t usec_total;
+} bcast_stats_t;
 
 int block_len; /* block size */
 int fd; /* source file descriptor */
@@ -87,7 +113,8 @@ job_sbcast_cred_msg_t *sbcast_cred; /* job alloc info and sbcast cred */
 static int _bcast_file(struct bcast_parameters *params);
 static int _file_bcast(struct bcast_parameters *params,
 		       file_bcast_msg_t *bcast_msg,
-		       job_sbcast_cred_msg_t *sbcast_cred);
+		       job_sbcast_cred_msg_t *sbcast_cred,
+		       uint32_t *cache_hits);
 static int _file_state(struct bcast_parameters *params);
 static list_t *_fill_in_excluded_paths(struct bcast_parameters *params);
 static int _find_subpath(void *x, void *key);
@@ -218,10 +245,16 @@ static int _get_cred_no_job(struct bcast_parameters *params)
 	return SLURM_SUCCESS;
 }
 
-/* Issue the RPC to transfer the file's data */
-static int _file_bcast(struct bcast_parameters *params,
-		       file_bcast_msg_t *bcast_msg,
-		       job_sbcast_cred_msg_t *sbcast_cred)
+/*
+ * Issue the RPC to transfer the file's data
+ * IN node_list - nodes to send bcast_msg to
+ * OUT missing - if set, nodes without the block in their cache are added to
+ *	it instead of being reported as errors
+ * OUT cache_hits - if set, incremented for each node that succeeded
+ */
+static int _send_bcast(struct bcast_parameters *params,
+		       file_bcast_msg_t *bcast_msg, char *node_list,
+		       hostlist_t *missing, uint32_t *cache_hits)
 {
 	list_t *ret_list = NULL;
 	list_itr_t *itr;
@@ -236,8 +269,7 @@ static int _file_bcast(struct bcast_parameters *params,
 	msg.forward.tree_width = params->tree_width;
 	msg.msg_type = REQUEST_FILE_BCAST;
 
-	ret_list = slurm_send_recv_msgs(sbcast_cred->node_list, &msg,
-					params->timeout);
+	ret_list = slurm_send_recv_msgs(node_list, &msg, params->timeout);
 	if (ret_list == NULL) {
 		error("slurm_send_recv_msgs: %m");
 		exit(1);
@@ -247,8 +279,15 @@ static int _file_bcast(struct bcast_parameters *params,
 	while ((ret_data_info = list_next(itr))) {
 		msg_rc = slurm_get_return_code(ret_data_info->type,
 					       ret_data_info->data);
-		if (msg_rc == SLURM_SUCCESS)
+		if (msg_rc == SLURM_SUCCESS) {
+			if (cache_hits)
+				(*cache_hits)++;
 			continue;
+		}
+		if (missing && (msg_rc == ESLURMD_BCAST_BLOCK_NOT_CACHED)) {
+			hostlist_push_host(missing, ret_data_info->node_name);
+			continue;
+		}
 
 		error("REQUEST_FILE_BCAST(%s): %s",
 		      ret_data_info->node_name,
@@ -261,17 +300,137 @@ static int _file_bcast(struct bcast_parameters *params,
 	return rc;
 }
 
+/*
+ * Send a block to every node. Blocks with a hash are first offered by hash
+ * alone, and the data only goes to the nodes missing it from their cache.
+ */
+static int _file_bcast(struct bcast_parameters *params,
+		       file_bcast_msg_t *bcast_msg,
+		       job_sbcast_cred_msg_t *sbcast_cred,
+		       uint32_t *cache_hits)
+{
+	file_bcast_msg_t cached_msg;
+	hostlist_t *missing;
+	int rc;
+
+	if (!bcast_msg->block_hash)
+		return _send_bcast(params, bcast_msg, sbcast_cred->node_list,
+				   NULL, NULL);
+
+	cached_msg = *bcast_msg;
+	cached_msg.flags |= FILE_BCAST_CACHED;
+	cached_msg.compress = COMPRESS_OFF;
+	cached_msg.block = NULL;
+	cached_msg.block_len = 0;
+
+	missing = hostlist_create(NULL);
+	rc = _send_bcast(params, &cached_msg, sbcast_cred->node_list, missing,
+			 cache_hits);
+	if ((rc == SLURM_SUCCESS) && hostlist_count(missing)) {
+		char *node_list = hostlist_ranged_string_xmalloc(missing);
+
+		debug("block %u not cached on %s",
+		      bcast_msg->block_no, node_list);
+		rc = _send_bcast(params, bcast_msg, node_list, NULL, NULL);
+		xfree(node_list);
+	}
+	FREE_NULL_HOSTLIST(missing);
+
+	return rc;
+}
+
+static void *_bcast_block_thread(void *arg)
+{
+	bcast_block_t *block = arg;
+	DEF_TIMERS;
+
+	START_TIMER;
+	block->rc = _file_bcast(block->params, &block->msg, sbcast_cred,
+				&block->cache_hits);
+	END_TIMER;
+	block->usec = TIMER_DURATION_USEC();
+
+	return NULL;
+}
+
+/* Account for a block sent and keep the first error seen */
+static void _bcast_block_done(bcast_block_t *block, bcast_stats_t *stats,
+			      int *rc)
+{
+	stats->blocks++;
+	stats->bytes += block->msg.uncomp_len;
+	stats->cached_bytes +=
+		(uint64_t) block->cache_hits * block->msg.uncomp_len;
+	stats->usec_total += block->usec;
+	stats->usec_min = MIN(stats->usec_min, block->usec);
+	stats->usec_max = MAX(stats->usec_max, block->usec);
+
+	if (block->rc && !*rc)
+		*rc = block->rc;
+
+	block->cache_hits = 0;
+	xfree(block->msg.block_hash);
+}
+
+static void _bcast_block_wait(bcast_block_t *block, bcast_stats_t *stats,
+			      int *rc)
+{
+	if (!block->tid)
+		return;
+
+	slurm_thread_join(block->tid);
+	_bcast_block_done(block, stats, rc);
+}
+
+static void _bcast_block_send(bcast_block_t *block, bcast_stats_t *stats,
+			      int *rc)
+{
+	(void) _bcast_block_thread(block);
+	_bcast_block_done(block, stats, rc);
+}
+
+static void _print_bcast_stats(bcast_stats_t *stats, uint64_t usec)
+{
+	hostlist_t *hl;
+	int node_cnt;
+	double secs = usec / 1000000.0;
+
+	if (!stats->blocks || !usec)
+		return;
+
+	hl = hostlist_create(sbcast_cred->node_list);
+	node_cnt = hostlist_count(hl);
+	FREE_NULL_HOSTLIST(hl);
+
+	verbose("Broadcast %"PRIu64" bytes in %u blocks to %d nodes in %.3f sec, %u blocks in flight",
+		stats->bytes, stats->blocks, node_cnt, secs, stats->window);
+	verbose("Throughput %.1f MB/s per node, %.1f MB/s aggregate",
+		(stats->bytes / secs) / (1024 * 1024),
+		((stats->bytes * node_cnt) / secs) / (1024 * 1024));
+	verbose("Block round trip usec min %"PRIu64" avg %"PRIu64" max %"PRIu64,
+		stats->usec_min, stats->usec_total / stats->blocks,
+		stats->usec_max);
+	if (stats->cached_bytes)
+		verbose("Node caches supplied %"PRIu64" of %"PRIu64" bytes",
+			stats->cached_bytes, (stats->bytes * node_cnt));
+}
+
 /* read and broadcast the file */
 static int _bcast_file(struct bcast_parameters *params)
 {
 	int rc = SLURM_SUCCESS;
 	file_bcast_msg_t bcast_msg;
-	char *buffer = NULL, *in_position = src;
+	char *in_position = src;
 	int32_t orig_len = 0;
 	uint64_t size_uncompressed = 0, size_compressed = 0;
 	uint32_t time_compression = 0;
 	bool more = true;
 	ssize_t remaining = f_stat.st_size;
+	uint32_t window, slot = 0;
+	bool use_cache;
+	bcast_block_t *blocks;
+	bcast_stats_t stats = { .usec_min = UINT64_MAX };
+	timespec_t bcast_start, bcast_end;
 	DEF_TIMERS;
 
 	/* Check if compression type is supported, fallback to off */
@@ -285,7 +444,22 @@ static int _bcast_file(struct bcast_parameters *params)
 		block_len = MIN(params->block_size, f_stat.st_size);
 	else
 		block_len = MIN((512 * 1024), f_stat.st_size);
-	buffer = xmalloc(block_len);
+
+	/* Blocks are only worth hashing if nodes keep a cache of them */
+	use_cache = (xstrcasestr(slurm_conf.bcast_parameters,
+				 "BlockCacheDir=") != NULL);
+
+	/*
+	 * Each block in flight holds its own buffer until every node replied
+	 * for it, so the buffer is only refilled after waiting on its slot.
+	 */
+	window = MIN(MAX(params->pipeline, 1), MAX_PIPELINE);
+	stats.window = window;
+	blocks = xcalloc(window, sizeof(*blocks));
+	for (int i = 0; i < window; i++) {
+		blocks[i].params = params;
+		blocks[i].buffer = xmalloc(block_len);
+	}
 
 	memset(&bcast_msg, 0, sizeof(file_bcast_msg_t));
 	bcast_msg.fname = params->dst_fname;
@@ -293,6 +467,15 @@ static int _bcast_file(struct bcast_parameters *params)
 	bcast_msg.block_no = 1;
 	if (params->flags & BCAST_FLAG_FORCE)
 		bcast_msg.flags |= FILE_BCAST_FORCE;
+	/*
+	 * Only slurmd 26.11 or later writes blocks at their block_offset, older
+	 * ones write at the current file position. Blocks are always sent with
+	 * SLURM_PROTOCOL_VERSION, which older slurmd reject, and slurmd rejects
+	 * blocks out of order unless flagged, so a file is never written in
+	 * the wrong order.
+	 */
+	if (window > 1)
+		bcast_msg.flags |= FILE_BCAST_PIPELINE;
 	if (params->flags & BCAST_FLAG_SHARED_OBJECT)
 		bcast_msg.flags |= FILE_BCAST_SO;
 	else if (params->flags & BCAST_FLAG_SEND_LIBS)
@@ -314,12 +497,22 @@ static int _bcast_file(struct bcast_parameters *params)
 	else if (params->tree_width != 0xfffd)
 		params->tree_width = MIN(MAX_THREADS, params->tree_width);
 
+	bcast_start = timespec_now();
 	while (more) {
+		bcast_block_t *block = &blocks[slot];
 		ssize_t remaining_before = remaining;
+		char *block_start = in_position;
+
+		/* Reuse of this slot's buffer must wait for its last block */
+		_bcast_block_wait(block, &stats, &rc);
+		block->tid = 0;
+		if (rc != SLURM_SUCCESS)
+			break;
+
 		START_TIMER;
 		bcast_msg.block_len =
 			compress_g_comp_block(params->compress, &in_position,
-					      f_stat.st_size, &buffer,
+					      f_stat.st_size, &block->buffer,
 					      block_len, &remaining);
 		orig_len = (int32_t) (remaining_before - remaining);
 		more = (remaining > 0);
@@ -331,20 +524,54 @@ static int _bcast_file(struct bcast_parameters *params)
 		      bcast_msg.block_len);
 		bcast_msg.compress = params->compress;
 		bcast_msg.uncomp_len = orig_len;
-		bcast_msg.block = buffer;
+		bcast_msg.block = block->buffer;
 		if (!more)
 			bcast_msg.flags |= FILE_BCAST_LAST_BLOCK;
+		block->msg = bcast_msg;
+		if (use_cache && (orig_len >= MIN_CACHED_BLOCK))
+			block->msg.block_hash =
+				bcast_hash_block(block_start, orig_len);
+
+		if ((window == 1) || (bcast_msg.block_no == 1) || !more) {
+			/*
+			 * The first block creates the file and the last block
+			 * closes it on each node, so no other block may be in
+			 * flight while they are sent.
+			 */
+			for (int i = 0; !more && (i < window); i++) {
+				if (i == slot)
+					continue;
+				_bcast_block_wait(&blocks[i], &stats, &rc);
+				blocks[i].tid = 0;
+			}
+			if (rc != SLURM_SUCCESS)
+				break;
+			_bcast_block_send(block, &stats, &rc);
+			if (rc != SLURM_SUCCESS)
+				break;
+		} else {
+			slurm_thread_create(NULL, &block->tid,
+					    _bcast_block_thread, block);
+			slot = (slot + 1) % window;
+		}
 
-		rc = _file_bcast(params, &bcast_msg, sbcast_cred);
-		if (rc != SLURM_SUCCESS)
-			break;
 		if (bcast_msg.flags & FILE_BCAST_LAST_BLOCK)
 			break; /* end of file */
 		bcast_msg.block_no++;
 		bcast_msg.block_offset += orig_len;
 	}
+
+	for (int i = 0; i < window; i++) {
+		_bcast_block_wait(&blocks[i], &stats, &rc);
+		xfree(blocks[i].buffer);
+	}
+	xfree(blocks);
+	bcast_end = timespec_now();
 	xfree(bcast_msg.user_name);
-	xfree(buffer);
+
+	if (rc == SLURM_SUCCESS)
+		_print_bcast_stats(&stats, timer_get_duration(&bcast_start,
+							      &bcast_end));
 
 	if (size_uncompressed && (params->compress != 0)) {
 		int64_t pct = (int64_t) size_uncompressed - size_compressed;
@@ -607,6 +834,18 @@ extern int bcast_file(struct bcast_parameters *params)
 	return rc;
 }
 
+extern char *bcast_hash_block(const char *data, uint32_t len)
+{
+	slurm_hash_t hash = { .type = HASH_PLUGIN_K12 };
+	int hash_len;
+
+	hash_len = hash_g_compute((char *) data, len, NULL, 0, &hash);
+	if (hash_len <= 0)
+		return NULL;
+
+	return xstring_bytes2hex(hash.hash, hash_len, NULL);
+}
+
 extern int bcast_decompress_data(file_bcast_msg_t *req)
 {
 	char *out_buf = NULL;
@@ -54,6 +54,7 @@ struct bcast_parameters {
 	char *exe_fname;
 	uint16_t flags;
 	char *node_list;
+	uint32_t pipeline; /* blocks in flight, 0 or 1 waits for each */
 	list_t *selected_steps; /* HetJob components selected_step list. */
 	slurm_selected_step_t *selected_step;
 	char *src_fname;
@@ -72,6 +73,7 @@ typedef struct file_bcast_info {
 	uint32_t job_id; /* job id */
 	uint32_t step_id; /* step id */
 	time_t last_update; /* transfer last block received */
+	uint64_t next_offset; /* offset of next block unless pipelined */
 	int received_blocks; /* number of blocks received */
 	time_t start_time; /* transfer start time */
 	uid_t uid; /* uid of owner */
@@ -87,6 +89,12 @@ typedef struct {
 
 extern int bcast_file(struct bcast_parameters *params);
 
+/*
+ * Hash a block the way nodes key their block cache.
+ * RET xmalloc()ed hex string or NULL on error
+ */
+extern char *bcast_hash_block(const char *data, uint32_t len);
+
 extern int bcast_decompress_data(file_bcast_msg_t *req);
 
 #endif
@@ -47,6 +47,7 @@
 #include "slurm/slurm.h"
 
 #include "src/common/events.h"
+#include "src/common/fanout.h"
 #include "src/common/forward.h"
 #include "src/common/hostlist.h"
 #include "src/common/macros.h"
@@ -160,6 +161,79 @@ static void _fwd_msg_free(forward_msg_t *fwd_msg)
 	xfree(fwd_msg);
 }
 
+static int _split_hostlist(hostlist_t *hl, hostlist_t ***sp_hl, int *count,
+			   uint16_t tree_width)
+{
+	if (running_in_slurmctld())
+		return topology_g_split_hostlist(hl, sp_hl, count, tree_width);
+
+	return hostlist_split_treewidth(hl, sp_hl, count, tree_width);
+}
+
+/*
+ * Abandon tree after failing to reach the forwarder for hl. This way if all
+ * the nodes in the branch are down we don't have to time out for each node
+ * serially. The remaining nodes are split into new subtrees. Every dead head
+ * costs another connect timeout at each level it is retried at, and nothing
+ * extends the timeout the parent is waiting with, so only do it when there are
+ * more nodes than tree_width and the new subtrees plus the hop lost to the dead
+ * forwarder still fit in depth_budget, the depth that timeout was computed for.
+ *
+ * RET number of subtrees in sp_hl, or 0 to send to every node directly
+ */
+static int _resplit_hostlist(hostlist_t *hl, uint16_t tree_width,
+			     int depth_budget, bool use_topology,
+			     hostlist_t ***sp_hl)
+{
+	int hl_count = 0, depth;
+
+	if (hostlist_count(hl) <= (tree_width ? tree_width :
+				   slurm_conf.tree_width))
+		return 0;
+
+	if (use_topology)
+		depth = topology_g_split_hostlist(hl, sp_hl, &hl_count,
+						  tree_width);
+	else
+		depth = _split_hostlist(hl, sp_hl, &hl_count, tree_width);
+
+	if (depth == SLURM_ERROR)
+		return 0;
+
+	if ((depth + 1) > depth_budget) {
+		/* Splitting emptied hl, give the nodes back */
+		for (int i = 0; i < hl_count; i++) {
+			hostlist_push_list(hl, (*sp_hl)[i]);
+			hostlist_destroy((*sp_hl)[i]);
+		}
+		log_flag(NET, "%s: not splitting %d nodes, depth %d does not fit in %d",
+			 __func__, hostlist_count(hl), depth, depth_budget);
+		xfree(*sp_hl);
+		return 0;
+	}
+
+	return hl_count;
+}
+
+/* Send hl to new subtrees after its forwarder failed */
+static void _reroute_forward(hostlist_t *hl, forward_struct_t *fwd_struct,
+			     header_t *header)
+{
+	hostlist_t **sp_hl = NULL;
+	int hl_count;
+
+	if (!(hl_count = _resplit_hostlist(hl, header->forward.tree_width,
+					   header->forward.tree_depth, true,
+					   &sp_hl))) {
+		_forward_msg_internal(hl, NULL, fwd_struct, header, 0,
+				      hostlist_count(hl));
+		return;
+	}
+
+	_forward_msg_internal(NULL, sp_hl, fwd_struct, header, 0, hl_count);
+	xfree(sp_hl);
+}
+
 static void *_forward_thread(void *arg)
 {
 	forward_msg_t *fwd_msg = arg;
@@ -206,14 +280,8 @@ static void *_forward_thread(void *arg)
 			free(name);
 			if (hostlist_count(hl) > 0) {
 				slurm_mutex_unlock(&fwd_struct->forward_mutex);
-				/* Abandon tree. This way if all the
-				 * nodes in the branch are down we
-				 * don't have to time out for each
-				 * node serially.
-				 */
-				_forward_msg_internal(hl, NULL, fwd_struct,
-						      &fwd_msg->header, 0,
-						      hostlist_count(hl));
+				_reroute_forward(hl, fwd_struct,
+						 &fwd_msg->header);
 				continue;
 			}
 			goto cleanup;
@@ -270,14 +338,8 @@ static void *_forward_thread(void *arg)
 				slurm_mutex_unlock(&fwd_struct->forward_mutex);
 				conn_g_destroy(conn, true);
 				conn = NULL;
-				/* Abandon tree. This way if all the
-				 * nodes in the branch are down we
-				 * don't have to time out for each
-				 * node serially.
-				 */
-				_forward_msg_internal(hl, NULL, fwd_struct,
-						      &fwd_msg->header, 0,
-						      hostlist_count(hl));
+				_reroute_forward(hl, fwd_struct,
+						 &fwd_msg->header);
 				continue;
 			}
 			goto cleanup;
@@ -453,6 +515,24 @@ static int _fwd_tree_get_addr(fwd_tree_t *fwd_tree, char *name,
 	return SLURM_SUCCESS;
 }
 
+/* Same as _reroute_forward() for the nodes of a failed fwd_tree */
+static void _reroute_tree(fwd_tree_t *fwd_tree)
+{
+	hostlist_t **sp_hl = NULL;
+	int hl_count;
+
+	if (!(hl_count = _resplit_hostlist(
+		      fwd_tree->tree_hl, fwd_tree->orig_msg->forward.tree_width,
+		      fwd_tree->tree_depth, false, &sp_hl))) {
+		_start_msg_tree_internal(fwd_tree->tree_hl, NULL, fwd_tree,
+					 hostlist_count(fwd_tree->tree_hl));
+		return;
+	}
+
+	_start_msg_tree_internal(NULL, sp_hl, fwd_tree, hl_count);
+	xfree(sp_hl);
+}
+
 static void *_fwd_tree_thread(void *arg)
 {
 	fwd_tree_t *fwd_tree = arg;
@@ -548,15 +628,7 @@ static void *_fwd_tree_thread(void *arg)
 				error("%s: Abandon tree forward by %s, ret_cnt:%u forward.cnt:%u",
 				      __func__, name, ret_cnt, send_msg.forward.cnt);
 				free(name);
-				/* Abandon tree. This way if all the
-				 * nodes in the branch are down we
-				 * don't have to time out for each
-				 * node serially.
-				 */
-				_start_msg_tree_internal(
-					fwd_tree->tree_hl, NULL,
-					fwd_tree,
-					hostlist_count(fwd_tree->tree_hl));
+				_reroute_tree(fwd_tree);
 				break;
 			}
 		} else {
@@ -790,7 +862,9 @@ static void _forward_msg_internal(hostlist_t *hl, hostlist_t **sp_hl,
 		       sizeof(slurm_addr_t));
 
 		fwd_msg->header.version = header->version;
-		fwd_msg->header.flags = header->flags;
+		/* Connections used for forwarding are never kept alive */
+		fwd_msg->header.flags = header->flags &
+			~(SLURM_MSG_KEEP_ALIVE | SLURM_MSG_KEPT_ALIVE);
 		fwd_msg->header.msg_type = header->msg_type;
 		fwd_msg->header.body_length = header->body_length;
 		fwd_msg->header.ret_list = NULL;
@@ -1006,19 +1080,8 @@ static void _get_dynamic_addrs(hostlist_t *hl, slurm_msg_t *msg)
 	slurm_mutex_unlock(&alias_addrs_mutex);
 }
 
-/*
- * start_msg_tree  - logic to begin the forward tree and
- *                   accumulate the return codes from processes getting the
- *                   forwarded message
- *
- * IN: hl          - hostlist_t   - list of every node to send message to
- * IN: msg         - slurm_msg_t  - message to send.
- * IN: timeout     - int          - how long to wait in milliseconds.
- * RET list_t *    - list containing the responses of the children
- *		     (if any) we forwarded the message to. list
- *		     containing type (ret_data_info_t).
- */
-extern list_t *start_msg_tree(hostlist_t *hl, slurm_msg_t *msg, int timeout)
+static list_t *_start_msg_tree(hostlist_t *hl, slurm_msg_t *msg, int timeout,
+			       bool use_fanout)
 {
 	fwd_tree_t fwd_tree;
 	pthread_mutex_t tree_mutex;
@@ -1044,17 +1107,21 @@ extern list_t *start_msg_tree(hostlist_t *hl, slurm_msg_t *msg, int timeout)
 	_get_alias_addrs(hl, msg, &host_count);
 	_get_dynamic_addrs(hl, msg);
 
-	if (running_in_slurmctld())
-		depth = topology_g_split_hostlist(hl, &sp_hl, &hl_count,
-						  msg->forward.tree_width);
-	else
-		depth = hostlist_split_treewidth(hl, &sp_hl, &hl_count,
-						 msg->forward.tree_width);
+	depth = _split_hostlist(hl, &sp_hl, &hl_count, msg->forward.tree_width);
 
 	if (depth == SLURM_ERROR) {
 		error("unable to split forward hostlist");
 		return NULL;
 	}
+
+	if (use_fanout) {
+		ret_list = fanout_send_msgs(sp_hl, hl_count, msg, depth,
+					    (2 * depth * timeout),
+					    FANOUT_FLAG_NONE);
+		xfree(sp_hl);
+		return ret_list;
+	}
+
 	slurm_mutex_init(&tree_mutex);
 	slurm_cond_init(&notify, NULL);
 
@@ -1092,6 +1159,29 @@ extern list_t *start_msg_tree(hostlist_t *hl, slurm_msg_t *msg, int timeout)
 	return ret_list;
 }
 
+/*
+ * start_msg_tree  - logic to begin the forward tree and
+ *                   accumulate the return codes from processes getting the
+ *                   forwarded message
+ *
+ * IN: hl          - hostlist_t   - list of every node to send message to
+ * IN: msg         - slurm_msg_t  - message to send.
+ * IN: timeout     - int          - how long to wait in milliseconds.
+ * RET list_t *    - list containing the responses of the children
+ *		     (if any) we forwarded the message to. list
+ *		     containing type (ret_data_info_t).
+ */
+extern list_t *start_msg_tree(hostlist_t *hl, slurm_msg_t *msg, int timeout)
+{
+	return _start_msg_tree(hl, msg, timeout, false);
+}
+
+extern list_t *start_msg_tree_fanout(hostlist_t *hl, slurm_msg_t *msg,
+				     int timeout)
+{
+	return _start_msg_tree(hl, msg, timeout, true);
+}
+
 /*
  * mark_as_failed_forward- mark a node as failed and add it to "ret_list"
  *
@@ -101,6 +101,14 @@ extern int forward_msg(forward_struct_t *forward_struct,
  */
 extern list_t *start_msg_tree(hostlist_t *hl, slurm_msg_t *msg, int timeout);
 
+/*
+ * Same as start_msg_tree() but each tree head is sent to over a conmgr
+ * connection instead of from a dedicated thread. See fanout_send_msgs().
+ * WARNING: never call from conmgr work as it blocks until all RPCs complete
+ */
+extern list_t *start_msg_tree_fanout(hostlist_t *hl, slurm_msg_t *msg,
+				     int timeout);
+
 /*
  * mark_as_failed_forward- mark a node as failed and add it to "ret_list"
  *
@@ -75,6 +75,12 @@
 #include "src/interfaces/conn.h"
 
 #define SLURM_IO_MAX_MSG_LEN 1024
+/*
+ * Largest stdout/stderr payload slurmstepd sends to 26.11 or newer clients.
+ * Older clients only accept SLURM_IO_MAX_MSG_LEN, as does slurmstepd for
+ * stdin.
+ */
+#define SLURM_IO_MAX_MSG_LEN_LARGE (16 * 1024)
 
 typedef enum {
 	SLURM_IO_INVALID = -1,
@@ -46,6 +46,7 @@
 #include <inttypes.h>
 #include <math.h>
 #include <netinet/in.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
@@ -56,6 +57,7 @@
 #include "slurm/slurm_errno.h"
 #include "slurm/slurm.h"
 
+#include "src/common/atomic.h"
 #include "src/common/log.h"
 #include "src/common/macros.h"
 #include "src/common/pack.h"
@@ -109,6 +111,300 @@ strong_alias(unpackstr_array,	slurm_unpackstr_array);
 strong_alias(packmem_array,	slurm_packmem_array);
 strong_alias(unpackmem_array,	slurm_unpackmem_array);
 
+/*
+ * Free buffers are kept in pools by size class, BUF_SIZE doubling up to
+ * BUF_POOL_MAX_SIZE. A buffer's head is allocated with the capacity of its
+ * class while buf->size stays at what was asked for, so growing within the
+ * class does not realloc. Small classes are kept per thread without locking,
+ * larger ones are shared.
+ */
+#define BUF_POOL_CLASSES 9
+#define BUF_POOL_MAX_SIZE (BUF_SIZE << (BUF_POOL_CLASSES - 1))
+/* Smaller buffers are not worth a BUF_SIZE head */
+#define BUF_POOL_MIN_SIZE (BUF_SIZE / 4)
+#define BUF_POOL_THREAD_CLASSES 3
+/* Largest class (relative to requested) to take a free buffer from */
+#define BUF_POOL_CLASS_STEPS 3
+
+static const int thread_pool_max[BUF_POOL_THREAD_CLASSES] = { 4, 2, 1 };
+#define SHARED_POOL_MAX 2
+
+typedef struct {
+	buf_t *bufs[4];
+	int count;
+} buf_pool_t;
+
+static __thread buf_pool_t thread_pool[BUF_POOL_THREAD_CLASSES];
+static pthread_key_t thread_pool_key;
+static pthread_once_t thread_pool_once = PTHREAD_ONCE_INIT;
+static __thread bool thread_pool_registered = false;
+
+static pthread_mutex_t shared_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static buf_pool_t shared_pool[BUF_POOL_CLASSES];
+
+/* Size estimates are (key << 32 | size), any key may evict another */
+#define BUF_HINT_SLOTS 256
+
+#ifndef __STDC_NO_ATOMICS__
+static atomic_uint64_t buf_hints[BUF_HINT_SLOTS];
+static atomic_uint64_t stat_allocs;
+static atomic_uint64_t stat_reused;
+static atomic_uint64_t stat_grown_in_place;
+static atomic_uint64_t stat_reallocs;
+#define _inc_stat(stat) (void) atomic_uint64_increment(stat)
+#else
+#define _inc_stat(stat)
+#endif
+
+/* Free buf_t along with its head */
+static void _free_buf_mem(buf_t *buf)
+{
+	xfree(buf->head);
+	xfree(buf);
+}
+
+static void _thread_pool_free(void *arg)
+{
+	for (int c = 0; c < BUF_POOL_THREAD_CLASSES; c++) {
+		buf_pool_t *pool = &thread_pool[c];
+
+		while (pool->count > 0)
+			_free_buf_mem(pool->bufs[--pool->count]);
+	}
+}
+
+static void _thread_pool_key_create(void)
+{
+	if (pthread_key_create(&thread_pool_key, _thread_pool_free))
+		fatal("%s: pthread_key_create() failed: %m", __func__);
+}
+
+/* RET size class for a buffer of size or -1 if it is not pooled */
+static int _size_class(uint32_t size)
+{
+	int c = 0;
+
+	if ((size < BUF_POOL_MIN_SIZE) || (size > BUF_POOL_MAX_SIZE))
+		return -1;
+
+	while ((BUF_SIZE << c) < size)
+		c++;
+
+	return c;
+}
+
+/* RET size class for a buffer head with exactly capacity bytes or -1 */
+static int _capacity_class(size_t capacity)
+{
+	int c = _size_class(capacity);
+
+	if ((c < 0) || ((BUF_SIZE << c) != capacity))
+		return -1;
+
+	return c;
+}
+
+static buf_t *_pool_get_class(int c)
+{
+	buf_t *buf = NULL;
+
+	if (c < BUF_POOL_THREAD_CLASSES) {
+		if (thread_pool[c].count > 0)
+			buf = thread_pool[c].bufs[--thread_pool[c].count];
+		return buf;
+	}
+
+	slurm_mutex_lock(&shared_pool_mutex);
+	if (shared_pool[c].count > 0)
+		buf = shared_pool[c].bufs[--shared_pool[c].count];
+	slurm_mutex_unlock(&shared_pool_mutex);
+
+	return buf;
+}
+
+/*
+ * Buffers which grew while packing are freed to a larger class than they
+ * started from, so also take from the next classes up rather than allocate
+ */
+static buf_t *_pool_get(int c)
+{
+	buf_t *buf = NULL;
+	int max_class = MIN((c + BUF_POOL_CLASS_STEPS), BUF_POOL_CLASSES);
+
+	for (; !buf && (c < max_class); c++)
+		buf = _pool_get_class(c);
+
+	return buf;
+}
+
+/* RET true if buf was kept */
+static bool _pool_put(int c, buf_t *buf)
+{
+	bool kept = false;
+
+	if (c < BUF_POOL_THREAD_CLASSES) {
+		if (thread_pool[c].count >= thread_pool_max[c])
+			return false;
+
+		if (!thread_pool_registered) {
+			/* Register so the pool is freed when thread exits */
+			pthread_once(&thread_pool_once,
+				     _thread_pool_key_create);
+			pthread_setspecific(thread_pool_key, thread_pool);
+			thread_pool_registered = true;
+		}
+
+		thread_pool[c].bufs[thread_pool[c].count++] = buf;
+		return true;
+	}
+
+	slurm_mutex_lock(&shared_pool_mutex);
+	if (shared_pool[c].count < SHARED_POOL_MAX) {
+		shared_pool[c].bufs[shared_pool[c].count++] = buf;
+		kept = true;
+	}
+	slurm_mutex_unlock(&shared_pool_mutex);
+
+	return kept;
+}
+
+/*
+ * Get a buffer of size bytes from the pools
+ * IN size - requested size of buffer
+ * IN try - return NULL instead of aborting on allocation failure
+ * RET buffer or NULL if size is not pooled (or allocation failed with try)
+ */
+static buf_t *_pool_init_buf(uint32_t size, bool try)
+{
+	int c = _size_class(size);
+	buf_t *buf;
+
+	if (c < 0)
+		return NULL;
+
+	if ((buf = _pool_get(c))) {
+		_inc_stat(stat_reused);
+		memset(buf->head, 0, size);
+	} else {
+		if (try) {
+			if (!(buf = try_xmalloc(sizeof(*buf))))
+				return NULL;
+			if (!(buf->head = try_xmalloc(BUF_SIZE << c))) {
+				xfree(buf);
+				return NULL;
+			}
+		} else {
+			buf = xmalloc(sizeof(*buf));
+			buf->head = xmalloc(BUF_SIZE << c);
+		}
+	}
+
+	buf->magic = BUF_MAGIC;
+	buf->size = size;
+	buf->processed = 0;
+	buf->mmaped = false;
+	buf->shadow = false;
+
+	return buf;
+}
+
+/*
+ * Grow buffer to new_size without moving it if its head has the capacity,
+ * otherwise to the capacity of the size class of new_size
+ * IN clear - zero the new bytes
+ * RET SLURM_SUCCESS or ENOMEM (only if try)
+ */
+static int _grow_buf_capacity(buf_t *buffer, uint64_t new_size, bool clear,
+			      bool try)
+{
+	size_t capacity = (buffer->head ? xsize(buffer->head) : 0);
+	int c;
+
+	if (capacity >= new_size) {
+		if (clear)
+			memset((buffer->head + buffer->size), 0,
+			       (new_size - buffer->size));
+		buffer->size = new_size;
+		_inc_stat(stat_grown_in_place);
+		return SLURM_SUCCESS;
+	}
+
+	if ((c = _size_class(new_size)) >= 0)
+		capacity = BUF_SIZE << c;
+	else
+		capacity = new_size;
+
+	if (try) {
+		if (!try_xrealloc(buffer->head, capacity))
+			return ENOMEM;
+	} else if (clear) {
+		xrealloc(buffer->head, capacity);
+	} else {
+		xrealloc_nz(buffer->head, capacity);
+	}
+
+	buffer->size = new_size;
+	_inc_stat(stat_reallocs);
+	return SLURM_SUCCESS;
+}
+
+extern uint32_t buf_size_hint(uint16_t key)
+{
+#ifndef __STDC_NO_ATOMICS__
+	uint64_t hint = atomic_uint64_get(buf_hints[key % BUF_HINT_SLOTS]);
+	uint64_t est = (uint32_t) hint;
+
+	/* Leave room for some growth */
+	est = MIN((est + (est / 8)), REASONABLE_BUF_SIZE);
+	if (((hint >> 32) == key) && (est > BUF_SIZE))
+		return est;
+#endif
+	return BUF_SIZE;
+}
+
+extern void buf_size_hint_update(uint16_t key, uint32_t size)
+{
+#ifndef __STDC_NO_ATOMICS__
+	uint64_t hint = atomic_uint64_get(buf_hints[key % BUF_HINT_SLOTS]);
+	uint32_t est = ((hint >> 32) == key) ? (uint32_t) hint : 0;
+
+	/*
+	 * Follow growth at once, but only decay by a quarter of the difference
+	 * so a single small dump (e.g. one user's jobs) does not undo the
+	 * estimate for the full dumps.
+	 */
+	if (size >= est)
+		est = size;
+	else
+		est -= (est - size) / 4;
+
+	(void) atomic_uint64_set(buf_hints[key % BUF_HINT_SLOTS],
+				 (((uint64_t) key << 32) | est));
+#endif
+}
+
+extern void buf_stats_get(buf_stats_t *stats)
+{
+#ifndef __STDC_NO_ATOMICS__
+	stats->allocs = atomic_uint64_get(stat_allocs);
+	stats->reused = atomic_uint64_get(stat_reused);
+	stats->grown_in_place = atomic_uint64_get(stat_grown_in_place);
+	stats->reallocs = atomic_uint64_get(stat_reallocs);
+#else
+	*stats = (buf_stats_t) { 0 };
+#endif
+}
+
+extern void buf_stats_reset(void)
+{
+#ifndef __STDC_NO_ATOMICS__
+	(void) atomic_uint64_set_zero(stat_allocs);
+	(void) atomic_uint64_set_zero(stat_reused);
+	(void) atomic_uint64_set_zero(stat_grown_in_place);
+	(void) atomic_uint64_set_zero(stat_reallocs);
+#endif
+}
+
 /* Basic buffer management routines */
 /* create_buf - create a buffer with the supplied contents, contents must
  * be xalloc'ed */
@@ -187,10 +483,16 @@ void free_buf(buf_t *my_buf)
 	if (!my_buf)
 		return;
 	xassert(my_buf->magic == BUF_MAGIC);
-	if (my_buf->mmaped)
+	if (my_buf->mmaped) {
 		munmap(my_buf->head, my_buf->size);
-	else if (!my_buf->shadow)
+	} else if (!my_buf->shadow && my_buf->head) {
+		int c = _capacity_class(xsize(my_buf->head));
+
+		if ((c >= 0) && _pool_put(c, my_buf))
+			return;
+
 		xfree(my_buf->head);
+	}
 
 	xfree(my_buf);
 }
@@ -210,8 +512,7 @@ void grow_buf(buf_t *buffer, uint32_t size)
 		fatal_abort("%s: Buffer size limit exceeded (%"PRIu64" > %u)",
 			    __func__, new_size, MAX_BUF_SIZE);
 
-	buffer->size = new_size;
-	xrealloc_nz(buffer->head, buffer->size);
+	(void) _grow_buf_capacity(buffer, new_size, false, false);
 }
 
 extern int try_grow_buf(buf_t *buffer, uint32_t size)
@@ -235,12 +536,7 @@ extern int try_grow_buf(buf_t *buffer, uint32_t size)
 		return ESLURM_DATA_TOO_LARGE;
 	}
 
-	if (!try_xrealloc(buffer->head, new_size))
-		return ENOMEM;
-
-	buffer->size = new_size;
-
-	return SLURM_SUCCESS;
+	return _grow_buf_capacity(buffer, new_size, true, true);
 }
 
 extern int try_grow_buf_remaining(buf_t *buffer, uint32_t size)
@@ -317,6 +613,11 @@ buf_t *init_buf(uint32_t size)
 
 	if (size <= 0)
 		size = BUF_SIZE;
+
+	_inc_stat(stat_allocs);
+	if ((my_buf = _pool_init_buf(size, false)))
+		return my_buf;
+
 	my_buf = xmalloc(sizeof(*my_buf));
 	my_buf->magic = BUF_MAGIC;
 	my_buf->size = size;
@@ -364,6 +665,10 @@ extern buf_t *try_init_buf(uint32_t size)
 		return NULL;
 	}
 
+	_inc_stat(stat_allocs);
+	if ((buf = _pool_init_buf(size, true)))
+		return buf;
+
 	if (!(buf = try_xmalloc(sizeof(*buf)))) {
 		error("%s: Unable to allocate memory for %zu bytes",
 		      __func__, sizeof(*buf));
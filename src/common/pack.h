@@ -96,12 +96,40 @@ typedef struct {
 	buf_t *body;
 } msg_bufs_t;
 
+typedef struct {
+	uint64_t allocs; /* buffers initialized */
+	uint64_t reused; /* buffers taken from a pool */
+	uint64_t grown_in_place; /* buffers grown without realloc */
+	uint64_t reallocs; /* buffers grown with realloc */
+} buf_stats_t;
+
 extern buf_t *create_buf(char *data, uint32_t size);
 extern buf_t *create_mmap_buf(const char *file);
 extern buf_t *create_shadow_buf(char *data, uint32_t size);
 extern void free_buf(buf_t *my_buf);
 extern buf_t *init_buf(uint32_t size);
 
+/*
+ * Get the size to init_buf() for data which is packed repeatedly in one large
+ * buffer (such as the job, node or partition dumps), from the estimate kept by
+ * buf_size_hint_update() plus room for some growth
+ * IN key - what is packed (e.g. RESPONSE_JOB_INFO)
+ * RET size likely to fit the data or BUF_SIZE
+ */
+extern uint32_t buf_size_hint(uint16_t key);
+
+/*
+ * Update the size estimate for key. The estimate rises to any larger size at
+ * once and decays slowly towards smaller sizes.
+ * IN key - what was packed (e.g. RESPONSE_JOB_INFO)
+ * IN size - bytes packed
+ */
+extern void buf_size_hint_update(uint16_t key, uint32_t size);
+
+/* Get or reset the counters of buffer allocations */
+extern void buf_stats_get(buf_stats_t *stats);
+extern void buf_stats_reset(void);
+
 /*
  * Assign data to buffer
  * IN data_ptr - Pointer to data to take ownership of
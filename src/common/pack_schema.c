@@ -0,0 +1,284 @@
+/*****************************************************************************\
+ *  pack_schema.c - table driven packing of fixed layout messages
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/pack_schema.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+
+/* Most fields any layout may have */
+#define MAX_FIELDS 32
+
+static const pack_layout_t *_find_layout(const pack_schema_t *schema,
+					 uint16_t protocol_version)
+{
+	for (const pack_layout_t *layout = schema->layouts; layout->fields;
+	     layout++) {
+		if (protocol_version >= layout->min_version)
+			return layout;
+	}
+
+	return NULL;
+}
+
+static uint32_t _fixed_width(pack_field_type_t type)
+{
+	switch (type) {
+	case PACK_FIELD_U16:
+		return sizeof(uint16_t);
+	case PACK_FIELD_U32:
+	case PACK_FIELD_STR: /* length prefix */
+		return sizeof(uint32_t);
+	case PACK_FIELD_U64:
+	case PACK_FIELD_TIME:
+		return sizeof(uint64_t);
+	case PACK_FIELD_END:
+		break;
+	}
+
+	fatal_abort("%s: invalid field type %d", __func__, type);
+}
+
+extern void pack_schema_pack(const pack_schema_t *schema, const void *msg,
+			     uint16_t protocol_version, buf_t *buffer)
+{
+	const pack_layout_t *layout = _find_layout(schema, protocol_version);
+	const char *base = msg;
+	uint32_t str_len[MAX_FIELDS];
+	uint64_t size = 0;
+	char *ptr;
+
+	xassert(buffer->magic == BUF_MAGIC);
+
+	if (!layout)
+		return;
+
+	for (int i = 0; layout->fields[i].type != PACK_FIELD_END; i++) {
+		const pack_field_t *field = &layout->fields[i];
+
+		xassert(i < MAX_FIELDS);
+		size += _fixed_width(field->type);
+
+		if (field->type == PACK_FIELD_STR) {
+			const char *str = *(char **) (base + field->offset);
+			size_t len = str ? (strlen(str) + 1) : 0;
+
+			if (len > MAX_PACK_MEM_LEN) {
+				error("%s: Buffer to be packed is too large (%zu > %u)",
+				      __func__, len, MAX_PACK_MEM_LEN);
+				len = 0;
+			}
+			str_len[i] = len;
+			size += len;
+		}
+	}
+
+	if (size > UINT32_MAX)
+		fatal_abort("%s: Message size limit exceeded (%"PRIu64" > %u)",
+			    __func__, size, UINT32_MAX);
+	if (try_grow_buf_remaining(buffer, size))
+		fatal_abort("%s: Unable to grow buffer by %"PRIu64" bytes",
+			    __func__, size);
+
+	ptr = &buffer->head[buffer->processed];
+
+	for (int i = 0; layout->fields[i].type != PACK_FIELD_END; i++) {
+		const pack_field_t *field = &layout->fields[i];
+		const void *val = base + field->offset;
+
+		switch (field->type) {
+		case PACK_FIELD_U16:
+		{
+			uint16_t n16 = htons(*(uint16_t *) val);
+			memcpy(ptr, &n16, sizeof(n16));
+			ptr += sizeof(n16);
+			break;
+		}
+		case PACK_FIELD_U32:
+		{
+			uint32_t n32 = htonl(*(uint32_t *) val);
+			memcpy(ptr, &n32, sizeof(n32));
+			ptr += sizeof(n32);
+			break;
+		}
+		case PACK_FIELD_U64:
+		{
+			uint64_t n64 = HTON_uint64(*(uint64_t *) val);
+			memcpy(ptr, &n64, sizeof(n64));
+			ptr += sizeof(n64);
+			break;
+		}
+		case PACK_FIELD_TIME:
+		{
+			int64_t n64 = HTON_int64((int64_t) *(time_t *) val);
+			memcpy(ptr, &n64, sizeof(n64));
+			ptr += sizeof(n64);
+			break;
+		}
+		case PACK_FIELD_STR:
+		{
+			uint32_t ns = htonl(str_len[i]);
+			memcpy(ptr, &ns, sizeof(ns));
+			ptr += sizeof(ns);
+			if (str_len[i]) {
+				memcpy(ptr, *(char **) val, str_len[i]);
+				ptr += str_len[i];
+			}
+			break;
+		}
+		case PACK_FIELD_END:
+			break;
+		}
+	}
+
+	xassert((ptr - &buffer->head[buffer->processed]) == size);
+	buffer->processed += size;
+}
+
+extern int pack_schema_unpack(const pack_schema_t *schema, void **msg_ptr,
+			      uint16_t protocol_version, buf_t *buffer)
+{
+	const pack_layout_t *layout = _find_layout(schema, protocol_version);
+	char *base = xmalloc(schema->size);
+	uint32_t need = 0;
+
+	xassert(buffer->magic == BUF_MAGIC);
+
+	if (schema->init)
+		schema->init(base);
+
+	if (!layout)
+		goto done;
+
+	for (int i = 0; layout->fields[i].type != PACK_FIELD_END; i++)
+		need += _fixed_width(layout->fields[i].type);
+
+	/*
+	 * need is what remains to be read of the fixed width fields, which
+	 * only has to be checked again after a variable length string
+	 */
+	if (remaining_buf(buffer) < need)
+		goto unpack_error;
+
+	for (int i = 0; layout->fields[i].type != PACK_FIELD_END; i++) {
+		const pack_field_t *field = &layout->fields[i];
+		void *val = base + field->offset;
+		char *ptr = &buffer->head[buffer->processed];
+
+		switch (field->type) {
+		case PACK_FIELD_U16:
+		{
+			uint16_t n16;
+			memcpy(&n16, ptr, sizeof(n16));
+			*(uint16_t *) val = ntohs(n16);
+			buffer->processed += sizeof(n16);
+			need -= sizeof(n16);
+			break;
+		}
+		case PACK_FIELD_U32:
+		{
+			uint32_t n32;
+			memcpy(&n32, ptr, sizeof(n32));
+			*(uint32_t *) val = ntohl(n32);
+			buffer->processed += sizeof(n32);
+			need -= sizeof(n32);
+			break;
+		}
+		case PACK_FIELD_U64:
+		{
+			uint64_t n64;
+			memcpy(&n64, ptr, sizeof(n64));
+			*(uint64_t *) val = NTOH_uint64(n64);
+			buffer->processed += sizeof(n64);
+			need -= sizeof(n64);
+			break;
+		}
+		case PACK_FIELD_TIME:
+		{
+			int64_t n64;
+			memcpy(&n64, ptr, sizeof(n64));
+			*(time_t *) val = (time_t) NTOH_int64(n64);
+			buffer->processed += sizeof(n64);
+			need -= sizeof(n64);
+			break;
+		}
+		case PACK_FIELD_STR:
+		{
+			uint32_t len;
+
+			need -= sizeof(uint32_t);
+			if (unpackstr_xmalloc_chooser(val, &len, buffer))
+				goto unpack_error;
+			if (remaining_buf(buffer) < need)
+				goto unpack_error;
+			break;
+		}
+		case PACK_FIELD_END:
+			break;
+		}
+	}
+
+done:
+	*msg_ptr = base;
+	return SLURM_SUCCESS;
+
+unpack_error:
+	pack_schema_free(schema, base);
+	return SLURM_ERROR;
+}
+
+extern void pack_schema_free(const pack_schema_t *schema, void *msg)
+{
+	char *base = msg;
+
+	if (!msg)
+		return;
+
+	for (const pack_layout_t *layout = schema->layouts; layout->fields;
+	     layout++) {
+		for (const pack_field_t *field = layout->fields;
+		     field->type != PACK_FIELD_END; field++) {
+			if (field->type == PACK_FIELD_STR)
+				xfree(*(char **) (base + field->offset));
+		}
+	}
+
+	xfree(msg);
+}
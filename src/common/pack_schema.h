@@ -0,0 +1,122 @@
+/*****************************************************************************\
+ *  pack_schema.h - table driven packing of fixed layout messages
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _PACK_SCHEMA_H
+#define _PACK_SCHEMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "src/common/pack.h"
+
+typedef enum {
+	PACK_FIELD_END = 0, /* terminates list of fields */
+	PACK_FIELD_U16, /* uint16_t, pack16() */
+	PACK_FIELD_U32, /* uint32_t, pack32() */
+	PACK_FIELD_U64, /* uint64_t, pack64() */
+	PACK_FIELD_TIME, /* time_t, pack_time() */
+	PACK_FIELD_STR, /* xmalloc()ed char *, packstr() */
+} pack_field_type_t;
+
+typedef struct {
+	pack_field_type_t type;
+	size_t offset; /* offset of member in message struct */
+} pack_field_t;
+
+/*
+ * Fields of a message as packed by protocol_version >= min_version.
+ * Fields are packed back to back in the listed order, which must match the
+ * hand written pack/unpack functions they replace.
+ */
+typedef struct {
+	uint16_t min_version;
+	const pack_field_t *fields; /* NULL terminates list of layouts */
+} pack_layout_t;
+
+typedef struct {
+	size_t size; /* sizeof() message struct */
+	/* optional, sets members not in every layout before unpacking */
+	void (*init)(void *msg);
+	const pack_layout_t *layouts; /* newest protocol version first */
+} pack_schema_t;
+
+/* Width of member on the wire, fails to compile if the type does not match */
+#define _PACK_FIELD_WIDTH_U16 sizeof(uint16_t)
+#define _PACK_FIELD_WIDTH_U32 sizeof(uint32_t)
+#define _PACK_FIELD_WIDTH_U64 sizeof(uint64_t)
+#define _PACK_FIELD_WIDTH_TIME sizeof(time_t)
+#define _PACK_FIELD_WIDTH_STR sizeof(char *)
+
+#define PACK_FIELD(_type, _struct, _member)				\
+{									\
+	.type = PACK_FIELD_##_type,					\
+	.offset = offsetof(_struct, _member) +				\
+		(0 * sizeof(char[(sizeof(((_struct *) 0)->_member) ==	\
+				  _PACK_FIELD_WIDTH_##_type) ? 1 : -1])),	\
+}
+
+#define PACK_FIELDS_END { .type = PACK_FIELD_END }
+#define PACK_LAYOUTS_END { .fields = NULL }
+
+/*
+ * Pack message using the first layout valid for protocol_version
+ * Buffer is grown once for the whole message, fatal if it can not be grown.
+ * Nothing is packed if no layout matches protocol_version.
+ * IN schema - description of message
+ * IN msg - message struct to pack
+ * IN protocol_version - version of peer
+ * IN/OUT buffer - buffer to pack into
+ */
+extern void pack_schema_pack(const pack_schema_t *schema, const void *msg,
+			     uint16_t protocol_version, buf_t *buffer);
+
+/*
+ * Unpack message using the first layout valid for protocol_version
+ * Fixed width fields are bounds checked together before being read. Message
+ * is left zeroed, or as set by schema->init(), if no layout matches
+ * protocol_version.
+ * IN schema - description of message
+ * OUT msg_ptr - xmalloc()ed message struct, only set on success
+ * IN protocol_version - version of peer
+ * IN/OUT buffer - buffer to unpack from
+ * RET SLURM_SUCCESS or SLURM_ERROR
+ */
+extern int pack_schema_unpack(const pack_schema_t *schema, void **msg_ptr,
+			      uint16_t protocol_version, buf_t *buffer);
+
+/* Free message struct and all string fields of every layout in schema */
+extern void pack_schema_free(const pack_schema_t *schema, void *msg);
+
+#endif
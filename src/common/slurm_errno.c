@@ -1140,6 +1140,10 @@ slurm_errtab_t slurm_errtab[] = {
 		ERRTAB_ENTRY(ESLURMD_STEPD_PROXY_FAILED),
 		"Unable to proxy slurmstepd message",
 	},
+	{
+		ERRTAB_ENTRY(ESLURMD_BCAST_BLOCK_NOT_CACHED),
+		"File broadcast block not in node's cache",
+	},
 
 	/* socket specific Slurm communications error */
 
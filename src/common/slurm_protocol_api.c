@@ -60,6 +60,7 @@
 #include "slurm/slurm_errno.h"
 
 #include "src/common/assoc_mgr.h"
+#include "src/common/conn_pool.h"
 #include "src/common/fd.h"
 #include "src/common/forward.h"
 #include "src/common/log.h"
@@ -74,11 +75,13 @@
 #include "src/common/slurm_protocol_socket.h"
 #include "src/common/stepd_proxy.h"
 #include "src/common/strlcpy.h"
+#include "src/common/timers.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
 #include "src/interfaces/accounting_storage.h"
 #include "src/interfaces/auth.h"
+#include "src/interfaces/compress.h"
 #include "src/interfaces/conn.h"
 #include "src/interfaces/hash.h"
 
@@ -103,7 +106,17 @@ strong_alias(get_unit_type, slurm_get_unit_type);
 
 /* #DEFINES */
 
+/* Largest compressed block in a compressed message body */
+#define COMPRESS_BLOCK_SIZE (64 * 1024)
+/* Smallest space worth compressing another block into */
+#define COMPRESS_BLOCK_MIN 1024
+
 /* STATIC VARIABLES */
+static pthread_mutex_t compress_lock = PTHREAD_MUTEX_INITIALIZER;
+static time_t compress_config_update = (time_t) -1;
+static uint32_t compress_threshold = 0;
+static msg_compress_stats_t *compress_stats = NULL;
+static uint32_t compress_stats_cnt = 0;
 
 /* STATIC FUNCTIONS */
 static char *_global_auth_key(void);
@@ -277,6 +290,237 @@ static int _compute_hash(buf_t *buffer, slurm_msg_t *msg, slurm_hash_t *hash)
 
 }
 
+/*
+ * Get CommunicationParameters=compress_threshold, loading the compress plugins
+ * the first time it is set.
+ * RET minimum body size to compress or 0 if disabled
+ */
+static uint32_t _compress_threshold(void)
+{
+	char *tmp_ptr;
+
+	if (compress_config_update == slurm_conf.last_update)
+		return compress_threshold;
+
+	slurm_mutex_lock(&compress_lock);
+	if (compress_config_update == slurm_conf.last_update)
+		goto done;
+
+	compress_threshold = 0;
+	if ((tmp_ptr = xstrcasestr(slurm_conf.comm_params,
+				   "compress_threshold="))) {
+		long tmp_val = strtol(tmp_ptr + 19, NULL, 10);
+
+		if ((tmp_val > 0) && (tmp_val <= MAX_MSG_SIZE))
+			compress_threshold = tmp_val;
+		else
+			error("CommunicationParameters option compress_threshold=%ld is invalid, ignored",
+			      tmp_val);
+	}
+
+	if (compress_threshold &&
+	    ((compress_g_init() != SLURM_SUCCESS) ||
+	     (compress_g_type_available(COMPRESS_PLUGIN_LZ4) !=
+	      SLURM_SUCCESS))) {
+		error("CommunicationParameters option compress_threshold requires compress/lz4, message compression disabled");
+		compress_threshold = 0;
+	}
+
+	compress_config_update = slurm_conf.last_update;
+done:
+	slurm_mutex_unlock(&compress_lock);
+	return compress_threshold;
+}
+
+/* Get counters for msg_type. Caller must hold compress_lock. */
+static msg_compress_stats_t *_compress_stats(uint16_t msg_type)
+{
+	for (int i = 0; i < compress_stats_cnt; i++) {
+		if (compress_stats[i].msg_type == msg_type)
+			return &compress_stats[i];
+	}
+
+	xrecalloc(compress_stats, (compress_stats_cnt + 1),
+		  sizeof(*compress_stats));
+	compress_stats[compress_stats_cnt].msg_type = msg_type;
+	return &compress_stats[compress_stats_cnt++];
+}
+
+/*
+ * Replace body with a compressed copy when it is over the threshold, the peer
+ * can decompress it, and it shrinks.
+ *
+ * A compressed body is the uncompressed size and compression type followed by
+ * blocks of compressed size, uncompressed size and compressed data.
+ *
+ * RET true if body was compressed
+ */
+static bool _compress_body(slurm_msg_t *msg, buf_t **body)
+{
+	uint32_t threshold = _compress_threshold();
+	uint32_t raw_len = get_buf_offset(*body);
+	char *in_pos = get_buf_data(*body);
+	ssize_t remaining = raw_len;
+	msg_compress_stats_t *stats;
+	buf_t *out;
+	DEF_TIMERS;
+
+	if (!threshold || (raw_len < threshold) ||
+	    !(msg->flags & SLURM_MSG_COMPRESS_OK) ||
+	    (msg->protocol_version < SLURM_26_11_PROTOCOL_VERSION))
+		return false;
+
+	START_TIMER;
+	out = init_buf(raw_len);
+	pack32(raw_len, out);
+	pack16(COMPRESS_PLUGIN_LZ4, out);
+
+	while (remaining > 0) {
+		char *in_start = in_pos;
+		char *out_pos = get_buf_data(out) + get_buf_offset(out) +
+				(2 * sizeof(uint32_t));
+		ssize_t out_size = ((ssize_t) remaining_buf(out) -
+				    (ssize_t) (2 * sizeof(uint32_t)));
+		ssize_t comp_len;
+
+		/* Stop once the compressed body is about as big as the raw one */
+		if (out_size < COMPRESS_BLOCK_MIN)
+			break;
+
+		comp_len = compress_g_comp_block(COMPRESS_PLUGIN_LZ4, &in_pos,
+						 remaining, &out_pos,
+						 MIN(out_size,
+						     COMPRESS_BLOCK_SIZE),
+						 &remaining);
+		if ((comp_len <= 0) || (in_pos == in_start)) {
+			remaining = -1;
+			break;
+		}
+
+		pack32(comp_len, out);
+		pack32((in_pos - in_start), out);
+		set_buf_offset(out, (get_buf_offset(out) + comp_len));
+	}
+	END_TIMER;
+
+	slurm_mutex_lock(&compress_lock);
+	stats = _compress_stats(msg->msg_type);
+	stats->compress_usec += TIMER_DURATION_USEC();
+	if (remaining) {
+		stats->skipped++;
+	} else {
+		stats->compressed++;
+		stats->raw_bytes += raw_len;
+		stats->wire_bytes += get_buf_offset(out);
+	}
+	slurm_mutex_unlock(&compress_lock);
+
+	if (remaining) {
+		FREE_NULL_BUFFER(out);
+		return false;
+	}
+
+	log_flag(NET, "%s: compressed %s from %u to %u bytes in %s",
+		 __func__, rpc_num2string(msg->msg_type), raw_len,
+		 get_buf_offset(out), TIMER_STR());
+
+	/* Release the unused tail as the body may be queued for a while */
+	xrealloc_nz(out->head, get_buf_offset(out));
+	out->size = get_buf_offset(out);
+
+	FREE_NULL_BUFFER(*body);
+	*body = out;
+	return true;
+}
+
+/*
+ * Decompress body of buffer in place if the header says it was compressed.
+ * Everything before the body is kept so msg->body_offset stays valid.
+ */
+static int _decompress_body(slurm_msg_t *msg, header_t *header,
+			    buf_t *buffer)
+{
+	uint32_t offset = get_buf_offset(buffer), out_offset = offset;
+	uint32_t raw_len;
+	uint16_t type;
+	char *out = NULL;
+	msg_compress_stats_t *stats;
+	buf_t *in;
+	DEF_TIMERS;
+
+	if (!(header->flags & SLURM_MSG_COMPRESSED))
+		return SLURM_SUCCESS;
+
+	xassert(!buffer->mmaped);
+
+	START_TIMER;
+	in = create_shadow_buf((get_buf_data(buffer) + offset),
+			       remaining_buf(buffer));
+
+	safe_unpack32(&raw_len, in);
+	safe_unpack16(&type, in);
+
+	if (raw_len > MAX_MSG_SIZE)
+		goto unpack_error;
+
+	if ((compress_g_init() != SLURM_SUCCESS) ||
+	    (compress_g_type_available(type) != SLURM_SUCCESS)) {
+		error("%s: %s compressed with unavailable compress plugin type %hu",
+		      __func__, rpc_num2string(header->msg_type), type);
+		goto unpack_error;
+	}
+
+	out = xmalloc_nz(offset + raw_len);
+	memcpy(out, get_buf_data(buffer), offset);
+
+	while (remaining_buf(in)) {
+		uint32_t comp_len, block_len;
+		char *block;
+
+		safe_unpack32(&comp_len, in);
+		safe_unpack32(&block_len, in);
+
+		if (!comp_len || (comp_len > remaining_buf(in)) ||
+		    (block_len > (offset + raw_len - out_offset)))
+			goto unpack_error;
+
+		if (!(block = compress_g_decompress(type, (get_buf_data(in) +
+							   get_buf_offset(in)),
+						    comp_len, block_len)))
+			goto unpack_error;
+
+		memcpy((out + out_offset), block, block_len);
+		xfree(block);
+
+		out_offset += block_len;
+		set_buf_offset(in, (get_buf_offset(in) + comp_len));
+	}
+
+	if (out_offset != (offset + raw_len))
+		goto unpack_error;
+	END_TIMER;
+
+	assign_buf(buffer, &out, offset);
+	header->body_length = raw_len;
+	msg->flags &= ~SLURM_MSG_COMPRESSED;
+	FREE_NULL_BUFFER(in);
+
+	slurm_mutex_lock(&compress_lock);
+	stats = _compress_stats(header->msg_type);
+	stats->decompressed++;
+	stats->decompress_usec += TIMER_DURATION_USEC();
+	slurm_mutex_unlock(&compress_lock);
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	error("%s: invalid compressed %s body", __func__,
+	      rpc_num2string(header->msg_type));
+	xfree(out);
+	FREE_NULL_BUFFER(in);
+	return SLURM_ERROR;
+}
+
 static int _get_tres_id(char *type, char *name)
 {
 	slurmdb_tres_rec_t tres_rec;
@@ -985,6 +1229,7 @@ skip_auth:
 
 	if ((header.body_length != remaining_buf(buffer)) ||
 	    _check_hash(buffer, &header, msg, auth_cred) ||
+	    _decompress_body(msg, &header, buffer) ||
 	    (unpack_msg(msg, buffer) != SLURM_SUCCESS)) {
 		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
 		auth_g_destroy(auth_cred);
@@ -1138,14 +1383,94 @@ endit:
  *		  forwarded the message to. List containing type
  *		  (ret_data_info_t).
  */
-extern list_t *slurm_receive_msgs(conn_t *conn, int steps, int timeout)
+extern int slurm_unpack_received_resp_msg(slurm_msg_t *msg, int fd,
+					  buf_t *buffer)
+{
+	header_t header;
+	int rc;
+	void *auth_cred = NULL;
+	char *peer = NULL;
+
+	if ((rc = unpack_header(&header, buffer)))
+		goto total_return;
+
+	if (header.ret_cnt > 0) {
+		if (header.ret_list)
+			msg->ret_list = header.ret_list;
+		else
+			msg->ret_list = list_create(destroy_data_info);
+		header.ret_cnt = 0;
+		header.ret_list = NULL;
+	}
+
+	/* Forward message to other nodes */
+	if (header.forward.cnt > 0) {
+		peer = fd_resolve_peer(fd);
+		error("%s: [%s] We need to forward this to other nodes use slurm_unpack_msg_and_forward instead",
+		      __func__, peer);
+		xfree(peer);
+	}
+
+	if (header.flags & SLURM_NO_AUTH_CRED)
+		goto skip_auth;
+
+	if (!(auth_cred = auth_g_unpack(buffer, header.version))) {
+		peer = fd_resolve_peer(fd);
+		error("%s: [%s] auth_g_unpack: %m", __func__, peer);
+		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
+		goto total_return;
+	}
+	msg->auth_index = auth_index(auth_cred);
+	if (header.flags & SLURM_GLOBAL_AUTH_KEY) {
+		rc = auth_g_verify(auth_cred, _global_auth_key());
+	} else {
+		rc = auth_g_verify(auth_cred, slurm_conf.authinfo);
+	}
+
+	if (rc != SLURM_SUCCESS) {
+		peer = fd_resolve_peer(fd);
+		error("%s: [%s] auth_g_verify: %s has authentication error: %m",
+		      __func__, peer, rpc_num2string(header.msg_type));
+		rc = SLURM_PROTOCOL_AUTHENTICATION_ERROR;
+		goto total_return;
+	}
+
+	auth_g_get_ids(auth_cred, &msg->auth_uid, &msg->auth_gid);
+	msg->auth_ids_set = true;
+
+skip_auth:
+
+	/*
+	 * Unpack message body
+	 */
+	msg->protocol_version = header.version;
+	msg->msg_type = header.msg_type;
+	msg->flags = header.flags;
+
+	if ((header.body_length != remaining_buf(buffer)) ||
+	    _check_hash(buffer, &header, msg, auth_cred) ||
+	    _decompress_body(msg, &header, buffer) ||
+	    (unpack_msg(msg, buffer) != SLURM_SUCCESS))
+		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
+
+total_return:
+	auth_g_destroy(auth_cred);
+	destroy_forward(&header.forward);
+	xfree(peer);
+	return rc;
+}
+
+/*
+ * Receive a response and the responses of any nodes it was forwarded to
+ * OUT flags - header flags of response (optional)
+ */
+static list_t *_receive_msgs(conn_t *conn, int steps, int timeout,
+			     uint16_t *flags)
 {
 	int fd = -1;
 	char *buf = NULL;
 	size_t buflen = 0;
-	header_t header;
 	int rc;
-	void *auth_cred = NULL;
 	slurm_msg_t msg;
 	buf_t *buffer;
 	ret_data_info_t *ret_data_info = NULL;
@@ -1196,7 +1521,6 @@ extern list_t *slurm_receive_msgs(conn_t *conn, int steps, int timeout)
 	 *  the message.
 	 */
 	if (slurm_msg_recvfrom_timeout(conn, &buf, &buflen, timeout) < 0) {
-		header.forward = FORWARD_INITIALIZER;
 		rc = errno;
 		goto total_return;
 	}
@@ -1204,91 +1528,15 @@ extern list_t *slurm_receive_msgs(conn_t *conn, int steps, int timeout)
 	log_flag_hex(NET_RAW, buf, buflen, "%s: [%s] read", __func__, peer);
 	buffer = create_buf(buf, buflen);
 
-	if ((rc = unpack_header(&header, buffer))) {
-		FREE_NULL_BUFFER(buffer);
-		goto total_return;
-	}
-
-	if (header.ret_cnt > 0) {
-		if (header.ret_list)
-			ret_list = header.ret_list;
-		else
-			ret_list = list_create(destroy_data_info);
-		header.ret_cnt = 0;
-		header.ret_list = NULL;
-	}
-
-	/* Forward message to other nodes */
-	if (header.forward.cnt > 0) {
-		/* peer may have not been resolved already */
-		if (!peer)
-			peer = fd_resolve_peer(fd);
-
-		error("%s: [%s] We need to forward this to other nodes use slurm_unpack_msg_and_forward instead",
-		      __func__, peer);
-	}
-
-	if (header.flags & SLURM_NO_AUTH_CRED)
-		goto skip_auth;
-
-	if (!(auth_cred = auth_g_unpack(buffer, header.version))) {
-		/* peer may have not been resolved already */
-		if (!peer)
-			peer = fd_resolve_peer(fd);
-
-		error("%s: [%s] auth_g_unpack: %m", __func__, peer);
-		FREE_NULL_BUFFER(buffer);
-		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
-		goto total_return;
-	}
-	msg.auth_index = auth_index(auth_cred);
-	if (header.flags & SLURM_GLOBAL_AUTH_KEY) {
-		rc = auth_g_verify(auth_cred, _global_auth_key());
-	} else {
-		rc = auth_g_verify(auth_cred, slurm_conf.authinfo);
-	}
-
-	if (rc != SLURM_SUCCESS) {
-		/* peer may have not been resolved already */
-		if (!peer)
-			peer = fd_resolve_peer(fd);
-
-		error("%s: [%s] auth_g_verify: %s has authentication error: %m",
-		      __func__, peer, rpc_num2string(header.msg_type));
-		auth_g_destroy(auth_cred);
-		FREE_NULL_BUFFER(buffer);
-		rc = SLURM_PROTOCOL_AUTHENTICATION_ERROR;
-		goto total_return;
-	}
-
-	auth_g_get_ids(auth_cred, &msg.auth_uid, &msg.auth_gid);
-	msg.auth_ids_set = true;
-
-skip_auth:
-
-	/*
-	 * Unpack message body
-	 */
-	msg.protocol_version = header.version;
-	msg.msg_type = header.msg_type;
-	msg.flags = header.flags;
-
-	if ((header.body_length != remaining_buf(buffer)) ||
-	    _check_hash(buffer, &header, &msg, auth_cred) ||
-	    (unpack_msg(&msg, buffer) != SLURM_SUCCESS)) {
-		auth_g_destroy(auth_cred);
-		FREE_NULL_BUFFER(buffer);
-		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
-		goto total_return;
-	}
-	auth_g_destroy(auth_cred);
+	rc = slurm_unpack_received_resp_msg(&msg, fd, buffer);
+	ret_list = msg.ret_list;
+	msg.ret_list = NULL;
+	if (flags)
+		*flags = msg.flags;
 
 	FREE_NULL_BUFFER(buffer);
-	rc = SLURM_SUCCESS;
 
 total_return:
-	destroy_forward(&header.forward);
-
 	if (rc != SLURM_SUCCESS) {
 		if (ret_list) {
 			ret_data_info = xmalloc(sizeof(ret_data_info_t));
@@ -1322,6 +1570,11 @@ total_return:
 
 }
 
+extern list_t *slurm_receive_msgs(conn_t *conn, int steps, int timeout)
+{
+	return _receive_msgs(conn, steps, timeout, NULL);
+}
+
 extern list_t *slurm_receive_resp_msgs(conn_t *conn, int steps, int timeout)
 {
 	int fd = -1;
@@ -1440,6 +1693,7 @@ skip_auth:
 	msg.flags = header.flags;
 
 	if ((header.body_length > remaining_buf(buffer)) ||
+	    _decompress_body(&msg, &header, buffer) ||
 	    (unpack_msg(&msg, buffer) != SLURM_SUCCESS)) {
 		FREE_NULL_BUFFER(buffer);
 		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
@@ -1611,6 +1865,7 @@ skip_auth:
 
 	if ((header.body_length != remaining_buf(buffer)) ||
 	    _check_hash(buffer, &header, msg, auth_cred) ||
+	    _decompress_body(msg, &header, buffer) ||
 	    (unpack_msg(msg, buffer) != SLURM_SUCCESS)) {
 		auth_g_destroy(auth_cred);
 		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
@@ -1655,14 +1910,18 @@ extern int slurm_buffers_pack_msg(slurm_msg_t *msg, msg_bufs_t *buffers,
 	time_t start_time = time(NULL);
 	slurm_hash_t hash = { 0 };
 	int h_len = 0;
+	bool compressed;
 
 	if (!msg->restrict_uid_set)
 		fatal("%s: restrict_uid is not set", __func__);
 	/*
 	 * Pack message into buffer
 	 */
-	buffers->body = init_buf(BUF_SIZE);
-	pack_msg(msg, buffers->body);
+	if (!(buffers->body = pack_msg_shadow_body(msg))) {
+		buffers->body = init_buf(BUF_SIZE);
+		pack_msg(msg, buffers->body);
+	}
+	compressed = _compress_body(msg, &buffers->body);
 	log_flag_hex(NET_RAW, get_buf_data(buffers->body),
 		     get_buf_offset(buffers->body),
 		     "%s: packed body", __func__);
@@ -1708,6 +1967,12 @@ skip_auth1:
 		forward_wait(msg);
 
 	init_header(&header, msg, msg->flags);
+	header.flags &= ~(SLURM_MSG_COMPRESSED | SLURM_MSG_COMPRESS_OK);
+	if (compressed)
+		header.flags |= SLURM_MSG_COMPRESSED;
+	if ((msg->protocol_version >= SLURM_26_11_PROTOCOL_VERSION) &&
+	    _compress_threshold())
+		header.flags |= SLURM_MSG_COMPRESS_OK;
 
 	if (msg->flags & SLURM_NO_AUTH_CRED)
 		goto skip_auth2;
@@ -1767,6 +2032,34 @@ skip_auth2:
 	return rc;
 }
 
+extern bool slurm_msg_compress_enabled(void)
+{
+	return (_compress_threshold() > 0);
+}
+
+extern msg_compress_stats_t *slurm_msg_compress_stats_get(uint32_t *count)
+{
+	msg_compress_stats_t *stats = NULL;
+
+	slurm_mutex_lock(&compress_lock);
+	if ((*count = compress_stats_cnt)) {
+		stats = xcalloc(compress_stats_cnt, sizeof(*stats));
+		memcpy(stats, compress_stats,
+		       (compress_stats_cnt * sizeof(*stats)));
+	}
+	slurm_mutex_unlock(&compress_lock);
+
+	return stats;
+}
+
+extern void slurm_msg_compress_stats_reset(void)
+{
+	slurm_mutex_lock(&compress_lock);
+	xfree(compress_stats);
+	compress_stats_cnt = 0;
+	slurm_mutex_unlock(&compress_lock);
+}
+
 /**********************************************************************\
  * send message functions
 \**********************************************************************/
@@ -2590,12 +2883,17 @@ list_t *slurm_send_addr_recv_msgs(slurm_msg_t *msg, char *name, int timeout)
 	uint16_t conn_timeout = MIN(slurm_conf.msg_timeout, 10);
 	conn_t *conn = NULL;
 	list_t *ret_list = NULL;
-	bool first = true;
+	bool first = true, reused = false, pooled = conn_pool_enabled();
+	uint16_t resp_flags = 0;
+
+	if (pooled && (conn = conn_pool_get(&msg->address)))
+		reused = true;
 
+retry:
 	start = now = time(NULL);
 	/* This connect retry logic permits Slurm hierarchical communications
 	 * to better survive slurmd restarts */
-	while ((now - start) < conn_timeout) {
+	while (!conn && ((now - start) < conn_timeout)) {
 		if ((conn = slurm_open_msg_conn(&msg->address, msg->tls_cert)))
 			break;
 		if ((errno != ECONNREFUSED) && (errno != ETIMEDOUT))
@@ -2625,9 +2923,25 @@ list_t *slurm_send_addr_recv_msgs(slurm_msg_t *msg, char *name, int timeout)
 	msg->ret_list = NULL;
 	msg->forward_struct = NULL;
 
+	if (pooled)
+		msg->flags |= SLURM_MSG_KEEP_ALIVE;
+
 	if (slurm_send_node_msg(conn, msg) >= 0)
-		ret_list = slurm_receive_msgs(conn, msg->forward.tree_depth,
-					      msg->forward.timeout);
+		ret_list = _receive_msgs(conn, msg->forward.tree_depth,
+					 msg->forward.timeout, &resp_flags);
+
+	if (!ret_list && reused &&
+	    ((errno == SLURM_PROTOCOL_SOCKET_ZERO_BYTES_SENT) ||
+	     (errno == ECONNRESET) || (errno == EPIPE))) {
+		/* slurmd closed idle connection before reading request */
+		log_flag(NET, "%s: [%pA] reused connection failed: %m, reconnecting",
+			 __func__, &msg->address);
+		conn_pool_count_retry();
+		FREE_NULL_CONN(conn);
+		reused = false;
+		first = true;
+		goto retry;
+	}
 
 	if (!ret_list) {
 		mark_as_failed_forward(&ret_list, name, errno);
@@ -2639,7 +2953,10 @@ list_t *slurm_send_addr_recv_msgs(slurm_msg_t *msg, char *name, int timeout)
 	(void) list_for_each(
 			ret_list, _foreach_ret_list_hostname_set, name);
 
-	conn_g_destroy(conn, true);
+	if (pooled && (resp_flags & SLURM_MSG_KEPT_ALIVE))
+		conn_pool_put(&msg->address, conn);
+	else
+		conn_g_destroy(conn, true);
 
 	return ret_list;
 }
@@ -212,6 +212,18 @@ extern int slurm_init_msg_engine(slurm_addr_t *slurm_address, bool permissive);
 
 extern int slurm_unpack_received_msg(slurm_msg_t *msg, int fd, buf_t *buffer);
 
+/*
+ * unpack a complete received response which may carry the responses of the
+ * nodes the request was forwarded to
+ * OUT msg - a slurm_msg struct to be filled in by the function
+ *	msg->ret_list is set with the forwarded responses (if any)
+ * IN  fd - file descriptor the message came from
+ * IN  buffer - Buf we will fill in the message with
+ * RET SLURM_SUCCESS or error
+ */
+extern int slurm_unpack_received_resp_msg(slurm_msg_t *msg, int fd,
+					  buf_t *buffer);
+
 /*
  *  Receive a slurm message on the open slurm descriptor "fd" waiting
  *    at most "timeout" seconds for the message data. If timeout is
@@ -391,10 +403,42 @@ extern int slurm_unpack_addr_array(slurm_addr_t **addr_array_ptr,
  * IN block_for_forwarding - call the forward_wait() which blocks until
  *    forwarding
  * RET SLURM_SUCCESS or error
+ *
+ * NOTE: When msg->data is already a packed buffer, the body is a shadow buffer
+ *    of it, so msg->data must not be freed before buffers->body.
  */
 extern int slurm_buffers_pack_msg(slurm_msg_t *msg, msg_bufs_t *buffers,
 				  bool block_for_forwarding);
 
+/* Message body compression counters for one message type */
+typedef struct {
+	uint16_t msg_type;
+	uint32_t compressed; /* bodies sent compressed */
+	uint32_t skipped; /* bodies over the threshold that did not shrink */
+	uint64_t raw_bytes; /* size of compressed bodies before compression */
+	uint64_t wire_bytes; /* size of compressed bodies on the wire */
+	uint64_t compress_usec; /* time spent compressing */
+	uint32_t decompressed; /* compressed bodies received */
+	uint64_t decompress_usec; /* time spent decompressing */
+} msg_compress_stats_t;
+
+/*
+ * Check if message bodies are compressed by this process, as configured by
+ * CommunicationParameters=compress_threshold=#.
+ * RET true if compress/lz4 is available and a threshold is set
+ */
+extern bool slurm_msg_compress_enabled(void);
+
+/*
+ * Get copy of message body compression counters
+ * OUT count - number of message types returned
+ * RET array of counters by message type, must be xfreed by caller
+ */
+extern msg_compress_stats_t *slurm_msg_compress_stats_get(uint32_t *count);
+
+/* Reset message body compression counters */
+extern void slurm_msg_compress_stats_reset(void);
+
 /**********************************************************************\
  * simplified communication routines
  * They open a connection do work then close the connection all within
@@ -114,5 +114,13 @@
 #define CTLD_QUEUE_PROCESSING	SLURM_BIT(5)
 #define SLURM_NO_AUTH_CRED	SLURM_BIT(6)
 #define SLURM_PACK_ADDRS	SLURM_BIT(7)
+/* Message body is compressed, see slurm_buffers_pack_msg() */
+#define SLURM_MSG_COMPRESSED	SLURM_BIT(8)
+/* Sender can decompress replies, copied into replies by slurm_resp_msg_init() */
+#define SLURM_MSG_COMPRESS_OK	SLURM_BIT(9)
+/* Sender will reuse connection if receiver keeps reading from it */
+#define SLURM_MSG_KEEP_ALIVE	SLURM_BIT(10)
+/* Receiver will read next request from connection after sending reply */
+#define SLURM_MSG_KEPT_ALIVE	SLURM_BIT(11)
 
 #endif
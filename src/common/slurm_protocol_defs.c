@@ -276,6 +276,7 @@ extern void slurm_msg_t_copy(slurm_msg_t *dest, slurm_msg_t *src)
 {
 	slurm_msg_t_init(dest);
 	dest->protocol_version = src->protocol_version;
+	dest->flags = src->flags & SLURM_MSG_KEPT_ALIVE;
 	dest->forward = src->forward;
 	dest->ret_list = src->ret_list;
 	dest->forward_struct = src->forward_struct;
@@ -2539,6 +2540,14 @@ extern void slurm_free_stats_response_msg(stats_info_response_msg_t *msg)
 	if (msg) {
 		xfree(msg->bf_exit);
 		xfree(msg->schedule_exit);
+		xfree(msg->rpc_compress_type_id);
+		xfree(msg->rpc_compress_cnt);
+		xfree(msg->rpc_compress_skipped);
+		xfree(msg->rpc_compress_raw_bytes);
+		xfree(msg->rpc_compress_wire_bytes);
+		xfree(msg->rpc_compress_time);
+		xfree(msg->rpc_decompress_cnt);
+		xfree(msg->rpc_decompress_time);
 		xfree(msg->rpc_type_id);
 		xfree(msg->rpc_type_cnt);
 		xfree(msg->rpc_type_time);
@@ -4778,6 +4787,7 @@ extern void slurm_free_file_bcast_msg(file_bcast_msg_t *msg)
 {
 	if (msg) {
 		xfree(msg->block);
+		xfree(msg->block_hash);
 		xfree(msg->fname);
 		xfree(msg->exe_fname);
 		xfree(msg->user_name);
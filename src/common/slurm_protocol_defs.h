@@ -1090,6 +1090,8 @@ typedef enum {
 	FILE_BCAST_LAST_BLOCK = 1 << 1,	/* last file block */
 	FILE_BCAST_SO = 1 << 2, 	/* shared object */
 	FILE_BCAST_EXE = 1 << 3,	/* executable ahead of shared object */
+	FILE_BCAST_CACHED = 1 << 4,	/* use block_hash from node's cache */
+	FILE_BCAST_PIPELINE = 1 << 5,	/* blocks may arrive out of order */
 } file_bcast_flags_t;
 
 typedef struct file_bcast_msg {
@@ -1109,6 +1111,7 @@ typedef struct file_bcast_msg {
 	uint64_t block_offset;	/* offset for this data block */
 	uint32_t uncomp_len;	/* uncompressed length of this data block */
 	char *block;		/* data for this block */
+	char *block_hash;	/* hex K12 hash of uncompressed block */
 	uint64_t file_size;	/* file size */
 } file_bcast_msg_t;
 
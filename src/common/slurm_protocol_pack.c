@@ -52,6 +52,7 @@
 #include "src/common/job_options.h"
 #include "src/common/log.h"
 #include "src/common/pack.h"
+#include "src/common/pack_schema.h"
 #include "src/common/part_record.h"
 #include "src/common/read_config.h"
 #include "src/common/slurm_protocol_api.h"
@@ -2752,43 +2753,56 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
-static void _pack_epilog_comp_msg(const slurm_msg_t *smsg, buf_t *buffer)
+static void _init_epilog_comp_msg(void *msg)
 {
-	epilog_complete_msg_t *msg = smsg->data;
+	epilog_complete_msg_t *epilog = msg;
 
-	if (smsg->protocol_version >= SLURM_25_11_PROTOCOL_VERSION) {
-		pack_step_id(&msg->step_id, buffer, smsg->protocol_version);
-		pack32(msg->return_code, buffer);
-		packstr(msg->node_name, buffer);
-	} else if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		pack32(msg->step_id.job_id, buffer);
-		pack32(msg->return_code, buffer);
-		packstr(msg->node_name, buffer);
-	}
+	epilog->step_id = SLURM_STEP_ID_INITIALIZER;
 }
 
-static int _unpack_epilog_comp_msg(slurm_msg_t *smsg, buf_t *buffer)
-{
-	epilog_complete_msg_t *msg = xmalloc(sizeof(*msg));
+static const pack_field_t epilog_comp_msg_fields[] = {
+	PACK_FIELD(U64, epilog_complete_msg_t, step_id.sluid),
+	PACK_FIELD(U32, epilog_complete_msg_t, step_id.job_id),
+	PACK_FIELD(U32, epilog_complete_msg_t, step_id.step_id),
+	PACK_FIELD(U32, epilog_complete_msg_t, step_id.step_het_comp),
+	PACK_FIELD(U32, epilog_complete_msg_t, return_code),
+	PACK_FIELD(STR, epilog_complete_msg_t, node_name),
+	PACK_FIELDS_END
+};
 
-	if (smsg->protocol_version >= SLURM_25_11_PROTOCOL_VERSION) {
-		safe_unpack_step_id_members(&msg->step_id, buffer,
-					    smsg->protocol_version);
-		safe_unpack32(&msg->return_code, buffer);
-		safe_unpackstr(&msg->node_name, buffer);
-	} else if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		msg->step_id = SLURM_STEP_ID_INITIALIZER;
-		safe_unpack32(&msg->step_id.job_id, buffer);
-		safe_unpack32(&msg->return_code, buffer);
-		safe_unpackstr(&msg->node_name, buffer);
-	}
+static const pack_field_t epilog_comp_msg_fields_min[] = {
+	PACK_FIELD(U32, epilog_complete_msg_t, step_id.job_id),
+	PACK_FIELD(U32, epilog_complete_msg_t, return_code),
+	PACK_FIELD(STR, epilog_complete_msg_t, node_name),
+	PACK_FIELDS_END
+};
 
-	smsg->data = msg;
-	return SLURM_SUCCESS;
+static const pack_schema_t epilog_comp_msg_schema = {
+	.size = sizeof(epilog_complete_msg_t),
+	.init = _init_epilog_comp_msg,
+	.layouts = (const pack_layout_t []) {
+		{
+			.min_version = SLURM_25_11_PROTOCOL_VERSION,
+			.fields = epilog_comp_msg_fields,
+		},
+		{
+			.min_version = SLURM_MIN_PROTOCOL_VERSION,
+			.fields = epilog_comp_msg_fields_min,
+		},
+		PACK_LAYOUTS_END
+	},
+};
 
-unpack_error:
-	slurm_free_epilog_complete_msg(msg);
-	return SLURM_ERROR;
+static void _pack_epilog_comp_msg(const slurm_msg_t *smsg, buf_t *buffer)
+{
+	pack_schema_pack(&epilog_comp_msg_schema, smsg->data,
+			 smsg->protocol_version, buffer);
+}
+
+static int _unpack_epilog_comp_msg(slurm_msg_t *smsg, buf_t *buffer)
+{
+	return pack_schema_unpack(&epilog_comp_msg_schema, &smsg->data,
+				  smsg->protocol_version, buffer);
 }
 
 static void _pack_job_step_create_response_msg(const slurm_msg_t *smsg,
@@ -8039,25 +8053,32 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static const pack_field_t return_code_msg_fields[] = {
+	PACK_FIELD(U32, return_code_msg_t, return_code),
+	PACK_FIELDS_END
+};
+
+static const pack_schema_t return_code_msg_schema = {
+	.size = sizeof(return_code_msg_t),
+	.layouts = (const pack_layout_t []) {
+		{
+			.min_version = 0,
+			.fields = return_code_msg_fields,
+		},
+		PACK_LAYOUTS_END
+	},
+};
+
 static void _pack_return_code_msg(const slurm_msg_t *smsg, buf_t *buffer)
 {
-	return_code_msg_t *msg = smsg->data;
-
-	pack32(msg->return_code, buffer);
+	pack_schema_pack(&return_code_msg_schema, smsg->data,
+			 smsg->protocol_version, buffer);
 }
 
 static int _unpack_return_code_msg(slurm_msg_t *smsg, buf_t *buffer)
 {
-	return_code_msg_t *msg = xmalloc(sizeof(*msg));
-
-	safe_unpack32(&msg->return_code, buffer);
-
-	smsg->data = msg;
-	return SLURM_SUCCESS;
-
-unpack_error:
-	slurm_free_return_code_msg(msg);
-	return SLURM_ERROR;
+	return pack_schema_unpack(&return_code_msg_schema, &smsg->data,
+				  smsg->protocol_version, buffer);
 }
 
 static void _pack_return_code2_msg(const slurm_msg_t *smsg, buf_t *buffer)
@@ -9250,43 +9271,56 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
-static void _pack_prolog_complete_msg(const slurm_msg_t *smsg, buf_t *buffer)
+static void _init_prolog_complete_msg(void *msg)
 {
-	prolog_complete_msg_t *msg = smsg->data;
+	prolog_complete_msg_t *prolog = msg;
 
-	if (smsg->protocol_version >= SLURM_25_11_PROTOCOL_VERSION) {
-		pack_step_id(&msg->step_id, buffer, smsg->protocol_version);
-		packstr(msg->node_name, buffer);
-		pack32(msg->prolog_rc, buffer);
-	} else if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		pack32(msg->step_id.job_id, buffer);
-		packstr(msg->node_name, buffer);
-		pack32(msg->prolog_rc, buffer);
-	}
+	prolog->step_id = SLURM_STEP_ID_INITIALIZER;
 }
 
-static int _unpack_prolog_complete_msg(slurm_msg_t *smsg, buf_t *buffer)
-{
-	prolog_complete_msg_t *msg = xmalloc(sizeof(*msg));
+static const pack_field_t prolog_complete_msg_fields[] = {
+	PACK_FIELD(U64, prolog_complete_msg_t, step_id.sluid),
+	PACK_FIELD(U32, prolog_complete_msg_t, step_id.job_id),
+	PACK_FIELD(U32, prolog_complete_msg_t, step_id.step_id),
+	PACK_FIELD(U32, prolog_complete_msg_t, step_id.step_het_comp),
+	PACK_FIELD(STR, prolog_complete_msg_t, node_name),
+	PACK_FIELD(U32, prolog_complete_msg_t, prolog_rc),
+	PACK_FIELDS_END
+};
 
-	if (smsg->protocol_version >= SLURM_25_11_PROTOCOL_VERSION) {
-		safe_unpack_step_id_members(&msg->step_id, buffer,
-					    smsg->protocol_version);
-		safe_unpackstr(&msg->node_name, buffer);
-		safe_unpack32(&msg->prolog_rc, buffer);
-	} else if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		msg->step_id = SLURM_STEP_ID_INITIALIZER;
-		safe_unpack32(&msg->step_id.job_id, buffer);
-		safe_unpackstr(&msg->node_name, buffer);
-		safe_unpack32(&msg->prolog_rc, buffer);
-	}
+static const pack_field_t prolog_complete_msg_fields_min[] = {
+	PACK_FIELD(U32, prolog_complete_msg_t, step_id.job_id),
+	PACK_FIELD(STR, prolog_complete_msg_t, node_name),
+	PACK_FIELD(U32, prolog_complete_msg_t, prolog_rc),
+	PACK_FIELDS_END
+};
 
-	smsg->data = msg;
-	return SLURM_SUCCESS;
+static const pack_schema_t prolog_complete_msg_schema = {
+	.size = sizeof(prolog_complete_msg_t),
+	.init = _init_prolog_complete_msg,
+	.layouts = (const pack_layout_t []) {
+		{
+			.min_version = SLURM_25_11_PROTOCOL_VERSION,
+			.fields = prolog_complete_msg_fields,
+		},
+		{
+			.min_version = SLURM_MIN_PROTOCOL_VERSION,
+			.fields = prolog_complete_msg_fields_min,
+		},
+		PACK_LAYOUTS_END
+	},
+};
 
-unpack_error:
-	slurm_free_prolog_complete_msg(msg);
-	return SLURM_ERROR;
+static void _pack_prolog_complete_msg(const slurm_msg_t *smsg, buf_t *buffer)
+{
+	pack_schema_pack(&prolog_complete_msg_schema, smsg->data,
+			 smsg->protocol_version, buffer);
+}
+
+static int _unpack_prolog_complete_msg(slurm_msg_t *smsg, buf_t *buffer)
+{
+	return pack_schema_unpack(&prolog_complete_msg_schema, &smsg->data,
+				  smsg->protocol_version, buffer);
 }
 
 static void _pack_prolog_launch_msg(const slurm_msg_t *smsg, buf_t *buffer)
@@ -11149,29 +11183,33 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static const pack_field_t job_user_msg_fields[] = {
+	PACK_FIELD(U32, job_user_id_msg_t, user_id),
+	PACK_FIELD(U16, job_user_id_msg_t, show_flags),
+	PACK_FIELDS_END
+};
+
+static const pack_schema_t job_user_msg_schema = {
+	.size = sizeof(job_user_id_msg_t),
+	.layouts = (const pack_layout_t []) {
+		{
+			.min_version = SLURM_MIN_PROTOCOL_VERSION,
+			.fields = job_user_msg_fields,
+		},
+		PACK_LAYOUTS_END
+	},
+};
+
 static void _pack_job_user_msg(const slurm_msg_t *smsg, buf_t *buffer)
 {
-	job_user_id_msg_t *msg = smsg->data;
-
-	pack32(msg->user_id, buffer);
-	pack16(msg->show_flags, buffer);
+	pack_schema_pack(&job_user_msg_schema, smsg->data,
+			 smsg->protocol_version, buffer);
 }
 
 static int _unpack_job_user_msg(slurm_msg_t *smsg, buf_t *buffer)
 {
-	job_user_id_msg_t *msg = xmalloc(sizeof(*msg));
-
-	if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		safe_unpack32(&msg->user_id, buffer);
-		safe_unpack16(&msg->show_flags, buffer);
-	}
-
-	smsg->data = msg;
-	return SLURM_SUCCESS;
-
-unpack_error:
-	slurm_free_job_user_id_msg(msg);
-	return SLURM_ERROR;
+	return pack_schema_unpack(&job_user_msg_schema, &smsg->data,
+				  smsg->protocol_version, buffer);
 }
 
 static void _pack_srun_timeout_msg(const slurm_msg_t *smsg, buf_t *buffer)
@@ -11583,39 +11621,44 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static const pack_field_t ping_slurmd_resp_fields[] = {
+	PACK_FIELD(U32, ping_slurmd_resp_msg_t, cpu_load),
+	PACK_FIELD(U64, ping_slurmd_resp_msg_t, free_mem),
+	PACK_FIELD(STR, ping_slurmd_resp_msg_t, node_name),
+	PACK_FIELDS_END
+};
+
+static const pack_field_t ping_slurmd_resp_fields_min[] = {
+	PACK_FIELD(U32, ping_slurmd_resp_msg_t, cpu_load),
+	PACK_FIELD(U64, ping_slurmd_resp_msg_t, free_mem),
+	PACK_FIELDS_END
+};
+
+static const pack_schema_t ping_slurmd_resp_schema = {
+	.size = sizeof(ping_slurmd_resp_msg_t),
+	.layouts = (const pack_layout_t []) {
+		{
+			.min_version = SLURM_26_05_PROTOCOL_VERSION,
+			.fields = ping_slurmd_resp_fields,
+		},
+		{
+			.min_version = SLURM_MIN_PROTOCOL_VERSION,
+			.fields = ping_slurmd_resp_fields_min,
+		},
+		PACK_LAYOUTS_END
+	},
+};
+
 static void _pack_ping_slurmd_resp(const slurm_msg_t *smsg, buf_t *buffer)
 {
-	ping_slurmd_resp_msg_t *msg = smsg->data;
-
-	if (smsg->protocol_version >= SLURM_26_05_PROTOCOL_VERSION) {
-		pack32(msg->cpu_load, buffer);
-		pack64(msg->free_mem, buffer);
-		packstr(msg->node_name, buffer);
-	} else if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		pack32(msg->cpu_load, buffer);
-		pack64(msg->free_mem, buffer);
-	}
+	pack_schema_pack(&ping_slurmd_resp_schema, smsg->data,
+			 smsg->protocol_version, buffer);
 }
 
 static int _unpack_ping_slurmd_resp(slurm_msg_t *smsg, buf_t *buffer)
 {
-	ping_slurmd_resp_msg_t *msg = xmalloc(sizeof(*msg));
-
-	if (smsg->protocol_version >= SLURM_26_05_PROTOCOL_VERSION) {
-		safe_unpack32(&msg->cpu_load, buffer);
-		safe_unpack64(&msg->free_mem, buffer);
-		safe_unpackstr(&msg->node_name, buffer);
-	} else if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		safe_unpack32(&msg->cpu_load, buffer);
-		safe_unpack64(&msg->free_mem, buffer);
-	}
-
-	smsg->data = msg;
-	return SLURM_SUCCESS;
-
-unpack_error:
-	slurm_free_ping_slurmd_resp(msg);
-	return SLURM_ERROR;
+	return pack_schema_unpack(&ping_slurmd_resp_schema, &smsg->data,
+				  smsg->protocol_version, buffer);
 }
 
 static void _pack_file_bcast(const slurm_msg_t *smsg, buf_t *buffer)
@@ -11624,7 +11667,29 @@ static void _pack_file_bcast(const slurm_msg_t *smsg, buf_t *buffer)
 
 	grow_buf(buffer,  msg->block_len);
 
-	if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+	if (smsg->protocol_version >= SLURM_26_11_PROTOCOL_VERSION) {
+		pack32(msg->block_no, buffer);
+		pack16(msg->compress, buffer);
+		pack16(msg->flags, buffer);
+		pack16(msg->modes, buffer);
+
+		pack32(msg->uid, buffer);
+		packstr(msg->user_name, buffer);
+		pack32(msg->gid, buffer);
+
+		pack_time(msg->atime, buffer);
+		pack_time(msg->mtime, buffer);
+
+		packstr(msg->fname, buffer);
+		packstr(msg->exe_fname, buffer);
+		pack32(msg->block_len, buffer);
+		pack32(msg->uncomp_len, buffer);
+		pack64(msg->block_offset, buffer);
+		pack64(msg->file_size, buffer);
+		packmem(msg->block, msg->block_len, buffer);
+		pack_sbcast_cred(msg->cred, buffer, smsg->protocol_version);
+		packstr(msg->block_hash, buffer);
+	} else if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		pack32(msg->block_no, buffer);
 		pack16(msg->compress, buffer);
 		pack16(msg->flags, buffer);
@@ -11653,7 +11718,35 @@ static int _unpack_file_bcast(slurm_msg_t *smsg, buf_t *buffer)
 	uint32_t uint32_tmp = 0;
 	file_bcast_msg_t *msg = xmalloc(sizeof(*msg));
 
-	if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+	if (smsg->protocol_version >= SLURM_26_11_PROTOCOL_VERSION) {
+		safe_unpack32(&msg->block_no, buffer);
+		safe_unpack16(&msg->compress, buffer);
+		safe_unpack16(&msg->flags, buffer);
+		safe_unpack16(&msg->modes, buffer);
+
+		safe_unpack32(&msg->uid, buffer);
+		safe_unpackstr(&msg->user_name, buffer);
+		safe_unpack32(&msg->gid, buffer);
+
+		safe_unpack_time(&msg->atime, buffer);
+		safe_unpack_time(&msg->mtime, buffer);
+
+		safe_unpackstr(&msg->fname, buffer);
+		safe_unpackstr(&msg->exe_fname, buffer);
+		safe_unpack32(&msg->block_len, buffer);
+		safe_unpack32(&msg->uncomp_len, buffer);
+		safe_unpack64(&msg->block_offset, buffer);
+		safe_unpack64(&msg->file_size, buffer);
+		safe_unpackmem_xmalloc(&msg->block, &uint32_tmp, buffer);
+		if (uint32_tmp != msg->block_len)
+			goto unpack_error;
+
+		msg->cred =
+			unpack_sbcast_cred(buffer, msg, smsg->protocol_version);
+		if (msg->cred == NULL)
+			goto unpack_error;
+		safe_unpackstr(&msg->block_hash, buffer);
+	} else if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		safe_unpack32(&msg->block_no, buffer);
 		safe_unpack16(&msg->compress, buffer);
 		safe_unpack16(&msg->flags, buffer);
@@ -11865,47 +11958,48 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static const pack_field_t kvs_get_fields[] = {
+	PACK_FIELD(U32, kvs_get_msg_t, task_id),
+	PACK_FIELD(U32, kvs_get_msg_t, size),
+	PACK_FIELD(U16, kvs_get_msg_t, port),
+	PACK_FIELD(STR, kvs_get_msg_t, hostname),
+	PACK_FIELD(STR, kvs_get_msg_t, tls_cert),
+	PACK_FIELDS_END
+};
+
+static const pack_field_t kvs_get_fields_min[] = {
+	PACK_FIELD(U32, kvs_get_msg_t, task_id),
+	PACK_FIELD(U32, kvs_get_msg_t, size),
+	PACK_FIELD(U16, kvs_get_msg_t, port),
+	PACK_FIELD(STR, kvs_get_msg_t, hostname),
+	PACK_FIELDS_END
+};
+
+static const pack_schema_t kvs_get_schema = {
+	.size = sizeof(kvs_get_msg_t),
+	.layouts = (const pack_layout_t []) {
+		{
+			.min_version = SLURM_25_11_PROTOCOL_VERSION,
+			.fields = kvs_get_fields,
+		},
+		{
+			.min_version = SLURM_MIN_PROTOCOL_VERSION,
+			.fields = kvs_get_fields_min,
+		},
+		PACK_LAYOUTS_END
+	},
+};
+
 static void _pack_kvs_get(const slurm_msg_t *smsg, buf_t *buffer)
 {
-	kvs_get_msg_t *msg = smsg->data;
-
-	if (smsg->protocol_version >= SLURM_25_11_PROTOCOL_VERSION) {
-		pack32(msg->task_id, buffer);
-		pack32(msg->size, buffer);
-		pack16(msg->port, buffer);
-		packstr(msg->hostname, buffer);
-		packstr(msg->tls_cert, buffer);
-	} else if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		pack32(msg->task_id, buffer);
-		pack32(msg->size, buffer);
-		pack16(msg->port, buffer);
-		packstr(msg->hostname, buffer);
-	}
+	pack_schema_pack(&kvs_get_schema, smsg->data, smsg->protocol_version,
+			 buffer);
 }
 
 static int _unpack_kvs_get(slurm_msg_t *smsg, buf_t *buffer)
 {
-	kvs_get_msg_t *msg = xmalloc(sizeof(*msg));
-
-	if (smsg->protocol_version >= SLURM_25_11_PROTOCOL_VERSION) {
-		safe_unpack32(&msg->task_id, buffer);
-		safe_unpack32(&msg->size, buffer);
-		safe_unpack16(&msg->port, buffer);
-		safe_unpackstr(&msg->hostname, buffer);
-		safe_unpackstr(&msg->tls_cert, buffer);
-	} else if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		safe_unpack32(&msg->task_id, buffer);
-		safe_unpack32(&msg->size, buffer);
-		safe_unpack16(&msg->port, buffer);
-		safe_unpackstr(&msg->hostname, buffer);
-	}
-
-	smsg->data = msg;
-	return SLURM_SUCCESS;
-
-unpack_error:
-	slurm_free_get_kvs_msg(msg);
-	return SLURM_ERROR;
+	return pack_schema_unpack(&kvs_get_schema, &smsg->data,
+				  smsg->protocol_version, buffer);
 }
 
 extern void
@@ -11969,63 +12063,46 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static const pack_field_t slurmd_status_fields[] = {
+	PACK_FIELD(TIME, slurmd_status_t, booted),
+	PACK_FIELD(TIME, slurmd_status_t, last_slurmctld_msg),
+	PACK_FIELD(U16, slurmd_status_t, slurmd_debug),
+	PACK_FIELD(U16, slurmd_status_t, actual_cpus),
+	PACK_FIELD(U16, slurmd_status_t, actual_boards),
+	PACK_FIELD(U16, slurmd_status_t, actual_sockets),
+	PACK_FIELD(U16, slurmd_status_t, actual_cores),
+	PACK_FIELD(U16, slurmd_status_t, actual_threads),
+	PACK_FIELD(U64, slurmd_status_t, actual_real_mem),
+	PACK_FIELD(U32, slurmd_status_t, actual_tmp_disk),
+	PACK_FIELD(U32, slurmd_status_t, pid),
+	PACK_FIELD(STR, slurmd_status_t, hostname),
+	PACK_FIELD(STR, slurmd_status_t, slurmd_logfile),
+	PACK_FIELD(STR, slurmd_status_t, step_list),
+	PACK_FIELD(STR, slurmd_status_t, version),
+	PACK_FIELDS_END
+};
+
+static const pack_schema_t slurmd_status_schema = {
+	.size = sizeof(slurmd_status_t),
+	.layouts = (const pack_layout_t []) {
+		{
+			.min_version = SLURM_MIN_PROTOCOL_VERSION,
+			.fields = slurmd_status_fields,
+		},
+		PACK_LAYOUTS_END
+	},
+};
+
 static void _pack_slurmd_status(const slurm_msg_t *smsg, buf_t *buffer)
 {
-	slurmd_status_t *msg = smsg->data;
-
-	if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		pack_time(msg->booted, buffer);
-		pack_time(msg->last_slurmctld_msg, buffer);
-
-		pack16(msg->slurmd_debug, buffer);
-		pack16(msg->actual_cpus, buffer);
-		pack16(msg->actual_boards, buffer);
-		pack16(msg->actual_sockets, buffer);
-		pack16(msg->actual_cores, buffer);
-		pack16(msg->actual_threads, buffer);
-
-		pack64(msg->actual_real_mem, buffer);
-		pack32(msg->actual_tmp_disk, buffer);
-		pack32(msg->pid, buffer);
-
-		packstr(msg->hostname, buffer);
-		packstr(msg->slurmd_logfile, buffer);
-		packstr(msg->step_list, buffer);
-		packstr(msg->version, buffer);
-	}
+	pack_schema_pack(&slurmd_status_schema, smsg->data,
+			 smsg->protocol_version, buffer);
 }
 
 static int _unpack_slurmd_status(slurm_msg_t *smsg, buf_t *buffer)
 {
-	slurmd_status_t *msg = xmalloc(sizeof(*msg));
-
-	if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		safe_unpack_time(&msg->booted, buffer);
-		safe_unpack_time(&msg->last_slurmctld_msg, buffer);
-
-		safe_unpack16(&msg->slurmd_debug, buffer);
-		safe_unpack16(&msg->actual_cpus, buffer);
-		safe_unpack16(&msg->actual_boards, buffer);
-		safe_unpack16(&msg->actual_sockets, buffer);
-		safe_unpack16(&msg->actual_cores, buffer);
-		safe_unpack16(&msg->actual_threads, buffer);
-
-		safe_unpack64(&msg->actual_real_mem, buffer);
-		safe_unpack32(&msg->actual_tmp_disk, buffer);
-		safe_unpack32(&msg->pid, buffer);
-
-		safe_unpackstr(&msg->hostname, buffer);
-		safe_unpackstr(&msg->slurmd_logfile, buffer);
-		safe_unpackstr(&msg->step_list, buffer);
-		safe_unpackstr(&msg->version, buffer);
-	}
-
-	smsg->data = msg;
-	return SLURM_SUCCESS;
-
-unpack_error:
-	slurm_free_slurmd_status(msg);
-	return SLURM_ERROR;
+	return pack_schema_unpack(&slurmd_status_schema, &smsg->data,
+				  smsg->protocol_version, buffer);
 }
 
 static void _pack_job_notify(const slurm_msg_t *smsg, buf_t *buffer)
@@ -12471,6 +12548,62 @@ static int _unpack_stats_response_msg(slurm_msg_t *smsg, buf_t *buffer)
 		safe_unpack32(&msg->bf_backfilled_het_jobs, buffer);
 		safe_unpack32_array(&msg->bf_exit, &msg->bf_exit_cnt, buffer);
 
+		if (smsg->protocol_version >= SLURM_26_11_PROTOCOL_VERSION) {
+			safe_unpack64(&msg->assoc_mgr_assoc_lookups, buffer);
+			safe_unpack64(&msg->assoc_mgr_qos_lookups, buffer);
+			safe_unpack64(&msg->assoc_mgr_user_lookups, buffer);
+			safe_unpack64(&msg->assoc_mgr_wckey_lookups, buffer);
+
+			safe_unpack32(&msg->rpc_compress_size, buffer);
+			safe_unpack16_array(&msg->rpc_compress_type_id,
+					    &uint32_tmp, buffer);
+			if (uint32_tmp != msg->rpc_compress_size)
+				goto unpack_error;
+			safe_unpack32_array(&msg->rpc_compress_cnt, &uint32_tmp,
+					    buffer);
+			if (uint32_tmp != msg->rpc_compress_size)
+				goto unpack_error;
+			safe_unpack32_array(&msg->rpc_compress_skipped,
+					    &uint32_tmp, buffer);
+			if (uint32_tmp != msg->rpc_compress_size)
+				goto unpack_error;
+			safe_unpack64_array(&msg->rpc_compress_raw_bytes,
+					    &uint32_tmp, buffer);
+			if (uint32_tmp != msg->rpc_compress_size)
+				goto unpack_error;
+			safe_unpack64_array(&msg->rpc_compress_wire_bytes,
+					    &uint32_tmp, buffer);
+			if (uint32_tmp != msg->rpc_compress_size)
+				goto unpack_error;
+			safe_unpack64_array(&msg->rpc_compress_time,
+					    &uint32_tmp, buffer);
+			if (uint32_tmp != msg->rpc_compress_size)
+				goto unpack_error;
+			safe_unpack32_array(&msg->rpc_decompress_cnt,
+					    &uint32_tmp, buffer);
+			if (uint32_tmp != msg->rpc_compress_size)
+				goto unpack_error;
+			safe_unpack64_array(&msg->rpc_decompress_time,
+					    &uint32_tmp, buffer);
+			if (uint32_tmp != msg->rpc_compress_size)
+				goto unpack_error;
+
+			safe_unpack64(&msg->conn_pool_connects, buffer);
+			safe_unpack64(&msg->conn_pool_reused, buffer);
+			safe_unpack64(&msg->conn_pool_stale, buffer);
+			safe_unpack64(&msg->conn_pool_expired, buffer);
+			safe_unpack64(&msg->conn_pool_retries, buffer);
+
+			safe_unpack64(&msg->auth_cache_hits, buffer);
+			safe_unpack64(&msg->auth_cache_misses, buffer);
+			safe_unpack64(&msg->auth_cache_evictions, buffer);
+
+			safe_unpack64(&msg->buf_allocs, buffer);
+			safe_unpack64(&msg->buf_reused, buffer);
+			safe_unpack64(&msg->buf_grown_in_place, buffer);
+			safe_unpack64(&msg->buf_reallocs, buffer);
+		}
+
 		safe_unpack32(&msg->rpc_type_size, buffer);
 		safe_unpack16_array(&msg->rpc_type_id, &uint32_tmp, buffer);
 		safe_unpack32_array(&msg->rpc_type_cnt, &uint32_tmp, buffer);
@@ -12904,31 +13037,33 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static const pack_field_t control_status_msg_fields[] = {
+	PACK_FIELD(U16, control_status_msg_t, backup_inx),
+	PACK_FIELD(TIME, control_status_msg_t, control_time),
+	PACK_FIELDS_END
+};
+
+static const pack_schema_t control_status_msg_schema = {
+	.size = sizeof(control_status_msg_t),
+	.layouts = (const pack_layout_t []) {
+		{
+			.min_version = SLURM_MIN_PROTOCOL_VERSION,
+			.fields = control_status_msg_fields,
+		},
+		PACK_LAYOUTS_END
+	},
+};
+
 static void _pack_control_status_msg(const slurm_msg_t *smsg, buf_t *buffer)
 {
-	control_status_msg_t *msg = smsg->data;
-
-	if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		pack16(msg->backup_inx, buffer);
-		pack_time(msg->control_time, buffer);
-	}
+	pack_schema_pack(&control_status_msg_schema, smsg->data,
+			 smsg->protocol_version, buffer);
 }
 
 static int _unpack_control_status_msg(slurm_msg_t *smsg, buf_t *buffer)
 {
-	control_status_msg_t *msg = xmalloc(sizeof(*msg));
-
-	if (smsg->protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		safe_unpack16(&msg->backup_inx, buffer);
-		safe_unpack_time(&msg->control_time, buffer);
-	}
-
-	smsg->data = msg;
-	return SLURM_SUCCESS;
-
-unpack_error:
-	slurm_free_control_status_msg(msg);
-	return SLURM_ERROR;
+	return pack_schema_unpack(&control_status_msg_schema, &smsg->data,
+				  smsg->protocol_version, buffer);
 }
 
 static void _pack_bb_status_req_msg(const slurm_msg_t *smsg, buf_t *buffer)
@@ -13509,8 +13644,7 @@ unpack_error:
  *			automatically updated
  * RET 0 or error code
  */
-int
-pack_msg(slurm_msg_t *msg, buf_t *buffer)
+static int _set_pack_protocol_version(slurm_msg_t *msg)
 {
 	if (msg->protocol_version < SLURM_MIN_PROTOCOL_VERSION) {
 		error("%s: Invalid message version=%hu, type:%s",
@@ -13533,6 +13667,48 @@ pack_msg(slurm_msg_t *msg, buf_t *buffer)
 		msg->protocol_version = SLURM_PROTOCOL_VERSION;
 	}
 
+	return SLURM_SUCCESS;
+}
+
+extern buf_t *pack_msg_shadow_body(slurm_msg_t *msg)
+{
+	buf_t *msg_buffer = msg->data;
+	buf_t *body;
+
+	switch (msg->msg_type) {
+	case RESPONSE_ASSOC_MGR_INFO:
+	case RESPONSE_BURST_BUFFER_INFO:
+	case RESPONSE_JOB_INFO:
+	case RESPONSE_JOB_STEP_INFO:
+	case RESPONSE_LICENSE_INFO:
+	case RESPONSE_NODE_INFO:
+	case RESPONSE_PARTITION_INFO:
+	case RESPONSE_RESERVATION_INFO:
+	case RESPONSE_STATS_INFO:
+	case RESPONSE_RESOURCE_LAYOUT:
+		break;
+	default:
+		return NULL;
+	}
+
+	if (!msg_buffer || _set_pack_protocol_version(msg))
+		return NULL;
+
+	/* Same bytes _pack_buf_msg() would have copied */
+	if (!(body = create_shadow_buf(msg_buffer->head,
+				       msg_buffer->processed)))
+		return NULL;
+	set_buf_offset(body, msg_buffer->processed);
+
+	return body;
+}
+
+int
+pack_msg(slurm_msg_t *msg, buf_t *buffer)
+{
+	if (_set_pack_protocol_version(msg))
+		return SLURM_ERROR;
+
 	switch (msg->msg_type) {
 	case RESPONSE_ASSOC_MGR_INFO:
 	case RESPONSE_BURST_BUFFER_INFO:
@@ -84,6 +84,16 @@ extern int unpack_header(header_t *header, buf_t *buffer);
  */
 extern int pack_msg(slurm_msg_t *msg, buf_t *buffer);
 
+/*
+ * Get the body of a message whose data is an already packed buffer (e.g.
+ * RESPONSE_JOB_INFO) without copying it.
+ * IN msg - message to get the body of
+ * RET shadow buffer of msg->data with the offset at the end of the data, or
+ *	NULL if the body must be packed with pack_msg(). Must be freed with
+ *	FREE_NULL_BUFFER() before msg->data is.
+ */
+extern buf_t *pack_msg_shadow_body(slurm_msg_t *msg);
+
 /*
  * unpacks a generic slurm protocol message body
  * OUT msg - the body structure to unpack (note: includes message type)
@@ -947,6 +947,24 @@ extern void slurmdb_destroy_job_rec(void *object)
 	}
 }
 
+extern void slurmdb_destroy_job_columns(void *object)
+{
+	slurmdb_job_columns_t *columns = object;
+
+	if (columns) {
+		xfree(columns->cluster);
+		for (int i = 0; i < SLURMDB_JOB_COL_CNT; i++) {
+			xfree(columns->num[i]);
+			if (!columns->str[i])
+				continue;
+			for (uint32_t j = 0; j < columns->rec_cnt; j++)
+				xfree(columns->str[i][j]);
+			xfree(columns->str[i]);
+		}
+		xfree(columns);
+	}
+}
+
 extern void slurmdb_free_qos_rec_members(slurmdb_qos_rec_t *qos)
 {
 	if (qos) {
@@ -2108,6 +2126,239 @@ extern uint32_t str_2_job_flags(char *flags)
 	return job_flags;
 }
 
+#define T(col, str, is_str) { col, str, is_str }
+static const struct {
+	slurmdb_job_col_t col;
+	char *str;
+	bool is_str;
+} slurmdb_job_col_map[] = {
+	T(SLURMDB_JOB_COL_ACCOUNT, "account", true),
+	T(SLURMDB_JOB_COL_ADMIN_COMMENT, "admin_comment", true),
+	T(SLURMDB_JOB_COL_ALLOC_NODES, "alloc_nodes", false),
+	T(SLURMDB_JOB_COL_ARRAY_JOB_ID, "array_job_id", false),
+	T(SLURMDB_JOB_COL_ARRAY_MAX_TASKS, "array_max_tasks", false),
+	T(SLURMDB_JOB_COL_ARRAY_TASK_ID, "array_task_id", false),
+	T(SLURMDB_JOB_COL_ARRAY_TASK_STR, "array_task_str", true),
+	T(SLURMDB_JOB_COL_ASSOCID, "associd", false),
+	T(SLURMDB_JOB_COL_CONSTRAINTS, "constraints", true),
+	T(SLURMDB_JOB_COL_CONTAINER, "container", true),
+	T(SLURMDB_JOB_COL_DB_INDEX, "db_index", false),
+	T(SLURMDB_JOB_COL_DERIVED_EC, "derived_ec", false),
+	T(SLURMDB_JOB_COL_DERIVED_ES, "derived_es", true),
+	T(SLURMDB_JOB_COL_ELAPSED, "elapsed", false),
+	T(SLURMDB_JOB_COL_ELIGIBLE, "eligible", false),
+	T(SLURMDB_JOB_COL_END, "end", false),
+	T(SLURMDB_JOB_COL_EXITCODE, "exitcode", false),
+	T(SLURMDB_JOB_COL_EXTRA, "extra", true),
+	T(SLURMDB_JOB_COL_FAILED_NODE, "failed_node", true),
+	T(SLURMDB_JOB_COL_FLAGS, "flags", false),
+	T(SLURMDB_JOB_COL_GID, "gid", false),
+	T(SLURMDB_JOB_COL_HET_JOB_ID, "het_job_id", false),
+	T(SLURMDB_JOB_COL_HET_JOB_OFFSET, "het_job_offset", false),
+	T(SLURMDB_JOB_COL_JOBID, "jobid", false),
+	T(SLURMDB_JOB_COL_JOBNAME, "jobname", true),
+	T(SLURMDB_JOB_COL_LICENSES, "licenses", true),
+	T(SLURMDB_JOB_COL_MCS_LABEL, "mcs_label", true),
+	T(SLURMDB_JOB_COL_NODES, "nodes", true),
+	T(SLURMDB_JOB_COL_PARTITION, "partition", true),
+	T(SLURMDB_JOB_COL_PRIORITY, "priority", false),
+	T(SLURMDB_JOB_COL_QOSID, "qosid", false),
+	T(SLURMDB_JOB_COL_REQ_CPUS, "req_cpus", false),
+	T(SLURMDB_JOB_COL_REQ_MEM, "req_mem", false),
+	T(SLURMDB_JOB_COL_REQUID, "requid", false),
+	T(SLURMDB_JOB_COL_RESTART_CNT, "restart_cnt", false),
+	T(SLURMDB_JOB_COL_RESVID, "resvid", false),
+	T(SLURMDB_JOB_COL_SLUID, "sluid", false),
+	T(SLURMDB_JOB_COL_START, "start", false),
+	T(SLURMDB_JOB_COL_STATE, "state", false),
+	T(SLURMDB_JOB_COL_STATE_REASON_PREV, "state_reason_prev", false),
+	T(SLURMDB_JOB_COL_SUBMIT, "submit", false),
+	T(SLURMDB_JOB_COL_SUBMIT_LINE, "submit_line", true),
+	T(SLURMDB_JOB_COL_SUSPENDED, "suspended", false),
+	T(SLURMDB_JOB_COL_SYSTEM_COMMENT, "system_comment", true),
+	T(SLURMDB_JOB_COL_TIMELIMIT, "timelimit", false),
+	T(SLURMDB_JOB_COL_TRES_ALLOC, "tres_alloc", true),
+	T(SLURMDB_JOB_COL_TRES_REQ, "tres_req", true),
+	T(SLURMDB_JOB_COL_UID, "uid", false),
+	T(SLURMDB_JOB_COL_USER, "user", true),
+	T(SLURMDB_JOB_COL_WCKEY, "wckey", true),
+	T(SLURMDB_JOB_COL_WCKEYID, "wckeyid", false),
+	T(SLURMDB_JOB_COL_WORK_DIR, "work_dir", true),
+};
+#undef T
+
+extern const char *slurmdb_job_col_2_str(slurmdb_job_col_t col)
+{
+	for (int i = 0; i < ARRAY_SIZE(slurmdb_job_col_map); i++)
+		if (slurmdb_job_col_map[i].col == col)
+			return slurmdb_job_col_map[i].str;
+
+	return NULL;
+}
+
+extern slurmdb_job_col_t str_2_slurmdb_job_col(const char *str)
+{
+	for (int i = 0; i < ARRAY_SIZE(slurmdb_job_col_map); i++)
+		if (!xstrcasecmp(slurmdb_job_col_map[i].str, str))
+			return slurmdb_job_col_map[i].col;
+
+	return SLURMDB_JOB_COL_CNT;
+}
+
+extern bool slurmdb_job_col_is_str(slurmdb_job_col_t col)
+{
+	for (int i = 0; i < ARRAY_SIZE(slurmdb_job_col_map); i++)
+		if (slurmdb_job_col_map[i].col == col)
+			return slurmdb_job_col_map[i].is_str;
+
+	return false;
+}
+
+extern slurmdb_job_columns_t *slurmdb_create_job_columns(char *cluster,
+							 bool *cols,
+							 uint32_t rec_cnt)
+{
+	slurmdb_job_columns_t *columns = xmalloc(sizeof(*columns));
+
+	columns->cluster = xstrdup(cluster);
+	for (int i = 0; i < SLURMDB_JOB_COL_CNT; i++) {
+		if (!cols[i])
+			continue;
+		if (slurmdb_job_col_is_str(i))
+			columns->str[i] = xcalloc(rec_cnt, sizeof(char *));
+		else
+			columns->num[i] = xcalloc(rec_cnt, sizeof(uint64_t));
+	}
+
+	return columns;
+}
+
+extern void slurmdb_job_columns_2_rec(slurmdb_job_columns_t *columns,
+				      uint32_t row, slurmdb_job_rec_t *job)
+{
+	uint64_t **num = columns->num;
+	char ***str = columns->str;
+
+	xassert(row < columns->rec_cnt);
+
+	job->cluster = xstrdup(columns->cluster);
+	job->show_full = 1;
+
+	if (str[SLURMDB_JOB_COL_ACCOUNT])
+		job->account = xstrdup(str[SLURMDB_JOB_COL_ACCOUNT][row]);
+	if (str[SLURMDB_JOB_COL_ADMIN_COMMENT])
+		job->admin_comment =
+			xstrdup(str[SLURMDB_JOB_COL_ADMIN_COMMENT][row]);
+	if (num[SLURMDB_JOB_COL_ALLOC_NODES])
+		job->alloc_nodes = num[SLURMDB_JOB_COL_ALLOC_NODES][row];
+	if (num[SLURMDB_JOB_COL_ARRAY_JOB_ID])
+		job->array_job_id = num[SLURMDB_JOB_COL_ARRAY_JOB_ID][row];
+	if (num[SLURMDB_JOB_COL_ARRAY_MAX_TASKS])
+		job->array_max_tasks =
+			num[SLURMDB_JOB_COL_ARRAY_MAX_TASKS][row];
+	if (num[SLURMDB_JOB_COL_ARRAY_TASK_ID])
+		job->array_task_id = num[SLURMDB_JOB_COL_ARRAY_TASK_ID][row];
+	if (str[SLURMDB_JOB_COL_ARRAY_TASK_STR])
+		job->array_task_str =
+			xstrdup(str[SLURMDB_JOB_COL_ARRAY_TASK_STR][row]);
+	if (num[SLURMDB_JOB_COL_ASSOCID])
+		job->associd = num[SLURMDB_JOB_COL_ASSOCID][row];
+	if (str[SLURMDB_JOB_COL_CONSTRAINTS])
+		job->constraints =
+			xstrdup(str[SLURMDB_JOB_COL_CONSTRAINTS][row]);
+	if (str[SLURMDB_JOB_COL_CONTAINER])
+		job->container = xstrdup(str[SLURMDB_JOB_COL_CONTAINER][row]);
+	if (num[SLURMDB_JOB_COL_DB_INDEX])
+		job->db_index = num[SLURMDB_JOB_COL_DB_INDEX][row];
+	if (num[SLURMDB_JOB_COL_DERIVED_EC])
+		job->derived_ec = num[SLURMDB_JOB_COL_DERIVED_EC][row];
+	if (str[SLURMDB_JOB_COL_DERIVED_ES])
+		job->derived_es = xstrdup(str[SLURMDB_JOB_COL_DERIVED_ES][row]);
+	if (num[SLURMDB_JOB_COL_ELAPSED])
+		job->elapsed = num[SLURMDB_JOB_COL_ELAPSED][row];
+	if (num[SLURMDB_JOB_COL_ELIGIBLE])
+		job->eligible = num[SLURMDB_JOB_COL_ELIGIBLE][row];
+	if (num[SLURMDB_JOB_COL_END])
+		job->end = num[SLURMDB_JOB_COL_END][row];
+	if (num[SLURMDB_JOB_COL_EXITCODE])
+		job->exitcode = num[SLURMDB_JOB_COL_EXITCODE][row];
+	if (str[SLURMDB_JOB_COL_EXTRA])
+		job->extra = xstrdup(str[SLURMDB_JOB_COL_EXTRA][row]);
+	if (str[SLURMDB_JOB_COL_FAILED_NODE])
+		job->failed_node =
+			xstrdup(str[SLURMDB_JOB_COL_FAILED_NODE][row]);
+	if (num[SLURMDB_JOB_COL_FLAGS])
+		job->flags = num[SLURMDB_JOB_COL_FLAGS][row];
+	if (num[SLURMDB_JOB_COL_GID])
+		job->gid = num[SLURMDB_JOB_COL_GID][row];
+	if (num[SLURMDB_JOB_COL_HET_JOB_ID])
+		job->het_job_id = num[SLURMDB_JOB_COL_HET_JOB_ID][row];
+	if (num[SLURMDB_JOB_COL_HET_JOB_OFFSET])
+		job->het_job_offset = num[SLURMDB_JOB_COL_HET_JOB_OFFSET][row];
+	if (num[SLURMDB_JOB_COL_JOBID])
+		job->jobid = num[SLURMDB_JOB_COL_JOBID][row];
+	if (str[SLURMDB_JOB_COL_JOBNAME])
+		job->jobname = xstrdup(str[SLURMDB_JOB_COL_JOBNAME][row]);
+	if (str[SLURMDB_JOB_COL_LICENSES])
+		job->licenses = xstrdup(str[SLURMDB_JOB_COL_LICENSES][row]);
+	if (str[SLURMDB_JOB_COL_MCS_LABEL])
+		job->mcs_label = xstrdup(str[SLURMDB_JOB_COL_MCS_LABEL][row]);
+	if (str[SLURMDB_JOB_COL_NODES])
+		job->nodes = xstrdup(str[SLURMDB_JOB_COL_NODES][row]);
+	if (str[SLURMDB_JOB_COL_PARTITION])
+		job->partition = xstrdup(str[SLURMDB_JOB_COL_PARTITION][row]);
+	if (num[SLURMDB_JOB_COL_PRIORITY])
+		job->priority = num[SLURMDB_JOB_COL_PRIORITY][row];
+	if (num[SLURMDB_JOB_COL_QOSID])
+		job->qosid = num[SLURMDB_JOB_COL_QOSID][row];
+	if (num[SLURMDB_JOB_COL_REQ_CPUS])
+		job->req_cpus = num[SLURMDB_JOB_COL_REQ_CPUS][row];
+	if (num[SLURMDB_JOB_COL_REQ_MEM])
+		job->req_mem = num[SLURMDB_JOB_COL_REQ_MEM][row];
+	if (num[SLURMDB_JOB_COL_REQUID])
+		job->requid = num[SLURMDB_JOB_COL_REQUID][row];
+	if (num[SLURMDB_JOB_COL_RESTART_CNT])
+		job->restart_cnt = num[SLURMDB_JOB_COL_RESTART_CNT][row];
+	if (num[SLURMDB_JOB_COL_RESVID])
+		job->resvid = num[SLURMDB_JOB_COL_RESVID][row];
+	if (num[SLURMDB_JOB_COL_SLUID])
+		job->sluid = num[SLURMDB_JOB_COL_SLUID][row];
+	if (num[SLURMDB_JOB_COL_START])
+		job->start = num[SLURMDB_JOB_COL_START][row];
+	if (num[SLURMDB_JOB_COL_STATE])
+		job->state = num[SLURMDB_JOB_COL_STATE][row];
+	if (num[SLURMDB_JOB_COL_STATE_REASON_PREV])
+		job->state_reason_prev =
+			num[SLURMDB_JOB_COL_STATE_REASON_PREV][row];
+	if (num[SLURMDB_JOB_COL_SUBMIT])
+		job->submit = num[SLURMDB_JOB_COL_SUBMIT][row];
+	if (str[SLURMDB_JOB_COL_SUBMIT_LINE])
+		job->submit_line =
+			xstrdup(str[SLURMDB_JOB_COL_SUBMIT_LINE][row]);
+	if (num[SLURMDB_JOB_COL_SUSPENDED])
+		job->suspended = num[SLURMDB_JOB_COL_SUSPENDED][row];
+	if (str[SLURMDB_JOB_COL_SYSTEM_COMMENT])
+		job->system_comment =
+			xstrdup(str[SLURMDB_JOB_COL_SYSTEM_COMMENT][row]);
+	if (num[SLURMDB_JOB_COL_TIMELIMIT])
+		job->timelimit = num[SLURMDB_JOB_COL_TIMELIMIT][row];
+	if (str[SLURMDB_JOB_COL_TRES_ALLOC])
+		job->tres_alloc_str =
+			xstrdup(str[SLURMDB_JOB_COL_TRES_ALLOC][row]);
+	if (str[SLURMDB_JOB_COL_TRES_REQ])
+		job->tres_req_str = xstrdup(str[SLURMDB_JOB_COL_TRES_REQ][row]);
+	if (num[SLURMDB_JOB_COL_UID])
+		job->uid = num[SLURMDB_JOB_COL_UID][row];
+	if (str[SLURMDB_JOB_COL_USER])
+		job->user = xstrdup(str[SLURMDB_JOB_COL_USER][row]);
+	if (str[SLURMDB_JOB_COL_WCKEY])
+		job->wckey = xstrdup(str[SLURMDB_JOB_COL_WCKEY][row]);
+	if (num[SLURMDB_JOB_COL_WCKEYID])
+		job->wckeyid = num[SLURMDB_JOB_COL_WCKEYID][row];
+	if (str[SLURMDB_JOB_COL_WORK_DIR])
+		job->work_dir = xstrdup(str[SLURMDB_JOB_COL_WORK_DIR][row]);
+}
+
 extern char *slurmdb_qos_flags_str(slurmdb_qos_flags_t flags)
 {
 	char *qos_flags = NULL, *at = NULL;
@@ -130,6 +130,19 @@ typedef enum {
 
 extern slurmdb_job_rec_t *slurmdb_create_job_rec(void);
 extern slurmdb_step_rec_t *slurmdb_create_step_rec(void);
+/*
+ * Allocate a columnar job record holder for rec_cnt records.
+ * IN cols - array of SLURMDB_JOB_COL_CNT, true for each column to allocate
+ */
+extern slurmdb_job_columns_t *slurmdb_create_job_columns(char *cluster,
+							 bool *cols,
+							 uint32_t rec_cnt);
+/*
+ * Fill in job (from slurmdb_create_job_rec()) with the values of the
+ * requested columns of the given row, strings are duplicated.
+ */
+extern void slurmdb_job_columns_2_rec(slurmdb_job_columns_t *columns,
+				      uint32_t row, slurmdb_job_rec_t *job);
 extern slurmdb_assoc_usage_t *slurmdb_create_assoc_usage(int tres_cnt);
 extern slurmdb_qos_usage_t *slurmdb_create_qos_usage(int tres_cnt);
 
@@ -160,6 +173,10 @@ extern char *slurmdb_federation_flags_str(uint32_t flags);
 extern uint32_t str_2_federation_flags(char *flags, int option);
 extern char *slurmdb_job_flags_str(uint32_t flags);
 extern uint32_t str_2_job_flags(char *flags);
+extern const char *slurmdb_job_col_2_str(slurmdb_job_col_t col);
+/* RET SLURMDB_JOB_COL_CNT if str is not a known column */
+extern slurmdb_job_col_t str_2_slurmdb_job_col(const char *str);
+extern bool slurmdb_job_col_is_str(slurmdb_job_col_t col);
 extern char *slurmdb_qos_str(list_t *qos_list, uint32_t level);
 extern uint32_t str_2_slurmdb_qos(list_t *qos_list, char *level);
 extern char *slurmdb_qos_flags_str(slurmdb_qos_flags_t flags);
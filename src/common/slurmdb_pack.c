@@ -3794,6 +3794,107 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/*
+ * Only the columns present are packed, each one tagged with its name so
+ * either side can know columns the other does not.
+ */
+extern void slurmdb_pack_job_columns(void *object, uint16_t protocol_version,
+				     buf_t *buffer)
+{
+	slurmdb_job_columns_t *columns = object;
+	uint32_t col_cnt = 0;
+
+	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+		packstr(columns->cluster, buffer);
+		pack32(columns->rec_cnt, buffer);
+
+		for (int i = 0; i < SLURMDB_JOB_COL_CNT; i++)
+			if (columns->num[i] || columns->str[i])
+				col_cnt++;
+		pack32(col_cnt, buffer);
+
+		for (int i = 0; i < SLURMDB_JOB_COL_CNT; i++) {
+			if (columns->str[i]) {
+				packstr((char *) slurmdb_job_col_2_str(i),
+					buffer);
+				packbool(true, buffer);
+				packstr_array(columns->str[i],
+					      columns->rec_cnt, buffer);
+			} else if (columns->num[i]) {
+				packstr((char *) slurmdb_job_col_2_str(i),
+					buffer);
+				packbool(false, buffer);
+				pack64_array(columns->num[i],
+					     columns->rec_cnt, buffer);
+			}
+		}
+	}
+}
+
+extern int slurmdb_unpack_job_columns(void **object, uint16_t protocol_version,
+				      buf_t *buffer)
+{
+	slurmdb_job_columns_t *columns = xmalloc(sizeof(*columns));
+	uint32_t col_cnt = 0, cnt = 0;
+	char *name = NULL;
+	char **str_array = NULL;
+	uint64_t *num_array = NULL;
+	bool is_str;
+
+	*object = columns;
+
+	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+		safe_unpackstr(&columns->cluster, buffer);
+		safe_unpack32(&columns->rec_cnt, buffer);
+		safe_unpack32(&col_cnt, buffer);
+
+		for (uint32_t i = 0; i < col_cnt; i++) {
+			slurmdb_job_col_t col;
+
+			safe_unpackstr(&name, buffer);
+			safe_unpackbool(&is_str, buffer);
+			if (is_str)
+				safe_unpackstr_array(&str_array, &cnt, buffer);
+			else
+				safe_unpack64_array(&num_array, &cnt, buffer);
+
+			if (cnt != columns->rec_cnt)
+				goto unpack_error;
+
+			col = str_2_slurmdb_job_col(name);
+			if ((col == SLURMDB_JOB_COL_CNT) ||
+			    (is_str != slurmdb_job_col_is_str(col)) ||
+			    columns->str[col] || columns->num[col]) {
+				debug2("%s: skipping unknown column %s",
+				       __func__, name);
+				xfree_array(str_array);
+				xfree(num_array);
+			} else if (is_str) {
+				columns->str[col] = str_array;
+				str_array = NULL;
+			} else {
+				columns->num[col] = num_array;
+				num_array = NULL;
+			}
+			xfree(name);
+		}
+	} else {
+		error("%s: protocol_version %hu not supported",
+		      __func__, protocol_version);
+		goto unpack_error;
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	xfree(name);
+	xfree_array(str_array);
+	xfree(num_array);
+	slurmdb_destroy_job_columns(columns);
+	*object = NULL;
+	return SLURM_ERROR;
+}
+
 extern void slurmdb_pack_qos_cond(void *in, uint16_t protocol_version,
 				  buf_t *buffer)
 {
@@ -233,6 +233,14 @@ extern slurmdbd_msg_type_t str_2_slurmdbd_msg_type(char *msg_type)
 		return DBD_GOT_CONFIG_KEYPAIRS;
 	} else if (!xstrcasecmp(msg_type, "Got Config Response")) {
 		return DBD_GOT_CONFIG;
+	} else if (!xstrcasecmp(msg_type, "Get Jobs Columns")) {
+		return DBD_GET_JOBS_COLUMNS;
+	} else if (!xstrcasecmp(msg_type, "Got Jobs Columns")) {
+		return DBD_GOT_JOBS_COLUMNS;
+	} else if (!xstrcasecmp(msg_type, "Get Jobs Stream")) {
+		return DBD_GET_JOBS_STREAM;
+	} else if (!xstrcasecmp(msg_type, "Got Jobs Chunk")) {
+		return DBD_GOT_JOBS_CHUNK;
 	} else if (!xstrcasecmp(msg_type, "Send Multiple Job Starts")) {
 		return DBD_SEND_MULT_JOB_START;
 	} else if (!xstrcasecmp(msg_type, "Got Multiple Job Starts")) {
@@ -853,6 +861,30 @@ extern char *slurmdbd_msg_type_2_str(slurmdbd_msg_type_t msg_type, int get_enum)
 		} else
 			return "Got Config Response";
 		break;
+	case DBD_GET_JOBS_COLUMNS:
+		if (get_enum) {
+			return "DBD_GET_JOBS_COLUMNS";
+		} else
+			return "Get Jobs Columns";
+		break;
+	case DBD_GOT_JOBS_COLUMNS:
+		if (get_enum) {
+			return "DBD_GOT_JOBS_COLUMNS";
+		} else
+			return "Got Jobs Columns";
+		break;
+	case DBD_GET_JOBS_STREAM:
+		if (get_enum) {
+			return "DBD_GET_JOBS_STREAM";
+		} else
+			return "Get Jobs Stream";
+		break;
+	case DBD_GOT_JOBS_CHUNK:
+		if (get_enum) {
+			return "DBD_GOT_JOBS_CHUNK";
+		} else
+			return "Got Jobs Chunk";
+		break;
 	case SLURM_PERSIST_INIT:
 		if (get_enum) {
 			return "SLURM_PERSIST_INIT";
@@ -895,6 +927,7 @@ extern void slurmdbd_free_conf(slurmdbd_conf_t *conf)
 	xfree(conf->serializer_plugins);
 	xfree(conf->storage_loc);
 	xfree(conf->storage_pass_script);
+	xfree(conf->storage_replica_host);
 	xfree(conf->storage_user);
 	xfree(conf);
 }
@@ -941,6 +974,8 @@ extern void slurmdbd_free_msg(persist_msg_t *msg)
 	case DBD_GOT_FEDERATIONS:
 	case DBD_GOT_INSTANCES:
 	case DBD_GOT_JOBS:
+	case DBD_GOT_JOBS_CHUNK:
+	case DBD_GOT_JOBS_COLUMNS:
 	case DBD_GOT_LIST:
 	case DBD_GOT_PROBS:
 	case DBD_GOT_RES:
@@ -981,6 +1016,8 @@ extern void slurmdbd_free_msg(persist_msg_t *msg)
 	case DBD_GET_FEDERATIONS:
 	case DBD_GET_INSTANCES:
 	case DBD_GET_JOBS_COND:
+	case DBD_GET_JOBS_COLUMNS:
+	case DBD_GET_JOBS_STREAM:
 	case DBD_GET_PROBS:
 	case DBD_GET_QOS:
 	case DBD_GET_RESVS:
@@ -1122,6 +1159,8 @@ extern void slurmdbd_free_cond_msg(dbd_cond_msg_t *msg,
 			my_destroy = slurmdb_destroy_federation_cond;
 			break;
 		case DBD_GET_JOBS_COND:
+		case DBD_GET_JOBS_COLUMNS:
+		case DBD_GET_JOBS_STREAM:
 			my_destroy = slurmdb_destroy_job_cond;
 			break;
 		case DBD_GET_QOS:
@@ -169,6 +169,13 @@ typedef enum {
 	DBD_GET_ASSOC_NG_USAGE, /* Get non-grouped assoc usage
 				 * (this is used for sreport user topuser) */
 	DBD_GOT_CONFIG, /* Response to DBD_GET_CONFIG */
+	DBD_GET_JOBS_COLUMNS, /* Get a projection of job information with a
+			       * condition */
+	DBD_GOT_JOBS_COLUMNS, /* Response to DBD_GET_JOBS_COLUMNS */
+	DBD_GET_JOBS_STREAM, /* Get job information with a condition, sent
+			      * back in several messages */
+	DBD_GOT_JOBS_CHUNK, /* Part of the response to DBD_GET_JOBS_STREAM,
+			     * the last part is sent as DBD_GOT_JOBS */
 	SLURM_DBD_MESSAGES_END = 2000, /* So that we don't overlap with any
 					* slurm_msg_type_t numbers. */
 	SLURM_PERSIST_INIT = 6500, /* So we don't use the
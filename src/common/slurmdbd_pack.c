@@ -250,6 +250,8 @@ static void _pack_cond_msg(dbd_cond_msg_t *msg, uint16_t rpc_version,
 		my_function = slurmdb_pack_federation_cond;
 		break;
 	case DBD_GET_JOBS_COND:
+	case DBD_GET_JOBS_COLUMNS:
+	case DBD_GET_JOBS_STREAM:
 		my_function = slurmdb_pack_job_cond;
 		break;
 	case DBD_GET_QOS:
@@ -319,6 +321,8 @@ static int _unpack_cond_msg(dbd_cond_msg_t **msg, uint16_t rpc_version,
 		my_function = slurmdb_unpack_federation_cond;
 		break;
 	case DBD_GET_JOBS_COND:
+	case DBD_GET_JOBS_COLUMNS:
+	case DBD_GET_JOBS_STREAM:
 		my_function = slurmdb_unpack_job_cond;
 		break;
 	case DBD_GET_QOS:
@@ -1402,6 +1406,8 @@ static void _pack_slurmdbd_conf(const persist_msg_t *pmsg,
 		packstr("", buffer);
 		/* never send storage_pass_script */
 		packstr("", buffer);
+		packstr(msg->storage_replica_host, buffer);
+		pack32(msg->storage_replica_max_lag, buffer);
 		/* never send storage_user */
 		packstr("", buffer);
 		pack16(msg->syslog_debug, buffer);
@@ -1481,6 +1487,8 @@ static int _unpack_slurmdbd_conf(persist_msg_t *pmsg,
 		safe_unpackstr(&build_ptr->serializer_plugins, buffer);
 		safe_unpackstr(&build_ptr->storage_loc, buffer);
 		safe_unpackstr(&build_ptr->storage_pass_script, buffer);
+		safe_unpackstr(&build_ptr->storage_replica_host, buffer);
+		safe_unpack32(&build_ptr->storage_replica_max_lag, buffer);
 		safe_unpackstr(&build_ptr->storage_user, buffer);
 		safe_unpack16(&build_ptr->syslog_debug, buffer);
 		safe_unpack16(&build_ptr->track_wckey, buffer);
@@ -1562,9 +1570,13 @@ extern void slurmdbd_pack_list_msg(dbd_list_msg_t *msg, uint16_t rpc_version,
 		my_function = pack_config_key_pair;
 		break;
 	case DBD_GOT_JOBS:
+	case DBD_GOT_JOBS_CHUNK:
 	case DBD_FIX_RUNAWAY_JOB:
 		my_function = slurmdb_pack_job_rec;
 		break;
+	case DBD_GOT_JOBS_COLUMNS:
+		my_function = slurmdb_pack_job_columns;
+		break;
 	case DBD_GOT_LIST:
 		my_function = packstr_func;
 		break;
@@ -1662,10 +1674,15 @@ extern int slurmdbd_unpack_list_msg(dbd_list_msg_t **msg, uint16_t rpc_version,
 		my_destroy = destroy_config_key_pair;
 		break;
 	case DBD_GOT_JOBS:
+	case DBD_GOT_JOBS_CHUNK:
 	case DBD_FIX_RUNAWAY_JOB:
 		my_function = slurmdb_unpack_job_rec;
 		my_destroy = slurmdb_destroy_job_rec;
 		break;
+	case DBD_GOT_JOBS_COLUMNS:
+		my_function = slurmdb_unpack_job_columns;
+		my_destroy = slurmdb_destroy_job_columns;
+		break;
 	case DBD_GOT_LIST:
 		my_function = safe_unpackstr_func;
 		my_destroy = xfree_ptr;
@@ -1779,6 +1796,8 @@ extern buf_t *pack_slurmdbd_msg(persist_msg_t *req, uint16_t rpc_version)
 	case DBD_GOT_EVENTS:
 	case DBD_GOT_FEDERATIONS:
 	case DBD_GOT_JOBS:
+	case DBD_GOT_JOBS_CHUNK:
+	case DBD_GOT_JOBS_COLUMNS:
 	case DBD_GOT_LIST:
 	case DBD_GOT_PROBS:
 	case DBD_GOT_RES:
@@ -1825,6 +1844,8 @@ extern buf_t *pack_slurmdbd_msg(persist_msg_t *req, uint16_t rpc_version)
 	case DBD_GET_FEDERATIONS:
 	case DBD_GET_INSTANCES:
 	case DBD_GET_JOBS_COND:
+	case DBD_GET_JOBS_COLUMNS:
+	case DBD_GET_JOBS_STREAM:
 	case DBD_GET_PROBS:
 	case DBD_GET_QOS:
 	case DBD_GET_RESVS:
@@ -1990,6 +2011,8 @@ extern int unpack_slurmdbd_msg(persist_msg_t *resp, uint16_t rpc_version,
 	case DBD_GOT_FEDERATIONS:
 	case DBD_GOT_INSTANCES:
 	case DBD_GOT_JOBS:
+	case DBD_GOT_JOBS_CHUNK:
+	case DBD_GOT_JOBS_COLUMNS:
 	case DBD_GOT_LIST:
 	case DBD_GOT_PROBS:
 	case DBD_ADD_QOS:
@@ -2037,6 +2060,8 @@ extern int unpack_slurmdbd_msg(persist_msg_t *resp, uint16_t rpc_version,
 	case DBD_GET_FEDERATIONS:
 	case DBD_GET_INSTANCES:
 	case DBD_GET_JOBS_COND:
+	case DBD_GET_JOBS_COLUMNS:
+	case DBD_GET_JOBS_STREAM:
 	case DBD_GET_PROBS:
 	case DBD_GET_QOS:
 	case DBD_GET_RESVS:
@@ -41,13 +41,16 @@
 #define _GNU_SOURCE
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <grp.h>
 #include <inttypes.h>
 #include <netdb.h>
 #include <regex.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -124,7 +127,11 @@ _handle_stray_socket(const char *socket_name)
 				      __func__, socket_name);
 			}
 		} else {
+			char *stat_path = xstrdup_printf("%s.stat",
+							 socket_name);
 			debug("Cleaned up stray socket %s", socket_name);
+			(void) unlink(stat_path);
+			xfree(stat_path);
 		}
 	}
 }
@@ -884,6 +891,11 @@ stepd_cleanup_sockets(const char *directory, const char *nodename)
 				rc = SLURM_ERROR;
 			}
 			xfree(path);
+
+			path = stepd_stat_shm_path(directory, nodename,
+						   &step_id);
+			(void) unlink(path);
+			xfree(path);
 		}
 	}
 
@@ -1431,6 +1443,113 @@ rwfail:
 	return rc;
 }
 
+extern char *stepd_stat_shm_path(const char *directory, const char *nodename,
+				 slurm_step_id_t *step_id)
+{
+	char *path = NULL;
+
+	xstrfmtcat(path, "%s/%s_%u.%u", directory, nodename, step_id->job_id,
+		   step_id->step_id);
+	if (step_id->step_het_comp != NO_VAL)
+		xstrfmtcat(path, ".%u", step_id->step_het_comp);
+	xstrcat(path, ".stat");
+
+	return path;
+}
+
+extern int stepd_stat_shm_read(const char *directory, const char *nodename,
+			       slurm_step_id_t *step_id,
+			       job_step_stat_t *resp)
+{
+	stepd_stat_shm_t *shm = MAP_FAILED;
+	struct stat stat_buf;
+	char *path, *data = NULL;
+	uint32_t len = 0, num_tasks = 0;
+	uint16_t protocol_version = 0;
+	buf_t *buffer = NULL;
+	int fd, rc = SLURM_ERROR;
+
+	path = stepd_stat_shm_path(directory, nodename, step_id);
+	if ((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+		debug3("%s: open(%s): %m", __func__, path);
+		goto done;
+	}
+
+	/* Never map past the end of the file, that would be a SIGBUS */
+	if (fstat(fd, &stat_buf) || (stat_buf.st_size < STEPD_STAT_SHM_SIZE)) {
+		debug("%s: %s is not a stat snapshot", __func__, path);
+		fd_close(&fd);
+		goto done;
+	}
+
+	shm = mmap(NULL, STEPD_STAT_SHM_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+	fd_close(&fd);
+	if (shm == MAP_FAILED) {
+		error("%s: mmap(%s): %m", __func__, path);
+		goto done;
+	}
+
+	if (shm->magic != STEPD_STAT_SHM_MAGIC) {
+		debug("%s: %s is not a stat snapshot", __func__, path);
+		goto done;
+	}
+
+	data = xmalloc(STEPD_STAT_SHM_SIZE);
+	for (int retry = 0; retry < 100; retry++) {
+		uint32_t seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+
+		/* Nothing published yet */
+		if (!seq)
+			goto done;
+		/* Writer in progress */
+		if (seq & 1) {
+			sched_yield();
+			continue;
+		}
+
+		len = shm->len;
+		num_tasks = shm->num_tasks;
+		protocol_version = shm->protocol_version;
+		if (len > (STEPD_STAT_SHM_SIZE - sizeof(*shm)))
+			len = 0;
+		memcpy(data, shm->data, len);
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&shm->seq, __ATOMIC_RELAXED) == seq) {
+			rc = SLURM_SUCCESS;
+			break;
+		}
+	}
+
+	if (rc != SLURM_SUCCESS) {
+		debug("%s: %s kept changing while being read", __func__, path);
+		goto done;
+	}
+
+	if ((protocol_version < SLURM_MIN_PROTOCOL_VERSION) || !len) {
+		rc = SLURM_ERROR;
+		goto done;
+	}
+
+	buffer = create_buf(data, len);
+	data = NULL;
+	if (jobacctinfo_unpack(&resp->jobacct, protocol_version,
+			       PROTOCOL_TYPE_SLURM, buffer, true)) {
+		error("%s: unable to unpack %s", __func__, path);
+		rc = SLURM_ERROR;
+		goto done;
+	}
+	resp->num_tasks = num_tasks;
+
+done:
+	if (shm != MAP_FAILED)
+		munmap(shm, STEPD_STAT_SHM_SIZE);
+	FREE_NULL_BUFFER(buffer);
+	xfree(data);
+	xfree(path);
+	return rc;
+}
+
 extern int stepd_job_usage(int fd, uint16_t protocol_version,
 			   jobacctinfo_t **jobacct)
 {
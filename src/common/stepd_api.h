@@ -320,6 +320,41 @@ int stepd_completion(int fd, uint16_t protocol_version,
 int stepd_stat_jobacct(int fd, uint16_t protocol_version,
 		       slurm_step_id_t *sent, job_step_stat_t *resp);
 
+/*
+ * Layout of the accounting snapshot a slurmstepd publishes next to its
+ * socket when JobAcctGatherParams=StatSnapshot is set. The writer makes seq
+ * odd while it updates the snapshot and even again when done, so readers
+ * retry until they see the same even value before and after their copy.
+ */
+#define STEPD_STAT_SHM_MAGIC 0x53544154 /* "STAT" */
+#define STEPD_STAT_SHM_SIZE (64 * 1024)
+
+typedef struct {
+	uint32_t magic;
+	uint16_t protocol_version; /* version data[] was packed with */
+	uint32_t seq;
+	uint32_t num_tasks;
+	uint32_t len; /* bytes used in data[] */
+	time_t update_time;
+	char data[]; /* packed jobacctinfo_t */
+} stepd_stat_shm_t;
+
+/*
+ * Return the path of the accounting snapshot of a step. Must xfree().
+ */
+extern char *stepd_stat_shm_path(const char *directory, const char *nodename,
+				 slurm_step_id_t *step_id);
+
+/*
+ * Read the accounting snapshot of a step without contacting the slurmstepd.
+ *
+ * Returns SLURM_SUCCESS and fills resp->jobacct and resp->num_tasks like
+ * stepd_stat_jobacct(), or SLURM_ERROR if no snapshot has been published.
+ */
+extern int stepd_stat_shm_read(const char *directory, const char *nodename,
+			       slurm_step_id_t *step_id,
+			       job_step_stat_t *resp);
+
 /*
  * Get job-level accounting data.
  *
@@ -41,17 +41,22 @@
 #include <stdio.h>
 #include <errno.h>
 #include <string.h>
+#include <sys/uio.h>
 
 #include "src/common/write_labelled_message.h"
 #include "slurm/slurm_errno.h"
 #include "src/common/log.h"
+#include "src/common/macros.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
 static char *_build_label(int task_id, int task_id_width,
 			  uint32_t het_job_offset,
 			  uint32_t het_job_task_offset);
-static int _write_line(int fd, char *prefix, char *suffix, void *buf, int len);
+static int _write_lines(int fd, struct iovec *iov, int cnt);
+
+/* Most labelled lines gathered into one write */
+#define MAX_LINES_PER_WRITE 128
 
 /*
  * fd             is the file descriptor to write to
@@ -77,42 +82,50 @@ extern int write_labelled_message(int fd, void *buf, int len, int task_id,
 				  uint32_t het_job_task_offset,
 				  bool label, int task_id_width)
 {
+	struct iovec iov[MAX_LINES_PER_WRITE * 3];
 	void *start, *end;
-	char *prefix = NULL, *suffix = NULL;
+	char *prefix = NULL;
 	int remaining = len;
-	int written = 0;
-	int line_len;
+	int written = 0, gathered = 0;
+	int line_len, prefix_len = 0;
+	int cnt = 0;
 	int rc = -1;
 
 	if (label) {
 		prefix = _build_label(task_id, task_id_width, het_job_offset,
 				      het_job_task_offset);
+		prefix_len = strlen(prefix);
 	}
 
 	while (remaining > 0) {
-		start = buf + written;
+		start = buf + written + gathered;
 		end = memchr(start, '\n', remaining);
-		if (end == NULL) { /* no newline found */
-			if (label)
-				suffix = "\n";
-			rc = _write_line(fd, prefix, suffix, start, remaining);
-			if (rc <= 0) {
-				goto done;
-			} else {
-				remaining -= rc;
-				written += rc;
-			}
-		} else {
+		if (end == NULL) /* no newline found */
+			line_len = remaining;
+		else
 			line_len = (int)(end - start) + 1;
-			rc = _write_line(fd, prefix, suffix, start, line_len);
-			if (rc <= 0) {
-				goto done;
-			} else {
-				remaining -= rc;
-				written += rc;
-			}
+
+		if (prefix) {
+			iov[cnt].iov_base = prefix;
+			iov[cnt++].iov_len = prefix_len;
+		}
+		iov[cnt].iov_base = start;
+		iov[cnt++].iov_len = line_len;
+		if (!end && label) {
+			iov[cnt].iov_base = "\n";
+			iov[cnt++].iov_len = 1;
 		}
+		gathered += line_len;
+		remaining -= line_len;
 
+		if (remaining && ((cnt + 3) <= (int) ARRAY_SIZE(iov)))
+			continue;
+
+		if ((rc = _write_lines(fd, iov, cnt)) < 0)
+			goto done;
+		written += gathered;
+		gathered = 0;
+		cnt = 0;
 	}
 done:
 	xfree(prefix);
@@ -149,49 +162,38 @@ static char *_build_label(int task_id, int task_id_width,
 /*
  * Blocks until write is complete, regardless of the file descriptor being in
  * non-blocking mode.
- * I/O from multiple hetjob components may be present, so add prefix/suffix to
- * buffer before issuing write to avoid interleaved output from multiple
- * components.
+ * I/O from multiple hetjob components may be present, so each line is written
+ * along with its prefix/suffix in the same writev() to avoid interleaved
+ * output from multiple components. Lines are gathered so a message full of
+ * short lines does not cost one write per line.
  */
-static int _write_line(int fd, char *prefix, char *suffix, void *buf, int len)
+static int _write_lines(int fd, struct iovec *iov, int cnt)
 {
-	int left, n, pre = 0, post = 0;
-	void *ptr, *tmp = NULL;
-
-	if (prefix || suffix) {
-		if (prefix)
-			pre = strlen(prefix);
-		if (suffix)
-			post = strlen(suffix);
-		tmp = xmalloc(pre + len + post);
-		if (prefix)
-			memcpy(tmp, prefix, pre);
-		memcpy(tmp + pre, buf, len);
-		if (suffix)
-			memcpy(tmp + pre + len, suffix, post);
-		ptr = tmp;
-		left = pre + len + post;
-	} else {
-		ptr = buf;
-		left = len;
-	}
+	ssize_t n;
 
-	while (left > 0) {
+	while (cnt > 0) {
 	again:
-		if ((n = write(fd, ptr, left)) < 0) {
+		if ((n = writev(fd, iov, cnt)) < 0) {
 			if (errno == EINTR)
 				goto again;
 			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
-				debug3("  got EAGAIN in _write_line");
+				debug3("  got EAGAIN in _write_lines");
 				goto again;
 			}
-			len = -1;
-			break;
+			return -1;
+		}
+
+		/* Skip what was written, possibly part of an entry */
+		while ((cnt > 0) && ((size_t) n >= iov->iov_len)) {
+			n -= iov->iov_len;
+			iov++;
+			cnt--;
+		}
+		if (cnt > 0) {
+			iov->iov_base += n;
+			iov->iov_len -= n;
 		}
-		left -= n;
-		ptr += n;
 	}
-	xfree(tmp);
 
-	return len;
+	return SLURM_SUCCESS;
 }
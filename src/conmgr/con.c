@@ -120,6 +120,7 @@ static const struct {
 	T(FLAG_WAIT_ON_EXTRACT),
 	T(FLAG_IS_TLS_SHUTTING_DOWN),
 	T(FLAG_INITIATE_TLS_SHUTDOWN),
+	T(FLAG_RPC_RECV_RESPONSE),
 };
 #undef T
 
@@ -941,6 +942,7 @@ extern void wrap_on_connection(conmgr_callback_args_t conmgr_args, void *arg)
 		error("%s: [%s] closing connection due to NULL return from on_connection",
 		      __func__, con->name);
 		slurm_mutex_lock(&mgr.mutex);
+		con->new_arg = NULL;
 		con_set_status_code(con, SLURM_COMMUNICATIONS_REJECTED);
 		close_con(true, con);
 		slurm_mutex_unlock(&mgr.mutex);
@@ -949,6 +951,8 @@ extern void wrap_on_connection(conmgr_callback_args_t conmgr_args, void *arg)
 
 	slurm_mutex_lock(&mgr.mutex);
 	con->arg = arg;
+	/* ownership of new_arg was handed to on_connection() */
+	con->new_arg = NULL;
 
 	EVENT_SIGNAL(&mgr.watch_sleep);
 	slurm_mutex_unlock(&mgr.mutex);
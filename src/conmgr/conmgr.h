@@ -271,6 +271,20 @@ typedef struct {
 	 */
 	int (*on_connect_timeout)(conmgr_callback_args_t conmgr_args,
 				  void *arg);
+
+	/*
+	 * Call back when connection ended before on_connection() was called
+	 * such as when connect() was refused or timed out.
+	 * Called once per connection instead of on_finish().
+	 *
+	 * IN conmgr_args - Args relaying conmgr callback state
+	 *	conmgr_args.status_code will be set to reason for failure
+	 * IN arg - arg ptr handed to fd processing functions
+	 * 	Ownership of arg pointer returned to caller as it will not be
+	 * 	used anymore.
+	 */
+	void (*on_connect_failed)(conmgr_callback_args_t conmgr_args,
+				  void *arg);
 } conmgr_events_t;
 
 typedef enum {
@@ -425,6 +439,13 @@ typedef enum {
 	 * Receive and forward incoming messages to their intended destinations.
 	 */
 	CON_FLAG_RPC_RECV_FORWARD = SLURM_BIT(23),
+	/*
+	 * Incoming messages are responses to RPCs sent over the connection.
+	 * msg->ret_list will be populated with the responses of the nodes the
+	 * RPC was forwarded to (if any).
+	 * Mutually exclusive with CON_FLAG_RPC_RECV_FORWARD.
+	 */
+	CON_FLAG_RPC_RECV_RESPONSE = SLURM_BIT(27),
 } conmgr_con_flags_t;
 
 /*
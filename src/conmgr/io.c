@@ -547,6 +547,38 @@ static int _append_output(conmgr_fd_t *con, buf_t *buf)
 	return SLURM_SUCCESS;
 }
 
+extern int queue_write_bufs(conmgr_fd_t *con, buf_t **bufs, const int count)
+{
+	xassert(con->magic == MAGIC_CON_MGR_FD);
+
+	slurm_mutex_lock(&mgr.mutex);
+	for (int i = 0; i < count; i++) {
+		buf_t *buf = bufs[i];
+
+		if (!buf)
+			continue;
+
+		xassert(buf->magic == BUF_MAGIC);
+		xassert(!buf->shadow);
+		bufs[i] = NULL;
+
+		/* Ignore empty write requests */
+		if (!get_buf_offset(buf)) {
+			FREE_NULL_BUFFER(buf);
+			continue;
+		}
+
+		/* Packed bytes become the pending output */
+		buf->size = get_buf_offset(buf);
+		set_buf_offset(buf, 0);
+
+		(void) _append_output(con, buf);
+	}
+	slurm_mutex_unlock(&mgr.mutex);
+
+	return SLURM_SUCCESS;
+}
+
 static int _write_data(conmgr_fd_t *con, const void *buffer, const size_t bytes)
 {
 	int rc = EINVAL;
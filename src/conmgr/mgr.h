@@ -148,6 +148,8 @@ typedef enum {
 	FLAG_IS_TLS_SHUTTING_DOWN = SLURM_BIT(25),
 	/* True if TLS shutdown is ready to start */
 	FLAG_INITIATE_TLS_SHUTDOWN = SLURM_BIT(26),
+	/* @see CON_FLAG_RPC_RECV_RESPONSE */
+	FLAG_RPC_RECV_RESPONSE = CON_FLAG_RPC_RECV_RESPONSE,
 } con_flags_t;
 
 /* Mask over flags that track connection state */
@@ -194,7 +196,10 @@ struct conmgr_fd_s {
 	/* input and output may be a different fd to inet mode */
 	int input_fd;
 	int output_fd;
-	/* arg handed to on_connection() or on_connect_timeout() */
+	/*
+	 * arg handed to on_connection(), on_connect_timeout() or
+	 * on_connect_failed()
+	 */
 	void *new_arg;
 	/* arg returned from on_connection */
 	void *arg;
@@ -482,6 +487,17 @@ extern void con_set_status_code(conmgr_fd_t *con, slurm_err_t status_code);
 extern void con_set_polling(conmgr_fd_t *con, pollctl_fd_type_t type,
 			    const char *caller);
 
+/*
+ * Queue packed buffers as output in order without copying them
+ * WARNING: caller must not hold mgr.mutex lock
+ * IN con - connection to queue outgoing buffers
+ * IN bufs - array of packed buffers (NULL entries are skipped). Takes
+ *	ownership of every buffer and sets its entry to NULL.
+ * IN count - number of entries in bufs
+ * RET SLURM_SUCCESS or error
+ */
+extern int queue_write_bufs(conmgr_fd_t *con, buf_t **bufs, const int count);
+
 /*
  * Write out list of buf_t to output_fd
  */
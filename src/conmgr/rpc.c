@@ -52,6 +52,12 @@
 #include "src/conmgr/mgr.h"
 #include "src/conmgr/tls.h"
 
+/*
+ * Bodies up to this size are copied next to the header when queued instead of
+ * keeping their (larger) packing buffer allocated until written.
+ */
+#define RPC_COPY_BODY_BYTES 4096
+
 static int _try_parse_rpc(conmgr_fd_t *con, slurm_msg_t **msg_ptr)
 {
 	int rc = SLURM_ERROR;
@@ -126,6 +132,12 @@ static int _try_parse_rpc(conmgr_fd_t *con, slurm_msg_t **msg_ptr)
 			log_flag(NET, "%s: [%s] slurm_unpack_msg_and_forward() failed: %s",
 			 __func__, con->name, slurm_strerror(rc));
 		}
+	} else if (con_flag(con, FLAG_RPC_RECV_RESPONSE)) {
+		if ((rc = slurm_unpack_received_resp_msg(msg, con->input_fd,
+							 rpc))) {
+			log_flag(NET, "%s: [%s] slurm_unpack_received_resp_msg() failed: %s",
+			 __func__, con->name, slurm_strerror(rc));
+		}
 	} else {
 		if ((rc = slurm_unpack_received_msg(msg, con->input_fd, rpc))) {
 			log_flag(NET, "%s: [%s] slurm_unpack_received_msg() failed: %s",
@@ -244,7 +256,9 @@ extern int write_msg(conmgr_fd_t *con, slurm_msg_t *msg)
 {
 	int rc;
 	msg_bufs_t buffers = {0};
-	uint32_t msglen = 0;
+	buf_t *bufs[2] = { NULL, NULL };
+	uint32_t msglen = 0, copied = 0;
+	bool copy_body;
 
 	xassert(con->magic == MAGIC_CON_MGR_FD);
 
@@ -273,32 +287,40 @@ extern int write_msg(conmgr_fd_t *con, slurm_msg_t *msg)
 		goto cleanup;
 	}
 
-	/* switch to network order */
-	msglen = htonl(msglen);
-
-	//TODO: handing over the buffers would be better than copying
-
-	if ((rc = conmgr_queue_write_data(con, &msglen, sizeof(msglen))))
-		goto cleanup;
+	/*
+	 * Hand large bodies over to the connection instead of copying them.
+	 * Shadow bodies point at msg->data, which the caller still owns.
+	 */
+	copy_body = (buffers.body->shadow ||
+		     (get_buf_offset(buffers.body) <= RPC_COPY_BODY_BYTES));
+
+	bufs[0] = init_buf(sizeof(msglen) + msglen -
+			   (copy_body ? 0 : get_buf_offset(buffers.body)));
+	pack32(msglen, bufs[0]);
+	packmem_array(get_buf_data(buffers.header),
+		      get_buf_offset(buffers.header), bufs[0]);
+	if (buffers.auth)
+		packmem_array(get_buf_data(buffers.auth),
+			      get_buf_offset(buffers.auth), bufs[0]);
 
-	if ((rc = conmgr_queue_write_data(con, get_buf_data(buffers.header),
-					  get_buf_offset(buffers.header))))
-		goto cleanup;
+	if (copy_body) {
+		packmem_array(get_buf_data(buffers.body),
+			      get_buf_offset(buffers.body), bufs[0]);
+	} else {
+		bufs[1] = buffers.body;
+		buffers.body = NULL;
+	}
 
-	if (buffers.auth &&
-	    (rc = conmgr_queue_write_data(con, get_buf_data(buffers.auth),
-					  get_buf_offset(buffers.auth))))
-		goto cleanup;
+	copied = get_buf_offset(bufs[0]);
 
-	rc = conmgr_queue_write_data(con, get_buf_data(buffers.body),
-				     get_buf_offset(buffers.body));
+	rc = queue_write_bufs(con, bufs, ARRAY_SIZE(bufs));
 cleanup:
 	if (!rc) {
 		log_flag(PROTOCOL, "%s: [%s] sending RPC %s",
 			 __func__, con->name, rpc_num2string(msg->msg_type));
-		log_flag(NET, "%s: [%s] sending RPC %s packed into %u bytes",
+		log_flag(NET, "%s: [%s] sending RPC %s packed into %u bytes with %u bytes copied",
 			 __func__, con->name, rpc_num2string(msg->msg_type),
-			 ntohl(msglen));
+			 msglen, copied);
 	} else {
 		log_flag(NET, "%s: [%s] error packing RPC %s: %s",
 			 __func__, con->name, rpc_num2string(msg->msg_type),
@@ -164,6 +164,22 @@ static void _on_finish_wrapper(conmgr_callback_args_t conmgr_args, void *arg)
 	slurm_mutex_unlock(&mgr.mutex);
 }
 
+static void _on_connect_failed_wrapper(conmgr_callback_args_t conmgr_args,
+				       void *arg)
+{
+	conmgr_fd_t *con = conmgr_args.con;
+
+	xassert(!con_flag(con, FLAG_IS_LISTEN));
+
+	con->events->on_connect_failed(conmgr_args, arg);
+
+	slurm_mutex_lock(&mgr.mutex);
+	con_unset_flag(con, FLAG_WAIT_ON_FINISH);
+	/* on_connect_failed must free arg */
+	con->new_arg = NULL;
+	slurm_mutex_unlock(&mgr.mutex);
+}
+
 static void _on_listener_finish_wrapper(conmgr_callback_args_t conmgr_args,
 					void *arg)
 {
@@ -1255,6 +1271,19 @@ static int _handle_connection(conmgr_fd_t *con, handle_connection_args_t *args)
 		return 0;
 	}
 
+	if (con->new_arg && con->events->on_connect_failed &&
+	    !con_flag(con, FLAG_IS_LISTEN)) {
+		log_flag(CONMGR, "%s: [%s] queuing up on_connect_failed()",
+			 __func__, con->name);
+
+		con_set_flag(con, FLAG_WAIT_ON_FINISH);
+
+		/* notify caller that on_connection() will never be called */
+		add_work_con_fifo(true, con, _on_connect_failed_wrapper,
+				  con->new_arg);
+		return 0;
+	}
+
 	if (!list_is_empty(con->work) || !list_is_empty(con->write_complete_work)) {
 		log_flag(CONMGR, "%s: [%s] outstanding work for connection output_fd=%d work=%u write_complete_work=%u",
 			 __func__, con->name, con->output_fd,
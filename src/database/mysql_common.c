@@ -297,6 +297,19 @@ static MYSQL_RES *_get_last_result(MYSQL *db_conn)
 	return last_result;
 }
 
+/*
+ * Remember this connection wrote something so that reads on it are not sent
+ * to a replica which may not have the change yet.
+ * NOTE: Ensure that mysql_conn->lock is set on function entry
+ */
+static void _note_write(mysql_conn_t *mysql_conn)
+{
+	if (mysql_conn->flags & DB_CONN_FLAG_ROLLBACK)
+		mysql_conn->writes_pending = true;
+	else
+		mysql_conn->last_write = time(NULL);
+}
+
 /* NOTE: Ensure that mysql_conn->lock is set on function entry */
 static int _mysql_query_internal(MYSQL *db_conn, char *query)
 {
@@ -1005,6 +1018,7 @@ extern mysql_conn_t *create_mysql_conn(int conn_num, bool rollback,
 extern int destroy_mysql_conn(mysql_conn_t *mysql_conn)
 {
 	if (mysql_conn) {
+		destroy_mysql_conn(mysql_conn->replica);
 		mysql_db_close_db_connection(mysql_conn);
 		xfree(mysql_conn->pre_commit_query);
 		xfree(mysql_conn->cluster_name);
@@ -1098,6 +1112,29 @@ extern mysql_db_info_t *create_mysql_db_info(slurm_mysql_plugin_type_t type)
 	return db_info;
 }
 
+extern mysql_db_info_t *create_mysql_replica_db_info(
+	slurm_mysql_plugin_type_t type, const char *replica)
+{
+	mysql_db_info_t *db_info = create_mysql_db_info(type);
+	char *host = xstrdup(replica), *port;
+
+	xfree(db_info->host);
+	xfree(db_info->backup);
+	db_info->host_scheme = HOST_SCHEME_ADDR;
+	db_info->backup_scheme = HOST_SCHEME_ADDR;
+
+	/* A single ':' can only be a port, IPv6 addresses have more */
+	if (xstrncasecmp(UNIX_PREFIX, host, UNIX_PREFIX_BYTES) &&
+	    (port = strchr(host, ':')) && !strchr(port + 1, ':')) {
+		*port++ = '\0';
+		db_info->port = parse_int("StorageReplicaHost", port, true);
+	}
+	_parse_storage_host(host, &db_info->host, &db_info->host_scheme);
+	xfree(host);
+
+	return db_info;
+}
+
 extern int destroy_mysql_db_info(mysql_db_info_t *db_info)
 {
 	if (db_info) {
@@ -1252,6 +1289,7 @@ extern int mysql_db_query(mysql_conn_t *mysql_conn, char *query)
 		fatal("You haven't inited this storage yet.");
 		return 0; /* For CLANG false positive */
 	}
+	_note_write(mysql_conn);
 	rc = _mysql_query_internal(mysql_conn->db_conn, query);
 	slurm_mutex_unlock(&mysql_conn->lock);
 	return rc;
@@ -1275,6 +1313,7 @@ extern int mysql_db_delete_affected_rows(mysql_conn_t *mysql_conn, char *query)
 		fatal("You haven't inited this storage yet.");
 		return 0; /* For CLANG false positive */
 	}
+	_note_write(mysql_conn);
 	if (!(rc = _mysql_query_internal(mysql_conn->db_conn, query)))
 		rc = mysql_affected_rows(mysql_conn->db_conn);
 	slurm_mutex_unlock(&mysql_conn->lock);
@@ -1320,6 +1359,9 @@ extern int mysql_db_commit(mysql_conn_t *mysql_conn)
 		      mysql_error(mysql_conn->db_conn));
 		errno = mysql_errno(mysql_conn->db_conn);
 		rc = SLURM_ERROR;
+	} else if (mysql_conn->writes_pending) {
+		mysql_conn->writes_pending = false;
+		mysql_conn->last_write = time(NULL);
 	}
 	slurm_mutex_unlock(&mysql_conn->lock);
 	return rc;
@@ -1343,6 +1385,7 @@ extern int mysql_db_rollback(mysql_conn_t *mysql_conn)
 		errno = mysql_errno(mysql_conn->db_conn);
 		rc = SLURM_ERROR;
 	} else {
+		mysql_conn->writes_pending = false;
 		/*
 		 * Starting in MariaDB 10.2 many of the api commands started
 		 * setting errno erroneously.
@@ -1360,6 +1403,9 @@ extern MYSQL_RES *mysql_db_query_ret(mysql_conn_t *mysql_conn,
 	MYSQL_RES *result = NULL;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	/* Multiple statements wanting the last result may be writes */
+	if (last)
+		_note_write(mysql_conn);
 	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
 		if (mysql_errno(mysql_conn->db_conn) == ER_NO_SUCH_TABLE)
 			goto fini;
@@ -1389,6 +1435,7 @@ extern int mysql_db_query_check_after(mysql_conn_t *mysql_conn, char *query)
 	int rc = SLURM_SUCCESS;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_note_write(mysql_conn);
 	if ((rc = _mysql_query_internal(
 		     mysql_conn->db_conn, query)) != SLURM_ERROR)
 		rc = _clear_results(mysql_conn->db_conn);
@@ -1401,6 +1448,7 @@ extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query)
 	uint64_t new_id = 0;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_note_write(mysql_conn);
 	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
 		new_id = mysql_insert_id(mysql_conn->db_conn);
 		if (!new_id) {
@@ -1524,6 +1572,48 @@ extern int mysql_db_get_var_u64(mysql_conn_t *mysql_conn,
 	return SLURM_SUCCESS;
 }
 
+extern int mysql_db_get_replica_lag(mysql_conn_t *mysql_conn)
+{
+	MYSQL_ROW row = NULL;
+	MYSQL_RES *result = NULL;
+	MYSQL_FIELD *fields = NULL;
+	char *query = "show slave status;";
+	int lag = -1;
+
+	/* MySQL 8.4 removed the old name, MariaDB still has it everywhere */
+	if (!xstrcasestr(mysql_get_server_info(mysql_conn->db_conn),
+			 "mariadb") &&
+	    (mysql_get_server_version(mysql_conn->db_conn) >= 80022))
+		query = "show replica status;";
+
+	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+		error("%s: null result from query `%s`", __func__, query);
+		return -1;
+	}
+
+	if (!(row = mysql_fetch_row(result))) {
+		debug("%s: replication is not configured on this server",
+		      __func__);
+		mysql_free_result(result);
+		return -1;
+	}
+
+	fields = mysql_fetch_fields(result);
+	for (int i = 0; i < mysql_num_fields(result); i++) {
+		if (xstrcasecmp(fields[i].name, "Seconds_Behind_Master") &&
+		    xstrcasecmp(fields[i].name, "Seconds_Behind_Source"))
+			continue;
+		/* NULL means the replica SQL thread is not running */
+		if (row[i])
+			lag = atoi(row[i]);
+		break;
+	}
+
+	mysql_free_result(result);
+
+	return lag;
+}
+
 extern void mysql_db_enable_streaming_replication(mysql_conn_t *mysql_conn)
 {
 	int rc = SLURM_SUCCESS;
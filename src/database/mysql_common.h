@@ -59,14 +59,19 @@ typedef enum {
 	SLURM_MYSQL_PLUGIN_JC, /* jobcomp */
 } slurm_mysql_plugin_type_t;
 
-typedef struct {
+typedef struct mysql_conn {
 	char *cluster_name;
 	MYSQL *db_conn;
 	uint32_t flags;
+	time_t last_write; /* last time writes on this connection committed */
 	pthread_mutex_t lock;
 	char *pre_commit_query;
+	struct mysql_conn *replica; /* connection to a read-only replica */
+	int replica_gen; /* generation of the replica list this came from */
+	int replica_inx; /* index of this replica in StorageReplicaHost */
 	list_t *update_list;
 	int conn;
+	bool writes_pending; /* writes not yet committed */
 	uint64_t wsrep_trx_fragment_size_orig;
 	char *wsrep_trx_fragment_unit_orig;
 } mysql_conn_t;
@@ -100,6 +105,12 @@ extern mysql_conn_t *create_mysql_conn(int conn_num, bool rollback,
 				       char *cluster_name);
 extern int destroy_mysql_conn(mysql_conn_t *mysql_conn);
 extern mysql_db_info_t *create_mysql_db_info(slurm_mysql_plugin_type_t type);
+/*
+ * Same as create_mysql_db_info() but connect to the given replica host, which
+ * may be "host", "host:port" or "unix:/path", instead of StorageHost.
+ */
+extern mysql_db_info_t *create_mysql_replica_db_info(
+	slurm_mysql_plugin_type_t type, const char *replica);
 extern int destroy_mysql_db_info(mysql_db_info_t *db_info);
 
 extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
@@ -126,6 +137,11 @@ extern int mysql_db_get_var_str(mysql_conn_t *mysql_conn,
 extern int mysql_db_get_var_u64(mysql_conn_t *mysql_conn,
 	    			 const char *variable_name,
 			    	 uint64_t *value);
+/*
+ * Get how many seconds a replica is behind its primary.
+ * RET seconds behind, or -1 if replication is not running or unknown.
+ */
+extern int mysql_db_get_replica_lag(mysql_conn_t *mysql_conn);
 extern void mysql_db_enable_streaming_replication(mysql_conn_t *mysql_conn);
 extern void mysql_db_restore_streaming_replication(mysql_conn_t *mysql_conn);
 #endif
@@ -204,6 +204,12 @@ typedef struct slurm_acct_storage_ops {
 	int  (*job_suspend)        (void *db_conn, job_record_t *job_ptr);
 	list_t *(*get_jobs_cond)   (void *db_conn, uint32_t uid,
 				    slurmdb_job_cond_t *job_cond);
+	list_t *(*get_jobs_columns)(void *db_conn, uint32_t uid,
+				    slurmdb_job_cond_t *job_cond);
+	int (*get_jobs_stream)     (void *db_conn, uint32_t uid,
+				    slurmdb_job_cond_t *job_cond,
+				    jobacct_storage_jobs_f callback,
+				    void *arg);
 	int (*archive_dump)        (void *db_conn,
 				    slurmdb_archive_cond_t *arch_cond);
 	int (*archive_load)        (void *db_conn,
@@ -296,6 +302,8 @@ static const char *syms[] = {
 	"jobacct_storage_p_step_complete",
 	"jobacct_storage_p_suspend",
 	"jobacct_storage_p_get_jobs_cond",
+	"jobacct_storage_p_get_jobs_columns",
+	"jobacct_storage_p_get_jobs_stream",
 	"jobacct_storage_p_archive",
 	"jobacct_storage_p_archive_load",
 	"acct_storage_p_update_shares_used",
@@ -1276,6 +1284,40 @@ extern list_t *jobacct_storage_g_get_jobs_cond(void *db_conn, uint32_t uid,
 	return ret_list;
 }
 
+/*
+ * get a projection of job info from the storage
+ * returns List of slurmdb_job_columns_t *, one per cluster
+ * note List needs to be freed when called
+ */
+extern list_t *jobacct_storage_g_get_jobs_columns(void *db_conn, uint32_t uid,
+						  slurmdb_job_cond_t *job_cond)
+{
+	xassert(plugin_inited != PLUGIN_NOT_INITED);
+
+	if (plugin_inited == PLUGIN_NOOP)
+		return NULL;
+
+	return (*(ops.get_jobs_columns))(db_conn, uid, job_cond);
+}
+
+/*
+ * get info from the storage a piece at a time
+ * callback is called with each List of slurmdb_job_rec_t *
+ */
+extern int jobacct_storage_g_get_jobs_stream(void *db_conn, uint32_t uid,
+					     slurmdb_job_cond_t *job_cond,
+					     jobacct_storage_jobs_f callback,
+					     void *arg)
+{
+	xassert(plugin_inited != PLUGIN_NOT_INITED);
+	xassert(callback);
+
+	if (plugin_inited == PLUGIN_NOOP)
+		return ESLURM_NOT_SUPPORTED;
+
+	return (*(ops.get_jobs_stream))(db_conn, uid, job_cond, callback, arg);
+}
+
 /*
  * expire old info from the storage
  */
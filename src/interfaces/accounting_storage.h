@@ -55,6 +55,10 @@ typedef enum {
 	ACCT_STORAGE_INFO_AGENT_COUNT
 } acct_storage_info_t;
 
+/* Handle one List of slurmdb_job_rec_t * from
+ * jobacct_storage_g_get_jobs_stream() */
+typedef int (*jobacct_storage_jobs_f)(list_t *job_list, void *arg);
+
 extern uid_t db_api_uid;
 
 extern int acct_storage_g_init(void); /* load the plugin */
@@ -703,6 +707,28 @@ extern int jobacct_storage_g_job_suspend(void *db_conn,
 extern list_t *jobacct_storage_g_get_jobs_cond(void *db_conn, uint32_t uid,
 					       slurmdb_job_cond_t *job_cond);
 
+/*
+ * get a projection of job info from the storage, job_cond->format_list
+ * holds the names of the columns wanted (see slurmdb_job_col_t)
+ * returns List of slurmdb_job_columns_t *, one per cluster
+ * note List needs to be freed when called
+ */
+extern list_t *jobacct_storage_g_get_jobs_columns(void *db_conn, uint32_t uid,
+						  slurmdb_job_cond_t *job_cond);
+
+/*
+ * get info from the storage a piece at a time instead of all at once
+ * callback is called with each List of slurmdb_job_rec_t * as it is
+ * retrieved, it may take records off the List, the rest are freed on return.
+ * A non-zero return from callback stops the query.
+ * RET SLURM_SUCCESS, ESLURM_NOT_SUPPORTED if the storage can't do this (nothing
+ *     was sent to callback) or an error code
+ */
+extern int jobacct_storage_g_get_jobs_stream(void *db_conn, uint32_t uid,
+					     slurmdb_job_cond_t *job_cond,
+					     jobacct_storage_jobs_f callback,
+					     void *arg);
+
 /*
  * expire old info from the storage
  */
@@ -42,6 +42,7 @@
 #include <string.h>
 #include <sys/socket.h>
 
+#include "src/common/list.h"
 #include "src/common/macros.h"
 #include "src/common/plugin.h"
 #include "src/common/plugrack.h"
@@ -49,6 +50,7 @@
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/util-net.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
@@ -111,6 +113,16 @@ typedef struct {
 	char *type;
 } auth_plugin_types_t;
 
+typedef struct {
+	char *token;
+	int plugin_id;
+	time_t expires;
+	void *data;
+	void (*free_func)(void *data);
+} auth_cache_entry_t;
+
+#define DEFAULT_CACHE_SIZE 1024
+
 auth_plugin_types_t auth_plugin_types[] = {
 	{ AUTH_PLUGIN_NONE, "auth/none" },
 	{ AUTH_PLUGIN_MUNGE, "auth/munge" },
@@ -130,6 +142,12 @@ static pthread_rwlock_t context_lock = PTHREAD_RWLOCK_INITIALIZER;
 static bool at_forked = false;
 static bool externally_locked = false;
 
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static xhash_t *cache = NULL;
+static list_t *cache_order = NULL;
+static int cache_size = -1;
+static auth_cache_stats_t cache_stats = { 0 };
+
 static void _atfork_child(void)
 {
 	slurm_rwlock_init(&context_lock);
@@ -284,6 +302,12 @@ extern int auth_g_fini(void)
 	xfree(g_context);
 	g_context_num = -1;
 
+	slurm_mutex_lock(&cache_mutex);
+	FREE_NULL_LIST(cache_order);
+	xhash_free(cache);
+	cache_size = -1;
+	slurm_mutex_unlock(&cache_mutex);
+
 done:
 	slurm_rwlock_unlock(&context_lock);
 	return rc;
@@ -615,6 +639,157 @@ extern void auth_g_thread_clear(void)
 	slurm_rwlock_unlock(&context_lock);
 }
 
+static void _cache_entry_id(void *item, const void **key, uint32_t *key_len)
+{
+	auth_cache_entry_t *entry = item;
+
+	*key = entry->token;
+	*key_len = strlen(entry->token);
+}
+
+static void _cache_entry_free(void *item)
+{
+	auth_cache_entry_t *entry = item;
+
+	if (entry->free_func)
+		entry->free_func(entry->data);
+	xfree(entry->token);
+	xfree(entry);
+}
+
+/* cache_mutex must be locked */
+static bool _cache_enabled(void)
+{
+	char *tmp_str;
+
+	if (cache_size >= 0)
+		return (cache_size > 0);
+
+	cache_size = 0;
+	if (!running_in_daemon())
+		return false;
+
+	cache_size = DEFAULT_CACHE_SIZE;
+	if ((tmp_str = conf_get_opt_str(slurm_conf.authalt_params,
+					"verify_cache_size="))) {
+		cache_size = atoi(tmp_str);
+		if (cache_size < 0) {
+			error("Invalid AuthAltParameters verify_cache_size=%s",
+			      tmp_str);
+			cache_size = 0;
+		}
+		xfree(tmp_str);
+	}
+
+	if (cache_size) {
+		cache = xhash_init(_cache_entry_id, _cache_entry_free);
+		cache_order = list_create(NULL);
+	}
+
+	return (cache_size > 0);
+}
+
+static int _cache_entry_expired(void *x, void *key)
+{
+	auth_cache_entry_t *entry = x;
+	time_t *now = key;
+
+	if (entry->expires > *now)
+		return 0;
+
+	xhash_delete_str(cache, entry->token);
+	return 1;
+}
+
+extern void auth_cache_add(int plugin_id, const char *token, time_t expires,
+			   void *data, void (*free_func)(void *data))
+{
+	auth_cache_entry_t *entry;
+	time_t now = time(NULL);
+
+	slurm_mutex_lock(&cache_mutex);
+
+	if (!token || (expires <= now) || !_cache_enabled() ||
+	    xhash_get_str(cache, token)) {
+		slurm_mutex_unlock(&cache_mutex);
+		if (free_func)
+			free_func(data);
+		return;
+	}
+
+	if (xhash_count(cache) >= cache_size)
+		(void) list_delete_all(cache_order, _cache_entry_expired, &now);
+
+	/* Drop the oldest tokens */
+	while (xhash_count(cache) >= cache_size) {
+		entry = list_pop(cache_order);
+		xhash_delete_str(cache, entry->token);
+		cache_stats.evictions++;
+	}
+
+	entry = xmalloc(sizeof(*entry));
+	entry->token = xstrdup(token);
+	entry->plugin_id = plugin_id;
+	entry->expires = expires;
+	entry->data = data;
+	entry->free_func = free_func;
+
+	xhash_add(cache, entry);
+	list_append(cache_order, entry);
+
+	slurm_mutex_unlock(&cache_mutex);
+}
+
+extern bool auth_cache_find(int plugin_id, const char *token,
+			    void (*func)(void *data, void *arg), void *arg)
+{
+	auth_cache_entry_t *entry;
+	bool found = false;
+
+	if (!token)
+		return false;
+
+	slurm_mutex_lock(&cache_mutex);
+
+	if (!_cache_enabled())
+		goto done;
+
+	if (!(entry = xhash_get_str(cache, token)) ||
+	    (entry->plugin_id != plugin_id)) {
+		cache_stats.misses++;
+		goto done;
+	}
+
+	if (entry->expires <= time(NULL)) {
+		list_delete_ptr(cache_order, entry);
+		xhash_delete_str(cache, token);
+		cache_stats.misses++;
+		goto done;
+	}
+
+	func(entry->data, arg);
+	cache_stats.hits++;
+	found = true;
+
+done:
+	slurm_mutex_unlock(&cache_mutex);
+	return found;
+}
+
+extern void auth_cache_stats_get(auth_cache_stats_t *stats)
+{
+	slurm_mutex_lock(&cache_mutex);
+	*stats = cache_stats;
+	slurm_mutex_unlock(&cache_mutex);
+}
+
+extern void auth_cache_stats_reset(void)
+{
+	slurm_mutex_lock(&cache_mutex);
+	memset(&cache_stats, 0, sizeof(cache_stats));
+	slurm_mutex_unlock(&cache_mutex);
+}
+
 extern char *auth_g_token_generate(int plugin_id, const char *username,
 				   int lifespan)
 {
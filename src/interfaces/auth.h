@@ -58,6 +58,12 @@
  */
 #define AUTH_DEFAULT_INDEX 0
 
+typedef struct {
+	uint64_t hits; /* tokens found in the verified token cache */
+	uint64_t misses; /* tokens which had to be verified */
+	uint64_t evictions; /* tokens dropped before expiring */
+} auth_cache_stats_t;
+
 /*
  * Prepare the global context.
  * auth_type IN: authentication mechanism (e.g. "auth/munge") or
@@ -126,6 +132,34 @@ extern void *auth_g_get_identity(void *cred);
 extern int auth_g_pack(void *cred, buf_t *buf, uint16_t protocol_version);
 extern void *auth_g_unpack(buf_t *buf, uint16_t protocol_version);
 
+/*
+ * Remember a token verified by a plugin until it expires, so the same token
+ * presented again does not have to be verified again. Only for plugins whose
+ * tokens are reused across messages (!hash_enable).
+ * Enabled in daemons, sized by AuthAltParameters=verify_cache_size=.
+ * IN plugin_id - AUTH_PLUGIN_* of the plugin which verified token
+ * IN token - verified token (copied)
+ * IN expires - time at which token expires
+ * IN data - plugin data to keep with token (consumed)
+ * IN free_func - function to free data
+ */
+extern void auth_cache_add(int plugin_id, const char *token, time_t expires,
+			   void *data, void (*free_func)(void *data));
+
+/*
+ * Look for a token previously passed to auth_cache_add()
+ * IN plugin_id - AUTH_PLUGIN_* of the plugin verifying token
+ * IN token - token to look for
+ * IN func - called with the cached data while the cache is locked
+ * IN arg - passed to func
+ * RET true if token was found and has not expired
+ */
+extern bool auth_cache_find(int plugin_id, const char *token,
+			    void (*func)(void *data, void *arg), void *arg);
+
+extern void auth_cache_stats_get(auth_cache_stats_t *stats);
+extern void auth_cache_stats_reset(void);
+
 extern char *auth_g_token_generate(int plugin_id, const char *username,
 				   int lifespan);
 
@@ -76,6 +76,8 @@ typedef struct {
 	int	(*task_addto)		(cgroup_ctl_type_t sub,
 					 stepd_step_rec_t *step, pid_t pid,
 					 uint32_t task_id);
+	int	(*task_open)		(uint32_t task_id);
+	int	(*task_spawned)		(pid_t pid, uint32_t task_id);
 	cgroup_acct_t *(*task_get_acct_data) (uint32_t taskid);
 	cgroup_acct_t *(*job_get_acct_data)(void);
 	long int (*get_acct_units)	(void);
@@ -114,6 +116,8 @@ static const char *syms[] = {
 	"cgroup_p_step_start_oom_mgr",
 	"cgroup_p_step_stop_oom_mgr",
 	"cgroup_p_task_addto",
+	"cgroup_p_task_open",
+	"cgroup_p_task_spawned",
 	"cgroup_p_task_get_acct_data",
 	"cgroup_p_job_get_acct_data",
 	"cgroup_p_get_acct_units",
@@ -1069,6 +1073,38 @@ extern int cgroup_g_task_addto(cgroup_ctl_type_t sub, stepd_step_rec_t *step,
 	return rc;
 }
 
+extern int cgroup_g_task_open(uint32_t task_id)
+{
+	int rc;
+
+	xassert(plugin_inited != PLUGIN_NOT_INITED);
+
+	if (plugin_inited == PLUGIN_NOOP)
+		return SLURM_ERROR;
+
+	slurm_mutex_lock(&g_context_lock);
+	rc = (*(ops.task_open))(task_id);
+	slurm_mutex_unlock(&g_context_lock);
+
+	return rc;
+}
+
+extern int cgroup_g_task_spawned(pid_t pid, uint32_t task_id)
+{
+	int rc;
+
+	xassert(plugin_inited != PLUGIN_NOT_INITED);
+
+	if (plugin_inited == PLUGIN_NOOP)
+		return SLURM_SUCCESS;
+
+	slurm_mutex_lock(&g_context_lock);
+	rc = (*(ops.task_spawned))(pid, task_id);
+	slurm_mutex_unlock(&g_context_lock);
+
+	return rc;
+}
+
 extern cgroup_acct_t *cgroup_g_task_get_acct_data(uint32_t taskid)
 {
 	xassert(plugin_inited != PLUGIN_NOT_INITED);
@@ -115,7 +115,8 @@ typedef enum {
 	CG_MEMCG_OOMGROUP,
 	CG_MEMCG_PEAK,
 	CG_MEMCG_SWAP,
-	CG_KILL_BUTTON
+	CG_KILL_BUTTON,
+	CG_IO_STAT
 } cgroup_ctl_feature_t;
 
 typedef enum {
@@ -162,6 +163,7 @@ typedef struct {
 	uint64_t job_mem_failcnt;
 	uint64_t job_memsw_failcnt;
 	uint64_t oom_kill_cnt;
+	bool step_terminated; /* step termination already requested */
 } cgroup_oom_t;
 
 typedef struct {
@@ -171,6 +173,8 @@ typedef struct {
 	uint64_t total_rss;
 	uint64_t total_pgmajfault;
 	uint64_t total_vmem;
+	uint64_t total_io_read; /* bytes read from block devices */
+	uint64_t total_io_write; /* bytes written to block devices */
 } cgroup_acct_t;
 
 /* Slurm cgroup plugins configuration parameters */
@@ -397,6 +401,26 @@ extern cgroup_oom_t *cgroup_g_step_stop_oom_mgr(stepd_step_rec_t *step);
 extern int cgroup_g_task_addto(cgroup_ctl_type_t sub, stepd_step_rec_t *step,
 			       pid_t pid, uint32_t task_id);
 
+/*
+ * Create the cgroup of a task if needed and open it, so the task can be
+ * spawned straight into it with clone3(CLONE_INTO_CGROUP).
+ *
+ * IN task_id - task number to form the path and create the task_x directory.
+ * RET fd of the task cgroup directory, or SLURM_ERROR if the plugin can only
+ *     add the task to its cgroup after it is forked.
+ */
+extern int cgroup_g_task_open(uint32_t task_id);
+
+/*
+ * Record that pid was spawned into the cgroup of task_id, so the following
+ * cgroup_g_step_addto() and cgroup_g_task_addto() calls leave it there.
+ *
+ * IN pid - pid spawned into the directory from cgroup_g_task_open().
+ * IN task_id - task number the directory was opened for.
+ * RET SLURM_SUCCESS or SLURM_ERROR if the task cgroup is unknown.
+ */
+extern int cgroup_g_task_spawned(pid_t pid, uint32_t task_id);
+
 /*
  * Given a task id return the accounting data reading the accounting controller
  * files for this step.
@@ -126,6 +126,7 @@ static slurm_step_id_t jobacct_step_id = {
 };
 static uint64_t jobacct_mem_limit  = 0;
 static uint64_t jobacct_vmem_limit = 0;
+static void (*poll_callback)(void) = NULL;
 static acct_gather_profile_timer_t *profile_timer =
 	&acct_gather_profile_timer[PROFILE_TASK];
 
@@ -355,6 +356,8 @@ static void *_watch_tasks(void *arg)
 		_poll_data(1);
 		slurm_mutex_unlock(&g_context_lock);
 
+		if (poll_callback)
+			(*poll_callback)();
 	}
 	return NULL;
 }
@@ -712,16 +715,18 @@ static int _foreach_aggregate_usage(void *x, void *arg)
  * will have some pids added (e.g. by REQUEST_ADD_EXTERN_PID) which will
  * be the ones aggregated and accounted for.
  */
-extern void jobacct_gather_stat_all_task(jobacctinfo_t *ret_jobacct)
+extern void jobacct_gather_stat_all_task(jobacctinfo_t *ret_jobacct,
+					 bool update_data)
 {
 	if ((plugin_inited == PLUGIN_NOOP) || _jobacct_shutdown_test())
 		return;
 
 	/*
 	 * As this is used mainly in the extern step this is called only once,
-	 * as there is only one task, so refresh data here unconditionally.
+	 * as there is only one task, so refresh data here if requested.
 	 */
-	_poll_data(0);
+	if (update_data)
+		_poll_data(0);
 
 	slurm_mutex_lock(&task_list_lock);
 	if (!task_list) {
@@ -897,6 +902,24 @@ extern void jobacct_gather_handle_mem_limit(uint64_t total_job_mem,
 	}
 }
 
+extern void jobacct_gather_poll_now(void)
+{
+	if (!_init_run_test() || _jobacct_shutdown_test())
+		return;
+
+	slurm_mutex_lock(&g_context_lock);
+	_poll_data(0);
+	slurm_mutex_unlock(&g_context_lock);
+
+	if (poll_callback)
+		(*poll_callback)();
+}
+
+extern void jobacct_gather_set_poll_callback(void (*callback)(void))
+{
+	poll_callback = callback;
+}
+
 /********************* jobacctinfo functions ******************************/
 
 extern jobacctinfo_t *jobacctinfo_create(jobacct_id_t *jobacct_id)
@@ -137,7 +137,8 @@ extern int jobacct_gather_add_task(pid_t pid, jobacct_id_t *jobacct_id,
 /* must free jobacctinfo_t if not NULL */
 extern jobacctinfo_t *jobacct_gather_stat_task(pid_t pid, bool update_data);
 
-extern void jobacct_gather_stat_all_task(jobacctinfo_t *ret_jobacct);
+extern void jobacct_gather_stat_all_task(jobacctinfo_t *ret_jobacct,
+					 bool update_data);
 
 /*
  * Get accounting data from the job-level.
@@ -158,6 +159,20 @@ extern int jobacct_gather_set_mem_limit(slurm_step_id_t *step_id,
 extern void jobacct_gather_handle_mem_limit(uint64_t total_job_mem,
 					    uint64_t total_job_vsize);
 
+/*
+ * Poll the tasks now instead of waiting for the next JobAcctGatherFrequency
+ * tick, e.g. when the kernel reports a memory event for the step.
+ */
+extern void jobacct_gather_poll_now(void);
+
+/*
+ * Register a function to be called after every periodic or forced poll of
+ * the tasks has completed, so the caller can pick up the fresh data with
+ * jobacct_gather_stat_task(pid, false). It is called without any of the
+ * jobacct_gather locks held.
+ */
+extern void jobacct_gather_set_poll_callback(void (*callback)(void));
+
 extern jobacctinfo_t *jobacctinfo_create(jobacct_id_t *jobacct_id);
 extern void jobacctinfo_destroy(void *object);
 extern int jobacctinfo_setinfo(jobacctinfo_t *jobacct,
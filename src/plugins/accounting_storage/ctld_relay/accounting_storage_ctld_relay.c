@@ -676,6 +676,20 @@ extern list_t *jobacct_storage_p_get_jobs_cond(void *db_conn, uid_t uid,
 	return NULL;
 }
 
+extern list_t *jobacct_storage_p_get_jobs_columns(void *db_conn, uid_t uid,
+						  slurmdb_job_cond_t *job_cond)
+{
+	return NULL;
+}
+
+extern int jobacct_storage_p_get_jobs_stream(void *db_conn, uid_t uid,
+					     slurmdb_job_cond_t *job_cond,
+					     jobacct_storage_jobs_f callback,
+					     void *arg)
+{
+	return ESLURM_NOT_SUPPORTED;
+}
+
 /*
  * Expire old info from the storage
  * Not applicable for any database
@@ -96,7 +96,16 @@ static mysql_db_info_t *mysql_db_info = NULL;
 static pthread_rwlock_t mysql_db_info_lock = PTHREAD_RWLOCK_INITIALIZER;
 static char *mysql_db_name = NULL;
 
+/* StorageReplicaHost, protected by mysql_db_info_lock */
+static mysql_db_info_t **replica_db_info = NULL;
+static int replica_cnt = 0;
+static int replica_gen = 0;
+/* When an unusable replica may be tried again */
+static time_t *replica_retry = NULL;
+static pthread_mutex_t replica_retry_lock = PTHREAD_MUTEX_INITIALIZER;
+
 #define DELETE_SEC_BACK 86400
+#define REPLICA_RETRY_DELAY 30
 
 char *acct_coord_table = "acct_coord_table";
 char *acct_table = "acct_table";
@@ -1079,6 +1088,168 @@ static int _as_mysql_acct_check_tables(mysql_conn_t *mysql_conn)
 	return rc;
 }
 
+/* NOTE: Ensure mysql_db_info_lock is write locked on function entry */
+static void _create_replica_db_info(void)
+{
+	char *hosts, *host, *save_ptr = NULL;
+
+	replica_gen++;
+	if (!slurmdbd_conf->storage_replica_host)
+		return;
+
+	hosts = xstrdup(slurmdbd_conf->storage_replica_host);
+	host = strtok_r(hosts, ",", &save_ptr);
+	while (host) {
+		xrecalloc(replica_db_info, replica_cnt + 1,
+			  sizeof(*replica_db_info));
+		replica_db_info[replica_cnt++] =
+			create_mysql_replica_db_info(SLURM_MYSQL_PLUGIN_AS,
+						     host);
+		host = strtok_r(NULL, ",", &save_ptr);
+	}
+	xfree(hosts);
+
+	slurm_mutex_lock(&replica_retry_lock);
+	xfree(replica_retry);
+	replica_retry = xcalloc(replica_cnt, sizeof(*replica_retry));
+	slurm_mutex_unlock(&replica_retry_lock);
+
+	verbose("Sending reads to %d replica(s) no more than %u seconds behind",
+		replica_cnt, slurmdbd_conf->storage_replica_max_lag);
+}
+
+/* NOTE: Ensure mysql_db_info_lock is write locked on function entry */
+static void _destroy_replica_db_info(void)
+{
+	for (int i = 0; i < replica_cnt; i++)
+		destroy_mysql_db_info(replica_db_info[i]);
+	xfree(replica_db_info);
+	replica_cnt = 0;
+}
+
+/* Don't try this replica again for a while */
+static void _replica_retry_later(int inx, time_t now)
+{
+	slurm_mutex_lock(&replica_retry_lock);
+	replica_retry[inx] = now + REPLICA_RETRY_DELAY;
+	slurm_mutex_unlock(&replica_retry_lock);
+}
+
+/* NOTE: Ensure mysql_db_info_lock is read locked on function entry */
+static mysql_conn_t *_connect_replica(mysql_conn_t *mysql_conn, int inx,
+				      time_t now)
+{
+	mysql_conn_t *replica;
+	bool retry;
+
+	slurm_mutex_lock(&replica_retry_lock);
+	retry = (replica_retry[inx] <= now);
+	slurm_mutex_unlock(&replica_retry_lock);
+	if (!retry)
+		return NULL;
+
+	/* Not a rollback connection so each read sees the latest data */
+	replica = create_mysql_conn(mysql_conn->conn, false,
+				    mysql_conn->cluster_name);
+	replica->flags |= DB_CONN_FLAG_REPLICA;
+	replica->replica_gen = replica_gen;
+	replica->replica_inx = inx;
+
+	if (mysql_db_get_db_connection(replica, mysql_db_name,
+				       replica_db_info[inx]) != SLURM_SUCCESS) {
+		error("unable to connect to replica %s, trying again in %d seconds",
+		      replica_db_info[inx]->host, REPLICA_RETRY_DELAY);
+		_replica_retry_later(inx, now);
+		destroy_mysql_conn(replica);
+		return NULL;
+	}
+
+	return replica;
+}
+
+static int _find_registered_conn(void *x, void *key)
+{
+	slurmdbd_conn_t *slurmdbd_conn = x;
+
+	return (slurmdbd_conn->db_conn == key);
+}
+
+/*
+ * Get the connection a read-only request should use. That is a connection to
+ * a StorageReplicaHost which is reachable, no more than StorageReplicaMaxLag
+ * seconds behind, and has caught up with the last writes done through
+ * mysql_conn. Otherwise it is mysql_conn itself.
+ */
+extern mysql_conn_t *get_read_connection(mysql_conn_t *mysql_conn)
+{
+	mysql_conn_t *read_conn = mysql_conn;
+	time_t now = time(NULL);
+
+	/* Uncommitted writes are only visible here */
+	if (!mysql_conn || mysql_conn->writes_pending ||
+	    (mysql_conn->flags & DB_CONN_FLAG_REPLICA))
+		return mysql_conn;
+
+	/*
+	 * The slurmdbd's own connection (no cluster) and registered
+	 * slurmctlds load their caches through here. Anything a stale replica
+	 * hid from them would never come back in an update, so they always
+	 * read from the primary.
+	 */
+	if (!mysql_conn->cluster_name ||
+	    (registered_clusters &&
+	     list_find_first(registered_clusters, _find_registered_conn,
+			     mysql_conn)))
+		return mysql_conn;
+
+	slurm_rwlock_rdlock(&mysql_db_info_lock);
+	if (mysql_conn->replica &&
+	    ((mysql_conn->replica->replica_gen != replica_gen) ||
+	     mysql_db_ping(mysql_conn->replica))) {
+		destroy_mysql_conn(mysql_conn->replica);
+		mysql_conn->replica = NULL;
+	}
+
+	for (int i = 0; i < replica_cnt; i++) {
+		mysql_conn_t *replica = mysql_conn->replica;
+		int lag;
+
+		if (!replica &&
+		    !(replica = _connect_replica(
+			      mysql_conn, (mysql_conn->conn + i) % replica_cnt,
+			      now)))
+			continue;
+		mysql_conn->replica = replica;
+
+		lag = mysql_db_get_replica_lag(replica);
+		if ((lag >= 0) &&
+		    (lag <= slurmdbd_conf->storage_replica_max_lag)) {
+			/* Our own committed writes must be there already */
+			if (!mysql_conn->last_write ||
+			    ((now - mysql_conn->last_write) > lag))
+				read_conn = replica;
+			break;
+		}
+
+		if (lag < 0)
+			debug("replica %s is not replicating, not using it",
+			      replica_db_info[replica->replica_inx]->host);
+		else
+			debug("replica %s is %d seconds behind, not using it",
+			      replica_db_info[replica->replica_inx]->host, lag);
+		_replica_retry_later(replica->replica_inx, now);
+		destroy_mysql_conn(replica);
+		mysql_conn->replica = NULL;
+	}
+	slurm_rwlock_unlock(&mysql_db_info_lock);
+
+	if (read_conn != mysql_conn)
+		debug3("%d(%s:%d) reading from replica",
+		       mysql_conn->conn, THIS_FILE, __LINE__);
+
+	return read_conn;
+}
+
 /* This should be added to the beginning of each function to make sure
  * we have a connection to the database before we try to use it.
  */
@@ -1092,6 +1263,12 @@ extern int check_connection(mysql_conn_t *mysql_conn)
 		int rc;
 		/* avoid memory leak and end thread */
 		mysql_db_close_db_connection(mysql_conn);
+		/* get_read_connection() will find another one */
+		if (mysql_conn->flags & DB_CONN_FLAG_REPLICA) {
+			error("lost connection to replica database");
+			errno = ESLURM_DB_CONNECTION;
+			return ESLURM_DB_CONNECTION;
+		}
 		slurm_rwlock_rdlock(&mysql_db_info_lock);
 		rc = mysql_db_get_db_connection(mysql_conn, mysql_db_name,
 						mysql_db_info);
@@ -2945,6 +3122,7 @@ extern int init(void)
 	}
 
 	mysql_db_info = create_mysql_db_info(SLURM_MYSQL_PLUGIN_AS);
+	_create_replica_db_info();
 	mysql_db_name = acct_get_db_name();
 
 	debug2("mysql_connect() called for db %s", mysql_db_name);
@@ -3002,6 +3180,8 @@ extern void fini(void)
 	slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 	slurm_rwlock_destroy(&as_mysql_cluster_list_lock);
 	destroy_mysql_db_info(mysql_db_info);
+	_destroy_replica_db_info();
+	xfree(replica_retry);
 	xfree(mysql_db_name);
 	xfree(default_qos_str);
 
@@ -3441,53 +3621,61 @@ extern int acct_storage_p_remove_reservation(mysql_conn_t *mysql_conn,
 extern list_t *acct_storage_p_get_users(mysql_conn_t *mysql_conn, uid_t uid,
 					slurmdb_user_cond_t *user_cond)
 {
-	return as_mysql_get_users(mysql_conn, uid, user_cond);
+	return as_mysql_get_users(get_read_connection(mysql_conn),
+				  uid, user_cond);
 }
 
 extern list_t *acct_storage_p_get_accts(mysql_conn_t *mysql_conn, uid_t uid,
 					slurmdb_account_cond_t *acct_cond)
 {
-	return as_mysql_get_accts(mysql_conn, uid, acct_cond);
+	return as_mysql_get_accts(get_read_connection(mysql_conn),
+				  uid, acct_cond);
 }
 
 extern list_t *acct_storage_p_get_clusters(mysql_conn_t *mysql_conn, uid_t uid,
 					   slurmdb_cluster_cond_t *cluster_cond)
 {
-	return as_mysql_get_clusters(mysql_conn, uid, cluster_cond);
+	return as_mysql_get_clusters(get_read_connection(mysql_conn),
+				     uid, cluster_cond);
 }
 
 extern list_t *acct_storage_p_get_federations(
 	mysql_conn_t *mysql_conn, uid_t uid,
 	slurmdb_federation_cond_t *fed_cond)
 {
-	return as_mysql_get_federations(mysql_conn, uid, fed_cond);
+	return as_mysql_get_federations(get_read_connection(mysql_conn),
+					uid, fed_cond);
 }
 
 extern list_t *acct_storage_p_get_tres(
 	mysql_conn_t *mysql_conn, uid_t uid,
 	slurmdb_tres_cond_t *tres_cond)
 {
-	return as_mysql_get_tres(mysql_conn, uid, tres_cond);
+	return as_mysql_get_tres(get_read_connection(mysql_conn),
+				 uid, tres_cond);
 }
 
 extern list_t *acct_storage_p_get_assocs(
 	mysql_conn_t *mysql_conn, uid_t uid,
 	slurmdb_assoc_cond_t *assoc_cond)
 {
-	return as_mysql_get_assocs(mysql_conn, uid, assoc_cond);
+	return as_mysql_get_assocs(get_read_connection(mysql_conn),
+				   uid, assoc_cond);
 }
 
 extern list_t *acct_storage_p_get_events(mysql_conn_t *mysql_conn, uint32_t uid,
 					 slurmdb_event_cond_t *event_cond)
 {
-	return as_mysql_get_cluster_events(mysql_conn, uid, event_cond);
+	return as_mysql_get_cluster_events(get_read_connection(mysql_conn),
+					   uid, event_cond);
 }
 
 extern list_t *acct_storage_p_get_instances(
 	mysql_conn_t *mysql_conn, uint32_t uid,
 	slurmdb_instance_cond_t *instance_cond)
 {
-	return as_mysql_get_instances(mysql_conn, uid, instance_cond);
+	return as_mysql_get_instances(get_read_connection(mysql_conn),
+				      uid, instance_cond);
 }
 
 extern list_t *acct_storage_p_get_problems(mysql_conn_t *mysql_conn,
@@ -3535,39 +3723,42 @@ extern int acct_storage_p_get_config(void *db_conn,
 extern list_t *acct_storage_p_get_qos(mysql_conn_t *mysql_conn, uid_t uid,
 				      slurmdb_qos_cond_t *qos_cond)
 {
-	return as_mysql_get_qos(mysql_conn, uid, qos_cond);
+	return as_mysql_get_qos(get_read_connection(mysql_conn), uid, qos_cond);
 }
 
 extern list_t *acct_storage_p_get_res(mysql_conn_t *mysql_conn, uid_t uid,
 				      slurmdb_res_cond_t *res_cond)
 {
-	return as_mysql_get_res(mysql_conn, uid, res_cond);
+	return as_mysql_get_res(get_read_connection(mysql_conn), uid, res_cond);
 }
 
 extern list_t *acct_storage_p_get_wckeys(mysql_conn_t *mysql_conn, uid_t uid,
 					 slurmdb_wckey_cond_t *wckey_cond)
 {
-	return as_mysql_get_wckeys(mysql_conn, uid, wckey_cond);
+	return as_mysql_get_wckeys(get_read_connection(mysql_conn),
+				   uid, wckey_cond);
 }
 
 extern list_t *acct_storage_p_get_reservations(
 	mysql_conn_t *mysql_conn, uid_t uid,
 	slurmdb_reservation_cond_t *resv_cond)
 {
-	return as_mysql_get_resvs(mysql_conn, uid, resv_cond);
+	return as_mysql_get_resvs(get_read_connection(mysql_conn),
+				  uid, resv_cond);
 }
 
 extern list_t *acct_storage_p_get_txn(mysql_conn_t *mysql_conn, uid_t uid,
 				      slurmdb_txn_cond_t *txn_cond)
 {
-	return as_mysql_get_txn(mysql_conn, uid, txn_cond);
+	return as_mysql_get_txn(get_read_connection(mysql_conn), uid, txn_cond);
 }
 
 extern int acct_storage_p_get_usage(mysql_conn_t *mysql_conn, uid_t uid,
 				    void *in, slurmdbd_msg_type_t type,
 				    time_t start, time_t end)
 {
-	return as_mysql_get_usage(mysql_conn, uid, in, type, start, end);
+	return as_mysql_get_usage(get_read_connection(mysql_conn),
+				  uid, in, type, start, end);
 }
 
 extern int acct_storage_p_roll_usage(mysql_conn_t *mysql_conn,
@@ -3777,11 +3968,45 @@ extern list_t *jobacct_storage_p_get_jobs_cond(mysql_conn_t *mysql_conn,
 	if (check_connection(mysql_conn) != SLURM_SUCCESS) {
 		return NULL;
 	}
-	job_list = as_mysql_jobacct_process_get_jobs(mysql_conn, uid, job_cond);
+	job_list = as_mysql_jobacct_process_get_jobs(
+		get_read_connection(mysql_conn), uid, job_cond);
 
 	return job_list;
 }
 
+/*
+ * get a projection of job info from the storage
+ * returns list of slurmdb_job_columns_t *
+ * note list needs to be freed when called
+ */
+extern list_t *jobacct_storage_p_get_jobs_columns(mysql_conn_t *mysql_conn,
+						  uid_t uid,
+						  slurmdb_job_cond_t *job_cond)
+{
+	if (check_connection(mysql_conn) != SLURM_SUCCESS)
+		return NULL;
+
+	return as_mysql_jobacct_process_get_jobs_columns(
+		get_read_connection(mysql_conn), uid, job_cond);
+}
+
+/*
+ * get info from the storage a page at a time
+ * callback is called with a list of job_rec_t for each page
+ */
+extern int jobacct_storage_p_get_jobs_stream(mysql_conn_t *mysql_conn,
+					     uid_t uid,
+					     slurmdb_job_cond_t *job_cond,
+					     jobacct_storage_jobs_f callback,
+					     void *arg)
+{
+	if (check_connection(mysql_conn) != SLURM_SUCCESS)
+		return ESLURM_DB_CONNECTION;
+
+	return as_mysql_jobacct_process_get_jobs_stream(
+		get_read_connection(mysql_conn), uid, job_cond, callback, arg);
+}
+
 /*
  * expire old info from the storage
  */
@@ -3833,6 +4058,8 @@ extern int acct_storage_p_reconfig(mysql_conn_t *mysql_conn, bool dbd)
 	slurm_rwlock_wrlock(&mysql_db_info_lock);
 	destroy_mysql_db_info(mysql_db_info);
 	mysql_db_info = create_mysql_db_info(SLURM_MYSQL_PLUGIN_AS);
+	_destroy_replica_db_info();
+	_create_replica_db_info();
 	slurm_rwlock_unlock(&mysql_db_info_lock);
 
 	return SLURM_SUCCESS;
@@ -151,6 +151,7 @@ typedef struct {
 
 /*global functions */
 extern int check_connection(mysql_conn_t *mysql_conn);
+extern mysql_conn_t *get_read_connection(mysql_conn_t *mysql_conn);
 extern char *fix_double_quotes(char *str);
 extern int last_affected_rows(mysql_conn_t *mysql_conn);
 extern void reset_mysql_conn(mysql_conn_t *mysql_conn);
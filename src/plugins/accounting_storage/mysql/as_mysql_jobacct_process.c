@@ -193,6 +193,66 @@ enum {
 	JOB_REQ_COUNT
 };
 
+/*
+ * Field of job_req_inx backing each slurmdb_job_col_t. Columns derived from
+ * several fields map to one of them, the rest are always selected in
+ * _get_job_columns_fields().
+ */
+static const int job_col_req_inx[SLURMDB_JOB_COL_CNT] = {
+	[SLURMDB_JOB_COL_ACCOUNT] = JOB_REQ_ACCOUNT,
+	[SLURMDB_JOB_COL_ADMIN_COMMENT] = JOB_REQ_ADMIN_COMMENT,
+	[SLURMDB_JOB_COL_ALLOC_NODES] = JOB_REQ_ALLOC_NODES,
+	[SLURMDB_JOB_COL_ARRAY_JOB_ID] = JOB_REQ_ARRAYJOBID,
+	[SLURMDB_JOB_COL_ARRAY_MAX_TASKS] = JOB_REQ_ARRAY_MAX,
+	[SLURMDB_JOB_COL_ARRAY_TASK_ID] = JOB_REQ_ARRAYTASKID,
+	[SLURMDB_JOB_COL_ARRAY_TASK_STR] = JOB_REQ_ARRAY_STR,
+	[SLURMDB_JOB_COL_ASSOCID] = JOB_REQ_ASSOCID,
+	[SLURMDB_JOB_COL_CONSTRAINTS] = JOB_REQ_CONSTRAINTS,
+	[SLURMDB_JOB_COL_CONTAINER] = JOB_REQ_CONTAINER,
+	[SLURMDB_JOB_COL_DB_INDEX] = JOB_REQ_DB_INX,
+	[SLURMDB_JOB_COL_DERIVED_EC] = JOB_REQ_DERIVED_EC,
+	[SLURMDB_JOB_COL_DERIVED_ES] = JOB_REQ_DERIVED_ES,
+	[SLURMDB_JOB_COL_ELAPSED] = JOB_REQ_START,
+	[SLURMDB_JOB_COL_ELIGIBLE] = JOB_REQ_ELIGIBLE,
+	[SLURMDB_JOB_COL_END] = JOB_REQ_END,
+	[SLURMDB_JOB_COL_EXITCODE] = JOB_REQ_EXIT_CODE,
+	[SLURMDB_JOB_COL_EXTRA] = JOB_REQ_EXTRA,
+	[SLURMDB_JOB_COL_FAILED_NODE] = JOB_REQ_FAILED_NODE,
+	[SLURMDB_JOB_COL_FLAGS] = JOB_REQ_FLAGS,
+	[SLURMDB_JOB_COL_GID] = JOB_REQ_GID,
+	[SLURMDB_JOB_COL_HET_JOB_ID] = JOB_REQ_HET_JOB_ID,
+	[SLURMDB_JOB_COL_HET_JOB_OFFSET] = JOB_REQ_HET_JOB_OFFSET,
+	[SLURMDB_JOB_COL_JOBID] = JOB_REQ_JOBID,
+	[SLURMDB_JOB_COL_JOBNAME] = JOB_REQ_NAME,
+	[SLURMDB_JOB_COL_LICENSES] = JOB_REQ_LICENSES,
+	[SLURMDB_JOB_COL_MCS_LABEL] = JOB_REQ_MCS_LABEL,
+	[SLURMDB_JOB_COL_NODES] = JOB_REQ_NODELIST,
+	[SLURMDB_JOB_COL_PARTITION] = JOB_REQ_PARTITION,
+	[SLURMDB_JOB_COL_PRIORITY] = JOB_REQ_PRIORITY,
+	[SLURMDB_JOB_COL_QOSID] = JOB_REQ_QOS,
+	[SLURMDB_JOB_COL_REQ_CPUS] = JOB_REQ_REQ_CPUS,
+	[SLURMDB_JOB_COL_REQ_MEM] = JOB_REQ_REQ_MEM,
+	[SLURMDB_JOB_COL_REQUID] = JOB_REQ_KILL_REQUID,
+	[SLURMDB_JOB_COL_RESTART_CNT] = JOB_REQ_RESTART_CNT,
+	[SLURMDB_JOB_COL_RESVID] = JOB_REQ_RESVID,
+	[SLURMDB_JOB_COL_SLUID] = JOB_REQ_SLUID,
+	[SLURMDB_JOB_COL_START] = JOB_REQ_START,
+	[SLURMDB_JOB_COL_STATE] = JOB_REQ_STATE,
+	[SLURMDB_JOB_COL_STATE_REASON_PREV] = JOB_REQ_STATE_REASON,
+	[SLURMDB_JOB_COL_SUBMIT] = JOB_REQ_SUBMIT,
+	[SLURMDB_JOB_COL_SUBMIT_LINE] = JOB_REQ_SUBMIT_LINE,
+	[SLURMDB_JOB_COL_SUSPENDED] = JOB_REQ_SUSPENDED,
+	[SLURMDB_JOB_COL_SYSTEM_COMMENT] = JOB_REQ_SYSTEM_COMMENT,
+	[SLURMDB_JOB_COL_TIMELIMIT] = JOB_REQ_TIMELIMIT,
+	[SLURMDB_JOB_COL_TRES_ALLOC] = JOB_REQ_TRESA,
+	[SLURMDB_JOB_COL_TRES_REQ] = JOB_REQ_TRESR,
+	[SLURMDB_JOB_COL_UID] = JOB_REQ_UID,
+	[SLURMDB_JOB_COL_USER] = JOB_REQ_USER_NAME,
+	[SLURMDB_JOB_COL_WCKEY] = JOB_REQ_WCKEY,
+	[SLURMDB_JOB_COL_WCKEYID] = JOB_REQ_WCKEYID,
+	[SLURMDB_JOB_COL_WORK_DIR] = JOB_REQ_WORK_DIR,
+};
+
 /* if this changes you will need to edit the corresponding
  * enum below also t1 is step_table */
 char *step_req_inx[] = {
@@ -517,13 +577,75 @@ static void _destroy_local_cluster(void *object)
 	}
 }
 
+/* Does the caller only get to see their own jobs (and coordinated ones)? */
+static bool _job_cond_is_private(slurmdb_job_cond_t *job_cond, bool is_admin)
+{
+	return (!is_admin && ((slurm_conf.private_data & PRIVATE_DATA_JOBS) ||
+			      (job_cond->flags & JOBCOND_FLAG_SCRIPT) ||
+			      (job_cond->flags & JOBCOND_FLAG_ENV)));
+}
+
+/*
+ * This is here to make sure we are looking at only this user if this flag is
+ * set.  We also include any accounts they may be coordinator of.
+ *
+ * This clause must be kept in sync with the access check in
+ * _job_cond_access_check(). The association table must be joined as t2.
+ */
+static void _setup_job_privacy_cond(slurmdb_user_rec_t *user,
+				    slurmdb_job_cond_t *job_cond,
+				    bool is_admin, char **extra)
+{
+	char *prefix = "t2";
+
+	if (!_job_cond_is_private(job_cond, is_admin))
+		return;
+
+	if (!*extra)
+		xstrcat(*extra, " where ");
+	else
+		xstrcat(*extra, " and ");
+	xstrfmtcat(*extra, "((%s.lineage like '%%/0-%s/%%')",
+		   prefix, user->name);
+	if (!(slurmdbd_conf->flags & DBD_CONF_FLAG_DISABLE_COORD_DBD) &&
+	    user->coord_accts && list_count(user->coord_accts)) {
+		slurmdb_coord_rec_t *coord = NULL;
+		list_itr_t *itr = list_iterator_create(user->coord_accts);
+		while ((coord = list_next(itr))) {
+			xstrfmtcat(*extra,
+				   " or (%s.lineage like '%%/%s/%%')",
+				   prefix, coord->name);
+		}
+		list_iterator_destroy(itr);
+	}
+	xstrcatchar(*extra, ')');
+}
+
+/* Rows of the job table to get at a time when streaming jobs */
+#define JOB_PAGE_ROWS 1000
+
+/* Where the next page of a cluster's jobs starts */
+typedef struct {
+	int comb_id; /* duplicate removal state carried between pages */
+	bool done; /* no jobs are left after the last page */
+	int last_id; /* duplicate removal state carried between pages */
+	uint32_t next_job_id; /* lowest id_job of the next page */
+	uint32_t rows; /* max rows of the job table to get for a page */
+} job_page_t;
+
+/*
+ * If page is set only get the jobs of the next page. A page always holds all
+ * the rows of a job id so duplicates can be removed the same way as without
+ * pages.
+ */
 static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 			     slurmdb_user_rec_t *user,
 			     slurmdb_job_cond_t *job_cond,
 			     char *cluster_name,
 			     char *job_fields, char *step_fields,
 			     char *sent_extra,
-			     bool is_admin, int only_pending, list_t *sent_list)
+			     bool is_admin, int only_pending,
+			     job_page_t *page, list_t *sent_list)
 {
 	char *query = NULL;
 	char *extra = xstrdup(sent_extra);
@@ -536,43 +658,20 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	list_itr_t *itr = NULL, *itr2 = NULL;
 	list_t *local_cluster_list = NULL;
 	int set = 0;
-	char *prefix="t2";
 	int rc = SLURM_SUCCESS;
 	int last_id = -1, curr_id = -1;
 	int comb_id = 0;
+	int page_end_id = -1;
 	local_cluster_t *curr_cluster = NULL;
 	bool jobid_filtered = false;
 
-	/* This is here to make sure we are looking at only this user
-	 * if this flag is set.  We also include any accounts they may be
-	 * coordinator of.
-	 *
-	 * This clause must be kept in sync with the access check in
-	 * as_mysql_jobacct_process_get_jobs().
-	 */
-	if (!is_admin && ((slurm_conf.private_data & PRIVATE_DATA_JOBS) ||
-			  (job_cond->flags & JOBCOND_FLAG_SCRIPT) ||
-			  (job_cond->flags & JOBCOND_FLAG_ENV))) {
-		if (!extra)
-			xstrcat(extra, " where ");
-		else
-			xstrcat(extra, " and ");
-		xstrfmtcat(extra, "((%s.lineage like '%%/0-%s/%%')",
-			   prefix, user->name);
-		if (!(slurmdbd_conf->flags & DBD_CONF_FLAG_DISABLE_COORD_DBD) &&
-		    user->coord_accts && list_count(user->coord_accts)) {
-			slurmdb_coord_rec_t *coord = NULL;
-			itr = list_iterator_create(user->coord_accts);
-			while ((coord = list_next(itr))) {
-				xstrfmtcat(extra,
-					   " or (%s.lineage like '%%/%s/%%')",
-					   prefix, coord->name);
-			}
-			list_iterator_destroy(itr);
-		}
-		xstrcatchar(extra, ')');
+	if (page) {
+		last_id = page->last_id;
+		comb_id = page->comb_id;
 	}
 
+	_setup_job_privacy_cond(user, job_cond, is_admin, &extra);
+
 	setup_job_cluster_cond_limits(mysql_conn, job_cond,
 				      cluster_name, &extra);
 
@@ -612,6 +711,15 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 			xstrcat(extra, " where (t1.time_end=0)");
 	}
 
+	if (page) {
+		if (extra)
+			xstrfmtcat(extra, " and (t1.id_job>=%u)",
+				   page->next_job_id);
+		else
+			xstrfmtcat(extra, " where (t1.id_job>=%u)",
+				   page->next_job_id);
+	}
+
 	if (extra) {
 		xstrcat(query, extra);
 		xfree(extra);
@@ -625,6 +733,9 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	*/
 	xstrcat(query, " order by id_job, time_submit desc");
 
+	if (page)
+		xstrfmtcat(query, " limit %u", page->rows);
+
 	DB_DEBUG(DB_JOB, mysql_conn->conn, "query\n%s", query);
 	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
 		xfree(query);
@@ -633,6 +744,33 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	}
 	xfree(query);
 
+	if (page) {
+		uint64_t row_cnt = mysql_num_rows(result);
+
+		if (row_cnt < page->rows) {
+			page->done = true;
+		} else {
+			/*
+			 * The rows of the last job id could go on past the
+			 * limit, leave that job id for the next page.
+			 */
+			mysql_data_seek(result, row_cnt - 1);
+			row = mysql_fetch_row(result);
+			page_end_id = slurm_atoul(row[JOB_REQ_JOBID]);
+			mysql_data_seek(result, 0);
+			row = mysql_fetch_row(result);
+			mysql_data_seek(result, 0);
+
+			if (slurm_atoul(row[JOB_REQ_JOBID]) == page_end_id) {
+				/* One job id fills the page, try a bigger one */
+				page->rows *= 2;
+				mysql_free_result(result);
+				goto end_it;
+			}
+			page->next_job_id = page_end_id;
+		}
+	}
+
 
 	/* Here we set up environment to check used nodes of jobs.
 	   Since we store the bitmap of the entire cluster we can use
@@ -658,6 +796,8 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 		int hetjob = slurm_atoul(row[JOB_REQ_HET_JOB_ID]);
 
 		curr_id = slurm_atoul(row[JOB_REQ_JOBID]);
+		if (curr_id == page_end_id)
+			break;
 		if (job_cond && !(job_cond->flags & JOBCOND_FLAG_DUP)) {
 			if ((curr_id == last_id) &&
 			    (slurm_atoul(row[JOB_REQ_STATE]) != JOB_RESIZING))
@@ -1208,6 +1348,11 @@ end_it:
 
 	FREE_NULL_LIST(local_cluster_list);
 
+	if (page) {
+		page->last_id = last_id;
+		page->comb_id = comb_id;
+	}
+
 	if (rc == SLURM_SUCCESS)
 		list_transfer(sent_list, job_list);
 
@@ -1215,6 +1360,239 @@ end_it:
 	return rc;
 }
 
+#define NUM_COL(col, val)						\
+do {									\
+	if (columns->num[col])						\
+		columns->num[col][inx] = (val);				\
+} while (0)
+
+#define STR_COL(col, val)						\
+do {									\
+	if (columns->str[col])						\
+		columns->str[col][inx] = xstrdup(val);			\
+} while (0)
+
+/*
+ * Same as the job part of _cluster_get_jobs() but only for the requested
+ * columns and without building a slurmdb_job_rec_t per row.
+ * JOBCOND_FLAG_NO_TRUNC and JOBCOND_FLAG_NO_STEP are implied.
+ */
+static void _set_job_columns(slurmdb_job_columns_t *columns, uint32_t inx,
+			     MYSQL_ROW row, time_t now)
+{
+	uint32_t state = slurm_atoul(row[JOB_REQ_STATE]);
+	uint32_t array_job_id = slurm_atoul(row[JOB_REQ_ARRAYJOBID]);
+	uint32_t array_task_id = slurm_atoul(row[JOB_REQ_ARRAYTASKID]);
+	uint32_t het_job_id = slurm_atoul(row[JOB_REQ_HET_JOB_ID]);
+	uint32_t het_job_offset = slurm_atoul(row[JOB_REQ_HET_JOB_OFFSET]);
+	uint32_t flags = slurm_atoul(row[JOB_REQ_FLAGS]);
+	uint32_t suspended = slurm_atoul(row[JOB_REQ_SUSPENDED]);
+	time_t start = slurm_atoul(row[JOB_REQ_START]);
+	time_t end = slurm_atoul(row[JOB_REQ_END]);
+	int elapsed;
+
+	/* See _cluster_get_jobs() for why these are needed */
+	if (!array_job_id && !array_task_id)
+		array_task_id = NO_VAL;
+	if (!het_job_id && !het_job_offset)
+		het_job_offset = NO_VAL;
+
+	if (end && (start > end))
+		start = end;
+
+	if (state == JOB_SUSPENDED)
+		suspended = now - suspended;
+	if (!start)
+		elapsed = 0;
+	else if (!end)
+		elapsed = now - start;
+	else
+		elapsed = end - start;
+	elapsed -= suspended;
+	if (elapsed < 0)
+		elapsed = 0;
+
+	if (!start && end && (flags & SLURMDB_JOB_FLAG_START_R))
+		start = NO_VAL;
+
+	if (row[JOB_REQ_ACCOUNT] && row[JOB_REQ_ACCOUNT][0])
+		STR_COL(SLURMDB_JOB_COL_ACCOUNT, row[JOB_REQ_ACCOUNT]);
+	else if (row[JOB_REQ_ACCOUNT1] && row[JOB_REQ_ACCOUNT1][0])
+		STR_COL(SLURMDB_JOB_COL_ACCOUNT, row[JOB_REQ_ACCOUNT1]);
+	STR_COL(SLURMDB_JOB_COL_ADMIN_COMMENT, row[JOB_REQ_ADMIN_COMMENT]);
+	NUM_COL(SLURMDB_JOB_COL_ALLOC_NODES,
+		slurm_atoul(row[JOB_REQ_ALLOC_NODES]));
+	NUM_COL(SLURMDB_JOB_COL_ARRAY_JOB_ID, array_job_id);
+	NUM_COL(SLURMDB_JOB_COL_ARRAY_MAX_TASKS,
+		slurm_atoul(row[JOB_REQ_ARRAY_MAX]));
+	NUM_COL(SLURMDB_JOB_COL_ARRAY_TASK_ID, array_task_id);
+	if (row[JOB_REQ_ARRAY_STR] && row[JOB_REQ_ARRAY_STR][0])
+		STR_COL(SLURMDB_JOB_COL_ARRAY_TASK_STR,
+			row[JOB_REQ_ARRAY_STR]);
+	NUM_COL(SLURMDB_JOB_COL_ASSOCID, slurm_atoul(row[JOB_REQ_ASSOCID]));
+	STR_COL(SLURMDB_JOB_COL_CONSTRAINTS, row[JOB_REQ_CONSTRAINTS]);
+	STR_COL(SLURMDB_JOB_COL_CONTAINER, row[JOB_REQ_CONTAINER]);
+	NUM_COL(SLURMDB_JOB_COL_DB_INDEX, slurm_atoull(row[JOB_REQ_DB_INX]));
+	NUM_COL(SLURMDB_JOB_COL_DERIVED_EC,
+		slurm_atoul(row[JOB_REQ_DERIVED_EC]));
+	STR_COL(SLURMDB_JOB_COL_DERIVED_ES, row[JOB_REQ_DERIVED_ES]);
+	NUM_COL(SLURMDB_JOB_COL_ELAPSED, elapsed);
+	NUM_COL(SLURMDB_JOB_COL_ELIGIBLE, slurm_atoul(row[JOB_REQ_ELIGIBLE]));
+	NUM_COL(SLURMDB_JOB_COL_END, end);
+	NUM_COL(SLURMDB_JOB_COL_EXITCODE, slurm_atoul(row[JOB_REQ_EXIT_CODE]));
+	STR_COL(SLURMDB_JOB_COL_EXTRA, row[JOB_REQ_EXTRA]);
+	STR_COL(SLURMDB_JOB_COL_FAILED_NODE, row[JOB_REQ_FAILED_NODE]);
+	NUM_COL(SLURMDB_JOB_COL_FLAGS, flags);
+	NUM_COL(SLURMDB_JOB_COL_GID, slurm_atoul(row[JOB_REQ_GID]));
+	NUM_COL(SLURMDB_JOB_COL_HET_JOB_ID, het_job_id);
+	NUM_COL(SLURMDB_JOB_COL_HET_JOB_OFFSET, het_job_offset);
+	NUM_COL(SLURMDB_JOB_COL_JOBID, slurm_atoul(row[JOB_REQ_JOBID]));
+	STR_COL(SLURMDB_JOB_COL_JOBNAME, row[JOB_REQ_NAME]);
+	STR_COL(SLURMDB_JOB_COL_LICENSES, row[JOB_REQ_LICENSES]);
+	/* we want a blank mcs_label and wckey if the name is null */
+	STR_COL(SLURMDB_JOB_COL_MCS_LABEL,
+		row[JOB_REQ_MCS_LABEL] ? row[JOB_REQ_MCS_LABEL] : "");
+	if (!row[JOB_REQ_NODELIST] || !xstrcmp(row[JOB_REQ_NODELIST], "(null)"))
+		STR_COL(SLURMDB_JOB_COL_NODES, "(unknown)");
+	else
+		STR_COL(SLURMDB_JOB_COL_NODES, row[JOB_REQ_NODELIST]);
+	STR_COL(SLURMDB_JOB_COL_PARTITION, row[JOB_REQ_PARTITION]);
+	NUM_COL(SLURMDB_JOB_COL_PRIORITY, slurm_atoul(row[JOB_REQ_PRIORITY]));
+	NUM_COL(SLURMDB_JOB_COL_QOSID, slurm_atoul(row[JOB_REQ_QOS]));
+	NUM_COL(SLURMDB_JOB_COL_REQ_CPUS, slurm_atoul(row[JOB_REQ_REQ_CPUS]));
+	NUM_COL(SLURMDB_JOB_COL_REQ_MEM, slurm_atoull(row[JOB_REQ_REQ_MEM]));
+	NUM_COL(SLURMDB_JOB_COL_REQUID,
+		row[JOB_REQ_KILL_REQUID] ?
+		slurm_atoul(row[JOB_REQ_KILL_REQUID]) : INFINITE);
+	NUM_COL(SLURMDB_JOB_COL_RESTART_CNT,
+		slurm_atoul(row[JOB_REQ_RESTART_CNT]));
+	NUM_COL(SLURMDB_JOB_COL_RESVID, slurm_atoul(row[JOB_REQ_RESVID]));
+	NUM_COL(SLURMDB_JOB_COL_SLUID, slurm_atoull(row[JOB_REQ_SLUID]));
+	NUM_COL(SLURMDB_JOB_COL_START, start);
+	NUM_COL(SLURMDB_JOB_COL_STATE, state);
+	NUM_COL(SLURMDB_JOB_COL_STATE_REASON_PREV,
+		slurm_atoul(row[JOB_REQ_STATE_REASON]));
+	NUM_COL(SLURMDB_JOB_COL_SUBMIT, slurm_atoul(row[JOB_REQ_SUBMIT]));
+	STR_COL(SLURMDB_JOB_COL_SUBMIT_LINE, row[JOB_REQ_SUBMIT_LINE]);
+	NUM_COL(SLURMDB_JOB_COL_SUSPENDED, suspended);
+	STR_COL(SLURMDB_JOB_COL_SYSTEM_COMMENT, row[JOB_REQ_SYSTEM_COMMENT]);
+	NUM_COL(SLURMDB_JOB_COL_TIMELIMIT, slurm_atoul(row[JOB_REQ_TIMELIMIT]));
+	STR_COL(SLURMDB_JOB_COL_TRES_ALLOC, row[JOB_REQ_TRESA]);
+	STR_COL(SLURMDB_JOB_COL_TRES_REQ, row[JOB_REQ_TRESR]);
+	if (row[JOB_REQ_UID])
+		NUM_COL(SLURMDB_JOB_COL_UID, slurm_atoul(row[JOB_REQ_UID]));
+	STR_COL(SLURMDB_JOB_COL_USER, row[JOB_REQ_USER_NAME]);
+	STR_COL(SLURMDB_JOB_COL_WCKEY,
+		row[JOB_REQ_WCKEY] ? row[JOB_REQ_WCKEY] : "");
+	NUM_COL(SLURMDB_JOB_COL_WCKEYID, slurm_atoul(row[JOB_REQ_WCKEYID]));
+	STR_COL(SLURMDB_JOB_COL_WORK_DIR, row[JOB_REQ_WORK_DIR]);
+}
+
+#undef NUM_COL
+#undef STR_COL
+
+static int _cluster_get_job_columns(mysql_conn_t *mysql_conn,
+				    slurmdb_user_rec_t *user,
+				    slurmdb_job_cond_t *job_cond,
+				    char *cluster_name, char *job_fields,
+				    char *sent_extra, bool is_admin,
+				    bool join_assoc, bool *cols,
+				    list_t *sent_list)
+{
+	char *query = NULL;
+	char *extra = xstrdup(sent_extra);
+	MYSQL_RES *result = NULL;
+	MYSQL_ROW row;
+	time_t now = time(NULL);
+	list_t *local_cluster_list = NULL;
+	local_cluster_t *curr_cluster = NULL;
+	slurmdb_job_columns_t *columns;
+	int last_id = -1, curr_id = -1;
+	int comb_id = 0;
+	bool jobid_filtered = (job_cond->step_list != NULL);
+
+	_setup_job_privacy_cond(user, job_cond, is_admin, &extra);
+	if (_job_cond_is_private(job_cond, is_admin))
+		join_assoc = true;
+
+	setup_job_cluster_cond_limits(mysql_conn, job_cond,
+				      cluster_name, &extra);
+
+	/*
+	 * Only the association table is ever needed here, the reservation
+	 * and script/env tables only feed fields that can't be requested.
+	 */
+	query = xstrdup_printf("select %s from \"%s_%s\" as t1",
+			       job_fields, cluster_name, job_table);
+	if (join_assoc)
+		xstrfmtcat(query,
+			   " left join \"%s_%s\" as t2 "
+			   "on t1.id_assoc=t2.id_assoc",
+			   cluster_name, assoc_table);
+	if (extra) {
+		xstrcat(query, extra);
+		xfree(extra);
+	}
+	xstrcat(query, " order by id_job, time_submit desc");
+
+	DB_DEBUG(DB_JOB, mysql_conn->conn, "query\n%s", query);
+	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+		xfree(query);
+		return SLURM_ERROR;
+	}
+	xfree(query);
+
+	if (job_cond->used_nodes) {
+		local_cluster_list = setup_cluster_list_with_inx(
+			mysql_conn, job_cond, (void **)&curr_cluster);
+		if (!local_cluster_list) {
+			mysql_free_result(result);
+			return SLURM_ERROR;
+		}
+	}
+
+	columns = slurmdb_create_job_columns(cluster_name, cols,
+					     mysql_num_rows(result));
+
+	while ((row = mysql_fetch_row(result))) {
+		int arrayjob = slurm_atoul(row[JOB_REQ_ARRAYJOBID]);
+		int hetjob = slurm_atoul(row[JOB_REQ_HET_JOB_ID]);
+
+		/* Same duplicate removal as _cluster_get_jobs() */
+		curr_id = slurm_atoul(row[JOB_REQ_JOBID]);
+		if (!(job_cond->flags & JOBCOND_FLAG_DUP)) {
+			if ((curr_id == last_id) &&
+			    (slurm_atoul(row[JOB_REQ_STATE]) != JOB_RESIZING))
+				continue;
+			if (jobid_filtered) {
+				if ((last_id != hetjob) &&
+				    (last_id != arrayjob)) {
+					comb_id = arrayjob + hetjob;
+				} else if (comb_id != (arrayjob + hetjob))
+					continue;
+			}
+		}
+
+		if (!good_nodes_from_inx(local_cluster_list,
+					 (void **)&curr_cluster,
+					 row[JOB_REQ_NODE_INX],
+					 slurm_atoul(row[JOB_REQ_START]))) {
+			last_id = curr_id;
+			continue;
+		}
+		last_id = curr_id;
+
+		_set_job_columns(columns, columns->rec_cnt++, row, now);
+	}
+	mysql_free_result(result);
+
+	FREE_NULL_LIST(local_cluster_list);
+
+	list_append(sent_list, columns);
+
+	return SLURM_SUCCESS;
+}
+
 extern list_t *setup_cluster_list_with_inx(mysql_conn_t *mysql_conn,
 					   slurmdb_job_cond_t *job_cond,
 					   void **curr_cluster)
@@ -1777,16 +2155,50 @@ extern int setup_job_cond_limits(slurmdb_job_cond_t *job_cond,
 	return set;
 }
 
-extern list_t *as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
-					         uid_t uid,
-					         slurmdb_job_cond_t *job_cond)
+/*
+ * This clause must be kept in sync with the access check in
+ * _setup_job_privacy_cond().
+ */
+static int _job_cond_access_check(mysql_conn_t *mysql_conn,
+				  slurmdb_job_cond_t *job_cond,
+				  slurmdb_user_rec_t *user, bool *is_admin)
+{
+	*is_admin = true;
+
+	if ((slurm_conf.private_data & PRIVATE_DATA_JOBS) ||
+	    (job_cond->flags & JOBCOND_FLAG_SCRIPT) ||
+	    (job_cond->flags & JOBCOND_FLAG_ENV)) {
+		if (!(*is_admin = is_user_min_admin_level(
+			      mysql_conn, user->uid, SLURMDB_ADMIN_OPERATOR))) {
+			/*
+			 * Only fill in the coordinator accounts here we will
+			 * check them later when we actually try to get the jobs
+			 */
+			(void) is_user_any_coord(mysql_conn, user);
+		}
+		if (!*is_admin && !user->name) {
+			debug("User %u has no associations, and is not admin, "
+			      "so not returning any jobs.", user->uid);
+			return ESLURM_ACCESS_DENIED;
+		}
+	}
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Get the jobs matching job_cond. If callback is set the jobs are handed to it
+ * a page at a time, otherwise they are all put in job_list.
+ */
+static int _get_jobs(mysql_conn_t *mysql_conn, uid_t uid,
+		     slurmdb_job_cond_t *job_cond, list_t *job_list,
+		     jobacct_storage_jobs_f callback, void *arg)
 {
 	char *extra = NULL;
 	char *tmp = NULL, *tmp2 = NULL;
 	list_itr_t *itr = NULL;
-	int is_admin=1;
-	int i;
-	list_t *job_list = NULL;
+	bool is_admin = true;
+	int i, rc;
 	slurmdb_user_rec_t user;
 	int only_pending = 0;
 	list_t *use_cluster_list = NULL;
@@ -1799,27 +2211,9 @@ extern list_t *as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	memset(&user, 0, sizeof(slurmdb_user_rec_t));
 	user.uid = uid;
 
-	/*
-	 * This clause must be kept in sync with the access check in
-	 * _cluster_get_jobs().
-	 */
-	if ((slurm_conf.private_data & PRIVATE_DATA_JOBS) ||
-	    (job_cond->flags & JOBCOND_FLAG_SCRIPT) ||
-	    (job_cond->flags & JOBCOND_FLAG_ENV)) {
-		if (!(is_admin = is_user_min_admin_level(
-			      mysql_conn, uid, SLURMDB_ADMIN_OPERATOR))) {
-			/*
-			 * Only fill in the coordinator accounts here we will
-			 * check them later when we actually try to get the jobs
-			 */
-			(void) is_user_any_coord(mysql_conn, &user);
-		}
-		if (!is_admin && !user.name) {
-			debug("User %u has no associations, and is not admin, "
-			      "so not returning any jobs.", user.uid);
-			return NULL;
-		}
-	}
+	if ((rc = _job_cond_access_check(mysql_conn, job_cond, &user,
+					 &is_admin)) != SLURM_SUCCESS)
+		return rc;
 
 	if (job_cond
 	    && job_cond->state_list && (list_count(job_cond->state_list) == 1)
@@ -1839,7 +2233,7 @@ extern list_t *as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 		if (reason) {
 			error("User %u is requesting %s, but no job requested, this is not allowed",
 			      user.uid, reason);
-			return NULL;
+			return ESLURM_ACCESS_DENIED;
 		}
 	}
 
@@ -1873,23 +2267,65 @@ extern list_t *as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 		locked = true;
 	}
 
-	assoc_mgr_lock(&locks);
+	if (!callback)
+		assoc_mgr_lock(&locks);
 
-	job_list = list_create(slurmdb_destroy_job_rec);
 	itr = list_iterator_create(use_cluster_list);
 	while ((cluster_name = list_next(itr))) {
-		int rc;
+		job_page_t page = {
+			.last_id = -1,
+			.rows = JOB_PAGE_ROWS,
+		};
+
 		_setup_job_cond_selected_steps(job_cond, cluster_name, &extra);
-		if ((rc = _cluster_get_jobs(mysql_conn, &user, job_cond,
-					    cluster_name, tmp, tmp2, extra,
-					    is_admin, only_pending, job_list))
-		    != SLURM_SUCCESS)
-			error("Problem getting jobs for cluster %s",
-			      cluster_name);
+
+		if (!callback) {
+			if (_cluster_get_jobs(mysql_conn, &user, job_cond,
+					      cluster_name, tmp, tmp2, extra,
+					      is_admin, only_pending, NULL,
+					      job_list) != SLURM_SUCCESS)
+				error("Problem getting jobs for cluster %s",
+				      cluster_name);
+			continue;
+		}
+
+		/*
+		 * Only hold the lock while getting a page, the callback could
+		 * be sending the page to a slow client.
+		 */
+		while (!page.done) {
+			list_t *page_list =
+				list_create(slurmdb_destroy_job_rec);
+
+			assoc_mgr_lock(&locks);
+			rc = _cluster_get_jobs(mysql_conn, &user, job_cond,
+					       cluster_name, tmp, tmp2, extra,
+					       is_admin, only_pending, &page,
+					       page_list);
+			assoc_mgr_unlock(&locks);
+
+			if (rc != SLURM_SUCCESS) {
+				error("Problem getting jobs for cluster %s",
+				      cluster_name);
+				rc = SLURM_SUCCESS;
+				FREE_NULL_LIST(page_list);
+				break;
+			}
+
+			if (list_count(page_list))
+				rc = (callback)(page_list, arg);
+			FREE_NULL_LIST(page_list);
+			if (rc != SLURM_SUCCESS)
+				break;
+		}
+		/* Nobody is listening anymore */
+		if (rc != SLURM_SUCCESS)
+			break;
 	}
 	list_iterator_destroy(itr);
 
-	assoc_mgr_unlock(&locks);
+	if (!callback)
+		assoc_mgr_unlock(&locks);
 
 	if (locked) {
 		FREE_NULL_LIST(use_cluster_list);
@@ -1900,5 +2336,136 @@ extern list_t *as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	xfree(tmp2);
 	xfree(extra);
 
+	return rc;
+}
+
+extern list_t *as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
+					         uid_t uid,
+					         slurmdb_job_cond_t *job_cond)
+{
+	list_t *job_list = list_create(slurmdb_destroy_job_rec);
+
+	if (_get_jobs(mysql_conn, uid, job_cond, job_list, NULL, NULL) !=
+	    SLURM_SUCCESS)
+		FREE_NULL_LIST(job_list);
+
 	return job_list;
 }
+
+extern int as_mysql_jobacct_process_get_jobs_stream(
+	mysql_conn_t *mysql_conn, uid_t uid, slurmdb_job_cond_t *job_cond,
+	jobacct_storage_jobs_f callback, void *arg)
+{
+	return _get_jobs(mysql_conn, uid, job_cond, NULL, callback, arg);
+}
+
+extern list_t *as_mysql_jobacct_process_get_jobs_columns(
+	mysql_conn_t *mysql_conn, uid_t uid, slurmdb_job_cond_t *job_cond)
+{
+	char *extra = NULL, *fields = NULL, *name;
+	list_itr_t *itr = NULL;
+	bool is_admin = true, join_assoc;
+	bool cols[SLURMDB_JOB_COL_CNT] = { 0 };
+	bool req[JOB_REQ_COUNT] = { 0 };
+	list_t *col_list = NULL;
+	slurmdb_user_rec_t user = { .uid = uid };
+	list_t *use_cluster_list = NULL;
+	char *cluster_name;
+	bool locked = false;
+
+	if (!job_cond || !job_cond->format_list ||
+	    !list_count(job_cond->format_list)) {
+		error("%s: no columns requested", __func__);
+		return NULL;
+	}
+
+	/* Only what sacct -X asks for is handled here */
+	if (!(job_cond->flags & JOBCOND_FLAG_NO_STEP) ||
+	    !(job_cond->flags & JOBCOND_FLAG_NO_TRUNC) ||
+	    (job_cond->flags & (JOBCOND_FLAG_RUNAWAY | JOBCOND_FLAG_SCRIPT |
+				JOBCOND_FLAG_ENV))) {
+		error("%s: job condition flags 0x%x not supported",
+		      __func__, job_cond->flags);
+		return NULL;
+	}
+
+	itr = list_iterator_create(job_cond->format_list);
+	while ((name = list_next(itr))) {
+		slurmdb_job_col_t col = str_2_slurmdb_job_col(name);
+
+		if (col == SLURMDB_JOB_COL_CNT) {
+			debug("%s: unknown column %s requested",
+			      __func__, name);
+			break;
+		}
+		cols[col] = true;
+		req[job_col_req_inx[col]] = true;
+	}
+	list_iterator_destroy(itr);
+	if (name)
+		return NULL;
+
+	if (_job_cond_access_check(mysql_conn, job_cond, &user, &is_admin) !=
+	    SLURM_SUCCESS)
+		return NULL;
+
+	/* Needed for duplicate removal and derived columns */
+	req[JOB_REQ_ARRAYJOBID] = true;
+	req[JOB_REQ_ARRAYTASKID] = true;
+	req[JOB_REQ_DB_INX] = true;
+	req[JOB_REQ_END] = true;
+	req[JOB_REQ_FLAGS] = true;
+	req[JOB_REQ_HET_JOB_ID] = true;
+	req[JOB_REQ_HET_JOB_OFFSET] = true;
+	req[JOB_REQ_JOBID] = true;
+	req[JOB_REQ_START] = true;
+	req[JOB_REQ_STATE] = true;
+	req[JOB_REQ_SUSPENDED] = true;
+	if (job_cond->used_nodes)
+		req[JOB_REQ_NODE_INX] = true;
+	if (cols[SLURMDB_JOB_COL_ACCOUNT])
+		req[JOB_REQ_ACCOUNT1] = true;
+
+	join_assoc = req[JOB_REQ_ACCOUNT] || req[JOB_REQ_USER_NAME];
+
+	/*
+	 * Keep the row layout of job_req_inx so the JOB_REQ_* indexes can be
+	 * used, anything not requested is left blank.
+	 */
+	for (int i = 0; i < JOB_REQ_COUNT; i++)
+		xstrfmtcat(fields, "%s%s", i ? ", " : "",
+			   req[i] ? job_req_inx[i] : "''");
+
+	setup_job_cond_limits(job_cond, &extra);
+
+	if (job_cond->cluster_list && list_count(job_cond->cluster_list))
+		use_cluster_list = job_cond->cluster_list;
+	else {
+		slurm_rwlock_rdlock(&as_mysql_cluster_list_lock);
+		use_cluster_list = list_shallow_copy(as_mysql_cluster_list);
+		locked = true;
+	}
+
+	col_list = list_create(slurmdb_destroy_job_columns);
+	itr = list_iterator_create(use_cluster_list);
+	while ((cluster_name = list_next(itr))) {
+		_setup_job_cond_selected_steps(job_cond, cluster_name, &extra);
+		if (_cluster_get_job_columns(mysql_conn, &user, job_cond,
+					     cluster_name, fields, extra,
+					     is_admin, join_assoc, cols,
+					     col_list) != SLURM_SUCCESS)
+			error("Problem getting jobs for cluster %s",
+			      cluster_name);
+	}
+	list_iterator_destroy(itr);
+
+	if (locked) {
+		FREE_NULL_LIST(use_cluster_list);
+		slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
+	}
+
+	xfree(fields);
+	xfree(extra);
+
+	return col_list;
+}
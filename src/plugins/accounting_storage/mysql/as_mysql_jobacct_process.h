@@ -61,4 +61,11 @@ extern list_t *as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 						 uid_t uid,
 						 slurmdb_job_cond_t *job_cond);
 
+extern list_t *as_mysql_jobacct_process_get_jobs_columns(
+	mysql_conn_t *mysql_conn, uid_t uid, slurmdb_job_cond_t *job_cond);
+
+extern int as_mysql_jobacct_process_get_jobs_stream(
+	mysql_conn_t *mysql_conn, uid_t uid, slurmdb_job_cond_t *job_cond,
+	jobacct_storage_jobs_f callback, void *arg);
+
 #endif
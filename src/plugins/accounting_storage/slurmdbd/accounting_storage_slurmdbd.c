@@ -2953,6 +2953,120 @@ extern list_t *jobacct_storage_p_get_jobs_cond(void *db_conn, uid_t uid,
 	return my_job_list;
 }
 
+/*
+ * get info from the storage as it is read by the slurmdbd
+ * callback is called with a list of job_rec_t * for each chunk received
+ */
+extern int jobacct_storage_p_get_jobs_stream(void *db_conn, uid_t uid,
+					     slurmdb_job_cond_t *job_cond,
+					     jobacct_storage_jobs_f callback,
+					     void *arg)
+{
+	persist_conn_t *pc = db_conn;
+	persist_msg_t req = {0}, resp = {0};
+	dbd_cond_msg_t get_msg = {
+		.cond = job_cond,
+	};
+	dbd_list_msg_t *got_msg;
+	int rc, cb_rc = SLURM_SUCCESS;
+	bool last = false;
+
+	/* The agent owns the connection in the slurmctld */
+	if (running_in_slurmctld() || !pc ||
+	    (pc->version < SLURM_26_11_PROTOCOL_VERSION))
+		return ESLURM_NOT_SUPPORTED;
+
+	req.msg_type = DBD_GET_JOBS_STREAM;
+	req.pcon = pc;
+	req.data = &get_msg;
+	rc = dbd_conn_send_recv_direct(SLURM_PROTOCOL_VERSION, &req, &resp);
+
+	while ((rc == SLURM_SUCCESS) && !last) {
+		if (resp.msg_type == PERSIST_RC) {
+			persist_rc_msg_t *msg = resp.data;
+
+			if ((rc = msg->rc))
+				error("%s", msg->comment);
+			slurm_persist_free_rc_msg(msg);
+			break;
+		} else if ((resp.msg_type != DBD_GOT_JOBS_CHUNK) &&
+			   (resp.msg_type != DBD_GOT_JOBS)) {
+			error("response type not DBD_GOT_JOBS_CHUNK: %u",
+			      resp.msg_type);
+			rc = SLURM_ERROR;
+			break;
+		}
+
+		last = (resp.msg_type == DBD_GOT_JOBS);
+		got_msg = resp.data;
+		/*
+		 * Keep reading after the callback fails so the rest of the
+		 * response isn't left on the connection.
+		 */
+		if (!cb_rc && got_msg->my_list && list_count(got_msg->my_list))
+			cb_rc = (callback)(got_msg->my_list, arg);
+		slurmdbd_free_list_msg(got_msg);
+
+		if (!last) {
+			memset(&resp, 0, sizeof(resp));
+			rc = dbd_conn_recv_direct(SLURM_PROTOCOL_VERSION, pc,
+						  &resp);
+		}
+	}
+
+	return rc ? rc : cb_rc;
+}
+
+/*
+ * get a projection of job info from the storage
+ * returns list of slurmdb_job_columns_t *
+ * note list needs to be freed when called
+ */
+extern list_t *jobacct_storage_p_get_jobs_columns(void *db_conn, uid_t uid,
+						  slurmdb_job_cond_t *job_cond)
+{
+	persist_msg_t req = {0}, resp = {0};
+	dbd_cond_msg_t get_msg = {
+		.cond = job_cond,
+	};
+	dbd_list_msg_t *got_msg;
+	int rc;
+	list_t *my_list = NULL;
+
+	req.msg_type = DBD_GET_JOBS_COLUMNS;
+	req.pcon = db_conn;
+	req.data = &get_msg;
+	rc = dbd_conn_send_recv(SLURM_PROTOCOL_VERSION, &req, &resp);
+
+	if (rc != SLURM_SUCCESS)
+		error("DBD_GET_JOBS_COLUMNS failure: %s", slurm_strerror(rc));
+	else if (resp.msg_type == PERSIST_RC) {
+		persist_rc_msg_t *msg = resp.data;
+		if (msg->rc == SLURM_SUCCESS) {
+			info("%s", msg->comment);
+			my_list = list_create(NULL);
+		} else {
+			errno = msg->rc;
+			debug("%s", msg->comment);
+		}
+		slurm_persist_free_rc_msg(msg);
+	} else if (resp.msg_type != DBD_GOT_JOBS_COLUMNS) {
+		error("response type not DBD_GOT_JOBS_COLUMNS: %u",
+		      resp.msg_type);
+	} else {
+		got_msg = (dbd_list_msg_t *) resp.data;
+		my_list = got_msg->my_list;
+		got_msg->my_list = NULL;
+		if (!my_list) {
+			errno = got_msg->return_code;
+			error("%s", slurm_strerror(got_msg->return_code));
+		}
+		slurmdbd_free_list_msg(got_msg);
+	}
+
+	return my_list;
+}
+
 /*
  * Expire old info from the storage
  * Not applicable for any database
@@ -55,6 +55,7 @@
 #include "src/common/uid.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
+#include "src/interfaces/auth.h"
 #include "src/interfaces/serializer.h"
 #include "src/plugins/auth/common/auth_common.h"
 
@@ -91,6 +92,12 @@ typedef struct auth_token_s {
 	char *username;
 } auth_token_t;
 
+/* Claims of a verified token kept in the auth verified token cache */
+typedef struct {
+	char *username;
+	identity_t *id;
+} token_claims_t;
+
 static auth_context_t rpc_ctxt = { 0 };
 static char *token = NULL;
 static __thread char *thread_token = NULL;
@@ -351,10 +358,31 @@ static data_for_each_cmd_t _verify_rs256_jwt(data_t *d, void *arg)
 	return DATA_FOR_EACH_STOP;
 }
 
-static void _handle_identity(jwt_t *jwt, auth_token_t *cred)
+static void _token_claims_free(void *x)
+{
+	token_claims_t *claims = x;
+
+	if (!claims)
+		return;
+
+	xfree(claims->username);
+	FREE_NULL_IDENTITY(claims->id);
+	xfree(claims);
+}
+
+static void _token_claims_copy(void *data, void *arg)
+{
+	token_claims_t *claims = data, *copy = arg;
+
+	copy->username = xstrdup(claims->username);
+	copy->id = copy_identity(claims->id);
+}
+
+static identity_t *_extract_identity(jwt_t *jwt)
 {
 	char *jwt_json = NULL;
 	data_t *jwt_data = NULL;
+	identity_t *id = NULL;
 
 	/* Get JWT payload as JSON and parse to data_t */
 	if (!(jwt_json = jwt_get_grants_json(jwt, NULL))) {
@@ -368,83 +396,112 @@ static void _handle_identity(jwt_t *jwt, auth_token_t *cred)
 		goto fail;
 	}
 
-	cred->id = auth_common_extract_identity_from_data(jwt_data);
+	id = auth_common_extract_identity_from_data(jwt_data);
 
-	if (cred->id) {
-		if (cred->username &&
-		    xstrcmp(cred->username, cred->id->pw_name)) {
-			error("%s: cannot override identity for %s with requested user %s",
-			      __func__, cred->id->pw_name, cred->username);
-			FREE_NULL_IDENTITY(cred->id);
-			goto fail;
-		}
+fail:
+	if (jwt_json)
+		free(jwt_json);
+	FREE_NULL_DATA(jwt_data);
+	return id;
+}
+
+static void _handle_identity(identity_t *id, auth_token_t *cred)
+{
+	if (!id)
+		return;
 
-		/* Store extracted identity information */
-		xfree(cred->username);
-		cred->username = xstrdup(cred->id->pw_name);
+	if (cred->username && xstrcmp(cred->username, id->pw_name)) {
+		error("%s: cannot override identity for %s with requested user %s",
+		      __func__, id->pw_name, cred->username);
+		return;
+	}
 
-		cred->uid = cred->id->uid;
-		cred->gid = cred->id->gid;
-		cred->ids_set = true;
+	/* Store extracted identity information */
+	cred->id = copy_identity(id);
+	xfree(cred->username);
+	cred->username = xstrdup(cred->id->pw_name);
 
-		/* Set assoc_mgr entry */
-		if (running_in_slurmctld() || running_in_slurmdbd())
-			assoc_mgr_set_uid(cred->uid, cred->username);
+	cred->uid = cred->id->uid;
+	cred->gid = cred->id->gid;
+	cred->ids_set = true;
 
-		debug("%s: successfully resolved identity for user %s from JWT claims",
-		      __func__, cred->username);
-	}
+	/* Set assoc_mgr entry */
+	if (running_in_slurmctld() || running_in_slurmdbd())
+		assoc_mgr_set_uid(cred->uid, cred->username);
 
-fail:
-	if (jwt_json)
-		free(jwt_json);
-	FREE_NULL_DATA(jwt_data);
+	debug("%s: successfully resolved identity for user %s from JWT claims",
+	      __func__, cred->username);
 }
 
 /*
- * Retrieve and set the username. Allows for the username to be overridden
- * for SlurmUser/root tokens so slurmrestd can issue RPCs under other
- * accounts.
+ * 'sun' is preferred if available
+ * 'username' is used otherwise
  */
-static int _handle_username(auth_context_t *ctxt, jwt_t *jwt,
-			    auth_token_t *cred)
+static char *_extract_username(auth_context_t *ctxt, jwt_t *jwt)
 {
 	char *username = NULL;
 
-	/*
-	 * 'sun' is preferred if available
-	 * 'username' is used otherwise
-	 */
 	if (!(username = xstrdup(jwt_get_grant(jwt, "sun"))) &&
 	    !(username = xstrdup(jwt_get_grant(jwt, "username"))) &&
-	    (!ctxt->claim_field ||
-	     !(username = xstrdup(jwt_get_grant(jwt, ctxt->claim_field))))) {
+	    ctxt->claim_field)
+		username = xstrdup(jwt_get_grant(jwt, ctxt->claim_field));
+
+	return username;
+}
+
+/*
+ * Set the username from the token. Allows for the username to be overridden
+ * for SlurmUser/root tokens so slurmrestd can issue RPCs under other
+ * accounts.
+ */
+static int _handle_username(const char *username, auth_token_t *cred)
+{
+	uid_t uid = NO_VAL;
+
+	if (!username) {
 		error("%s: jwt_get_grant failure", __func__);
 		return SLURM_ERROR;
 	}
 
 	if (!cred->username) {
-		cred->username = username;
-	} else if (!xstrcmp(cred->username, username)) {
-		/* if they match, ignore it, they were being redundant */
-		xfree(username);
-	} else {
-		uid_t uid = NO_VAL;
-		if (uid_from_string(username, &uid)) {
-			error("%s: uid_from_string failure", __func__);
-			xfree(username);
-			return SLURM_ERROR;
-		}
-		if ((uid != 0) && (slurm_conf.slurm_user_id != uid)) {
-			error("%s: attempt to authenticate as alternate user %s from non-SlurmUser %s",
-			      __func__, username, cred->username);
-			xfree(username);
-			return SLURM_ERROR;
-		}
-		/* use the packed username instead of the token value */
-		xfree(username);
+		cred->username = xstrdup(username);
+		return SLURM_SUCCESS;
+	}
+
+	/* if they match, ignore it, they were being redundant */
+	if (!xstrcmp(cred->username, username))
+		return SLURM_SUCCESS;
+
+	if (uid_from_string(username, &uid)) {
+		error("%s: uid_from_string failure", __func__);
+		return SLURM_ERROR;
+	}
+	if ((uid != 0) && (slurm_conf.slurm_user_id != uid)) {
+		error("%s: attempt to authenticate as alternate user %s from non-SlurmUser %s",
+		      __func__, username, cred->username);
+		return SLURM_ERROR;
+	}
+
+	/* use the packed username instead of the token value */
+	return SLURM_SUCCESS;
+}
+
+/* Apply the claims of a verified token to cred */
+static int _handle_claims(auth_context_t *ctxt, token_claims_t *claims,
+			  auth_token_t *cred)
+{
+	if (ctxt->use_client_ids)
+		_handle_identity(claims->id, cred);
+
+	if (!cred->id && ctxt->use_client_ids_only) {
+		error("%s: failed to retrieve required identity", __func__);
+		return SLURM_ERROR;
 	}
 
+	if (!cred->id && _handle_username(claims->username, cred))
+		return SLURM_ERROR;
+
+	cred->verified = true;
 	return SLURM_SUCCESS;
 }
 
@@ -454,7 +511,8 @@ extern int cred_verify(auth_context_t *ctxt, auth_token_t *cred)
 	const char *alg;
 	data_t *jwt_header = NULL;
 	jwt_t *jwt = NULL;
-	char *username = NULL;
+	token_claims_t *claims = NULL;
+	time_t expires;
 
 	if (!cred)
 		return SLURM_ERROR;
@@ -473,6 +531,19 @@ extern int cred_verify(auth_context_t *ctxt, auth_token_t *cred)
 		goto fail;
 	}
 
+	/* Clients send the same token with every RPC */
+	if (ctxt == &rpc_ctxt) {
+		token_claims_t cached = { 0 };
+
+		if (auth_cache_find(plugin_id, cred->token, _token_claims_copy,
+				    &cached)) {
+			rc = _handle_claims(ctxt, &cached, cred);
+			xfree(cached.username);
+			FREE_NULL_IDENTITY(cached.id);
+			return rc ? auth_rc : SLURM_SUCCESS;
+		}
+	}
+
 	if (!(jwt_header = auth_common_extract_jwt_header(cred->token))) {
 		error("%s: initial jwt_decode failure", __func__);
 		goto fail;
@@ -534,33 +605,36 @@ extern int cred_verify(auth_context_t *ctxt, auth_token_t *cred)
 	 * check the expiration, and extract identity using auth/common
 	 */
 
-	if (jwt_get_grant_int(jwt, "exp") < time(NULL)) {
+	if ((expires = jwt_get_grant_int(jwt, "exp")) < time(NULL)) {
 		error("%s: token expired", __func__);
 		auth_rc = ESLURM_AUTH_EXPIRED;
 		goto fail;
 	}
 
+	claims = xmalloc(sizeof(*claims));
 	if (ctxt->use_client_ids)
-		_handle_identity(jwt, cred);
+		claims->id = _extract_identity(jwt);
+	claims->username = _extract_username(ctxt, jwt);
 
-	if (!cred->id && ctxt->use_client_ids_only) {
-		error("%s: failed to retrieve required identity", __func__);
-		goto fail;
-	}
+	jwt_free(jwt);
+	jwt = NULL;
 
-	if (!cred->id && _handle_username(ctxt, jwt, cred))
+	if (_handle_claims(ctxt, claims, cred))
 		goto fail;
 
-	jwt_free(jwt);
-	jwt = NULL;
-	cred->verified = true;
+	if (ctxt == &rpc_ctxt)
+		auth_cache_add(plugin_id, cred->token, expires, claims,
+			       _token_claims_free);
+	else
+		_token_claims_free(claims);
+
 	return SLURM_SUCCESS;
 
 fail:
 	FREE_NULL_DATA(jwt_header);
 	if (jwt)
 		jwt_free(jwt);
-	xfree(username);
+	_token_claims_free(claims);
 	return auth_rc;
 }
 
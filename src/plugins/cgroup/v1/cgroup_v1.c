@@ -1554,6 +1554,17 @@ extern int cgroup_p_task_addto(cgroup_ctl_type_t sub, stepd_step_rec_t *step,
 	return _handle_task_cgroup(sub, step, pid, task_id);
 }
 
+/* Tasks are spread over one hierarchy per controller, so they are forked */
+extern int cgroup_p_task_open(uint32_t task_id)
+{
+	return SLURM_ERROR;
+}
+
+extern int cgroup_p_task_spawned(pid_t pid, uint32_t task_id)
+{
+	return ESLURM_NOT_SUPPORTED;
+}
+
 extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t taskid)
 {
 	char *cpu_time = NULL, *memory_stat = NULL, *ptr;
@@ -1595,6 +1606,8 @@ extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t taskid)
 	stats->total_rss = NO_VAL64;
 	stats->total_pgmajfault = NO_VAL64;
 	stats->total_vmem = NO_VAL64;
+	stats->total_io_read = NO_VAL64;
+	stats->total_io_write = NO_VAL64;
 	stats->memory_peak = INFINITE64; /* As required in common_jag.c */
 
 	if (common_cgroup_get_param(task_cpuacct_cg, "cpuacct.stat", &cpu_time,
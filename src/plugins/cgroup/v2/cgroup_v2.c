@@ -58,6 +58,7 @@
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 #include "src/common/daemonize.h"
+#include "src/interfaces/jobacct_gather.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmd/slurmd/slurmd.h"
 #include "src/plugins/cgroup/common/cgroup_common.h"
@@ -69,6 +70,12 @@
 #define SYSTEM_CGDIR "system"
 #define SLURMD_CGROUP "slurmd"
 
+/* Tasks stalled on memory for 150ms within a 1s window */
+#define MEM_PSI_TRIGGER "some 150000 1000000"
+
+/* Least time between two accounting polls caused by memory events */
+#define MEM_EVENT_POLL_INTERVAL ((timespec_t) { .tv_sec = 1 })
+
 /* Required Slurm plugin symbols: */
 const char plugin_name[] = "Cgroup v2 plugin";
 const char plugin_type[] = "cgroup/v2";
@@ -102,8 +109,28 @@ typedef struct {
 	xcgroup_t task_cg;
 	uint32_t taskid;
 	bpf_program_t p;
+	uint64_t oom_kill_cnt; /* oom_kill events already reported */
+	pid_t last_pid; /* last pid moved into task_cg */
+	pid_t spawned_pid; /* pid cloned straight into task_cg */
 } task_cg_info_t;
 
+typedef struct {
+	uint64_t high;
+	uint64_t max;
+	uint64_t oom;
+	uint64_t oom_kill;
+} mem_events_t;
+
+typedef struct {
+	int inotify_fd;
+	int psi_fd;
+	stepd_step_rec_t *step;
+} mem_event_args_t;
+
+static pthread_t mem_event_thread;
+static int mem_event_pipe[2] = { -1, -1 };
+static bool mem_event_step_terminated = false;
+
 typedef struct {
 	int npids;
 	pid_t *pids;
@@ -689,6 +716,15 @@ static int _find_task_cg_info(void *x, void *key)
 	return 0;
 }
 
+static int _find_spawned_pid(void *x, void *key)
+{
+	task_cg_info_t *task_cg_info = x;
+	pid_t pid = *(pid_t *) key;
+
+	return ((task_cg_info->taskid != task_special_id) &&
+		(task_cg_info->spawned_pid == pid));
+}
+
 static void _free_task_cg_info(void *x)
 {
 	task_cg_info_t *task_cg = (task_cg_info_t *)x;
@@ -1805,6 +1841,7 @@ extern void fini(void)
 	 * we may not be stopping yet. When the process terminates systemd will
 	 * remove the remaining directories.
 	 */
+	_stop_mem_event_monitor();
 	FREE_NULL_BITMAP(int_cg_ns.avail_controllers);
 	common_cgroup_destroy(&int_cg[CG_LEVEL_SYSTEM]);
 	common_cgroup_destroy(&int_cg[CG_LEVEL_ROOT]);
@@ -2061,6 +2098,9 @@ extern int cgroup_p_step_addto(cgroup_ctl_type_t ctl, pid_t *pids, int npids)
 		/* Ignore any possible movement of slurmstepd */
 		if (pids[i] == stepd_pid)
 			continue;
+		/* Tasks spawned into their own cgroup stay there */
+		if (list_find_first(task_list, _find_spawned_pid, &pids[i]))
+			continue;
 		if (cgroup_p_task_addto(ctl, NULL, pids[i],
 					task_special_id) != SLURM_SUCCESS)
 			rc = SLURM_ERROR;
@@ -2688,6 +2728,263 @@ fail:
 	return NULL;
 }
 
+/*
+ * Memory event monitor: wait for the kernel to notify changes in the step's
+ * memory.events (and memory pressure when OverMemoryKill is used) and react
+ * right away instead of at the end of the step or at the next accounting
+ * poll.
+ */
+static uint64_t _mem_event_value(char *buf, const char *name)
+{
+	uint64_t value = 0;
+	size_t len = strlen(name);
+	char *ptr = buf;
+
+	while (ptr && *ptr) {
+		if (!strncmp(ptr, name, len) && (ptr[len] == ' ')) {
+			if (sscanf(ptr + len + 1, "%"PRIu64, &value) != 1)
+				value = 0;
+			break;
+		}
+		if ((ptr = xstrchr(ptr, '\n')))
+			ptr++;
+	}
+
+	return value;
+}
+
+static void _read_mem_events(xcgroup_t *cg, mem_events_t *events)
+{
+	char *buf = NULL;
+	size_t sz;
+
+	memset(events, 0, sizeof(*events));
+
+	if (common_cgroup_get_param(cg, "memory.events", &buf, &sz) !=
+	    SLURM_SUCCESS)
+		return;
+
+	events->high = _mem_event_value(buf, "high");
+	events->max = _mem_event_value(buf, "max");
+	events->oom = _mem_event_value(buf, "oom");
+	events->oom_kill = _mem_event_value(buf, "oom_kill");
+	xfree(buf);
+}
+
+static int _attribute_oom_kill(void *x, void *arg)
+{
+	task_cg_info_t *task_cg_info = x;
+	stepd_step_rec_t *step = arg;
+	mem_events_t events;
+	uint64_t kills;
+
+	_read_mem_events(&task_cg_info->task_cg, &events);
+	if (events.oom_kill <= task_cg_info->oom_kill_cnt)
+		return 0;
+
+	kills = events.oom_kill - task_cg_info->oom_kill_cnt;
+	task_cg_info->oom_kill_cnt = events.oom_kill;
+
+	if (task_cg_info->taskid == task_special_id)
+		error("%ps: %"PRIu64" process%s outside of the tasks OOM killed",
+		      &step->step_id, kills, (kills == 1) ? "" : "es");
+	else
+		error("%ps: %"PRIu64" process%s of task %u OOM killed",
+		      &step->step_id, kills, (kills == 1) ? "" : "es",
+		      task_cg_info->taskid);
+
+	return 0;
+}
+
+static int _open_psi_trigger(xcgroup_t *cg)
+{
+	char *path = NULL;
+	int fd;
+
+	xstrfmtcat(path, "%s/memory.pressure", cg->path);
+	if ((fd = open(path, (O_RDWR | O_NONBLOCK | O_CLOEXEC))) < 0) {
+		log_flag(CGROUP, "Cannot open %s: %m", path);
+	} else if (write(fd, MEM_PSI_TRIGGER, strlen(MEM_PSI_TRIGGER) + 1) <
+		   0) {
+		log_flag(CGROUP, "Cannot set trigger in %s: %m", path);
+		close(fd);
+		fd = -1;
+	}
+	xfree(path);
+
+	return fd;
+}
+
+static void *_mem_event_monitor(void *x)
+{
+	mem_event_args_t *args = x;
+	stepd_step_rec_t *step = args->step;
+	xcgroup_t *cg = &int_cg[CG_LEVEL_STEP_USER];
+	mem_events_t last, cur;
+	struct pollfd fds[3];
+	timespec_t last_poll = { 0 };
+	bool poll_acct = false;
+	char buf[sizeof(struct inotify_event) + NAME_MAX + 1];
+
+	debug("started.");
+
+	fds[0].fd = mem_event_pipe[0];
+	fds[0].events = POLLIN;
+	fds[1].fd = args->inotify_fd;
+	fds[1].events = POLLIN;
+	/* PSI triggers are signaled with POLLPRI, negative fds are ignored */
+	fds[2].fd = args->psi_fd;
+	fds[2].events = POLLPRI;
+
+	_read_mem_events(cg, &last);
+
+	while (1) {
+		int timeout = -1;
+
+		/* An event came in too soon after the last poll, wait for it */
+		if (poll_acct) {
+			timespec_diff_ns_t wait = timespec_diff_ns(
+				timespec_add(last_poll, MEM_EVENT_POLL_INTERVAL),
+				timespec_now());
+
+			timeout = wait.after ? (timespec_to_msec(wait.diff) + 1) :
+				0;
+		}
+
+		if (poll(fds, 3, timeout) < 0) {
+			if (errno == EINTR)
+				continue;
+			error("poll(): %m");
+			break;
+		}
+
+		/* Stop message or the write end was closed */
+		if (fds[0].revents)
+			break;
+
+		if (fds[1].revents & POLLIN) {
+			/* Only the fact memory.events changed matters */
+			while (read(args->inotify_fd, buf, sizeof(buf)) > 0)
+				;
+
+			_read_mem_events(cg, &cur);
+
+			if (cur.oom_kill > last.oom_kill) {
+				list_for_each(task_list, _attribute_oom_kill,
+					      step);
+				/*
+				 * Terminate a multinode step now rather than
+				 * when the tasks of this node are done.
+				 */
+				if (step->oom_kill_step &&
+				    !mem_event_step_terminated) {
+					slurm_terminate_job_step(
+						&step->step_id);
+					mem_event_step_terminated = true;
+				}
+			}
+
+			if ((cur.high > last.high) || (cur.max > last.max) ||
+			    (cur.oom > last.oom) ||
+			    (cur.oom_kill > last.oom_kill))
+				poll_acct = true;
+			last = cur;
+		} else if (fds[1].revents) {
+			error("problem with inotify fd, not watching memory.events anymore");
+			fds[1].fd = -1;
+		}
+
+		if (fds[2].revents & POLLPRI) {
+			poll_acct = true;
+		} else if (fds[2].revents) {
+			/* The cgroup is going away */
+			fds[2].fd = -1;
+		}
+
+		/*
+		 * Update usage and enforce OverMemoryKill now, at most once
+		 * per MEM_EVENT_POLL_INTERVAL as memory.high events may fire
+		 * continuously. Events within the interval are folded into
+		 * one poll at its end.
+		 */
+		if (poll_acct &&
+		    !timespec_is_after(timespec_add(last_poll,
+						    MEM_EVENT_POLL_INTERVAL),
+				       timespec_now())) {
+			log_flag(CGROUP, "memory event in %ps, polling accounting",
+				 &step->step_id);
+			last_poll = timespec_now();
+			poll_acct = false;
+			jobacct_gather_poll_now();
+		}
+	}
+
+	close(args->inotify_fd);
+	if (args->psi_fd >= 0)
+		close(args->psi_fd);
+	close(mem_event_pipe[0]);
+	xfree(args);
+
+	debug("stopping.");
+
+	return NULL;
+}
+
+static void _start_mem_event_monitor(stepd_step_rec_t *step)
+{
+	char *path = NULL;
+	mem_event_args_t *args = xmalloc(sizeof(*args));
+
+	args->step = step;
+	args->psi_fd = -1;
+
+	xstrfmtcat(path, "%s/memory.events", int_cg[CG_LEVEL_STEP_USER].path);
+	if ((args->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0) {
+		error("Cannot initialize inotify for memory events: %m");
+		goto fail;
+	}
+	if (inotify_add_watch(args->inotify_fd, path, IN_MODIFY) < 0) {
+		error("Cannot add watch to %s: %m", path);
+		goto fail;
+	}
+
+	/* Memory pressure is only of interest to enforce OverMemoryKill */
+	if (slurm_conf.job_acct_oom_kill)
+		args->psi_fd = _open_psi_trigger(&int_cg[CG_LEVEL_STEP_USER]);
+
+	if (pipe2(mem_event_pipe, O_CLOEXEC)) {
+		error("pipe(): %m");
+		goto fail;
+	}
+
+	mem_event_step_terminated = false;
+	slurm_thread_create(NULL, &mem_event_thread, _mem_event_monitor, args);
+	xfree(path);
+	return;
+
+fail:
+	if (args->inotify_fd >= 0)
+		close(args->inotify_fd);
+	if (args->psi_fd >= 0)
+		close(args->psi_fd);
+	xfree(args);
+	xfree(path);
+}
+
+static void _stop_mem_event_monitor(void)
+{
+	char c = 1;
+
+	if (mem_event_pipe[1] < 0)
+		return;
+
+	if (write(mem_event_pipe[1], &c, sizeof(c)) != sizeof(c))
+		error("%s: write: %m", __func__);
+	slurm_thread_join(mem_event_thread);
+	close(mem_event_pipe[1]);
+	mem_event_pipe[0] = mem_event_pipe[1] = -1;
+}
+
 extern int cgroup_p_step_start_oom_mgr(stepd_step_rec_t *step)
 {
 	/* Only set the memory.oom.group if needed. */
@@ -2702,6 +2999,10 @@ extern int cgroup_p_step_start_oom_mgr(stepd_step_rec_t *step)
 			}
 		}
 	}
+
+	if (bit_test(int_cg_ns.avail_controllers, CG_MEMORY))
+		_start_mem_event_monitor(step);
+
 	return SLURM_SUCCESS;
 }
 
@@ -2714,6 +3015,8 @@ extern cgroup_oom_t *cgroup_p_step_stop_oom_mgr(stepd_step_rec_t *step)
 	if (!bit_test(int_cg_ns.avail_controllers, CG_MEMORY))
 		return NULL;
 
+	_stop_mem_event_monitor();
+
 	_get_memory_events(&job_kills, &step_kills);
 
 	if (cgroup_p_has_feature(CG_MEMCG_SWAP))
@@ -2729,26 +3032,18 @@ extern cgroup_oom_t *cgroup_p_step_stop_oom_mgr(stepd_step_rec_t *step)
 	oom_step_results->oom_kill_cnt = step_kills;
 	oom_step_results->step_mem_failcnt = step_kills;
 	oom_step_results->step_memsw_failcnt = step_swkills;
+	oom_step_results->step_terminated = mem_event_step_terminated;
 
 	return oom_step_results;
 }
 
-extern int cgroup_p_task_addto(cgroup_ctl_type_t ctl, stepd_step_rec_t *step,
-			       pid_t pid, uint32_t task_id)
+/* Find the cgroup of a task, creating it the first time */
+static task_cg_info_t *_get_task_cg_info(uint32_t task_id)
 {
 	task_cg_info_t *task_cg_info;
 	char *task_cg_path = NULL;
 	bool need_to_add = false;
 
-	/* Ignore any possible movement of slurmstepd */
-	if (pid == getpid())
-		return SLURM_SUCCESS;
-
-	if (task_id == task_special_id)
-		log_flag(CGROUP, "Starting task_special cgroup accounting");
-	else
-		log_flag(CGROUP, "Starting task %u cgroup accounting", task_id);
-
 	/* Let's be sure this task is not already created. */
 	if (!(task_cg_info = list_find_first(task_list, _find_task_cg_info,
 					     &task_id))) {
@@ -2775,7 +3070,7 @@ extern int cgroup_p_task_addto(cgroup_ctl_type_t ctl, stepd_step_rec_t *step,
 				      task_id);
 			xfree(task_cg_info);
 			xfree(task_cg_path);
-			return SLURM_ERROR;
+			return NULL;
 		}
 		xfree(task_cg_path);
 
@@ -2788,7 +3083,7 @@ extern int cgroup_p_task_addto(cgroup_ctl_type_t ctl, stepd_step_rec_t *step,
 				      task_id);
 			common_cgroup_destroy(&task_cg_info->task_cg);
 			xfree(task_cg_info);
-			return SLURM_ERROR;
+			return NULL;
 		}
                 /* Initialize the bpf_program before appending to the list. */
 		init_ebpf_prog(&task_cg_info->p);
@@ -2797,25 +3092,125 @@ extern int cgroup_p_task_addto(cgroup_ctl_type_t ctl, stepd_step_rec_t *step,
 		list_append(task_list, task_cg_info);
 	}
 
+	return task_cg_info;
+}
+
+extern int cgroup_p_task_addto(cgroup_ctl_type_t ctl, stepd_step_rec_t *step,
+			       pid_t pid, uint32_t task_id)
+{
+	task_cg_info_t *task_cg_info;
+
+	/* Ignore any possible movement of slurmstepd */
+	if (pid == getpid())
+		return SLURM_SUCCESS;
+
+	if (task_id == task_special_id)
+		log_flag(CGROUP, "Starting task_special cgroup accounting");
+	else
+		log_flag(CGROUP, "Starting task %u cgroup accounting", task_id);
+
+	if (!(task_cg_info = _get_task_cg_info(task_id)))
+		return SLURM_ERROR;
+
+	/*
+	 * All controllers share the task cgroup in v2, so the task plugin adds
+	 * the same pid once per constrained controller. Every write to
+	 * cgroup.procs is a full migration in the kernel, so only do the first.
+	 */
+	if (task_cg_info->last_pid == pid) {
+		log_flag(CGROUP, "pid %d already in %s cg",
+			 pid, task_cg_info->task_cg.path);
+		return SLURM_SUCCESS;
+	}
+
 	/* Attach the pid to the corresponding step_x/task_y cgroup */
 	if (common_cgroup_move_process(&task_cg_info->task_cg, pid) !=
 	    SLURM_SUCCESS)
 		error("Unable to move pid %d to %s cg",
 		      pid, (task_cg_info->task_cg).path);
+	else
+		task_cg_info->last_pid = pid;
 
 	return SLURM_SUCCESS;
 }
 
+extern int cgroup_p_task_open(uint32_t task_id)
+{
+	task_cg_info_t *task_cg_info;
+	int fd;
+
+	/* The step hierarchy has not been created */
+	if (!int_cg[CG_LEVEL_STEP_USER].path)
+		return SLURM_ERROR;
+
+	if (!(task_cg_info = _get_task_cg_info(task_id)))
+		return SLURM_ERROR;
+
+	if ((fd = open(task_cg_info->task_cg.path,
+		       O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0) {
+		error("%s: open(%s): %m", __func__, task_cg_info->task_cg.path);
+		return SLURM_ERROR;
+	}
+
+	return fd;
+}
+
+extern int cgroup_p_task_spawned(pid_t pid, uint32_t task_id)
+{
+	task_cg_info_t *task_cg_info;
+
+	if (!(task_cg_info = list_find_first(task_list, _find_task_cg_info,
+					     &task_id)))
+		return SLURM_ERROR;
+
+	log_flag(CGROUP, "pid %d spawned into %s cg",
+		 pid, task_cg_info->task_cg.path);
+	task_cg_info->spawned_pid = pid;
+	task_cg_info->last_pid = pid;
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * io.stat holds one line per block device:
+ * "<major>:<minor> rbytes=<n> wbytes=<n> rios=<n> wios=<n> ..."
+ */
+static void _parse_io_stat(char *io_stat, cgroup_acct_t *stats)
+{
+	char *line = io_stat, *ptr;
+	uint64_t val;
+
+	stats->total_io_read = 0;
+	stats->total_io_write = 0;
+
+	while (line && *line) {
+		char *next = xstrchr(line, '\n');
+
+		if (next)
+			*next++ = '\0';
+
+		if ((ptr = xstrstr(line, "rbytes=")) &&
+		    (sscanf(ptr, "rbytes=%"PRIu64, &val) == 1))
+			stats->total_io_read += val;
+		if ((ptr = xstrstr(line, "wbytes=")) &&
+		    (sscanf(ptr, "wbytes=%"PRIu64, &val) == 1))
+			stats->total_io_write += val;
+
+		line = next;
+	}
+}
+
 static cgroup_acct_t *_get_acct_data(xcgroup_t *cg, char *label)
 {
 	uint64_t active_file, inactive_file;
 	char *cpu_stat = NULL, *memory_stat = NULL, *memory_current = NULL;
-	char *memory_peak = NULL;
+	char *memory_peak = NULL, *io_stat = NULL;
 	char *ptr;
 	size_t tmp_sz = 0;
 	cgroup_acct_t *stats = NULL;
 	bool no_file_cache = false;
 	static bool interfaces_checked = false, memory_peak_interface = false;
+	static bool io_stat_interface = false;
 
 	xassert(cg);
 
@@ -2833,6 +3228,7 @@ static cgroup_acct_t *_get_acct_data(xcgroup_t *cg, char *label)
 		 * old kernels might not provide it.
 		 */
 		memory_peak_interface = cgroup_p_has_feature(CG_MEMCG_PEAK);
+		io_stat_interface = cgroup_p_has_feature(CG_IO_STAT);
 		interfaces_checked = true;
 	}
 
@@ -2859,6 +3255,13 @@ static cgroup_acct_t *_get_acct_data(xcgroup_t *cg, char *label)
 		}
 	}
 
+	if (io_stat_interface) {
+		if (common_cgroup_get_param(cg, "io.stat", &io_stat,
+					    &tmp_sz) != SLURM_SUCCESS) {
+			log_flag(CGROUP, "Cannot read %s io.stat file", label);
+		}
+	}
+
 	/*
 	 * Initialize values. A NO_VAL64 will indicate the caller that something
 	 * happened here. Values that aren't set here are returned as 0.
@@ -2868,6 +3271,8 @@ static cgroup_acct_t *_get_acct_data(xcgroup_t *cg, char *label)
 	stats->ssec = NO_VAL64;
 	stats->total_rss = NO_VAL64;
 	stats->total_pgmajfault = NO_VAL64;
+	stats->total_io_read = NO_VAL64;
+	stats->total_io_write = NO_VAL64;
 	stats->memory_peak = INFINITE64; /* As required in common_jag.c */
 
 	if (cpu_stat) {
@@ -2927,6 +3332,11 @@ static cgroup_acct_t *_get_acct_data(xcgroup_t *cg, char *label)
 
 	xfree(memory_peak);
 
+	if (io_stat) {
+		_parse_io_stat(io_stat, stats);
+		xfree(io_stat);
+	}
+
 	return stats;
 }
 
@@ -3033,6 +3443,9 @@ extern bool cgroup_p_has_feature(cgroup_ctl_feature_t f)
 		if (!access(file_path, F_OK))
 			return true;
 		break;
+	case CG_IO_STAT:
+		/* io.stat needs EnableExtraControllers=io */
+		return bit_test(int_cg_ns.avail_controllers, CG_IO);
 	default:
 		break;
 	}
@@ -35,10 +35,14 @@
 
 #define _GNU_SOURCE
 
+#include <unistd.h>
+
 #include "src/common/slurm_xlator.h"
 
 #include "src/interfaces/hash.h"
 #include "src/common/log.h"
+#include "src/common/threadpool.h"
+#include "src/common/xmalloc.h"
 
 #include "src/plugins/hash/common_xkcp/KangarooTwelve.h"
 
@@ -50,8 +54,35 @@ const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 /* Required for hash plugins: */
 const uint32_t plugin_id = HASH_PLUGIN_K12;
 
+/* Must match KangarooTwelve.c */
+#define K12_CHUNK_SIZE 8192
+#define K12_CV_SIZE 32
+#define K12_RATE (1600 - (K12_CV_SIZE * 8))
+#define K12_CAPACITY (K12_CV_SIZE * 8)
+#define K12_SUFFIX_LEAF 0x0B
+#define K12_SUFFIX_FIRST 0x03
+
+/* Leaves each thread must have to be worth waking it (256 KiB) */
+#define PARALLEL_MIN_LEAVES 32
+#define PARALLEL_MAX_THREADS 8
+
+typedef struct {
+	const unsigned char *input;
+	size_t leaves;
+	unsigned char *cv;
+	int rc;
+	pthread_t tid;
+} leaves_args_t;
+
+static int max_threads = 1;
+
 extern int init(void)
 {
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (cpus > 1)
+		max_threads = MIN(cpus, PARALLEL_MAX_THREADS);
+
 	debug("%s: %s loaded", __func__, plugin_name);
 
 	return SLURM_SUCCESS;
@@ -62,12 +93,126 @@ extern void fini(void)
 	debug("%s: unloading %s", __func__, plugin_name);
 }
 
+/* Compute the chaining value of every leaf (chunk) in args */
+static void *_hash_leaves(void *arg)
+{
+	leaves_args_t *args = arg;
+	KeccakWidth1600_12rounds_SpongeInstance leaf;
+
+	for (size_t i = 0; i < args->leaves; i++) {
+		if (KeccakWidth1600_12rounds_SpongeInitialize(&leaf, K12_RATE,
+							      K12_CAPACITY) ||
+		    KeccakWidth1600_12rounds_SpongeAbsorb(
+			    &leaf, (args->input + (i * K12_CHUNK_SIZE)),
+			    K12_CHUNK_SIZE) ||
+		    KeccakWidth1600_12rounds_SpongeAbsorbLastFewBits(
+			    &leaf, K12_SUFFIX_LEAF) ||
+		    KeccakWidth1600_12rounds_SpongeSqueeze(
+			    &leaf, (args->cv + (i * K12_CV_SIZE)),
+			    K12_CV_SIZE)) {
+			args->rc = 1;
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * KangarooTwelve is a tree hash: after the first chunk every 8 KiB chunk of
+ * input is a leaf hashed on its own, and only the leaf chaining values are
+ * absorbed by the final node. Split the leaves fully inside input between
+ * threads, then let KangarooTwelve_Update() finish the tail and customization
+ * string as usual. The result is identical to KangarooTwelve().
+ *
+ * RET 0 on success, 1 on failure or -1 if input is too small to split
+ */
+static int _k12_parallel(const unsigned char *input, size_t len,
+			 unsigned char *output, size_t output_len,
+			 const unsigned char *custom, size_t cs_len)
+{
+	KangarooTwelve_Instance kt;
+	leaves_args_t args[PARALLEL_MAX_THREADS] = { { 0 } };
+	size_t leaves, offset = K12_CHUNK_SIZE;
+	unsigned char padding = K12_SUFFIX_FIRST;
+	unsigned char *cv;
+	int threads, rc = 0;
+
+	if (len < (2 * K12_CHUNK_SIZE))
+		return -1;
+	leaves = (len / K12_CHUNK_SIZE) - 1;
+	threads = MIN(max_threads, (leaves / PARALLEL_MIN_LEAVES));
+	if (threads < 2)
+		return -1;
+
+	cv = xmalloc(leaves * K12_CV_SIZE);
+	for (int i = 0; i < threads; i++) {
+		size_t first = (leaves * i) / threads;
+		size_t last = (leaves * (i + 1)) / threads;
+
+		args[i].input = input + offset + (first * K12_CHUNK_SIZE);
+		args[i].leaves = last - first;
+		args[i].cv = cv + (first * K12_CV_SIZE);
+	}
+
+	/* Calling thread takes the first share */
+	for (int i = 1; i < threads; i++)
+		slurm_thread_create(NULL, &args[i].tid, _hash_leaves, &args[i]);
+
+	/* Absorb the first chunk in the final node meanwhile */
+	if (KangarooTwelve_Initialize(&kt, output_len) ||
+	    KangarooTwelve_Update(&kt, input, K12_CHUNK_SIZE))
+		rc = 1;
+
+	_hash_leaves(&args[0]);
+	rc |= args[0].rc;
+
+	for (int i = 1; i < threads; i++) {
+		slurm_thread_join(args[i].tid);
+		rc |= args[i].rc;
+	}
+
+	if (rc)
+		goto done;
+
+	/* Close the first chunk as KangarooTwelve_Update() would */
+	if (KeccakWidth1600_12rounds_SpongeAbsorb(&kt.finalNode, &padding, 1)) {
+		rc = 1;
+		goto done;
+	}
+	kt.finalNode.byteIOIndex = (kt.finalNode.byteIOIndex + 7) & ~7;
+	kt.queueAbsorbedLen = 0;
+	kt.blockNumber = 1;
+
+	if (KeccakWidth1600_12rounds_SpongeAbsorb(&kt.finalNode, cv,
+						  (leaves * K12_CV_SIZE))) {
+		rc = 1;
+		goto done;
+	}
+	kt.blockNumber += leaves;
+	offset += leaves * K12_CHUNK_SIZE;
+
+	if (KangarooTwelve_Update(&kt, (input + offset), (len - offset)) ||
+	    KangarooTwelve_Final(&kt, output, custom, cs_len))
+		rc = 1;
+
+done:
+	xfree(cv);
+	return rc;
+}
+
 extern int hash_p_compute(char *input, int len, char *custom_str, int cs_len,
 			   slurm_hash_t *hash)
 {
-	if (KangarooTwelve((unsigned char *) input, len, hash->hash,
-			   sizeof(hash->hash), (unsigned char *) custom_str,
-			   cs_len))
+	int rc;
+
+	if ((rc = _k12_parallel((unsigned char *) input, len, hash->hash,
+				sizeof(hash->hash),
+				(unsigned char *) custom_str, cs_len)) < 0)
+		rc = KangarooTwelve((unsigned char *) input, len, hash->hash,
+				    sizeof(hash->hash),
+				    (unsigned char *) custom_str, cs_len);
+	if (rc)
 		return -1;
 
 	hash->type = HASH_PLUGIN_K12;
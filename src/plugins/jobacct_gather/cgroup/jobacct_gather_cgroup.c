@@ -47,6 +47,7 @@
 #include "src/interfaces/acct_gather_energy.h"
 #include "src/common/xstring.h"
 #include "src/interfaces/cgroup.h"
+#include "src/interfaces/gpu.h"
 #include "src/interfaces/proctrack.h"
 #include "src/slurmd/common/xcpuinfo.h"
 #include "src/slurmd/slurmd/slurmd.h"
@@ -58,6 +59,59 @@ const char plugin_type[] = "jobacct_gather/cgroup";
 const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 
 static bool is_first_task = true;
+static int task_pids_only = -1;
+
+/*
+ * The cgroup/v2 task counters include every process of the task, so unless
+ * something still needs per process data only the task pids are read from
+ * /proc. Otherwise every pid of the step is read on each poll. Disk I/O is
+ * only counted by the cgroup when the io controller is available.
+ */
+static bool _task_pids_only(void)
+{
+	char *type = slurm_cgroup_conf.cgroup_plugin;
+	int gpumem_pos = -1, gpuutil_pos = -1;
+
+	if (task_pids_only != -1)
+		return task_pids_only;
+
+	task_pids_only = 0;
+
+	if (xstrcasestr(slurm_conf.job_acct_gather_params, "ProcScan"))
+		return false;
+
+	if (!xstrcmp(type, "autodetect"))
+		type = autodetect_cgroup_version();
+	if (xstrcmp(type, "cgroup/v2"))
+		return false;
+
+	if (!cgroup_g_has_feature(CG_IO_STAT)) {
+		log_flag(JAG, "io controller not available, reading all the processes of the step");
+		return false;
+	}
+
+	/* GPU usage can only be read per process */
+	if (!xstrcasestr(slurm_conf.job_acct_gather_params, "DisableGPUAcct"))
+		gpu_get_tres_pos(&gpumem_pos, &gpuutil_pos);
+	if ((gpumem_pos != -1) || (gpuutil_pos != -1)) {
+		log_flag(JAG, "GPU usage is tracked, reading all the processes of the step");
+		return false;
+	}
+
+	log_flag(JAG, "using cgroup counters, reading only the task processes");
+	task_pids_only = 1;
+	return true;
+}
+
+static void _stop_task_pids_only(uint32_t taskid)
+{
+	if (task_pids_only != 1)
+		return;
+
+	verbose("Incomplete cgroup accounting data for task %u, reading all the processes of the step from now on",
+		taskid);
+	task_pids_only = 0;
+}
 
 static void _prec_extra(jag_prec_t *prec, uint32_t taskid)
 {
@@ -67,6 +121,7 @@ static void _prec_extra(jag_prec_t *prec, uint32_t taskid)
 
 	if (!cgroup_acct_data) {
 		error("Cannot get cgroup accounting data for %d", taskid);
+		_stop_task_pids_only(taskid);
 		return;
 	}
 
@@ -75,6 +130,7 @@ static void _prec_extra(jag_prec_t *prec, uint32_t taskid)
 	    cgroup_acct_data->ssec == NO_VAL64) {
 		debug2("failed to collect cgroup cpu stats pid %d ppid %d",
 		       prec->pid, prec->ppid);
+		_stop_task_pids_only(taskid);
 	} else {
 		prec->usec = cgroup_acct_data->usec;
 		prec->ssec = cgroup_acct_data->ssec;
@@ -85,6 +141,7 @@ static void _prec_extra(jag_prec_t *prec, uint32_t taskid)
 	    cgroup_acct_data->total_vmem == NO_VAL64) {
 		debug2("failed to collect cgroup memory stats pid %d ppid %d",
 		       prec->pid, prec->ppid);
+		_stop_task_pids_only(taskid);
 	} else {
 		/*
 		 * This number represents the amount of "dirty" private memory
@@ -127,6 +184,18 @@ static void _prec_extra(jag_prec_t *prec, uint32_t taskid)
 			cgroup_acct_data->memory_peak;
 	}
 
+	/*
+	 * /proc/<pid>/io was only read for the task pid, so the block I/O of
+	 * the whole task cgroup is better than that.
+	 */
+	if ((task_pids_only == 1) &&
+	    (cgroup_acct_data->total_io_read != NO_VAL64)) {
+		prec->tres_data[TRES_ARRAY_FS_DISK].size_read =
+			cgroup_acct_data->total_io_read;
+		prec->tres_data[TRES_ARRAY_FS_DISK].size_write =
+			cgroup_acct_data->total_io_write;
+	}
+
 	xfree(cgroup_acct_data);
 	return;
 }
@@ -199,6 +268,7 @@ extern void jobacct_gather_p_poll_data(list_t *task_list, uint64_t cont_id,
 		memset(&callbacks, 0, sizeof(jag_callbacks_t));
 		first = 0;
 		callbacks.prec_extra = _prec_extra;
+		callbacks.task_pids_only = _task_pids_only;
 	}
 
 	jag_common_poll_data(task_list, cont_id, &callbacks, profile);
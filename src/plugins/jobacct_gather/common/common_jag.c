@@ -49,6 +49,7 @@
 #include "src/interfaces/jobacct_gather.h"
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_defs.h"
+#include "src/common/timers.h"
 #include "src/interfaces/acct_gather_energy.h"
 #include "src/interfaces/acct_gather_filesystem.h"
 #include "src/interfaces/acct_gather_interconnect.h"
@@ -77,6 +78,11 @@ list_t *prec_list = NULL;
 static int my_pagesize = 0;
 static int energy_profile = ENERGY_DATA_NODE_ENERGY_UP;
 
+/* Cost of jag_common_poll_data() */
+static uint64_t poll_cnt = 0;
+static uint64_t poll_usec_tot = 0;
+static uint64_t poll_usec_max = 0;
+
 static int _find_prec(void *x, void *key)
 {
 	jag_prec_t *prec = (jag_prec_t *) x;
@@ -648,6 +654,25 @@ static int _mark_as_completed(void *x, void *empty)
 	return SLURM_SUCCESS;
 }
 
+static void _get_task_pids(list_t *task_list, pid_t **pids, int *npids)
+{
+	struct jobacctinfo *jobacct;
+	list_itr_t *itr;
+
+	*pids = xcalloc(list_count(task_list), sizeof(**pids));
+	*npids = 0;
+
+	itr = list_iterator_create(task_list);
+	while ((jobacct = list_next(itr))) {
+		if (jobacct->pid)
+			(*pids)[(*npids)++] = jobacct->pid;
+	}
+	list_iterator_destroy(itr);
+
+	if (!*npids)
+		xfree(*pids);
+}
+
 static list_t *_get_precs(list_t *task_list, uint64_t cont_id,
 			  jag_callbacks_t *callbacks)
 {
@@ -669,8 +694,14 @@ static list_t *_get_precs(list_t *task_list, uint64_t cont_id,
 	 */
 	list_for_each(prec_list, _mark_as_completed, NULL);
 
-	/* get only the processes in the proctrack container */
-	proctrack_g_get_pids(cont_id, &pids, &npids);
+	/*
+	 * get only the processes in the proctrack container, or only the
+	 * tasks themselves if the plugin gets the data for their offspring
+	 */
+	if (callbacks->task_pids_only && (*(callbacks->task_pids_only))())
+		_get_task_pids(task_list, &pids, &npids);
+	else
+		proctrack_g_get_pids(cont_id, &pids, &npids);
 	if (npids) {
 		for (int i = 0; i < npids; i++) {
 			_handle_stats(pids[i], callbacks,
@@ -855,6 +886,10 @@ extern void jag_common_init(long plugin_units)
 
 extern void jag_common_fini(void)
 {
+	if (poll_cnt)
+		log_flag(JAG, "%"PRIu64" polls took %"PRIu64" usec on average and %"PRIu64" usec at most",
+			 poll_cnt, (poll_usec_tot / poll_cnt), poll_usec_max);
+
 	FREE_NULL_LIST(prec_list);
 }
 
@@ -1057,6 +1092,8 @@ extern void jag_common_poll_data(list_t *task_list, uint64_t cont_id,
 	int energy_counted = 0;
 	time_t ct;
 	int i = 0;
+	uint64_t usec;
+	DEF_TIMERS;
 
 	xassert(callbacks);
 
@@ -1070,6 +1107,7 @@ extern void jag_common_poll_data(list_t *task_list, uint64_t cont_id,
 		return;
 	}
 	processing = 1;
+	START_TIMER;
 
 	if (!callbacks->get_offspring_data)
 		callbacks->get_offspring_data = _get_offspring_data;
@@ -1326,5 +1364,14 @@ extern void jag_common_poll_data(list_t *task_list, uint64_t cont_id,
 						total_job_vsize);
 
 finished:
+	END_TIMER;
+	usec = TIMER_DURATION_USEC();
+	poll_cnt++;
+	poll_usec_tot += usec;
+	poll_usec_max = MAX(poll_usec_max, usec);
+	log_flag(JAG, "gathered %d processes for %d tasks in %s",
+		 list_count(prec_list), task_list ? list_count(task_list) : 0,
+		 TIMER_STR());
+
 	processing = 0;
 }
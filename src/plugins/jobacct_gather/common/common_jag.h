@@ -61,6 +61,11 @@ typedef struct jag_callbacks {
 			      struct jag_callbacks *callbacks);
 	void (*get_offspring_data) (list_t *prec_list, jag_prec_t *ancestor,
 				    pid_t pid, jag_prec_t *permanent_ancestor);
+	/*
+	 * Return true to only read the task pids instead of every pid in the
+	 * container, when prec_extra provides data for the whole task.
+	 */
+	bool (*task_pids_only) (void);
 } jag_callbacks_t;
 
 extern void jag_common_init(long in_hertz);
@@ -40,26 +40,80 @@
 #endif
 
 #include <math.h>
+#include <pthread.h>
 #include <stdlib.h>
 
+#include "src/common/threadpool.h"
+#include "src/common/xstring.h"
+
 #include "fair_tree.h"
 
-static int  _ft_decay_apply_new_usage(job_record_t *job, time_t *start);
-static void _apply_priority_fs(void);
+/* Most threads used to calculate the subtrees of root in parallel */
+#define FT_MAX_THREADS 8
+/* Trees smaller than this are calculated in the decay thread alone */
+#define FT_MIN_PARALLEL_ASSOCS 1000
+
+/*
+ * Fair Tree is calculated on a copy of the association tree, taken under the
+ * association read lock. The write lock is only held to publish the results.
+ */
+typedef struct ft_assoc ft_assoc_t;
+
+struct ft_assoc {
+	uint32_t id;
+	char *name;		/* user or account name, only for debugging */
+	char *acct;		/* only for debugging */
+	bool user;
+	bool use_parent;	/* FairShare=parent */
+	double shares_norm;
+	long double usage_raw;
+	long double parent_usage_raw;
+	long double usage_efctv;
+	long double usage_norm;
+	long double level_fs;
+	double fs_factor;
+	ft_assoc_t **children;	/* NULL terminated, NULL if none */
+};
 
 typedef struct {
-	size_t i;
-	slurmdb_assoc_rec_t **merged;
-} append_array_args_t;
+	ft_assoc_t *assocs;
+	uint32_t assoc_cnt;
+	uint32_t assoc_max;
+	ft_assoc_t **children;	/* storage for every children array */
+	uint32_t children_cnt;
+	uint32_t children_max;
+	ft_assoc_t **top;	/* children of root */
+	long double root_usage_raw;
+	uint32_t user_assoc_cnt;
+	pthread_mutex_t lock;	/* protects next_top */
+	uint32_t next_top;	/* next child of root to calculate */
+} ft_tree_t;
+
+typedef struct {
+	ft_tree_t *tree;
+	long double parent_usage_raw;
+	ft_assoc_t **children;
+	uint32_t i;
+} ft_copy_args_t;
+
+static int  _ft_decay_apply_new_usage(job_record_t *job, time_t *start);
+static ft_tree_t *_ft_tree_create(void);
+static void _ft_tree_destroy(ft_tree_t *tree);
+static void _apply_priority_fs(ft_tree_t *tree);
+static void _publish_priority_fs(ft_tree_t *tree);
 
 /* Fair Tree code called from the decay thread loop */
 extern void fair_tree_decay(list_t *jobs, time_t start)
 {
 	slurmctld_lock_t job_write_lock =
 		{ NO_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK, NO_LOCK };
-	assoc_mgr_lock_t locks =
+	assoc_mgr_lock_t read_locks =
+		{ READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
+		  NO_LOCK, NO_LOCK, NO_LOCK };
+	assoc_mgr_lock_t write_locks =
 		{ WRITE_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
 		  NO_LOCK, NO_LOCK, NO_LOCK };
+	ft_tree_t *tree;
 
 	/* apply decayed usage */
 	lock_slurmctld(job_write_lock);
@@ -67,29 +121,184 @@ extern void fair_tree_decay(list_t *jobs, time_t start)
 	unlock_slurmctld(job_write_lock);
 
 	/* calculate fs factor for associations */
-	assoc_mgr_lock(&locks);
-	_apply_priority_fs();
-	assoc_mgr_unlock(&locks);
+	assoc_mgr_lock(&read_locks);
+	tree = _ft_tree_create();
+	assoc_mgr_unlock(&read_locks);
+
+	if (tree) {
+		_apply_priority_fs(tree);
+
+		assoc_mgr_lock(&write_locks);
+		_publish_priority_fs(tree);
+		assoc_mgr_unlock(&write_locks);
+
+		_ft_tree_destroy(tree);
+	}
 
 	/* assign job priorities */
-	lock_slurmctld(job_write_lock);
-	list_for_each(jobs, (ListForF) decay_apply_weighted_factors, &start);
-	unlock_slurmctld(job_write_lock);
+	decay_apply_weighted_factors_batched(jobs, start);
+}
+
+
+static ft_assoc_t **_ft_copy_children(ft_tree_t *tree, list_t *children,
+				      long double parent_usage_raw);
+
+static int _foreach_ft_copy_assoc(void *x, void *arg)
+{
+	slurmdb_assoc_rec_t *assoc = x;
+	ft_copy_args_t *args = arg;
+	ft_tree_t *tree = args->tree;
+	ft_assoc_t *ft_assoc;
+
+	if (tree->assoc_cnt >= tree->assoc_max) {
+		error("%s: association tree has more than %u associations",
+		      __func__, tree->assoc_max);
+		return -1;
+	}
+
+	ft_assoc = &tree->assocs[tree->assoc_cnt++];
+	ft_assoc->id = assoc->id;
+	ft_assoc->user = (assoc->user != NULL);
+	ft_assoc->use_parent = (assoc->shares_raw == SLURMDB_FS_USE_PARENT);
+	ft_assoc->shares_norm = assoc->usage->shares_norm;
+	ft_assoc->usage_raw = assoc->usage->usage_raw;
+	ft_assoc->parent_usage_raw = args->parent_usage_raw;
+
+	if (slurm_conf.debug_flags & DEBUG_FLAG_PRIO) {
+		ft_assoc->name = xstrdup(assoc->user ? assoc->user :
+					 assoc->acct);
+		ft_assoc->acct = xstrdup(assoc->acct);
+	}
+
+	args->children[args->i++] = ft_assoc;
+
+	if (!assoc->user)
+		ft_assoc->children = _ft_copy_children(
+			tree, assoc->usage->children_list,
+			assoc->usage->usage_raw);
+
+	return 0;
+}
+
+/* Copy a children list into a NULL terminated array of the tree */
+static ft_assoc_t **_ft_copy_children(ft_tree_t *tree, list_t *children,
+				      long double parent_usage_raw)
+{
+	ft_copy_args_t args = {
+		.tree = tree,
+		.parent_usage_raw = parent_usage_raw,
+	};
+	uint32_t count;
+
+	if (!children || !(count = list_count(children)))
+		return NULL;
+
+	if ((tree->children_cnt + count + 1) > tree->children_max) {
+		error("%s: association tree has more than %u children",
+		      __func__, tree->children_max);
+		return NULL;
+	}
+
+	args.children = &tree->children[tree->children_cnt];
+	tree->children_cnt += count + 1;
+
+	(void) list_for_each_ro(children, _foreach_ft_copy_assoc, &args);
+	args.children[args.i] = NULL;
+
+	return args.children;
+}
+
+/*
+ * Copy what Fair Tree needs from the association tree.
+ * Call with a READ lock on associations.
+ */
+static ft_tree_t *_ft_tree_create(void)
+{
+	ft_tree_t *tree;
+
+	if (!assoc_mgr_root_assoc || !assoc_mgr_assoc_list)
+		return NULL;
+
+	tree = xmalloc(sizeof(*tree));
+	tree->assoc_max = list_count(assoc_mgr_assoc_list);
+	tree->assocs = xcalloc(tree->assoc_max, sizeof(ft_assoc_t));
+	/* every association plus one terminator per children array */
+	tree->children_max = (tree->assoc_max * 2) + 1;
+	tree->children = xcalloc(tree->children_max, sizeof(ft_assoc_t *));
+	tree->root_usage_raw = assoc_mgr_root_assoc->usage->usage_raw;
+	tree->user_assoc_cnt = g_user_assoc_count;
+	slurm_mutex_init(&tree->lock);
+
+	tree->top = _ft_copy_children(
+		tree, assoc_mgr_root_assoc->usage->children_list,
+		tree->root_usage_raw);
+
+	return tree;
+}
+
+static void _ft_tree_destroy(ft_tree_t *tree)
+{
+	for (uint32_t i = 0; i < tree->assoc_cnt; i++) {
+		xfree(tree->assocs[i].name);
+		xfree(tree->assocs[i].acct);
+	}
+	slurm_mutex_destroy(&tree->lock);
+	xfree(tree->assocs);
+	xfree(tree->children);
+	xfree(tree);
+}
+
+
+/* Copy the results back to the associations. Call with a WRITE lock. */
+static void _publish_priority_fs(ft_tree_t *tree)
+{
+	if (!assoc_mgr_root_assoc)
+		return;
+
+	assoc_mgr_root_assoc->usage->level_fs = (long double) NO_VAL;
+
+	for (uint32_t i = 0; i < tree->assoc_cnt; i++) {
+		ft_assoc_t *ft_assoc = &tree->assocs[i];
+		slurmdb_assoc_rec_t *assoc =
+			assoc_mgr_find_assoc_id(ft_assoc->id);
+
+		/* Removed since the tree was copied */
+		if (!assoc || !assoc->usage)
+			continue;
+
+		assoc->usage->usage_efctv = ft_assoc->usage_efctv;
+		assoc->usage->usage_norm = ft_assoc->usage_norm;
+		assoc->usage->level_fs = ft_assoc->level_fs;
+		if (ft_assoc->user)
+			assoc->usage->fs_factor = ft_assoc->fs_factor;
+	}
 }
 
 
 /* In Fair Tree, usage_efctv is the normalized usage within the account */
-static void _ft_set_assoc_usage_efctv(slurmdb_assoc_rec_t *assoc)
+static void _ft_set_assoc_usage_efctv(ft_assoc_t *assoc)
 {
-	slurmdb_assoc_rec_t *parent = assoc->usage->fs_assoc_ptr;
+	if (!assoc->parent_usage_raw) {
+		assoc->usage_efctv = 0L;
+		return;
+	}
+
+	assoc->usage_efctv = assoc->usage_raw / assoc->parent_usage_raw;
+}
 
-	if (!parent || !parent->usage->usage_raw) {
-		assoc->usage->usage_efctv = 0L;
+/* Same as set_assoc_usage_norm() with the root usage from the copy */
+static void _ft_set_assoc_usage_norm(ft_tree_t *tree, ft_assoc_t *assoc)
+{
+	/* If root usage is 0, there is no usage anywhere. */
+	if (!tree->root_usage_raw) {
+		assoc->usage_norm = 0L;
 		return;
 	}
 
-	assoc->usage->usage_efctv =
-		assoc->usage->usage_raw / parent->usage->usage_raw;
+	assoc->usage_norm = assoc->usage_raw / tree->root_usage_raw;
+
+	if (assoc->usage_norm > 1L)
+		assoc->usage_norm = 1L;
 }
 
 
@@ -105,23 +314,20 @@ static int _ft_decay_apply_new_usage(job_record_t *job, time_t *start)
 }
 
 
-static void _ft_debug(slurmdb_assoc_rec_t *assoc,
-		      uint16_t assoc_level, bool tied)
+static void _ft_debug(ft_assoc_t *assoc, uint16_t assoc_level, bool tied)
 {
 	int spaces;
-	char *name;
 	int tie_char_count = tied ? 1 : 0;
 
 	spaces = (assoc_level + 1) * 4;
-	name = assoc->user ? assoc->user : assoc->acct;
 
-	if (assoc->shares_raw == SLURMDB_FS_USE_PARENT) {
+	if (assoc->use_parent) {
 		info("%*s%.*s%s (%s):  parent",
 		     spaces,
 		     "",
 		     tie_char_count,
 		     "=",
-		     name,
+		     assoc->name,
 		     assoc->acct);
 	} else {
 		info("%*s%.*s%s (%s):  %.20Lf",
@@ -129,9 +335,9 @@ static void _ft_debug(slurmdb_assoc_rec_t *assoc,
 		     "",
 		     tie_char_count,
 		     "=",
-		     name,
+		     assoc->name,
 		     assoc->acct,
-		     assoc->usage->level_fs);
+		     assoc->level_fs);
 	}
 
 }
@@ -146,17 +352,17 @@ static int _cmp_level_fs(const void *x,
 	 *  2. Prioritize users over accounts (required for tie breakers when
 	 *     comparing users and accounts)
 	 */
-	slurmdb_assoc_rec_t **a = (slurmdb_assoc_rec_t **)x;
-	slurmdb_assoc_rec_t **b = (slurmdb_assoc_rec_t **)y;
+	ft_assoc_t **a = (ft_assoc_t **)x;
+	ft_assoc_t **b = (ft_assoc_t **)y;
 
 	/* 1. level_fs value */
-	if ((*a)->usage->level_fs != (*b)->usage->level_fs)
-		return (*a)->usage->level_fs < (*b)->usage->level_fs ? 1 : -1;
+	if ((*a)->level_fs != (*b)->level_fs)
+		return (*a)->level_fs < (*b)->level_fs ? 1 : -1;
 
 	/* 2. Prioritize users over accounts */
 
 	/* a and b are both users or both accounts */
-	if (!(*a)->user == !(*b)->user)
+	if ((*a)->user == (*b)->user)
 		return 0;
 
 	/* -1 if a is user, 1 if b is user */
@@ -173,7 +379,7 @@ static int _cmp_level_fs(const void *x,
  * If LF > 1.0, the association is under-served.
  * If LF < 1.0, the association is over-served.
  */
-static void _calc_assoc_fs(slurmdb_assoc_rec_t *assoc)
+static void _calc_assoc_fs(ft_tree_t *tree, ft_assoc_t *assoc)
 {
 	long double U; /* long double U != long W */
 	long double S;
@@ -181,19 +387,19 @@ static void _calc_assoc_fs(slurmdb_assoc_rec_t *assoc)
 	_ft_set_assoc_usage_efctv(assoc);
 
 	/* Fair Tree doesn't use usage_norm but we will set it anyway */
-	set_assoc_usage_norm(assoc);
+	_ft_set_assoc_usage_norm(tree, assoc);
 
-	U = assoc->usage->usage_efctv;
-	S = assoc->usage->shares_norm;
+	U = assoc->usage_efctv;
+	S = assoc->shares_norm;
 
 	/* Users marked as USE_PARENT are assigned the maximum level_fs so they
 	 * rank highest in their account, subject to ties.
 	 * Accounts marked as USE_PARENT do not use level_fs */
-	if (assoc->shares_raw == SLURMDB_FS_USE_PARENT) {
+	if (assoc->use_parent) {
 		if (assoc->user)
-			assoc->usage->level_fs = INFINITY;
+			assoc->level_fs = INFINITY;
 		else
-			assoc->usage->level_fs = (long double) NO_VAL;
+			assoc->level_fs = (long double) NO_VAL;
 		return;
 	}
 
@@ -205,53 +411,60 @@ static void _calc_assoc_fs(slurmdb_assoc_rec_t *assoc)
 	 *
 	 * NOT A BUG: U can be 0. The result is infinity, a valid value. */
 	if (S == 0L)
-		assoc->usage->level_fs = 0L;
+		assoc->level_fs = 0L;
 	else
-		assoc->usage->level_fs = S / U;
+		assoc->level_fs = S / U;
 }
 
-static int _foreach_append_to_array(void *x, void *arg)
+/* Calculate level_fs for each sibling then sort them by it */
+static size_t _calc_siblings_fs(ft_tree_t *tree, ft_assoc_t **siblings)
 {
-	append_array_args_t *args = arg;
+	size_t i;
 
-	args->merged[args->i++] = x;
+	for (i = 0; siblings[i]; i++)
+		_calc_assoc_fs(tree, siblings[i]);
 
-	return 0;
+	qsort(siblings, i, sizeof(ft_assoc_t *), _cmp_level_fs);
+
+	return i;
 }
 
-/* Append list of associations to array
- * IN list - list of associations
- * IN merged - array of associations to append to
- * IN/OUT merged_size - number of associations in merged array
- * RET - New array. Must be freed.
+/*
+ * Calculate and sort the level_fs of every association below the siblings.
+ * level_fs only depends on an association and its parent, so this can be done
+ * for each subtree independently of the others.
  */
-static slurmdb_assoc_rec_t **_append_list_to_array(list_t *list,
-						   slurmdb_assoc_rec_t **merged,
-						   size_t *merged_size)
+static void _calc_subtree_fs(ft_tree_t *tree, ft_assoc_t **siblings)
 {
-	size_t bytes;
-	append_array_args_t args = {
-		.i = *merged_size,
-	};
+	ft_assoc_t *assoc;
 
-	if (!list) {
-		error("%s: unable to append NULL list to assoc list.",
-		      __func__);
-		return merged;
+	for (size_t i = 0; (assoc = siblings[i]); i++) {
+		if (!assoc->children)
+			continue;
+		_calc_siblings_fs(tree, assoc->children);
+		_calc_subtree_fs(tree, assoc->children);
 	}
+}
 
-	*merged_size += list_count(list);
+/* Calculate the subtrees of the children of root until none are left */
+static void *_calc_subtree_thread(void *arg)
+{
+	ft_tree_t *tree = arg;
+	ft_assoc_t *top[2] = { NULL, NULL };
 
-	/* must be null-terminated, so add one extra slot */
-	bytes = sizeof(slurmdb_assoc_rec_t *) * (*merged_size + 1);
-	merged = xrealloc(merged, bytes);
-	args.merged = merged;
+	while (true) {
+		slurm_mutex_lock(&tree->lock);
+		if ((top[0] = tree->top[tree->next_top]))
+			tree->next_top++;
+		slurm_mutex_unlock(&tree->lock);
 
-	list_for_each_ro(list, _foreach_append_to_array, &args);
+		if (!top[0])
+			break;
 
-	/* null terminate the array */
-	merged[*merged_size] = NULL;
-	return merged;
+		_calc_subtree_fs(tree, top);
+	}
+
+	return NULL;
 }
 
 /* Returns number of tied sibling accounts.
@@ -259,11 +472,10 @@ static slurmdb_assoc_rec_t **_append_list_to_array(list_t *list,
  * IN begin_ndx - begin looking for ties at this index
  * RET - number of sibling accounts with equal level_fs values
  */
-static size_t _count_tied_accounts(slurmdb_assoc_rec_t** assocs,
-				   size_t begin_ndx)
+static size_t _count_tied_accounts(ft_assoc_t **assocs, size_t begin_ndx)
 {
-	slurmdb_assoc_rec_t* next_assoc;
-	slurmdb_assoc_rec_t* assoc = assocs[begin_ndx];
+	ft_assoc_t *next_assoc;
+	ft_assoc_t *assoc = assocs[begin_ndx];
 	size_t i = begin_ndx;
 	size_t tied_accounts = 0;
 	while ((next_assoc = assocs[++i])) {
@@ -271,7 +483,7 @@ static size_t _count_tied_accounts(slurmdb_assoc_rec_t** assocs,
 		 * encounter here will be equal to this account */
 		if (!next_assoc->user)
 			break;
-		if (assoc->usage->level_fs != next_assoc->usage->level_fs)
+		if (assoc->level_fs != next_assoc->level_fs)
 			break;
 		tied_accounts++;
 	}
@@ -286,41 +498,43 @@ static size_t _count_tied_accounts(slurmdb_assoc_rec_t** assocs,
  * IN assoc_level - depth in the tree (root is 0)
  * RET - Array of the children. Must be freed.
  */
-static slurmdb_assoc_rec_t** _merge_accounts(
-	slurmdb_assoc_rec_t** siblings,
-	size_t begin, size_t end, uint16_t assoc_level)
+static ft_assoc_t **_merge_accounts(ft_assoc_t **siblings,
+				    size_t begin, size_t end,
+				    uint16_t assoc_level)
 {
-	size_t i;
+	size_t i, j;
 	/* number of associations in merged array */
 	size_t merged_size = 0;
 	/* merged is a null terminated array */
-	slurmdb_assoc_rec_t** merged = (slurmdb_assoc_rec_t **)
-		xmalloc(sizeof(slurmdb_assoc_rec_t *));
-	merged[0] = NULL;
+	ft_assoc_t **merged = NULL;
 
 	for (i = begin; i <= end; i++) {
-		list_t *children = siblings[i]->usage->children_list;
+		for (j = 0; siblings[i]->children && siblings[i]->children[j];
+		     j++)
+			merged_size++;
+	}
+
+	merged = xcalloc(merged_size + 1, sizeof(ft_assoc_t *));
+	merged_size = 0;
+
+	for (i = begin; i <= end; i++) {
+		ft_assoc_t **children = siblings[i]->children;
 
 		/* the first account's debug was already printed */
 		if ((slurm_conf.debug_flags & DEBUG_FLAG_PRIO) && i > begin)
 			_ft_debug(siblings[i], assoc_level, true);
 
-		if (!children || list_is_empty(children)) {
-			continue;
-		}
-
-		merged = _append_list_to_array(children, merged, &merged_size);
+		for (j = 0; children && children[j]; j++)
+			merged[merged_size++] = children[j];
 	}
 	return merged;
 }
 
 
-/* Calculate fairshare for each child then sort children by fairshare value
- * (level_fs). Once they are sorted, operate on each child in sorted order.
- * This portion of the tree is now sorted and users are given a fairshare value
- * based on the order they are operated on. The basic equation is
- * (rank / g_user_assoc_count), though ties are allowed. The rank is
- * decremented for each user that is encountered except when ties occur.
+/* Operate on sorted siblings. This portion of the tree is now sorted and users
+ * are given a fairshare value based on the order they are operated on. The
+ * basic equation is (rank / user_assoc_cnt), though ties are allowed. The rank
+ * is decremented for each user that is encountered except when ties occur.
  *
  * Tie Handling Rules:
  * 	1) Sibling users with the same level_fs receive the same rank
@@ -329,34 +543,22 @@ static slurmdb_assoc_rec_t** _merge_accounts(
  *	3) A user with the same level_fs as a sibling account will receive
  *	   the same rank as the account's highest ranked user
  *
- * IN siblings - array of siblings
+ * IN tree - copy of the association tree
+ * IN siblings - array of siblings, sorted by level_fs
  * IN assoc_level - depth in the tree (root is 0)
- * IN/OUT rank - current user ranking, starting at g_user_assoc_count
+ * IN/OUT rank - current user ranking, starting at user_assoc_cnt
  * IN/OUT rnt - rank, no ties (what rank would be if no tie exists)
  * IN account_tied - is this account tied with the previous user
  */
-static void _calc_tree_fs(slurmdb_assoc_rec_t** siblings,
+static void _calc_tree_fs(ft_tree_t *tree, ft_assoc_t **siblings,
 			  uint16_t assoc_level, uint32_t *rank,
 			  uint32_t *rnt, bool account_tied)
 {
-	slurmdb_assoc_rec_t *assoc = NULL;
+	ft_assoc_t *assoc = NULL;
 	long double prev_level_fs = (long double) NO_VAL;
 	bool tied = false;
 	size_t i;
 
-	if (!siblings) {
-		error("%s: unable to calculate fairshare on empty tree",
-		      __func__);
-		return;
-	}
-
-	/* Calculate level_fs for each child */
-	for (i = 0; (assoc = siblings[i]); i++)
-		_calc_assoc_fs(assoc);
-
-	/* Sort children by level_fs */
-	qsort(siblings, i, sizeof(slurmdb_assoc_rec_t *), _cmp_level_fs);
-
 	/* Iterate through children in sorted order. If it's a user, calculate
 	 * fs_factor, otherwise recurse. */
 	for (i = 0; (assoc = siblings[i]); i++) {
@@ -366,7 +568,7 @@ static void _calc_tree_fs(slurmdb_assoc_rec_t** siblings,
 			/* The parent was tied so this level starts out tied */
 			tied = true;
 		} else {
-			tied = prev_level_fs == assoc->usage->level_fs;
+			tied = prev_level_fs == assoc->level_fs;
 		}
 
 		if (slurm_conf.debug_flags & DEBUG_FLAG_PRIO)
@@ -380,57 +582,77 @@ static void _calc_tree_fs(slurmdb_assoc_rec_t** siblings,
 			if (!tied)
 				*rank = *rnt;
 
-			assoc->usage->fs_factor =
-				*rank / (double) g_user_assoc_count;
+			assoc->fs_factor =
+				*rank / (double) tree->user_assoc_cnt;
 
 			(*rnt)--;
 		} else {
-			slurmdb_assoc_rec_t** children;
+			ft_assoc_t **children;
 			size_t merge_count = _count_tied_accounts(siblings, i);
 
-			/* Merging does not affect child level_fs calculations
-			 * since the necessary information is stored on each
-			 * assoc's usage struct */
-			children = _merge_accounts(siblings, i,
-						   i + merge_count,
-						   assoc_level);
-
-			_calc_tree_fs(children, assoc_level+1,
-				      rank, rnt, tied);
-
-			/* Skip over any merged accounts */
-			i += merge_count;
-
-			xfree(children);
+			if (!merge_count) {
+				/* Already sorted by _calc_subtree_fs() */
+				if (assoc->children)
+					_calc_tree_fs(tree, assoc->children,
+						      assoc_level + 1, rank,
+						      rnt, tied);
+			} else {
+				/* Merging does not affect child level_fs
+				 * calculations since the necessary
+				 * information is stored on each assoc */
+				children = _merge_accounts(siblings, i,
+							   i + merge_count,
+							   assoc_level);
+				_calc_siblings_fs(tree, children);
+
+				_calc_tree_fs(tree, children, assoc_level + 1,
+					      rank, rnt, tied);
+
+				/* Skip over any merged accounts */
+				i += merge_count;
+
+				xfree(children);
+			}
 		}
-		prev_level_fs = assoc->usage->level_fs;
+		prev_level_fs = assoc->level_fs;
 	}
 
 }
 
 
-/* Start fairshare calculations at root. Call assoc_mgr_lock before this. */
-static void _apply_priority_fs(void)
+/*
+ * Start fairshare calculations at root. The level_fs of each subtree of root
+ * is calculated in parallel on large trees, then users are ranked in order.
+ */
+static void _apply_priority_fs(ft_tree_t *tree)
 {
-	slurmdb_assoc_rec_t** children = NULL;
-	uint32_t rank = g_user_assoc_count;
+	pthread_t threads[FT_MAX_THREADS];
+	uint32_t rank = tree->user_assoc_cnt;
 	uint32_t rnt = rank;
-	size_t child_count = 0;
+	size_t top_cnt;
+	int thread_cnt = 0;
 
 	log_flag(PRIO, "Fair Tree fairshare algorithm, starting at root:");
 
-	if (!assoc_mgr_root_assoc)
+	if (!tree->top) {
+		error("%s: unable to calculate fairshare on empty tree",
+		      __func__);
 		return;
+	}
 
-	assoc_mgr_root_assoc->usage->level_fs = (long double) NO_VAL;
+	top_cnt = _calc_siblings_fs(tree, tree->top);
+
+	if (tree->assoc_cnt >= FT_MIN_PARALLEL_ASSOCS)
+		thread_cnt = MIN(top_cnt, FT_MAX_THREADS) - 1;
+
+	for (int i = 0; i < thread_cnt; i++)
+		slurm_thread_create("fairtree", &threads[i],
+				    _calc_subtree_thread, tree);
 
-	/* _calc_tree_fs requires an array instead of list */
-	children = _append_list_to_array(
-		assoc_mgr_root_assoc->usage->children_list,
-		children,
-		&child_count);
+	(void) _calc_subtree_thread(tree);
 
-	_calc_tree_fs(children, 0, &rank, &rnt, false);
+	for (int i = 0; i < thread_cnt; i++)
+		slurm_thread_join(threads[i]);
 
-	xfree(children);
+	_calc_tree_fs(tree, tree->top, 0, &rank, &rnt, false);
 }
@@ -76,6 +76,12 @@
 #define SECS_PER_DAY	(24 * 60 * 60)
 #define SECS_PER_WEEK	(7 * SECS_PER_DAY)
 
+/*
+ * Job priorities are recalculated in batches of this many jobs, releasing the
+ * job write lock in between so a large queue does not block other RPCs.
+ */
+#define PRIO_UPDATE_BATCH 1000
+
 /* These are defined here so when we link with something other than
  * the slurmctld we will have these symbols defined.  They will get
  * overwritten when linking with the slurmctld.
@@ -144,11 +150,18 @@ typedef struct {
 	uid_t uid;
 } priority_factors_args_t;
 
+typedef struct {
+	uint32_t *job_ids;
+	uint32_t job_cnt;
+} prio_job_ids_t;
+
 /* variables defined in priority_multifactor.h */
 
 static void _priority_p_set_assoc_usage_debug(slurmdb_assoc_rec_t *assoc);
 static void _set_assoc_usage_efctv(slurmdb_assoc_rec_t *assoc);
 static void _set_norm_shares(list_t *children_list);
+static bool _job_prio_factors_unchanged(time_t start_time,
+					job_record_t *job_ptr);
 
 static void _destroy_priority_factors_obj_light(void *object)
 {
@@ -580,6 +593,24 @@ static int _priority_each_partition(void *object, void *arg)
 	return SLURM_SUCCESS;
 }
 
+/* Multiply the factors by their weights, return the sum of the TRES factors */
+static double _weight_priority_factors(priority_factors_t *factors)
+{
+	double tmp_tres = 0.0;
+
+	factors->priority_age   *= (double)weight_age;
+	factors->priority_assoc *= (double)weight_assoc;
+	factors->priority_fs    *= (double)weight_fs;
+	factors->priority_js    *= (double)weight_js;
+	factors->priority_part  *= (double)weight_part;
+	factors->priority_qos   *= (double)weight_qos;
+
+	if (weight_tres && factors->priority_tres)
+		tmp_tres = _get_tres_prio_weighted(factors->priority_tres);
+
+	return tmp_tres;
+}
+
 /* Returns the priority after applying the weight factors */
 static uint32_t _get_priority_internal(time_t start_time,
 				       job_record_t *job_ptr)
@@ -627,18 +658,7 @@ static uint32_t _get_priority_internal(time_t start_time,
 	} else	/* clang needs this memset to avoid a warning */
 		memset(&pre_factors, 0, sizeof(priority_factors_t));
 
-	job_ptr->prio_factors->priority_age  *= (double)weight_age;
-	job_ptr->prio_factors->priority_assoc *= (double)weight_assoc;
-	job_ptr->prio_factors->priority_fs   *= (double)weight_fs;
-	job_ptr->prio_factors->priority_js   *= (double)weight_js;
-	job_ptr->prio_factors->priority_part *= (double)weight_part;
-	job_ptr->prio_factors->priority_qos  *= (double)weight_qos;
-
-	if (weight_tres && job_ptr->prio_factors->priority_tres) {
-		double *tres_factors = NULL;
-		tres_factors = job_ptr->prio_factors->priority_tres;
-		tmp_tres = _get_tres_prio_weighted(tres_factors);
-	}
+	tmp_tres = _weight_priority_factors(job_ptr->prio_factors);
 
 	priority = job_ptr->prio_factors->priority_age
 		+ job_ptr->prio_factors->priority_assoc
@@ -2097,9 +2117,14 @@ extern int decay_apply_weighted_factors(job_record_t *job_ptr,
 	     !(flags & PRIORITY_FLAGS_CALCULATE_RUNNING)))
 		return SLURM_SUCCESS;
 
+	/* Nothing to apply if none of the job's factors changed */
+	if (_job_prio_factors_unchanged(*start_time_ptr, job_ptr))
+		return SLURM_SUCCESS;
+
 	new_prio = _get_priority_internal(*start_time_ptr, job_ptr);
-	if (((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
-	    (job_ptr->priority < new_prio)) {
+	if ((((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
+	     (job_ptr->priority < new_prio)) &&
+	    (job_ptr->priority != new_prio)) {
 		job_ptr->priority = new_prio;
 		last_job_update = time(NULL);
 	}
@@ -2133,21 +2158,18 @@ extern uint32_t priority_p_recover(uint32_t prio_boost)
 	return 0;
 }
 
-extern void set_priority_factors(time_t start_time, job_record_t *job_ptr)
+/*
+ * Fill in the unweighted priority factors of a job.
+ * IN start_time - time the age factor is calculated at
+ * IN job_ptr - job to calculate the factors of
+ * IN/OUT factors - zeroed factors to fill in. If TRES are weighted,
+ *		    priority_tres must have room for slurmctld_tres_cnt factors.
+ */
+static void _fill_priority_factors(time_t start_time, job_record_t *job_ptr,
+				   priority_factors_t *factors)
 {
 	assoc_mgr_lock_t locks = { .assoc = READ_LOCK, .qos = READ_LOCK };
 
-	xassert(job_ptr);
-
-	if (!job_ptr->prio_factors) {
-		job_ptr->prio_factors =
-			xmalloc(sizeof(priority_factors_t));
-	} else {
-		xfree(job_ptr->prio_factors->tres_weights);
-		xfree(job_ptr->prio_factors->priority_tres);
-		memset(job_ptr->prio_factors, 0, sizeof(priority_factors_t));
-	}
-
 	if (weight_age && job_ptr->details->accrue_time) {
 		uint32_t diff = 0;
 
@@ -2159,16 +2181,13 @@ extern void set_priority_factors(time_t start_time, job_record_t *job_ptr)
 			diff = start_time - job_ptr->details->accrue_time;
 
 		if (diff < max_age)
-			job_ptr->prio_factors->priority_age =
-				(double)diff / (double)max_age;
+			factors->priority_age = (double)diff / (double)max_age;
 		else
-			job_ptr->prio_factors->priority_age = 1.0;
+			factors->priority_age = 1.0;
 	}
 
-	if (job_ptr->assoc_ptr && weight_fs) {
-		job_ptr->prio_factors->priority_fs =
-			_get_fairshare_priority(job_ptr);
-	}
+	if (job_ptr->assoc_ptr && weight_fs)
+		factors->priority_fs = _get_fairshare_priority(job_ptr);
 
 	/* FIXME: this should work off the product of TRESBillingWeights */
 	if (weight_js && active_node_record_count && cluster_cpus) {
@@ -2192,74 +2211,71 @@ extern void set_priority_factors(time_t start_time, job_record_t *job_ptr)
 		if (flags & PRIORITY_FLAGS_SIZE_RELATIVE) {
 			uint32_t time_limit = 1;
 			/* Job size in CPUs (based upon average CPUs/Node */
-			job_ptr->prio_factors->priority_js =
+			factors->priority_js =
 				(double)min_nodes *
 				(double)cluster_cpus /
 				(double)node_count;
-			if (cpu_cnt > job_ptr->prio_factors->priority_js) {
-				job_ptr->prio_factors->priority_js =
-					(double)cpu_cnt;
-			}
+			if (cpu_cnt > factors->priority_js)
+				factors->priority_js = (double)cpu_cnt;
 			/* Divide by job time limit */
 			if (job_ptr->time_limit != NO_VAL)
 				time_limit = job_ptr->time_limit;
 			else if (job_ptr->part_ptr)
 				time_limit = job_ptr->part_ptr->max_time;
-			job_ptr->prio_factors->priority_js /= time_limit;
+			factors->priority_js /= time_limit;
 			/* Normalize to max value of 1.0 */
-			job_ptr->prio_factors->priority_js /= cluster_cpus;
+			factors->priority_js /= cluster_cpus;
 			if (slurm_conf.priority_favor_small) {
-				job_ptr->prio_factors->priority_js =
-					(double) 1.0 -
-					job_ptr->prio_factors->priority_js;
+				factors->priority_js =
+					(double) 1.0 - factors->priority_js;
 			}
 		} else if (slurm_conf.priority_favor_small) {
 			if (node_count > min_nodes)
-				job_ptr->prio_factors->priority_js =
+				factors->priority_js =
 					(double) (node_count - min_nodes) /
 					(double) node_count;
 			else
-				job_ptr->prio_factors->priority_js = 0;
+				factors->priority_js = 0;
 			if (cpu_cnt) {
-				job_ptr->prio_factors->priority_js +=
+				factors->priority_js +=
 					(double)(cluster_cpus - cpu_cnt)
 					/ (double)cluster_cpus;
-				job_ptr->prio_factors->priority_js /= 2;
+				factors->priority_js /= 2;
 			}
 		} else {	/* favor large */
-			job_ptr->prio_factors->priority_js =
+			factors->priority_js =
 				(double) min_nodes / (double) node_count;
 			if (cpu_cnt) {
-				job_ptr->prio_factors->priority_js +=
+				factors->priority_js +=
 					(double)cpu_cnt / (double)cluster_cpus;
-				job_ptr->prio_factors->priority_js /= 2;
+				factors->priority_js /= 2;
 			}
 		}
-		if (job_ptr->prio_factors->priority_js < .0)
-			job_ptr->prio_factors->priority_js = 0.0;
-		else if (job_ptr->prio_factors->priority_js > 1.0)
-			job_ptr->prio_factors->priority_js = 1.0;
+		if (factors->priority_js < .0)
+			factors->priority_js = 0.0;
+		else if (factors->priority_js > 1.0)
+			factors->priority_js = 1.0;
 	}
 
 	if (job_ptr->part_ptr && job_ptr->part_ptr->priority_job_factor &&
 	    weight_part) {
-		job_ptr->prio_factors->priority_part =
+		factors->priority_part =
 			(flags & PRIORITY_FLAGS_NO_NORMAL_PART) ?
 			job_ptr->part_ptr->priority_job_factor :
 			job_ptr->part_ptr->norm_priority;
 	}
 
-	job_ptr->prio_factors->priority_site = job_ptr->site_factor;
+	factors->priority_site = job_ptr->site_factor;
 
 	assoc_mgr_lock(&locks);
 	if (job_ptr->assoc_ptr && weight_assoc)
-		job_ptr->prio_factors->priority_assoc =
+		factors->priority_assoc =
 			(flags & PRIORITY_FLAGS_NO_NORMAL_ASSOC) ?
 			job_ptr->assoc_ptr->priority :
 			job_ptr->assoc_ptr->usage->priority_norm;
 
 	if (job_ptr->qos_ptr && job_ptr->qos_ptr->priority && weight_qos) {
-		job_ptr->prio_factors->priority_qos =
+		factors->priority_qos =
 			(flags & PRIORITY_FLAGS_NO_NORMAL_QOS) ?
 			job_ptr->qos_ptr->priority :
 			job_ptr->qos_ptr->usage->norm_priority;
@@ -2267,24 +2283,154 @@ extern void set_priority_factors(time_t start_time, job_record_t *job_ptr)
 	assoc_mgr_unlock(&locks);
 
 	if (job_ptr->details)
-		job_ptr->prio_factors->nice = job_ptr->details->nice;
+		factors->nice = job_ptr->details->nice;
 	else
-		job_ptr->prio_factors->nice = NICE_OFFSET;
+		factors->nice = NICE_OFFSET;
+
+	if (weight_tres)
+		_get_tres_factors(job_ptr, job_ptr->part_ptr,
+				  factors->priority_tres);
+}
+
+extern void set_priority_factors(time_t start_time, job_record_t *job_ptr)
+{
+	xassert(job_ptr);
+
+	if (!job_ptr->prio_factors) {
+		job_ptr->prio_factors =
+			xmalloc(sizeof(priority_factors_t));
+	} else {
+		xfree(job_ptr->prio_factors->tres_weights);
+		xfree(job_ptr->prio_factors->priority_tres);
+		memset(job_ptr->prio_factors, 0, sizeof(priority_factors_t));
+	}
 
 	if (weight_tres) {
-		if (!job_ptr->prio_factors->priority_tres) {
-			job_ptr->prio_factors->priority_tres =
-				xcalloc(slurmctld_tres_cnt, sizeof(double));
-			job_ptr->prio_factors->tres_weights =
-				xcalloc(slurmctld_tres_cnt, sizeof(double));
-			memcpy(job_ptr->prio_factors->tres_weights, weight_tres,
-			       sizeof(double) * slurmctld_tres_cnt);
-			job_ptr->prio_factors->tres_cnt = slurmctld_tres_cnt;
-		}
+		job_ptr->prio_factors->priority_tres =
+			xcalloc(slurmctld_tres_cnt, sizeof(double));
+		job_ptr->prio_factors->tres_weights =
+			xcalloc(slurmctld_tres_cnt, sizeof(double));
+		memcpy(job_ptr->prio_factors->tres_weights, weight_tres,
+		       sizeof(double) * slurmctld_tres_cnt);
+		job_ptr->prio_factors->tres_cnt = slurmctld_tres_cnt;
+	}
 
-		_get_tres_factors(job_ptr, job_ptr->part_ptr,
-				  job_ptr->prio_factors->priority_tres);
+	_fill_priority_factors(start_time, job_ptr, job_ptr->prio_factors);
+}
+
+/*
+ * Return true if the weighted priority factors of a job are the same as the
+ * ones saved by its last priority calculation, so its priority would not
+ * change either. The factors saved before a change of the TRES weights are
+ * never reused, as those weights are not part of the other factors.
+ */
+static bool _job_prio_factors_unchanged(time_t start_time,
+					job_record_t *job_ptr)
+{
+	priority_factors_t *old_factors = job_ptr->prio_factors;
+	priority_factors_t new_factors = { 0 };
+	bool unchanged = false;
+
+	/* Per partition/QOS priorities are not kept in prio_factors */
+	if (!old_factors || !job_ptr->details || job_ptr->direct_set_prio ||
+	    job_ptr->part_ptr_list || job_ptr->qos_list)
+		return false;
+
+	if (!weight_tres != !old_factors->tres_weights)
+		return false;
+
+	if (weight_tres) {
+		if (!old_factors->priority_tres ||
+		    (old_factors->tres_cnt != slurmctld_tres_cnt) ||
+		    memcmp(old_factors->tres_weights, weight_tres,
+			   sizeof(double) * slurmctld_tres_cnt))
+			return false;
+		new_factors.priority_tres =
+			xcalloc(slurmctld_tres_cnt, sizeof(double));
 	}
+
+	_fill_priority_factors(start_time, job_ptr, &new_factors);
+	(void) _weight_priority_factors(&new_factors);
+
+	if ((new_factors.priority_age != old_factors->priority_age) ||
+	    (new_factors.priority_assoc != old_factors->priority_assoc) ||
+	    (new_factors.priority_fs != old_factors->priority_fs) ||
+	    (new_factors.priority_js != old_factors->priority_js) ||
+	    (new_factors.priority_part != old_factors->priority_part) ||
+	    (new_factors.priority_qos != old_factors->priority_qos) ||
+	    (new_factors.priority_site != old_factors->priority_site) ||
+	    (new_factors.nice != old_factors->nice))
+		goto fini;
+
+	if (weight_tres &&
+	    memcmp(new_factors.priority_tres, old_factors->priority_tres,
+		   sizeof(double) * slurmctld_tres_cnt))
+		goto fini;
+
+	unchanged = true;
+fini:
+	xfree(new_factors.priority_tres);
+	return unchanged;
+}
+
+static int _foreach_add_prio_job_id(void *x, void *arg)
+{
+	job_record_t *job_ptr = x;
+	prio_job_ids_t *job_ids = arg;
+
+	/* Same jobs decay_apply_weighted_factors() would skip */
+	if ((job_ptr->priority == 0) ||
+	    IS_JOB_POWER_UP_NODE(job_ptr) ||
+	    (!IS_JOB_PENDING(job_ptr) &&
+	     !(flags & PRIORITY_FLAGS_CALCULATE_RUNNING)))
+		return 0;
+
+	job_ids->job_ids[job_ids->job_cnt++] = job_ptr->job_id;
+
+	return 0;
+}
+
+extern void decay_apply_weighted_factors_batched(list_t *jobs,
+						 time_t start_time)
+{
+	slurmctld_lock_t job_read_lock = { .job = READ_LOCK };
+	slurmctld_lock_t job_write_lock = {
+		.job = WRITE_LOCK,
+		.node = READ_LOCK,
+		.part = READ_LOCK,
+	};
+	prio_job_ids_t job_ids = { 0 };
+	uint32_t i = 0;
+
+	lock_slurmctld(job_read_lock);
+	job_ids.job_ids = xcalloc(list_count(jobs) + 1, sizeof(uint32_t));
+	(void) list_for_each_ro(jobs, _foreach_add_prio_job_id, &job_ids);
+	unlock_slurmctld(job_read_lock);
+
+	/*
+	 * Jobs can be purged while the lock is released, so look them up
+	 * again by id in each batch.
+	 */
+	while (i < job_ids.job_cnt) {
+		uint32_t batch_end = MIN(i + PRIO_UPDATE_BATCH,
+					 job_ids.job_cnt);
+
+		lock_slurmctld(job_write_lock);
+		for (; i < batch_end; i++) {
+			job_record_t *job_ptr =
+				find_job_record(job_ids.job_ids[i]);
+
+			if (job_ptr)
+				decay_apply_weighted_factors(job_ptr,
+							     &start_time);
+		}
+		unlock_slurmctld(job_write_lock);
+	}
+
+	log_flag(PRIO, "%s: checked priority of %u jobs in batches of %d",
+		 __func__, job_ids.job_cnt, PRIO_UPDATE_BATCH);
+
+	xfree(job_ids.job_ids);
 }
 
 
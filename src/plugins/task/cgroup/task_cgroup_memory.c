@@ -297,7 +297,7 @@ extern int task_cgroup_memory_check_oom(stepd_step_rec_t *step)
 		 * step, this is done to ensure that if this is a multinode
 		 * step, the step gets terminated in all other nodes.
 		 */
-		if (step->oom_kill_step) {
+		if (step->oom_kill_step && !results->step_terminated) {
 			slurm_terminate_job_step(&step->step_id);
 		}
 		rc = ENOMEM;
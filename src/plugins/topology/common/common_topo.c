@@ -218,10 +218,81 @@ extern int common_topo_split_hostlist_treewidth(hostlist_t *hl,
 						hostlist_t ***sp_hl,
 						int *count, uint16_t tree_width)
 {
+	int depth;
+
 	if (running_in_slurmctld() && common_topo_route_part())
-		return _route_part_split_hostlist(hl, sp_hl, count, tree_width);
+		depth = _route_part_split_hostlist(hl, sp_hl, count,
+						   tree_width);
+	else
+		depth = hostlist_split_treewidth(hl, sp_hl, count, tree_width);
+
+	if (depth != SLURM_ERROR)
+		common_topo_pick_forwarders(*sp_hl, *count);
+
+	return depth;
+}
+
+/* Check if node has responded recently enough to be trusted to forward */
+static bool _node_responding(node_record_t *node_ptr, time_t min_response)
+{
+	return (node_ptr && !IS_NODE_NO_RESPOND(node_ptr) &&
+		!IS_NODE_DOWN(node_ptr) && !IS_NODE_POWERED_DOWN(node_ptr) &&
+		!IS_NODE_POWERING_DOWN(node_ptr) &&
+		!IS_NODE_POWERING_UP(node_ptr) &&
+		!IS_NODE_REBOOT_ISSUED(node_ptr) &&
+		(node_ptr->last_response >= min_response));
+}
+
+extern void common_topo_pick_forwarders(hostlist_t **sp_hl, int count)
+{
+	slurmctld_lock_t node_read_lock = { .node = READ_LOCK };
+	time_t min_response = 0;
+
+	if (!running_in_slurmctld())
+		return;
+
+	if (slurm_conf.slurmd_timeout)
+		min_response = time(NULL) - slurm_conf.slurmd_timeout;
+
+	lock_slurmctld(node_read_lock);
+	for (int i = 0; i < count; i++) {
+		hostlist_iterator_t *itr;
+		hostlist_t *hl;
+		char *name;
+		int pos = 0;
+
+		if (hostlist_count(sp_hl[i]) < 2)
+			continue;
 
-	return hostlist_split_treewidth(hl, sp_hl, count, tree_width);
+		itr = hostlist_iterator_create(sp_hl[i]);
+		while ((name = hostlist_next(itr))) {
+			if (_node_responding(find_node_record(name),
+					     min_response))
+				break;
+			free(name);
+			pos++;
+		}
+
+		/* First host is fine or none of them are responding */
+		if (!pos || !name) {
+			hostlist_iterator_destroy(itr);
+			free(name);
+			continue;
+		}
+
+		log_flag(ROUTE, "sp_hl[%d]: forwarding through %s instead of %d non-responding nodes",
+			 i, name, pos);
+
+		hostlist_remove(itr);
+		hostlist_iterator_destroy(itr);
+
+		hl = hostlist_create(name);
+		free(name);
+		hostlist_push_list(hl, sp_hl[i]);
+		hostlist_destroy(sp_hl[i]);
+		sp_hl[i] = hl;
+	}
+	unlock_slurmctld(node_read_lock);
 }
 
 extern int common_topo_get_node_addr(char *node_name, char **addr,
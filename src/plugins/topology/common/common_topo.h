@@ -67,6 +67,19 @@ extern int common_topo_split_hostlist_treewidth(
 	hostlist_t ***sp_hl,
 	int *count, uint16_t tree_width);
 
+/*
+ * common_topo_pick_forwarders - Move the first node of each hostlist which
+ *                               has responded recently to the front, so that
+ *                               it forwards to the rest instead of a node
+ *                               which is down or not responding.
+ *
+ * Only reorders in the slurmctld, which knows the state of the nodes.
+ *
+ * IN/OUT: sp_hl - hostlist_t ** - array of hostlists split for forwarding
+ * IN:     count - int           - number of hostlists in sp_hl
+ */
+extern void common_topo_pick_forwarders(hostlist_t **sp_hl, int count);
+
 /*
  * common_topo_get_node_addr - Build node address and the associated pattern
  *      based on the topology information in default plugin, only use node name
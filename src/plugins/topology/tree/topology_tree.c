@@ -673,6 +673,8 @@ extern int topology_p_split_hostlist(hostlist_t *hl, hostlist_t ***sp_hl,
 	FREE_NULL_BITMAP(nodes_bitmap);
 	FREE_NULL_BITMAP(switch_bitmap);
 
+	common_topo_pick_forwarders(*sp_hl, *count);
+
 	return depth;
 }
 
@@ -71,12 +71,14 @@
 #define OPT_LONG_HELPSTATE 0x113
 #define OPT_LONG_HELPREASON 0x114
 #define OPT_LONG_EXPAND_PATTERNS 0x115
+#define OPT_LONG_STREAM    0x116
 
 #define JOB_HASH_SIZE 1000
 
 static void _help_fields_msg(void);
 static void _help_msg(void);
 static void _init_params(void);
+static void _print_job(slurmdb_job_rec_t *job);
 static void _usage(void);
 
 decl_static_data(help_txt);
@@ -370,18 +372,328 @@ static void _remove_duplicate_fed_jobs(list_t *jobs)
 	xfree(hash_job);
 }
 
+/*
+ * Set the columns needed to print a field of a job record from
+ * slurmdb_jobs_get_columns().
+ * RET false if the field needs the full job record
+ */
+static bool _print_field_columns(uint16_t type, bool *cols)
+{
+	switch (type) {
+	case PRINT_ACCOUNT:
+		cols[SLURMDB_JOB_COL_ACCOUNT] = true;
+		break;
+	case PRINT_ADMIN_COMMENT:
+		cols[SLURMDB_JOB_COL_ADMIN_COMMENT] = true;
+		break;
+	case PRINT_ALLOC_NODES:
+		cols[SLURMDB_JOB_COL_ALLOC_NODES] = true;
+		/* fall through */
+	case PRINT_ALLOC_CPUS:
+	case PRINT_CONSUMED_ENERGY:
+	case PRINT_CONSUMED_ENERGY_RAW:
+	case PRINT_TRESA:
+		cols[SLURMDB_JOB_COL_TRES_ALLOC] = true;
+		break;
+	case PRINT_ASSOCID:
+		cols[SLURMDB_JOB_COL_ASSOCID] = true;
+		break;
+	case PRINT_CLUSTER:
+	case PRINT_NTASKS:
+		break;
+	case PRINT_COMMENT:
+		cols[SLURMDB_JOB_COL_DERIVED_ES] = true;
+		break;
+	case PRINT_CONSTRAINTS:
+		cols[SLURMDB_JOB_COL_CONSTRAINTS] = true;
+		break;
+	case PRINT_CONTAINER:
+		cols[SLURMDB_JOB_COL_CONTAINER] = true;
+		break;
+	case PRINT_CPU_TIME:
+	case PRINT_CPU_TIME_RAW:
+		cols[SLURMDB_JOB_COL_ELAPSED] = true;
+		cols[SLURMDB_JOB_COL_TRES_ALLOC] = true;
+		break;
+	case PRINT_DB_INX:
+	case PRINT_SLUID:
+		cols[SLURMDB_JOB_COL_DB_INDEX] = true;
+		break;
+	case PRINT_DERIVED_EC:
+		cols[SLURMDB_JOB_COL_DERIVED_EC] = true;
+		break;
+	case PRINT_ELAPSED:
+	case PRINT_ELAPSED_RAW:
+		cols[SLURMDB_JOB_COL_ELAPSED] = true;
+		break;
+	case PRINT_ELIGIBLE:
+		cols[SLURMDB_JOB_COL_ELIGIBLE] = true;
+		break;
+	case PRINT_END:
+		cols[SLURMDB_JOB_COL_END] = true;
+		break;
+	case PRINT_EXITCODE:
+		cols[SLURMDB_JOB_COL_EXITCODE] = true;
+		break;
+	case PRINT_EXTRA:
+		cols[SLURMDB_JOB_COL_EXTRA] = true;
+		break;
+	case PRINT_FAILED_NODE:
+		cols[SLURMDB_JOB_COL_FAILED_NODE] = true;
+		break;
+	case PRINT_FLAGS:
+		cols[SLURMDB_JOB_COL_FLAGS] = true;
+		break;
+	case PRINT_GID:
+	case PRINT_GROUP:
+		cols[SLURMDB_JOB_COL_GID] = true;
+		break;
+	case PRINT_JOBID:
+		cols[SLURMDB_JOB_COL_ARRAY_MAX_TASKS] = true;
+		cols[SLURMDB_JOB_COL_ARRAY_TASK_STR] = true;
+		cols[SLURMDB_JOB_COL_HET_JOB_ID] = true;
+		cols[SLURMDB_JOB_COL_HET_JOB_OFFSET] = true;
+		break;
+	case PRINT_JOBIDRAW:
+		break;
+	case PRINT_JOBNAME:
+		cols[SLURMDB_JOB_COL_JOBNAME] = true;
+		break;
+	case PRINT_LICENSES:
+		cols[SLURMDB_JOB_COL_LICENSES] = true;
+		break;
+	case PRINT_MCS_LABEL:
+		cols[SLURMDB_JOB_COL_MCS_LABEL] = true;
+		break;
+	case PRINT_NNODES:
+		cols[SLURMDB_JOB_COL_ALLOC_NODES] = true;
+		cols[SLURMDB_JOB_COL_TRES_ALLOC] = true;
+		cols[SLURMDB_JOB_COL_TRES_REQ] = true;
+		break;
+	case PRINT_NODELIST:
+		cols[SLURMDB_JOB_COL_NODES] = true;
+		break;
+	case PRINT_ORIGINAL_SLUID:
+		cols[SLURMDB_JOB_COL_SLUID] = true;
+		break;
+	case PRINT_PARTITION:
+		cols[SLURMDB_JOB_COL_PARTITION] = true;
+		break;
+	case PRINT_PLANNED:
+		cols[SLURMDB_JOB_COL_ELIGIBLE] = true;
+		cols[SLURMDB_JOB_COL_START] = true;
+		cols[SLURMDB_JOB_COL_END] = true;
+		break;
+	case PRINT_PLANNED_CPU:
+	case PRINT_PLANNED_CPU_RAW:
+		cols[SLURMDB_JOB_COL_ELIGIBLE] = true;
+		cols[SLURMDB_JOB_COL_START] = true;
+		cols[SLURMDB_JOB_COL_REQ_CPUS] = true;
+		break;
+	case PRINT_PRIO:
+		cols[SLURMDB_JOB_COL_PRIORITY] = true;
+		break;
+	case PRINT_QOS:
+	case PRINT_QOSRAW:
+		cols[SLURMDB_JOB_COL_QOSID] = true;
+		break;
+	case PRINT_REASON:
+		cols[SLURMDB_JOB_COL_STATE_REASON_PREV] = true;
+		break;
+	case PRINT_REQ_CPUS:
+		cols[SLURMDB_JOB_COL_REQ_CPUS] = true;
+		break;
+	case PRINT_REQ_MEM:
+	case PRINT_REQ_NODES:
+	case PRINT_TRESR:
+		cols[SLURMDB_JOB_COL_TRES_REQ] = true;
+		break;
+	case PRINT_RESERVATION_ID:
+		cols[SLURMDB_JOB_COL_RESVID] = true;
+		break;
+	case PRINT_RESTART_CNT:
+		cols[SLURMDB_JOB_COL_RESTART_CNT] = true;
+		break;
+	case PRINT_START:
+		cols[SLURMDB_JOB_COL_START] = true;
+		break;
+	case PRINT_STATE:
+		cols[SLURMDB_JOB_COL_STATE] = true;
+		cols[SLURMDB_JOB_COL_REQUID] = true;
+		break;
+	case PRINT_SUBMIT:
+		break;
+	case PRINT_SUBMIT_LINE:
+		cols[SLURMDB_JOB_COL_SUBMIT_LINE] = true;
+		break;
+	case PRINT_SUSPENDED:
+		cols[SLURMDB_JOB_COL_SUSPENDED] = true;
+		break;
+	case PRINT_SYSTEM_COMMENT:
+		cols[SLURMDB_JOB_COL_SYSTEM_COMMENT] = true;
+		break;
+	case PRINT_TIMELIMIT:
+	case PRINT_TIMELIMIT_RAW:
+		cols[SLURMDB_JOB_COL_TIMELIMIT] = true;
+		break;
+	case PRINT_UID:
+	case PRINT_USER:
+		cols[SLURMDB_JOB_COL_UID] = true;
+		cols[SLURMDB_JOB_COL_USER] = true;
+		break;
+	case PRINT_WCKEY:
+		cols[SLURMDB_JOB_COL_WCKEY] = true;
+		break;
+	case PRINT_WCKEYID:
+		cols[SLURMDB_JOB_COL_WCKEYID] = true;
+		break;
+	case PRINT_WORK_DIR:
+		cols[SLURMDB_JOB_COL_WORK_DIR] = true;
+		break;
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Try to get only the columns needed for the requested fields instead of full
+ * job records. Only done for the plain case of printing jobs without steps.
+ * RET SLURM_SUCCESS if job_columns was filled in
+ */
+static int _get_data_columns(void)
+{
+	slurmdb_job_cond_t *job_cond = params.job_cond;
+	bool cols[SLURMDB_JOB_COL_CNT] = { 0 };
+	print_field_t *field;
+	list_itr_t *itr;
+	int rc = SLURM_SUCCESS;
+
+	if (params.mimetype || params.opt_completion ||
+	    !(job_cond->flags & JOBCOND_FLAG_NO_STEP) ||
+	    !(job_cond->flags & JOBCOND_FLAG_NO_TRUNC) ||
+	    (job_cond->flags & (JOBCOND_FLAG_SCRIPT | JOBCOND_FLAG_ENV)) ||
+	    (params.cluster_name && !(job_cond->flags & JOBCOND_FLAG_DUP)))
+		return SLURM_ERROR;
+
+	itr = list_iterator_create(print_fields_list);
+	while ((field = list_next(itr))) {
+		if (!_print_field_columns(field->type, cols)) {
+			rc = SLURM_ERROR;
+			break;
+		}
+	}
+	list_iterator_destroy(itr);
+	if (rc != SLURM_SUCCESS)
+		return rc;
+
+	/* Needed for sorting and --array */
+	cols[SLURMDB_JOB_COL_ARRAY_JOB_ID] = true;
+	cols[SLURMDB_JOB_COL_ARRAY_TASK_ID] = true;
+	cols[SLURMDB_JOB_COL_JOBID] = true;
+	cols[SLURMDB_JOB_COL_SUBMIT] = true;
+	if (params.opt_array)
+		cols[SLURMDB_JOB_COL_ARRAY_TASK_STR] = true;
+
+	job_cond->format_list = list_create(NULL);
+	for (int i = 0; i < SLURMDB_JOB_COL_CNT; i++)
+		if (cols[i])
+			list_append(job_cond->format_list,
+				    (char *) slurmdb_job_col_2_str(i));
+
+	job_columns = slurmdb_jobs_get_columns(acct_db_conn, job_cond);
+	FREE_NULL_LIST(job_cond->format_list);
+
+	if (!job_columns) {
+		debug("%s: columnar job query not available, getting full job records",
+		      __func__);
+		return SLURM_ERROR;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+/* Add up the usage of the finished steps of a job */
+static void _sum_job_steps(slurmdb_job_rec_t *job)
+{
+	slurmdb_step_rec_t *step = NULL;
+	list_itr_t *itr_step = NULL;
+
+	if (!job->steps || !list_count(job->steps))
+		return;
+
+	itr_step = list_iterator_create(job->steps);
+	while ((step = list_next(itr_step))) {
+		/* now aggregate the aggregatable */
+
+		if (step->state < JOB_COMPLETE)
+			continue;
+		job->tot_cpu_sec += step->tot_cpu_sec;
+		job->tot_cpu_usec += step->tot_cpu_usec;
+		job->user_cpu_sec +=
+			step->user_cpu_sec;
+		job->user_cpu_usec +=
+			step->user_cpu_usec;
+		job->sys_cpu_sec +=
+			step->sys_cpu_sec;
+		job->sys_cpu_usec +=
+			step->sys_cpu_usec;
+	}
+	list_iterator_destroy(itr_step);
+}
+
+static int _print_job_chunk(list_t *job_list, void *arg)
+{
+	slurmdb_job_rec_t *job = NULL;
+	list_itr_t *itr = list_iterator_create(job_list);
+
+	while ((job = list_next(itr))) {
+		_sum_job_steps(job);
+		_print_job(job);
+	}
+	list_iterator_destroy(itr);
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Print the jobs as they come from the slurmdbd instead of waiting for all of
+ * them. The jobs are printed in the order the database has them (by cluster
+ * and job id) rather than sorted by submit time.
+ * RET SLURM_SUCCESS, ESLURM_NOT_SUPPORTED if nothing was printed and the jobs
+ *     need to be gotten all at once, or an error code
+ */
+static int _get_data_stream(void)
+{
+	slurmdb_job_cond_t *job_cond = params.job_cond;
+
+	/* Both need the whole list of jobs */
+	if (params.mimetype ||
+	    (params.cluster_name && !(job_cond->flags & JOBCOND_FLAG_DUP))) {
+		debug("--stream is not used with --json, --yaml or federated jobs");
+		return ESLURM_NOT_SUPPORTED;
+	}
+
+	return slurmdb_jobs_get_stream(acct_db_conn, job_cond,
+				       _print_job_chunk, NULL);
+}
+
 extern int get_data(void)
 {
 	slurmdb_job_rec_t *job = NULL;
-	slurmdb_step_rec_t *step = NULL;
 	list_itr_t *itr = NULL;
-	list_itr_t *itr_step = NULL;
 	slurmdb_job_cond_t *job_cond = params.job_cond;
-	int cnt;
+	int rc;
 
 	if (params.opt_completion) {
 		jobs = slurmdb_jobcomp_jobs_get(job_cond);
 		return SLURM_SUCCESS;
+	} else if (params.opt_stream &&
+		   ((rc = _get_data_stream()) != ESLURM_NOT_SUPPORTED)) {
+		return (rc == SLURM_SUCCESS) ? SLURM_SUCCESS : SLURM_ERROR;
+	} else if (_get_data_columns() == SLURM_SUCCESS) {
+		return SLURM_SUCCESS;
 	} else {
 		jobs = slurmdb_jobs_get(acct_db_conn, job_cond);
 	}
@@ -403,30 +715,8 @@ extern int get_data(void)
 		list_sort(jobs, _sort_desc_submit_time);
 
 	itr = list_iterator_create(jobs);
-	while ((job = list_next(itr))) {
-
-		if (!job->steps || !(cnt = list_count(job->steps)))
-			continue;
-
-		itr_step = list_iterator_create(job->steps);
-		while ((step = list_next(itr_step))) {
-			/* now aggregate the aggregatable */
-
-			if (step->state < JOB_COMPLETE)
-				continue;
-			job->tot_cpu_sec += step->tot_cpu_sec;
-			job->tot_cpu_usec += step->tot_cpu_usec;
-			job->user_cpu_sec +=
-				step->user_cpu_sec;
-			job->user_cpu_usec +=
-				step->user_cpu_usec;
-			job->sys_cpu_sec +=
-				step->sys_cpu_sec;
-			job->sys_cpu_usec +=
-				step->sys_cpu_usec;
-		}
-		list_iterator_destroy(itr_step);
-	}
+	while ((job = list_next(itr)))
+		_sum_job_steps(job);
 	list_iterator_destroy(itr);
 
 	return SLURM_SUCCESS;
@@ -500,6 +790,7 @@ extern void parse_command_line(int argc, char **argv)
                 {"reason",         required_argument, 0,    'R'},
                 {"state",          required_argument, 0,    's'},
                 {"starttime",      required_argument, 0,    'S'},
+                {"stream",         no_argument,       0,    OPT_LONG_STREAM},
                 {"truncate",       no_argument,       0,    'T'},
                 {"uid",            required_argument, 0,    'u'},
 		{"use-local-uid",  no_argument,       0,    OPT_LONG_LOCAL_UID},
@@ -754,6 +1045,9 @@ extern void parse_command_line(int argc, char **argv)
 			if (errno == ESLURM_INVALID_TIME_VALUE)
 				exit(1);
 			break;
+		case OPT_LONG_STREAM:
+			params.opt_stream = true;
+			break;
 		case 'T':
 			job_cond->flags &= ~JOBCOND_FLAG_NO_TRUNC;
 			break;
@@ -1264,6 +1558,119 @@ static void _print_env(slurmdb_job_rec_t *job)
 	printf("%s", job->env ? job->env : "NONE\n");
 }
 
+typedef struct {
+	slurmdb_job_columns_t *columns;
+	uint32_t row;
+} job_row_t;
+
+static uint64_t _job_row_val(job_row_t *r, slurmdb_job_col_t col)
+{
+	if (!r->columns->num[col])
+		return 0;
+	return r->columns->num[col][r->row];
+}
+
+/* Same order as _sort_desc_submit_time() */
+static int _sort_job_rows(const void *x, const void *y)
+{
+	job_row_t *r1 = (job_row_t *) x;
+	job_row_t *r2 = (job_row_t *) y;
+	slurmdb_job_col_t keys[] = {
+		SLURMDB_JOB_COL_SUBMIT,
+		SLURMDB_JOB_COL_ARRAY_JOB_ID,
+		SLURMDB_JOB_COL_ARRAY_TASK_ID,
+		SLURMDB_JOB_COL_JOBID,
+	};
+
+	for (int i = 0; i < ARRAY_SIZE(keys); i++) {
+		uint64_t v1 = _job_row_val(r1, keys[i]);
+		uint64_t v2 = _job_row_val(r2, keys[i]);
+
+		if (v1 < v2)
+			return -1;
+		else if (v1 > v2)
+			return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Print job_columns in the same order and format as full job records, each
+ * row is turned into a short lived job record only holding the columns.
+ */
+static void _list_job_columns(void)
+{
+	slurmdb_job_columns_t *columns;
+	job_row_t *rows;
+	uint32_t rec_cnt = 0, inx = 0;
+	list_itr_t *itr;
+
+	itr = list_iterator_create(job_columns);
+	while ((columns = list_next(itr)))
+		rec_cnt += columns->rec_cnt;
+
+	rows = xcalloc(rec_cnt, sizeof(*rows));
+	list_iterator_reset(itr);
+	while ((columns = list_next(itr))) {
+		for (uint32_t i = 0; i < columns->rec_cnt; i++) {
+			rows[inx].columns = columns;
+			rows[inx++].row = i;
+		}
+	}
+	list_iterator_destroy(itr);
+
+	qsort(rows, rec_cnt, sizeof(*rows), _sort_job_rows);
+
+	for (inx = 0; inx < rec_cnt; inx++) {
+		slurmdb_job_rec_t *job = slurmdb_create_job_rec();
+
+		slurmdb_job_columns_2_rec(rows[inx].columns, rows[inx].row,
+					  job);
+		if (!params.cluster_name || !_test_local_job(job->jobid) ||
+		    !xstrcmp(params.cluster_name, job->cluster))
+			print_fields(JOB, job);
+		slurmdb_destroy_job_rec(job);
+	}
+
+	xfree(rows);
+}
+
+/* Print a job and its steps */
+static void _print_job(slurmdb_job_rec_t *job)
+{
+	list_itr_t *itr_step = NULL;
+	slurmdb_step_rec_t *step = NULL;
+	slurmdb_job_cond_t *job_cond = params.job_cond;
+
+	if ((params.cluster_name) &&
+	    _test_local_job(job->jobid) &&
+	    xstrcmp(params.cluster_name, job->cluster))
+		return;
+
+	if (job_cond->flags & JOBCOND_FLAG_SCRIPT) {
+		_print_script(job);
+		return;
+	} else if (job_cond->flags & JOBCOND_FLAG_ENV) {
+		_print_env(job);
+		return;
+	}
+
+	if (job->show_full)
+		print_fields(JOB, job);
+
+	if (!(job_cond->flags & JOBCOND_FLAG_NO_STEP)) {
+		itr_step = list_iterator_create(job->steps);
+		while ((step = list_next(itr_step))) {
+			if ((step->end == 0) &&
+			    (job->state != JOB_RESIZING))
+				step->end = job->end;
+			print_fields(JOBSTEP, step);
+		}
+		list_iterator_destroy(itr_step);
+	}
+}
+
 /* do_list() -- List the assembled data
  *
  * In:	Nothing explicit.
@@ -1275,10 +1682,7 @@ static void _print_env(slurmdb_job_rec_t *job)
 extern void do_list(data_parser_t *parser)
 {
 	list_itr_t *itr = NULL;
-	list_itr_t *itr_step = NULL;
 	slurmdb_job_rec_t *job = NULL;
-	slurmdb_step_rec_t *step = NULL;
-	slurmdb_job_cond_t *job_cond = params.job_cond;
 
 	if (params.mimetype) {
 		errno = data_parser_dump_cli_single(
@@ -1286,38 +1690,17 @@ extern void do_list(data_parser_t *parser)
 		return;
 	}
 
+	if (job_columns) {
+		_list_job_columns();
+		return;
+	}
+
 	if (!jobs)
 		return;
 
 	itr = list_iterator_create(jobs);
-	while ((job = list_next(itr))) {
-		if ((params.cluster_name) &&
-		    _test_local_job(job->jobid) &&
-		    xstrcmp(params.cluster_name, job->cluster))
-			continue;
-
-		if (job_cond->flags & JOBCOND_FLAG_SCRIPT) {
-			_print_script(job);
-			continue;
-		} else if (job_cond->flags & JOBCOND_FLAG_ENV) {
-			_print_env(job);
-			continue;
-		}
-
-		if (job->show_full)
-			print_fields(JOB, job);
-
-		if (!(job_cond->flags & JOBCOND_FLAG_NO_STEP)) {
-			itr_step = list_iterator_create(job->steps);
-			while ((step = list_next(itr_step))) {
-				if ((step->end == 0) &&
-				    (job->state != JOB_RESIZING))
-					step->end = job->end;
-				print_fields(JOBSTEP, step);
-			}
-			list_iterator_destroy(itr_step);
-		}
-	}
+	while ((job = list_next(itr)))
+		_print_job(job);
 	list_iterator_destroy(itr);
 }
 
@@ -1358,6 +1741,7 @@ extern void sacct_fini(void)
 		list_iterator_destroy(print_fields_itr);
 	FREE_NULL_LIST(print_fields_list);
 	FREE_NULL_LIST(jobs);
+	FREE_NULL_LIST(job_columns);
 	FREE_NULL_LIST(g_qos_list);
 	FREE_NULL_LIST(g_tres_list);
 
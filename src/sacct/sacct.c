@@ -169,6 +169,7 @@ print_field_t fields[] = {
 };
 
 list_t *jobs = NULL;
+list_t *job_columns = NULL;
 
 int main(int argc, char **argv)
 {
@@ -222,6 +222,7 @@ typedef struct {
 	gid_t opt_gid;		/* running persons gid */
 	bool opt_local;		/* --local */
 	int opt_noheader;	/* can only be cleared */
+	bool opt_stream;	/* --stream */
 	uid_t opt_uid;		/* running persons uid */
 	int units;		/* --units*/
 	bool use_local_uid;	/* --use-local-uid */
@@ -233,6 +234,7 @@ extern print_field_t fields[];
 extern sacct_parameters_t params;
 
 extern list_t *jobs;
+extern list_t *job_columns; /* slurmdb_job_columns_t's, used instead of jobs */
 extern list_t *print_fields_list;
 extern list_itr_t *print_fields_itr;
 extern int field_count;
@@ -61,6 +61,7 @@
 #define OPT_LONG_SEND_LIBS 0x103
 #define OPT_LONG_AUTOCOMP  0x104
 #define OPT_LONG_TREE_WIDTH 0x105
+#define OPT_LONG_PIPELINE  0x106
 
 
 /* getopt_long options, integers but not characters */
@@ -71,6 +72,7 @@ static void _fill_in_selected_step_from_env(void);
 static void _fill_in_selected_steps_from_env(char *het_size_str);
 static void     _help( void );
 static bool _need_hetjob_components(job_info_msg_t **job_info_msg);
+static uint32_t _map_pipeline(char *buf);
 static uint32_t _map_size( char *buf );
 static void     _print_options( void );
 static void     _usage( void );
@@ -195,6 +197,7 @@ extern void parse_command_line(int argc, char **argv)
 		{"jobid",     required_argument, 0, 'j'},
 		{"no-allocation", optional_argument, 0, 'Z'},
 		{"nodelist",  optional_argument, 0, 'w'},
+		{"pipeline",  required_argument, 0, OPT_LONG_PIPELINE},
 		{"send-libs", optional_argument, 0, OPT_LONG_SEND_LIBS},
 		{"preserve",  no_argument,       0, 'p'},
 		{"size",      required_argument, 0, 's'},
@@ -212,6 +215,12 @@ extern void parse_command_line(int argc, char **argv)
 		xfree(tmp);
 	}
 
+	if ((tmp = conf_get_opt_str(slurm_conf.bcast_parameters,
+				    "Pipeline="))) {
+		params.pipeline = _map_pipeline(tmp);
+		xfree(tmp);
+	}
+
 	if (slurm_conf.bcast_exclude)
 		params.exclude = xstrdup(slurm_conf.bcast_exclude);
 
@@ -228,6 +237,8 @@ extern void parse_command_line(int argc, char **argv)
 		else
 			params.tree_width = atoi(env_val);
 	}
+	if ((env_val = getenv("SBCAST_PIPELINE")))
+		params.pipeline = _map_pipeline(env_val);
 	if (getenv("SBCAST_FORCE"))
 		params.flags |= BCAST_FLAG_FORCE;
 
@@ -288,6 +299,9 @@ extern void parse_command_line(int argc, char **argv)
 		case (int)'p':
 			params.flags |= BCAST_FLAG_PRESERVE;
 			break;
+		case OPT_LONG_PIPELINE:
+			params.pipeline = _map_pipeline(optarg);
+			break;
 		case (int) OPT_LONG_SEND_LIBS:
 			ret = parse_send_libs(optarg);
 			if (ret == -1)
@@ -410,6 +424,18 @@ static uint32_t _map_size( char *buf )
 	return (uint32_t) b_size;
 }
 
+/* map count of blocks in flight, 0 if invalid */
+static uint32_t _map_pipeline(char *buf)
+{
+	uint32_t count;
+
+	if (parse_uint32(buf, &count)) {
+		fprintf(stderr, "pipeline specification is invalid, ignored\n");
+		return 0;
+	}
+	return count;
+}
+
 /* print the parameters specified */
 static void _print_options( void )
 {
@@ -419,6 +445,7 @@ static void _print_options( void )
 	info("exclude    = %s", params.exclude);
 	info("force      = %s",
 	     (params.flags & BCAST_FLAG_FORCE) ? "true" : "false");
+	info("pipeline   = %u", params.pipeline);
 	info("treewidth     = %d", params.tree_width);
 	info("preserve   = %s",
 	     (params.flags & BCAST_FLAG_PRESERVE) ? "true" : "false");
@@ -434,7 +461,7 @@ static void _print_options( void )
 
 static void _usage( void )
 {
-	printf("Usage: sbcast [--exclude] [-CfFjpvV] [--send-libs] SOURCE DEST\n");
+	printf("Usage: sbcast [--exclude] [-CfFjpvV] [--pipeline] [--send-libs] SOURCE DEST\n");
 }
 
 static void _help( void )
@@ -446,6 +473,7 @@ Usage: sbcast [OPTIONS] SOURCE DEST\n\
   -f, --force           replace destination file as required\n\
   --treewidth=num       specify message treewidth\n\
   -j, --jobid=#[+#][.#] specify job ID with optional hetjob offset and/or step ID\n\
+  --pipeline=num        blocks to send before waiting for replies\n\
   -p, --preserve        preserve modes and times of source file\n\
   --send-libs[=yes|no]  autodetect and broadcast executable's shared objects\n\
   -s, --size=num        block size in bytes (rounded off)\n\
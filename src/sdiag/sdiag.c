@@ -241,6 +241,38 @@ static int _print_stats(void)
 		       buf->bf_exit[i]);
 	}
 
+	printf("\nAssociation manager lookups\n");
+	printf("\tAssociations: %"PRIu64"\n", buf->assoc_mgr_assoc_lookups);
+	printf("\tQOS: %"PRIu64"\n", buf->assoc_mgr_qos_lookups);
+	printf("\tUsers: %"PRIu64"\n", buf->assoc_mgr_user_lookups);
+	printf("\tWCKeys: %"PRIu64"\n", buf->assoc_mgr_wckey_lookups);
+
+	printf("\nConnection pool to slurmd\n");
+	printf("\tConnects: %"PRIu64"\n", buf->conn_pool_connects);
+	printf("\tReused: %"PRIu64"\n", buf->conn_pool_reused);
+	if (buf->req_time > buf->req_time_start)
+		printf("\tConnects saved per second: %.2f\n",
+		       ((double) buf->conn_pool_reused /
+			(buf->req_time - buf->req_time_start)));
+	printf("\tStale: %"PRIu64"\n", buf->conn_pool_stale);
+	printf("\tExpired: %"PRIu64"\n", buf->conn_pool_expired);
+	printf("\tRetries: %"PRIu64"\n", buf->conn_pool_retries);
+
+	printf("\nVerified authentication token cache\n");
+	printf("\tHits: %"PRIu64"\n", buf->auth_cache_hits);
+	printf("\tMisses: %"PRIu64"\n", buf->auth_cache_misses);
+	if (buf->auth_cache_hits + buf->auth_cache_misses)
+		printf("\tHit rate: %.2f%%\n",
+		       (100.0 * buf->auth_cache_hits /
+			(buf->auth_cache_hits + buf->auth_cache_misses)));
+	printf("\tEvictions: %"PRIu64"\n", buf->auth_cache_evictions);
+
+	printf("\nMessage buffers\n");
+	printf("\tAllocated: %"PRIu64"\n", buf->buf_allocs);
+	printf("\tReused: %"PRIu64"\n", buf->buf_reused);
+	printf("\tGrown in place: %"PRIu64"\n", buf->buf_grown_in_place);
+	printf("\tReallocated: %"PRIu64"\n", buf->buf_reallocs);
+
 	printf("\nLatency for 1000 calls to gettimeofday(): %d microseconds\n",
 	       buf->gettimeofday_latency);
 
@@ -273,6 +305,26 @@ static int _print_stats(void)
 		xfree(user);
 	}
 
+	printf("\nRemote Procedure Call compression statistics by message type\n");
+	for (i = 0; i < buf->rpc_compress_size; i++) {
+		double ratio = 0.0;
+
+		if (buf->rpc_compress_wire_bytes[i])
+			ratio = (double) buf->rpc_compress_raw_bytes[i] /
+				buf->rpc_compress_wire_bytes[i];
+
+		printf("\t%-40s(%5u) compressed:%-6u skipped:%-6u raw_bytes:%-12"PRIu64" wire_bytes:%-12"PRIu64" ratio:%-6.2f compress_time:%-12"PRIu64" decompressed:%-6u decompress_time:%"PRIu64"\n",
+		       rpc_num2string(buf->rpc_compress_type_id[i]),
+		       buf->rpc_compress_type_id[i], buf->rpc_compress_cnt[i],
+		       buf->rpc_compress_skipped[i],
+		       buf->rpc_compress_raw_bytes[i],
+		       buf->rpc_compress_wire_bytes[i], ratio,
+		       buf->rpc_compress_time[i], buf->rpc_decompress_cnt[i],
+		       buf->rpc_decompress_time[i]);
+	}
+	if (!buf->rpc_compress_size)
+		printf("\tNo RPCs compressed yet.\n");
+
 	printf("\nPending RPC statistics\n");
 	if (buf->rpc_queue_type_count == 0)
 		printf("\tNo pending RPCs\n");
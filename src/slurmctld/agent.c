@@ -75,6 +75,7 @@
 #include <unistd.h>
 
 #include "src/common/env.h"
+#include "src/common/fanout.h"
 #include "src/common/fd.h"
 #include "src/common/forward.h"
 #include "src/common/list.h"
@@ -149,6 +150,7 @@ typedef struct {
 	uint16_t retry;			/* if set, keep trying */
 	thd_t *thread_struct;		/* thread structures */
 	bool get_reply;			/* flag if reply expected */
+	bool fanout;			/* send over conmgr connections */
 	uid_t r_uid;			/* receiver UID */
 	slurm_msg_type_t msg_type;	/* RPC to be issued */
 	void **msg_args_pptr;		/* RPC data to be used */
@@ -165,6 +167,7 @@ typedef struct {
 	uint32_t *threads_active_ptr;	/* currently active thread ptr */
 	thd_t *thread_struct_ptr;	/* thread structures ptr */
 	bool get_reply;			/* flag if reply expected */
+	bool fanout;			/* send over conmgr connections */
 	uid_t r_uid;			/* receiver UID */
 	slurm_msg_type_t msg_type;	/* RPC to be issued */
 	void *msg_args_ptr;		/* ptr to RPC data to be used */
@@ -196,8 +199,10 @@ static void _agent_retry(int min_wait, bool wait_too);
 static int  _batch_launch_defer(queued_request_t *queued_req_ptr);
 static int  _signal_defer(queued_request_t *queued_req_ptr);
 static inline int _comm_err(char *node_name, slurm_msg_type_t msg_type);
+static bool _is_fanout_direct_msg(slurm_msg_type_t msg_type);
 static void _list_delete_retry(void *retry_entry);
-static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr);
+static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr,
+				      bool fanout);
 static task_info_t *_make_task_data(agent_info_t *agent_info_ptr, int inx);
 static void _notify_slurmctld_jobs(agent_info_t *agent_ptr);
 static void _notify_slurmctld_nodes(agent_info_t *agent_ptr,
@@ -280,6 +285,7 @@ void *agent(void *args)
 	time_t begin_time;
 	bool spawn_retry_agent = false;
 	int rpc_thread_cnt;
+	bool fanout = (!agent_arg_ptr->addr && fanout_enabled());
 
 	log_flag(AGENT, "%s: Agent_cnt=%d agent_thread_cnt=%d with msg_type=%s retry_list_size=%d",
 		 __func__, agent_cnt, agent_thread_cnt,
@@ -288,7 +294,11 @@ void *agent(void *args)
 
 	slurm_mutex_lock(&agent_cnt_mutex);
 
-	rpc_thread_cnt = 2 + MIN(agent_arg_ptr->node_count, AGENT_THREAD_COUNT);
+	if (fanout && _is_fanout_direct_msg(agent_arg_ptr->msg_type))
+		rpc_thread_cnt = 3;
+	else
+		rpc_thread_cnt = 2 + MIN(agent_arg_ptr->node_count,
+					 AGENT_THREAD_COUNT);
 	while (1) {
 		if (slurmctld_config.shutdown_time ||
 		    ((agent_thread_cnt+rpc_thread_cnt) <= MAX_SERVER_THREADS)) {
@@ -309,7 +319,7 @@ void *agent(void *args)
 		goto cleanup;
 
 	/* initialize the agent data structures */
-	agent_info_ptr = _make_agent_info(agent_arg_ptr);
+	agent_info_ptr = _make_agent_info(agent_arg_ptr, fanout);
 	thread_ptr = agent_info_ptr->thread_struct;
 
 	/* start the watchdog thread */
@@ -428,7 +438,19 @@ static int _valid_agent_arg(agent_arg_t *agent_arg_ptr)
 	return SLURM_SUCCESS;
 }
 
-static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr)
+/*
+ * Messages which are sent directly to each node without a reply. These can be
+ * sent to all of the nodes by a single agent thread when using fanout.
+ */
+static bool _is_fanout_direct_msg(slurm_msg_type_t msg_type)
+{
+	return ((msg_type == REQUEST_RECONFIGURE) ||
+		(msg_type == REQUEST_RECONFIGURE_WITH_CONFIG) ||
+		(msg_type == REQUEST_REBOOT_NODES));
+}
+
+static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr,
+				      bool fanout)
 {
 	agent_info_t *agent_info_ptr = NULL;
 	thd_t *thread_ptr = NULL;
@@ -450,6 +472,7 @@ static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr)
 	agent_info_ptr->msg_flags = agent_arg_ptr->msg_flags;
 	agent_info_ptr->protocol_version = agent_arg_ptr->protocol_version;
 	agent_info_ptr->tls_cert = agent_arg_ptr->tls_cert;
+	agent_info_ptr->fanout = fanout;
 
 	if (!agent_info_ptr->thread_count)
 		return agent_info_ptr;
@@ -482,6 +505,11 @@ static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr)
 		 * Send the message directly to each node. */
 		split = true;
 	}
+	if (split && fanout && _is_fanout_direct_msg(agent_arg_ptr->msg_type)) {
+		/* Every node is connected to by conmgr from one thread */
+		hostlist_uniq(agent_arg_ptr->hostlist);
+		split = false;
+	}
 	if (agent_arg_ptr->addr || !split) {
 		thread_ptr[0].state = DSH_NEW;
 		if (agent_arg_ptr->addr) {
@@ -544,6 +572,7 @@ static task_info_t *_make_task_data(agent_info_t *agent_info_ptr, int inx)
 	task_info_ptr->threads_active_ptr= &agent_info_ptr->threads_active;
 	task_info_ptr->thread_struct_ptr = &agent_info_ptr->thread_struct[inx];
 	task_info_ptr->get_reply         = agent_info_ptr->get_reply;
+	task_info_ptr->fanout = agent_info_ptr->fanout;
 	task_info_ptr->r_uid = agent_info_ptr->r_uid;
 	task_info_ptr->msg_type          = agent_info_ptr->msg_type;
 	task_info_ptr->msg_args_ptr      = *agent_info_ptr->msg_args_pptr;
@@ -1036,8 +1065,13 @@ static void *_thread_per_group_rpc(void *args)
 				goto cleanup;
 			}
 		} else if (thread_ptr->nodelist) {
-			if (!(ret_list = start_msg_tree(thread_ptr->nodelist,
-							&msg, 0))) {
+			if (task_ptr->fanout)
+				ret_list = start_msg_tree_fanout(
+					thread_ptr->nodelist, &msg, 0);
+			else
+				ret_list = start_msg_tree(thread_ptr->nodelist,
+							  &msg, 0);
+			if (!ret_list) {
 				error("%s: no ret_list given", __func__);
 				goto cleanup;
 			}
@@ -1048,6 +1082,11 @@ static void *_thread_per_group_rpc(void *args)
 				goto cleanup;
 			}
 		}
+	} else if (thread_ptr->nodelist) {
+		xassert(task_ptr->fanout);
+		/* Nodes not sent to are RESPONSE_FORWARD_FAILED */
+		ret_list = fanout_send_msgs_direct(thread_ptr->nodelist, &msg,
+						   0, FANOUT_FLAG_NO_REPLY);
 	} else {
 		if (thread_ptr->addr) {
 			//info("got the address");
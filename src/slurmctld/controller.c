@@ -1025,6 +1025,7 @@ int main(int argc, char **argv)
 				      slurm_strerror(error_code));
 			}
 			configless_update();
+			ping_nodes_init();
 			if (conf_includes_list) {
 				/*
 				 * clear included files so that subsequent conf
@@ -2709,6 +2710,8 @@ static void *_slurmctld_background(void *no_data)
 			 * and restore them to service */
 			ping_interval = 100;	/* 100 seconds */
 		}
+		/* Spread one ping of every node over ping_slices calls */
+		ping_interval = MAX(1, ping_interval / ping_nodes_slices());
 
 		if (!last_ping_node_time) {
 			last_ping_node_time = now + (time_t)MIN_CHECKIN_TIME -
@@ -10358,13 +10358,14 @@ static int _foreach_pack_jobid(void *object, void *arg)
 
 /*
  * _pack_init_job_info - create buffer with header packed for a job_info_msg_t
+ * IN size - initial size of buffer
  *
  * NOTE: change _unpack_job_info_msg() in common/slurm_protocol_pack.c
  *	whenever the data format changes
  */
-static buf_t *_pack_init_job_info(uint16_t protocol_version)
+static buf_t *_pack_init_job_info(uint32_t size, uint16_t protocol_version)
 {
-	buf_t *buffer = init_buf(BUF_SIZE);
+	buf_t *buffer = init_buf(size);
 
 	/* write message body header : size and time */
 	/* put in a place holder job record count of 0 for now */
@@ -10392,7 +10393,8 @@ extern buf_t *pack_all_jobs(uint16_t show_flags, uid_t uid, uint32_t filter_uid,
 {
 	uint32_t tmp_offset;
 	_foreach_pack_job_info_t pack_info = {
-		.buffer = _pack_init_job_info(protocol_version),
+		.buffer = _pack_init_job_info(buf_size_hint(RESPONSE_JOB_INFO),
+					      protocol_version),
 		.filter_uid = filter_uid,
 		.jobs_packed = 0,
 		.protocol_version = protocol_version,
@@ -10418,6 +10420,7 @@ extern buf_t *pack_all_jobs(uint16_t show_flags, uid_t uid, uint32_t filter_uid,
 	set_buf_offset(pack_info.buffer, 0);
 	pack32(pack_info.jobs_packed, pack_info.buffer);
 	set_buf_offset(pack_info.buffer, tmp_offset);
+	buf_size_hint_update(RESPONSE_JOB_INFO, tmp_offset);
 
 	xfree(pack_info.visible_parts);
 
@@ -10440,7 +10443,7 @@ extern buf_t *pack_spec_jobs(list_t *job_ids, uint16_t show_flags, uid_t uid,
 {
 	uint32_t tmp_offset;
 	_foreach_pack_job_info_t pack_info = {
-		.buffer = _pack_init_job_info(protocol_version),
+		.buffer = _pack_init_job_info(BUF_SIZE, protocol_version),
 		.filter_uid = filter_uid,
 		.jobs_packed = 0,
 		.protocol_version = protocol_version,
@@ -10493,7 +10496,7 @@ extern buf_t *pack_one_job(slurm_step_id_t *step_id, uint16_t show_flags,
 	bool hide_job = false;
 	bool valid_operator;
 
-	buffer = _pack_init_job_info(protocol_version);
+	buffer = _pack_init_job_info(BUF_SIZE, protocol_version);
 
 	assoc_mgr_lock(&locks);
 	user_rec.uid = uid;
@@ -969,7 +969,8 @@ extern buf_t *pack_all_nodes(uint16_t show_flags, uid_t uid,
 	xassert(verify_lock(CONF_LOCK, READ_LOCK));
 	xassert(verify_lock(PART_LOCK, READ_LOCK));
 
-	buffer = init_buf(BUF_SIZE * 16);
+	buffer = init_buf(MAX((BUF_SIZE * 16),
+			      buf_size_hint(RESPONSE_NODE_INFO)));
 	nodes_packed = 0;
 
 	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
@@ -1016,6 +1017,7 @@ extern buf_t *pack_all_nodes(uint16_t show_flags, uid_t uid,
 	set_buf_offset(buffer, 0);
 	pack32(nodes_packed, buffer);
 	set_buf_offset(buffer, tmp_offset);
+	buf_size_hint_update(RESPONSE_NODE_INFO, tmp_offset);
 
 	_free_pack_node_info_members(&pack_info);
 
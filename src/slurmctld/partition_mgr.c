@@ -975,7 +975,7 @@ extern buf_t *pack_all_part(uint16_t show_flags, uid_t uid,
 	time_t now = time(NULL);
 	bool privileged = validate_operator(uid);
 	_foreach_pack_part_info_t pack_info = {
-		.buffer = init_buf(BUF_SIZE),
+		.buffer = init_buf(buf_size_hint(RESPONSE_PARTITION_INFO)),
 		.parts_packed = 0,
 		.privileged = privileged,
 		.protocol_version = protocol_version,
@@ -995,6 +995,7 @@ extern buf_t *pack_all_part(uint16_t show_flags, uid_t uid,
 	set_buf_offset(pack_info.buffer, 0);
 	pack32(pack_info.parts_packed, pack_info.buffer);
 	set_buf_offset(pack_info.buffer, tmp_offset);
+	buf_size_hint_update(RESPONSE_PARTITION_INFO, tmp_offset);
 
 	xfree(pack_info.visible_parts);
 	return pack_info.buffer;
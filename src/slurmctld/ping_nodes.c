@@ -62,6 +62,7 @@ static pthread_mutex_t lock_mutex = PTHREAD_MUTEX_INITIALIZER;
 static bool ping_updated = false;
 static int ping_count = 0;
 static time_t ping_start = 0;
+static int ping_slices = 1;
 
 /*
  * is_ping_done - test if the last node ping cycle has completed.
@@ -160,8 +161,11 @@ void ping_nodes (void)
 					 * communication delays */
 	int i;
 	time_t now = time(NULL), still_live_time, node_dead_time;
-	static time_t last_ping_time = (time_t) 0;
+	static time_t last_ping_time = (time_t) 0; /* previous full ping */
 	static time_t last_ping_timeout = (time_t) 0;
+	static time_t full_ping_time = (time_t) 0; /* current full ping */
+	static int slice = -1;
+	int slices = ping_slices;
 	hostlist_t *down_hostlist = NULL;
 	char *host_str = NULL;
 	agent_arg_t *ping_agent_args = NULL;
@@ -183,6 +187,18 @@ void ping_nodes (void)
 	reg_agent_args->protocol_version = SLURM_PROTOCOL_VERSION;
 	reg_agent_args->hostlist = hostlist_create(NULL);
 
+	/*
+	 * With ping_slices each call only pings the nodes of one slice, so
+	 * a full ping of every node still takes ping_slices calls. Only
+	 * move the periodic registration window once per full ping.
+	 */
+	if (++slice >= slices)
+		slice = 0;
+	if (!slice) {
+		last_ping_time = full_ping_time;
+		full_ping_time = now;
+	}
+
 	/*
 	 * If there are a large number of down nodes, the node ping
 	 * can take a long time to complete:
@@ -190,7 +206,8 @@ void ping_nodes (void)
 	 *  ping_time = down_nodes * 10_seconds / 10
 	 *  ping_time = down_nodes (seconds)
 	 * Because of this, we extend the SlurmdTimeout by the
-	 * time needed to complete a ping of all nodes.
+	 * time needed to complete a ping of all nodes. That is from
+	 * the start of the previous full ping, not the previous slice.
 	 */
 	if ((last_ping_timeout == 0) ||
 	    (last_ping_time == (time_t) 0)) {
@@ -199,17 +216,19 @@ void ping_nodes (void)
 		node_dead_time = last_ping_time - last_ping_timeout;
 	}
 	still_live_time = now - (slurm_conf.slurmd_timeout / 3);
-	last_ping_time  = now;
 	last_ping_timeout = slurm_conf.slurmd_timeout;
 
 	if (max_reg_threads == 0) {
 		max_reg_threads = MAX(slurm_conf.tree_width, 1);
 		max_reg_threads = MIN(max_reg_threads, 50);
 	}
-	reg_offset += max_reg_threads;
-	if ((reg_offset > active_node_record_count) &&
-	    (reg_offset >= (max_reg_threads * MAX_REG_FREQUENCY)))
-		reg_offset = 0;
+
+	if (!slice) {
+		reg_offset += max_reg_threads;
+		if ((reg_offset > active_node_record_count) &&
+		    (reg_offset >= (max_reg_threads * MAX_REG_FREQUENCY)))
+			reg_offset = 0;
+	}
 
 	for (i = 0; (node_ptr = next_node(&i)); i++) {
 		node_offset++;
@@ -252,7 +271,7 @@ void ping_nodes (void)
 		 * once in a while). We limit these requests since they
 		 * can generate a flood of incoming RPCs. */
 		if (IS_NODE_UNKNOWN(node_ptr) || (node_ptr->boot_time == 0) ||
-		    ((node_offset >= reg_offset) &&
+		    (!slice && (node_offset >= reg_offset) &&
 		     (node_offset < (reg_offset + max_reg_threads)))) {
 			if (reg_agent_args->protocol_version >
 			    node_ptr->protocol_version)
@@ -277,6 +296,9 @@ void ping_nodes (void)
 		if (IS_NODE_NO_RESPOND(node_ptr) && IS_NODE_DOWN(node_ptr))
 			continue;
 
+		if ((node_ptr->index % slices) != slice)
+			continue;
+
 		if (ping_agent_args->protocol_version >
 		    node_ptr->protocol_version)
 			ping_agent_args->protocol_version =
@@ -330,6 +352,25 @@ void ping_nodes (void)
 	}
 }
 
+extern void ping_nodes_init(void)
+{
+	char *tmp_ptr;
+	int slices = 1;
+
+	if ((tmp_ptr = conf_get_opt_str(slurm_conf.slurmctld_params,
+					"ping_slices="))) {
+		slices = atoi(tmp_ptr);
+		xfree(tmp_ptr);
+	}
+
+	ping_slices = MAX(slices, 1);
+}
+
+extern int ping_nodes_slices(void)
+{
+	return ping_slices;
+}
+
 /*
  * Return true when ctld considers node_ptr out of service for the
  * health-check health signal: down, draining or drained, failing, or in
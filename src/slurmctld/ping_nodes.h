@@ -78,4 +78,18 @@ extern void ping_end (void);
  */
 extern void ping_nodes (void);
 
+/*
+ * ping_nodes_init - read the SlurmctldParameters used by ping_nodes().
+ *	Call after slurm_conf is (re)loaded.
+ */
+extern void ping_nodes_init(void);
+
+/*
+ * ping_nodes_slices - number of ping_nodes() calls that one ping of every node
+ *	is spread over (SlurmctldParameters=ping_slices=#). ping_nodes() must be
+ *	called that many times more often than a single call ping would be.
+ * RET number of slices, 1 if not configured
+ */
+extern int ping_nodes_slices(void);
+
 #endif /* !_HAVE_PING_NODES_H */
@@ -55,6 +55,17 @@
 #include "src/slurmctld/state_save.h"
 
 bool enabled = true;
+/* Only node registrations are queued (SlurmctldParameters=node_reg_queue) */
+static bool node_reg_only = false;
+
+/* RET true if q has a running queue */
+static bool _queue_running(slurmctld_rpc_t *q)
+{
+	if (node_reg_only && (q->msg_type != MESSAGE_NODE_REGISTRATION_STATUS))
+		return false;
+
+	return q->queue_enabled;
+}
 
 static void *_rpc_queue_worker(void *arg)
 {
@@ -158,12 +169,10 @@ static void *_rpc_queue_worker(void *arg)
 			long delta = -1;
 
 			START_TIMER;
-			if (q->max_queued) {
-				slurm_mutex_lock(&q->mutex);
-				q->queued--;
-				record_rpc_queue_stats(q);
-				slurm_mutex_unlock(&q->mutex);
-			}
+			slurm_mutex_lock(&q->mutex);
+			q->queued--;
+			record_rpc_queue_stats(q);
+			slurm_mutex_unlock(&q->mutex);
 			msg->flags |= CTLD_QUEUE_PROCESSING;
 
 			slurmctld_req(msg, q);
@@ -280,21 +289,37 @@ static void _apply_config(data_t *conf, slurmctld_rpc_t *q)
 extern void rpc_queue_init(void)
 {
 	data_t *conf = NULL;
+	bool all_queues = xstrcasestr(slurm_conf.slurmctld_params,
+				      "enable_rpc_queue");
 
-	if (!xstrcasestr(slurm_conf.slurmctld_params, "enable_rpc_queue")) {
+	/*
+	 * node_reg_queue only queues node registrations, so a burst of them
+	 * (e.g. all slurmd registering after a slurmctld restart) is applied
+	 * in batches under one lock acquisition instead of one each.
+	 */
+	if (!all_queues &&
+	    !xstrcasestr(slurm_conf.slurmctld_params, "node_reg_queue")) {
 		enabled = false;
 		return;
 	}
 
-	error("enabled experimental rpc queuing system");
-
-	conf = _load_config();
+	if (all_queues) {
+		error("enabled experimental rpc queuing system");
+		conf = _load_config();
+	} else {
+		node_reg_only = true;
+	}
 
 	for (slurmctld_rpc_t *q = slurmctld_rpcs; q->msg_type; q++) {
 		char name[PRCTL_BUF_BYTES] = "INVALID";
 		bool was_enabled = q->queue_enabled;
 		q->msg_name = rpc_num2string(q->msg_type);
 
+		/* Leave the defaults in slurmctld_rpcs as they are */
+		if (node_reg_only &&
+		    (q->msg_type != MESSAGE_NODE_REGISTRATION_STATUS))
+			continue;
+
 		_apply_config(conf, q);
 
 		/* config may have disabled this queue, check again */
@@ -334,7 +359,7 @@ extern void rpc_queue_shutdown(void)
 
 	/* mark all as shut down */
 	for (slurmctld_rpc_t *q = slurmctld_rpcs; q->msg_type; q++) {
-		if (!q->queue_enabled)
+		if (!_queue_running(q))
 			continue;
 
 		slurm_mutex_lock(&q->mutex);
@@ -345,7 +370,7 @@ extern void rpc_queue_shutdown(void)
 
 	/* wait for completion and cleanup */
 	for (slurmctld_rpc_t *q = slurmctld_rpcs; q->msg_type; q++) {
-		if (!q->queue_enabled)
+		if (!_queue_running(q))
 			continue;
 
 		slurm_thread_join(q->thread);
@@ -368,30 +393,29 @@ extern int rpc_enqueue(slurmctld_rpc_t *q, slurm_msg_t *msg)
 	xassert(q->msg_type == msg->msg_type);
 
 	/* check if RPC does not have a dedicated queue */
-	if (!q->queue_enabled)
+	if (!_queue_running(q))
 		return ESLURM_NOT_SUPPORTED;
 
-	if (q->max_queued) {
-		slurm_mutex_lock(&q->mutex);
-
-		if (q->queued >= q->max_queued) {
-			q->dropped++;
-			record_rpc_queue_stats(q);
-
-			slurm_mutex_unlock(&q->mutex);
-
-			if (q->hard_drop)
-				return SLURMCTLD_COMMUNICATIONS_HARD_DROP;
-			else
-				return SLURMCTLD_COMMUNICATIONS_BACKOFF;
-		}
+	slurm_mutex_lock(&q->mutex);
 
-		q->queued++;
+	if (q->max_queued && (q->queued >= q->max_queued)) {
+		q->dropped++;
 		record_rpc_queue_stats(q);
 
 		slurm_mutex_unlock(&q->mutex);
+
+		if (q->hard_drop)
+			return SLURMCTLD_COMMUNICATIONS_HARD_DROP;
+		else
+			return SLURMCTLD_COMMUNICATIONS_BACKOFF;
 	}
 
+	/* Always track the backlog so sdiag can report it */
+	q->queued++;
+	record_rpc_queue_stats(q);
+
+	slurm_mutex_unlock(&q->mutex);
+
 	list_enqueue(q->work, msg);
 
 	slurm_mutex_lock(&q->mutex);
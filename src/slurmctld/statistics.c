@@ -40,6 +40,7 @@
 
 #include "src/slurmctld/agent.h"
 #include "src/slurmctld/slurmctld.h"
+#include "src/common/conn_pool.h"
 #include "src/common/id_util.h"
 #include "src/common/list.h"
 #include "src/common/pack.h"
@@ -47,6 +48,7 @@
 #include "src/common/slurmdbd_defs.h"
 
 #include "src/common/assoc_mgr.h"
+#include "src/interfaces/auth.h"
 #include "src/interfaces/gres.h"
 #include "src/interfaces/select.h"
 
@@ -64,6 +66,52 @@ typedef struct foreach_part_gen_stats {
 	partitions_stats_t *ps;
 } foreach_part_gen_stats_t;
 
+/* Pack message body compression counters by message type */
+static void _pack_compress_stats(buf_t *buffer)
+{
+	uint32_t cnt = 0;
+	msg_compress_stats_t *stats = slurm_msg_compress_stats_get(&cnt);
+	uint16_t *type_id = xcalloc(cnt, sizeof(*type_id));
+	uint32_t *compressed = xcalloc(cnt, sizeof(*compressed));
+	uint32_t *skipped = xcalloc(cnt, sizeof(*skipped));
+	uint64_t *raw_bytes = xcalloc(cnt, sizeof(*raw_bytes));
+	uint64_t *wire_bytes = xcalloc(cnt, sizeof(*wire_bytes));
+	uint64_t *compress_time = xcalloc(cnt, sizeof(*compress_time));
+	uint32_t *decompressed = xcalloc(cnt, sizeof(*decompressed));
+	uint64_t *decompress_time = xcalloc(cnt, sizeof(*decompress_time));
+
+	for (int i = 0; i < cnt; i++) {
+		type_id[i] = stats[i].msg_type;
+		compressed[i] = stats[i].compressed;
+		skipped[i] = stats[i].skipped;
+		raw_bytes[i] = stats[i].raw_bytes;
+		wire_bytes[i] = stats[i].wire_bytes;
+		compress_time[i] = stats[i].compress_usec;
+		decompressed[i] = stats[i].decompressed;
+		decompress_time[i] = stats[i].decompress_usec;
+	}
+
+	pack32(cnt, buffer);
+	pack16_array(type_id, cnt, buffer);
+	pack32_array(compressed, cnt, buffer);
+	pack32_array(skipped, cnt, buffer);
+	pack64_array(raw_bytes, cnt, buffer);
+	pack64_array(wire_bytes, cnt, buffer);
+	pack64_array(compress_time, cnt, buffer);
+	pack32_array(decompressed, cnt, buffer);
+	pack64_array(decompress_time, cnt, buffer);
+
+	xfree(type_id);
+	xfree(compressed);
+	xfree(skipped);
+	xfree(raw_bytes);
+	xfree(wire_bytes);
+	xfree(compress_time);
+	xfree(decompressed);
+	xfree(decompress_time);
+	xfree(stats);
+}
+
 /* Pack all scheduling statistics */
 extern buf_t *pack_all_stat(uint16_t protocol_version)
 {
@@ -139,6 +187,39 @@ extern buf_t *pack_all_stat(uint16_t protocol_version)
 		pack32(slurmctld_diag_stats.backfilled_het_jobs, buffer);
 		pack32_array(slurmctld_diag_stats.bf_exit, BF_EXIT_COUNT,
 			     buffer);
+
+		if (protocol_version >= SLURM_26_11_PROTOCOL_VERSION) {
+			uint64_t lookups[ASSOC_MGR_ENTITY_COUNT];
+			conn_pool_stats_t conn_pool_stats;
+			auth_cache_stats_t auth_cache_stats;
+			buf_stats_t buf_stats;
+
+			assoc_mgr_get_lookup_stats(lookups);
+			pack64(lookups[ASSOC_LOCK], buffer);
+			pack64(lookups[QOS_LOCK], buffer);
+			pack64(lookups[USER_LOCK], buffer);
+			pack64(lookups[WCKEY_LOCK], buffer);
+
+			_pack_compress_stats(buffer);
+
+			conn_pool_stats_get(&conn_pool_stats);
+			pack64(conn_pool_stats.connects, buffer);
+			pack64(conn_pool_stats.reused, buffer);
+			pack64(conn_pool_stats.stale, buffer);
+			pack64(conn_pool_stats.expired, buffer);
+			pack64(conn_pool_stats.retries, buffer);
+
+			auth_cache_stats_get(&auth_cache_stats);
+			pack64(auth_cache_stats.hits, buffer);
+			pack64(auth_cache_stats.misses, buffer);
+			pack64(auth_cache_stats.evictions, buffer);
+
+			buf_stats_get(&buf_stats);
+			pack64(buf_stats.allocs, buffer);
+			pack64(buf_stats.reused, buffer);
+			pack64(buf_stats.grown_in_place, buffer);
+			pack64(buf_stats.reallocs, buffer);
+		}
 	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		pack32(1, buffer); /* please remove on next version */
 
@@ -246,6 +327,12 @@ extern void reset_stats(int level)
 	memset(slurmctld_diag_stats.bf_exit, 0,
 	       sizeof(slurmctld_diag_stats.bf_exit));
 
+	assoc_mgr_reset_lookup_stats();
+	slurm_msg_compress_stats_reset();
+	conn_pool_stats_reset();
+	auth_cache_stats_reset();
+	buf_stats_reset();
+
 	last_proc_req_start = time(NULL);
 }
 
@@ -0,0 +1,434 @@
+/*****************************************************************************\
+ *  bcast_cache.c - content addressed cache of file broadcast blocks
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "slurm/slurm_errno.h"
+
+#include "src/common/fd.h"
+#include "src/common/file_bcast.h"
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/proc_args.h"
+#include "src/common/read_config.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmd/slurmd/bcast_cache.h"
+
+#define DEFAULT_CACHE_SIZE_MB 4096
+/* hex of 256 bit hash */
+#define HASH_HEX_LEN 64
+
+/*
+ * Blocks are kept in a directory per uid and only served back to that uid, so
+ * a user can not learn whether another user broadcast the same content.
+ */
+typedef struct {
+	uid_t uid;
+	char *hash;
+	uint32_t size;
+	time_t last_used;
+} cache_block_t;
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char *cache_dir = NULL;
+static uint64_t cache_limit = 0;
+static uint64_t cache_used = 0;
+static list_t *cache_blocks = NULL;
+
+static void _free_cache_block(void *x)
+{
+	cache_block_t *block = x;
+
+	xfree(block->hash);
+	xfree(block);
+}
+
+static int _find_cache_block(void *x, void *key)
+{
+	cache_block_t *block = x;
+	cache_block_t *find = key;
+
+	return ((block->uid == find->uid) && !xstrcmp(block->hash, find->hash));
+}
+
+/* Oldest first */
+static int _sort_last_used(void *x, void *y)
+{
+	cache_block_t *b1 = *(cache_block_t **) x;
+	cache_block_t *b2 = *(cache_block_t **) y;
+
+	if (b1->last_used < b2->last_used)
+		return -1;
+	if (b1->last_used > b2->last_used)
+		return 1;
+	return 0;
+}
+
+/* Blocks are named by their lower case hex hash */
+static bool _valid_hash(const char *hash)
+{
+	if (!hash || (strlen(hash) != HASH_HEX_LEN))
+		return false;
+
+	for (int i = 0; i < HASH_HEX_LEN; i++) {
+		if (!isdigit((unsigned char) hash[i]) &&
+		    ((hash[i] < 'a') || (hash[i] > 'f')))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Copy hash as sent by sbcast in lower case
+ * IN hash - hex hash in either case
+ * OUT lower - buffer of HASH_HEX_LEN + 1 bytes
+ * RET true if hash is valid
+ */
+static bool _lower_hash(const char *hash, char *lower)
+{
+	if (!hash || (strlen(hash) != HASH_HEX_LEN))
+		return false;
+
+	for (int i = 0; i < HASH_HEX_LEN; i++) {
+		if (!isxdigit((unsigned char) hash[i]))
+			return false;
+		lower[i] = tolower((unsigned char) hash[i]);
+	}
+	lower[HASH_HEX_LEN] = '\0';
+
+	return true;
+}
+
+static char *_uid_dir(uid_t uid)
+{
+	return xstrdup_printf("%s/%u", cache_dir, uid);
+}
+
+static char *_block_path(uid_t uid, const char *hash)
+{
+	return xstrdup_printf("%s/%u/%s", cache_dir, uid, hash);
+}
+
+/* Must hold cache_mutex */
+static cache_block_t *_find_block(uid_t uid, const char *hash)
+{
+	cache_block_t key = { .uid = uid, .hash = (char *) hash };
+
+	return list_find_first(cache_blocks, _find_cache_block, &key);
+}
+
+/* Must hold cache_mutex */
+static void _add_block(uid_t uid, const char *hash, uint32_t size,
+		       time_t last_used)
+{
+	cache_block_t *block = xmalloc(sizeof(*block));
+
+	block->uid = uid;
+	block->hash = xstrdup(hash);
+	block->size = size;
+	block->last_used = last_used;
+	list_append(cache_blocks, block);
+	cache_used += size;
+}
+
+/* Must hold cache_mutex */
+static void _evict(uint64_t needed)
+{
+	cache_block_t *block;
+
+	if ((cache_used + needed) <= cache_limit)
+		return;
+
+	list_sort(cache_blocks, _sort_last_used);
+	while (((cache_used + needed) > cache_limit) &&
+	       (block = list_pop(cache_blocks))) {
+		char *path = _block_path(block->uid, block->hash);
+
+		if (unlink(path) && (errno != ENOENT))
+			error("%s: unable to remove %s: %m", __func__, path);
+		debug2("%s: evicted block %s of uid %u",
+		       __func__, block->hash, block->uid);
+		cache_used -= block->size;
+		xfree(path);
+		_free_cache_block(block);
+	}
+}
+
+/* Load the blocks of one uid, must hold cache_mutex */
+static void _load_uid_dir(uid_t uid)
+{
+	DIR *dir;
+	struct dirent *ent;
+	char *dir_path = _uid_dir(uid);
+
+	if (!(dir = opendir(dir_path))) {
+		error("%s: unable to open %s: %m", __func__, dir_path);
+		xfree(dir_path);
+		return;
+	}
+
+	while ((ent = readdir(dir))) {
+		struct stat st;
+		char *path;
+
+		if (ent->d_name[0] == '.')
+			continue;
+
+		path = _block_path(uid, ent->d_name);
+		if (!_valid_hash(ent->d_name) || stat(path, &st) ||
+		    !S_ISREG(st.st_mode) || (st.st_size > UINT32_MAX)) {
+			/* Partial writes or foreign files */
+			(void) unlink(path);
+		} else {
+			_add_block(uid, ent->d_name, st.st_size, st.st_atime);
+		}
+		xfree(path);
+	}
+	closedir(dir);
+	xfree(dir_path);
+}
+
+/* Load blocks left by a previous slurmd, must hold cache_mutex */
+static void _load_cache_dir(void)
+{
+	DIR *dir;
+	struct dirent *ent;
+
+	if (!(dir = opendir(cache_dir))) {
+		error("%s: unable to open %s: %m", __func__, cache_dir);
+		return;
+	}
+
+	while ((ent = readdir(dir))) {
+		struct stat st;
+		char *path, *end = NULL;
+		unsigned long uid;
+
+		if (ent->d_name[0] == '.')
+			continue;
+
+		path = xstrdup_printf("%s/%s", cache_dir, ent->d_name);
+		uid = strtoul(ent->d_name, &end, 10);
+		if (stat(path, &st)) {
+			/* Removed meanwhile */
+		} else if (S_ISDIR(st.st_mode)) {
+			if (!*end && (uid < INFINITE))
+				_load_uid_dir(uid);
+		} else {
+			/* Blocks shared by all users in older versions */
+			(void) unlink(path);
+		}
+		xfree(path);
+	}
+	closedir(dir);
+
+	_evict(0);
+}
+
+extern void bcast_cache_init(void)
+{
+	char *tmp;
+
+	slurm_mutex_lock(&cache_mutex);
+
+	if (!(cache_dir = conf_get_opt_str(slurm_conf.bcast_parameters,
+					   "BlockCacheDir="))) {
+		slurm_mutex_unlock(&cache_mutex);
+		return;
+	}
+
+	cache_limit = DEFAULT_CACHE_SIZE_MB;
+	if ((tmp = conf_get_opt_str(slurm_conf.bcast_parameters,
+				    "BlockCacheSize="))) {
+		if (parse_uint64(tmp, &cache_limit) ||
+		    !cache_limit) {
+			error("Invalid BcastParameters=BlockCacheSize=%s, using %u MB",
+			      tmp, DEFAULT_CACHE_SIZE_MB);
+			cache_limit = DEFAULT_CACHE_SIZE_MB;
+		}
+		xfree(tmp);
+	}
+	cache_limit *= 1024 * 1024;
+
+	if ((mkdir(cache_dir, 0700) < 0) && (errno != EEXIST)) {
+		error("%s: unable to create %s, block cache disabled: %m",
+		      __func__, cache_dir);
+		xfree(cache_dir);
+		slurm_mutex_unlock(&cache_mutex);
+		return;
+	}
+
+	cache_blocks = list_create(_free_cache_block);
+	_load_cache_dir();
+
+	info("%s: %s holds %u blocks, %"PRIu64" of %"PRIu64" MB used",
+	     __func__, cache_dir, list_count(cache_blocks),
+	     (cache_used / (1024 * 1024)), (cache_limit / (1024 * 1024)));
+
+	slurm_mutex_unlock(&cache_mutex);
+}
+
+extern void bcast_cache_fini(void)
+{
+	slurm_mutex_lock(&cache_mutex);
+	FREE_NULL_LIST(cache_blocks);
+	xfree(cache_dir);
+	cache_used = 0;
+	slurm_mutex_unlock(&cache_mutex);
+}
+
+extern int bcast_cache_get(uid_t uid, const char *block_hash, uint32_t len,
+			   char **data)
+{
+	cache_block_t *block;
+	char hash[HASH_HEX_LEN + 1];
+	char *path, *buf;
+	int fd;
+
+	*data = NULL;
+
+	slurm_mutex_lock(&cache_mutex);
+	if (!cache_blocks || !_lower_hash(block_hash, hash) ||
+	    !(block = _find_block(uid, hash)) || (block->size != len)) {
+		slurm_mutex_unlock(&cache_mutex);
+		return ESLURMD_BCAST_BLOCK_NOT_CACHED;
+	}
+	block->last_used = time(NULL);
+	path = _block_path(uid, hash);
+	slurm_mutex_unlock(&cache_mutex);
+
+	/* Evicted blocks are unlinked, an open fd still reads all of it */
+	if ((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+		debug("%s: unable to open %s: %m", __func__, path);
+		xfree(path);
+		return ESLURMD_BCAST_BLOCK_NOT_CACHED;
+	}
+
+	buf = xmalloc_nz(len);
+	safe_read(fd, buf, len);
+	close(fd);
+	xfree(path);
+
+	*data = buf;
+	return SLURM_SUCCESS;
+
+rwfail:
+	error("%s: short read of %s", __func__, path);
+	xfree(buf);
+	close(fd);
+	xfree(path);
+	return ESLURMD_BCAST_BLOCK_NOT_CACHED;
+}
+
+extern void bcast_cache_put(uid_t uid, const char *block_hash,
+			    const char *data, uint32_t len)
+{
+	char hash[HASH_HEX_LEN + 1];
+	char *dir_path = NULL, *path = NULL, *tmp_path = NULL, *actual = NULL;
+	int fd = -1;
+
+	slurm_mutex_lock(&cache_mutex);
+	if (!cache_blocks || !_lower_hash(block_hash, hash) ||
+	    (len > cache_limit) ||
+	    _find_block(uid, hash)) {
+		slurm_mutex_unlock(&cache_mutex);
+		return;
+	}
+	dir_path = _uid_dir(uid);
+	path = _block_path(uid, hash);
+	slurm_mutex_unlock(&cache_mutex);
+
+	/* Key blocks by what was received, never by what the sender claims */
+	actual = bcast_hash_block(data, len);
+	if (xstrcmp(actual, hash)) {
+		error("%s: block content does not match hash %s, not cached",
+		      __func__, hash);
+		goto end;
+	}
+
+	if ((mkdir(dir_path, 0700) < 0) && (errno != EEXIST)) {
+		error("%s: unable to create %s: %m", __func__, dir_path);
+		goto end;
+	}
+
+	tmp_path = xstrdup_printf("%s.tmp.%lu", path,
+				  (unsigned long) pthread_self());
+	if ((fd = open(tmp_path, (O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC),
+		       0600)) < 0) {
+		error("%s: unable to create %s: %m", __func__, tmp_path);
+		goto end;
+	}
+	safe_write(fd, data, len);
+
+	slurm_mutex_lock(&cache_mutex);
+	if (!cache_blocks || _find_block(uid, hash)) {
+		/* Cache went away or another thread added it meanwhile */
+		(void) unlink(tmp_path);
+	} else {
+		_evict(len);
+		if (rename(tmp_path, path)) {
+			error("%s: unable to rename %s: %m", __func__,
+			      tmp_path);
+			(void) unlink(tmp_path);
+		} else {
+			_add_block(uid, hash, len, time(NULL));
+		}
+	}
+	slurm_mutex_unlock(&cache_mutex);
+
+	goto end;
+
+rwfail:
+	error("%s: unable to write %s: %m", __func__, tmp_path);
+	(void) unlink(tmp_path);
+end:
+	if (fd >= 0)
+		close(fd);
+	xfree(actual);
+	xfree(dir_path);
+	xfree(path);
+	xfree(tmp_path);
+}
@@ -0,0 +1,69 @@
+/*****************************************************************************\
+ *  bcast_cache.h - content addressed cache of file broadcast blocks
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _BCAST_CACHE_H
+#define _BCAST_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Set up the cache from BcastParameters=BlockCacheDir and BlockCacheSize.
+ * Blocks left in the cache directory by a previous slurmd are kept.
+ */
+extern void bcast_cache_init(void);
+extern void bcast_cache_fini(void);
+
+/*
+ * Read block from the cache. Only blocks added for the same uid are found.
+ * IN uid - user the block is read for
+ * IN block_hash - hex hash of block content, in either case
+ * IN len - expected length of block
+ * OUT data - xmalloc()ed block content
+ * RET SLURM_SUCCESS or ESLURMD_BCAST_BLOCK_NOT_CACHED
+ */
+extern int bcast_cache_get(uid_t uid, const char *block_hash, uint32_t len,
+			   char **data);
+
+/*
+ * Add block to the cache for uid, evicting the least recently used blocks of
+ * any uid over BlockCacheSize. Blocks whose content does not match block_hash
+ * are not added.
+ */
+extern void bcast_cache_put(uid_t uid, const char *block_hash,
+			    const char *data, uint32_t len);
+
+#endif
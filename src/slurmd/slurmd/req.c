@@ -113,12 +113,14 @@
 #include "src/slurmd/common/slurmd_common.h"
 #include "src/slurmd/common/slurmstepd_init.h"
 
+#include "src/slurmd/slurmd/bcast_cache.h"
 #include "src/slurmd/slurmd/cred_context.h"
 #include "src/slurmd/slurmd/get_mach_stat.h"
 #include "src/slurmd/slurmd/job_mem_limit.h"
 #include "src/slurmd/slurmd/launch_state.h"
 #include "src/slurmd/slurmd/req.h"
 #include "src/slurmd/slurmd/slurmd.h"
+#include "src/slurmd/slurmd/stepd_pool.h"
 
 #define RETRY_DELAY 15		/* retry every 15 seconds */
 #define MAX_RETRY   240		/* retry 240 times (one hour max) */
@@ -466,6 +468,46 @@ rwfail:
 	return (-1);
 }
 
+/*
+ * Send the configuration that does not depend on the step. A pooled
+ * slurmstepd gets this when it is started and waits for the rest.
+ */
+static int _send_slurmstepd_conf(int fd)
+{
+	/* send conf over to slurmstepd */
+	if (send_slurmd_conf_lite(fd, conf)) {
+		error("%s: send_slurmd_conf_lite(%d) failed: %m", __func__, fd);
+		return errno;
+	}
+
+	/* send conf_hashtbl */
+	if (read_conf_send_stepd(fd)) {
+		error("%s: read_conf_send_stepd(%d) failed: %m", __func__, fd);
+		return errno;
+	}
+
+	/* send cgroup state over to slurmstepd */
+	if (cgroup_write_state(fd)) {
+		error("%s: cgroup_write_state(%d) failed: %m", __func__, fd);
+		return errno;
+	}
+
+	/* send cgroup conf over to slurmstepd */
+	if (cgroup_write_conf(fd)) {
+		error("%s: cgroup_write_conf(%d) failed: %m", __func__, fd);
+		return errno;
+	}
+
+	/* send acct_gather.conf over to slurmstepd */
+	if (acct_gather_write_conf(fd)) {
+		error("%s: acct_gather_write_conf(%d) failed: %m",
+		      __func__, fd);
+		return errno;
+	}
+
+	return 0;
+}
+
 static int
 _send_slurmstepd_init(int fd, int type, void *req, slurm_addr_t *cli,
 		      hostlist_t *step_hset, uint16_t protocol_version)
@@ -480,18 +522,6 @@ _send_slurmstepd_init(int fd, int type, void *req, slurm_addr_t *cli,
 
 	slurm_msg_t_init(&msg);
 
-	/* send conf over to slurmstepd */
-	if (send_slurmd_conf_lite(fd, conf)) {
-		error("%s: send_slurmd_conf_lite(%d) failed: %m", __func__, fd);
-		goto fail;
-	}
-
-	/* send conf_hashtbl */
-	if (read_conf_send_stepd(fd)) {
-		error("%s: read_conf_send_stepd(%d) failed: %m", __func__, fd);
-		goto fail;
-	}
-
 	/* send type over to slurmstepd */
 	safe_write(fd, &type, sizeof(int));
 
@@ -597,30 +627,10 @@ _send_slurmstepd_init(int fd, int type, void *req, slurm_addr_t *cli,
 	safe_write(fd, get_buf_data(buffer), len);
 	FREE_NULL_BUFFER(buffer);
 
-	/* send cgroup state over to slurmstepd */
-	if (cgroup_write_state(fd)) {
-		error("%s: cgroup_write_state(%d) failed: %m", __func__, fd);
-		goto fail;
-	}
-
 	/*
-	 * Send all secondary conf files to the stepd.
+	 * Send the remaining secondary conf files to the stepd.
 	 */
 
-	/* send cgroup conf over to slurmstepd */
-	if (cgroup_write_conf(fd)) {
-		error("%s: cgroup_write_conf(%d) failed: %m",
-		      __func__, fd);
-		goto fail;
-	}
-
-	/* send acct_gather.conf over to slurmstepd */
-	if (acct_gather_write_conf(fd)) {
-		error("%s: acct_gather_write_conf(%d) failed: %m",
-		      __func__, fd);
-		goto fail;
-	}
-
 	/* Send job_container information to slurmstepd */
 	if (namespace_g_send_stepd(fd)) {
 		error("%s: namespace_g_send_stepd(%d) failed: %m",
@@ -691,87 +701,24 @@ rwfail:
 #endif /* SLURMSTEPD_MEMCHECK != 1 */
 
 /*
- * Fork and exec the slurmstepd, then send the slurmstepd its
- * initialization data.  Then wait for slurmstepd to send an "ok"
- * message before returning.  When the "ok" message is received,
- * the slurmstepd has created and begun listening on its unix
- * domain socket.
+ * Fork twice and exec the slurmstepd in the grandchild, so the slurmstepd's
+ * parent process will be init, not slurmd. The slurmstepd reads from
+ * to_stepd[0] and writes to to_slurmd[1].
  *
- * Note that this code forks twice and it is the grandchild that
- * becomes the slurmstepd process, so the slurmstepd's parent process
- * will be init, not slurmd.
+ * IN join_ns - join the job's namespace before exec'ing the slurmstepd
+ * RET pid of the child to reap, or -1 if fork() failed. Never returns in the
+ *     grandchild.
  */
-static int _forkexec_slurmstepd(uint16_t type, void *req, slurm_addr_t *cli,
-				uid_t uid, uint32_t job_id, uint32_t step_id,
-				hostlist_t *step_hset,
-				uint16_t protocol_version)
+static pid_t _fork_slurmstepd(int *to_stepd, int *to_slurmd, uid_t uid,
+			      uint32_t job_id, uint32_t step_id, bool join_ns)
 {
 	pid_t pid;
-	int to_stepd[2] = {-1, -1};
-	int to_slurmd[2] = {-1, -1};
-
-	if (pipe(to_stepd) < 0 || pipe(to_slurmd) < 0) {
-		error("%s: pipe failed: %m", __func__);
-		return SLURM_ERROR;
-	}
-
-	if (_add_starting_step(type, req)) {
-		error("%s: failed in _add_starting_step: %m", __func__);
-		return SLURM_ERROR;
-	}
 
 	if ((pid = fork()) < 0) {
 		error("%s: fork: %m", __func__);
-		close(to_stepd[0]);
-		close(to_stepd[1]);
-		close(to_slurmd[0]);
-		close(to_slurmd[1]);
-		_remove_starting_step(type, req);
-		return SLURM_ERROR;
+		return -1;
 	} else if (pid > 0) {
-		int rc = SLURM_SUCCESS;
-#if (SLURMSTEPD_MEMCHECK != 1)
-		int rc2;
-#endif
-		/*
-		 * Parent sends initialization data to the slurmstepd
-		 * over the to_stepd pipe, and waits for the return code
-		 * reply on the to_slurmd pipe.
-		 */
-		if (close(to_stepd[0]) < 0)
-			error("Unable to close read to_stepd in parent: %m");
-		if (close(to_slurmd[1]) < 0)
-			error("Unable to close write to_slurmd in parent: %m");
-
-		if ((rc = _send_slurmstepd_init(to_stepd[1], type,
-						req, cli, step_hset,
-						protocol_version)) != 0) {
-			error("Unable to init slurmstepd");
-			goto done;
-		}
-
-		/*
-		 * If running under memcheck, this pipe doesn't work correctly
-		 * so just skip it.
-		 */
-#if (SLURMSTEPD_MEMCHECK != 1)
-		if ((rc2 = _handle_return_code(to_slurmd[0],
-					       to_stepd[1], &rc))) {
-			rc = rc2;
-			goto done;
-		}
-#endif
-	done:
-		_remove_starting_step(type, req);
-
-		/* Reap child */
-		if (waitpid(pid, NULL, 0) < 0)
-			error("Unable to reap slurmd child process");
-		if (close(to_stepd[1]) < 0)
-			error("close write to_stepd in parent: %m");
-		if (close(to_slurmd[0]) < 0)
-			error("close read to_slurmd in parent: %m");
-		return rc;
+		return pid;
 	} else {
 #if (SLURMSTEPD_MEMCHECK == 1)
 		/* memcheck test of slurmstepd, option #1 */
@@ -833,7 +780,7 @@ static int _forkexec_slurmstepd(uint16_t type, void *req, slurm_addr_t *cli,
 			failed = 1;
 		}
 
-		if (step_id != SLURM_EXTERN_CONT) {
+		if (join_ns && (step_id != SLURM_EXTERN_CONT)) {
 			slurm_step_id_t tmp_step_id = SLURM_STEP_ID_INITIALIZER;
 			tmp_step_id.job_id = job_id;
 			tmp_step_id.step_id = step_id;
@@ -905,6 +852,149 @@ static int _forkexec_slurmstepd(uint16_t type, void *req, slurm_addr_t *cli,
 	}
 }
 
+/*
+ * Start a slurmstepd that is only sent the configuration that does not depend
+ * on the step. It waits for _send_slurmstepd_init() to send it a step.
+ */
+extern int prefork_slurmstepd(int *to_stepd_fd, int *to_slurmd_fd)
+{
+	pid_t pid;
+	int rc;
+	int to_stepd[2] = {-1, -1};
+	int to_slurmd[2] = {-1, -1};
+
+	if (pipe2(to_stepd, O_CLOEXEC) || pipe2(to_slurmd, O_CLOEXEC)) {
+		error("%s: pipe failed: %m", __func__);
+		goto fail;
+	}
+
+	if ((pid = _fork_slurmstepd(to_stepd, to_slurmd, 0, 0, NO_VAL,
+				    false)) < 0)
+		goto fail;
+
+	fd_close(&to_stepd[0]);
+	fd_close(&to_slurmd[1]);
+
+	rc = _send_slurmstepd_conf(to_stepd[1]);
+
+	if (waitpid(pid, NULL, 0) < 0)
+		error("Unable to reap slurmd child process");
+
+	if (rc)
+		goto fail;
+
+	*to_stepd_fd = to_stepd[1];
+	*to_slurmd_fd = to_slurmd[0];
+	return SLURM_SUCCESS;
+
+fail:
+	fd_close(&to_stepd[0]);
+	fd_close(&to_stepd[1]);
+	fd_close(&to_slurmd[0]);
+	fd_close(&to_slurmd[1]);
+	return SLURM_ERROR;
+}
+
+/*
+ * Hand the request to a pooled slurmstepd or fork and exec a new one, then
+ * send the slurmstepd its initialization data. Then wait for slurmstepd to
+ * send an "ok" message before returning. When the "ok" message is received,
+ * the slurmstepd has created and begun listening on its unix domain socket.
+ */
+static int _forkexec_slurmstepd(uint16_t type, void *req, slurm_addr_t *cli,
+				uid_t uid, uint32_t job_id, uint32_t step_id,
+				hostlist_t *step_hset,
+				uint16_t protocol_version)
+{
+	pid_t pid = -1;
+	int rc = SLURM_SUCCESS;
+#if (SLURMSTEPD_MEMCHECK != 1)
+	int rc2;
+#endif
+	int to_stepd[2] = {-1, -1};
+	int to_slurmd[2] = {-1, -1};
+	bool pooled = false;
+	timespec_t start = timespec_now();
+
+	if (_add_starting_step(type, req)) {
+		error("%s: failed in _add_starting_step: %m", __func__);
+		return SLURM_ERROR;
+	}
+
+	if (stepd_pool_get(&to_stepd[1], &to_slurmd[0])) {
+		if (!_send_slurmstepd_init(to_stepd[1], type, req, cli,
+					   step_hset, protocol_version)) {
+			pooled = true;
+		} else {
+			debug("%s: pooled slurmstepd is gone, starting a new one",
+			      __func__);
+			fd_close(&to_stepd[1]);
+			fd_close(&to_slurmd[0]);
+		}
+	}
+
+	if (!pooled) {
+		if (pipe(to_stepd) < 0 || pipe(to_slurmd) < 0) {
+			error("%s: pipe failed: %m", __func__);
+			rc = SLURM_ERROR;
+			goto done;
+		}
+
+		if ((pid = _fork_slurmstepd(to_stepd, to_slurmd, uid, job_id,
+					    step_id, true)) < 0) {
+			rc = SLURM_ERROR;
+			goto done;
+		}
+
+		/*
+		 * Parent sends initialization data to the slurmstepd
+		 * over the to_stepd pipe, and waits for the return code
+		 * reply on the to_slurmd pipe.
+		 */
+		if (close(to_stepd[0]) < 0)
+			error("Unable to close read to_stepd in parent: %m");
+		to_stepd[0] = -1;
+		if (close(to_slurmd[1]) < 0)
+			error("Unable to close write to_slurmd in parent: %m");
+		to_slurmd[1] = -1;
+
+		if ((rc = _send_slurmstepd_conf(to_stepd[1])) ||
+		    (rc = _send_slurmstepd_init(to_stepd[1], type,
+						req, cli, step_hset,
+						protocol_version))) {
+			error("Unable to init slurmstepd");
+			goto done;
+		}
+	}
+
+	/*
+	 * If running under memcheck, this pipe doesn't work correctly
+	 * so just skip it.
+	 */
+#if (SLURMSTEPD_MEMCHECK != 1)
+	if ((rc2 = _handle_return_code(to_slurmd[0], to_stepd[1], &rc))) {
+		rc = rc2;
+		goto done;
+	}
+#endif
+	if (rc == SLURM_SUCCESS)
+		stepd_pool_record_launch(pooled, start);
+
+done:
+	_remove_starting_step(type, req);
+
+	/* Reap child */
+	if ((pid > 0) && (waitpid(pid, NULL, 0) < 0))
+		error("Unable to reap slurmd child process");
+	fd_close(&to_stepd[0]);
+	fd_close(&to_slurmd[1]);
+	if ((to_stepd[1] >= 0) && (close(to_stepd[1]) < 0))
+		error("close write to_stepd in parent: %m");
+	if ((to_slurmd[0] >= 0) && (close(to_slurmd[0]) < 0))
+		error("close read to_slurmd in parent: %m");
+	return rc;
+}
+
 static void _setup_x11_display(slurm_step_id_t *step_id, char ***env,
 			       uint32_t *envc)
 {
@@ -3479,8 +3569,15 @@ static void _rpc_stat_jobacct(slurm_msg_t *msg)
 	slurm_msg_t_copy(&resp_msg, msg);
 	resp->return_code = SLURM_SUCCESS;
 
-	if (stepd_stat_jobacct(fd, protocol_version, req, resp)
-	    == SLURM_ERROR) {
+	/*
+	 * Use the snapshot published by the slurmstepd at its last poll if
+	 * there is one, instead of making it poll the tasks again.
+	 */
+	if (xstrcasestr(slurm_conf.job_acct_gather_params, "StatSnapshot") &&
+	    !stepd_stat_shm_read(conf->spooldir, conf->node_name, req, resp)) {
+		debug3("%s: using stat snapshot of %ps", __func__, req);
+	} else if (stepd_stat_jobacct(fd, protocol_version, req, resp)
+		   == SLURM_ERROR) {
 		debug("accounting for nonexistent %ps requested", req);
 	}
 
@@ -3938,7 +4035,7 @@ void file_bcast_init(void)
 	/* skip locks during slurmd init */
 	file_bcast_list = list_create(_free_file_bcast_info_t);
 	bcast_libdir_list = list_create(_free_libdir_rec_t);
-
+	bcast_cache_init();
 }
 
 void file_bcast_purge(void)
@@ -3946,6 +4043,7 @@ void file_bcast_purge(void)
 	slurm_rwlock_wrlock(&file_bcast_lock);
 	FREE_NULL_LIST(file_bcast_list);
 	FREE_NULL_LIST(bcast_libdir_list);
+	bcast_cache_fini();
 	/* destroying list before exit, no need to unlock */
 }
 
@@ -4042,6 +4140,19 @@ static void _rpc_file_bcast(slurm_msg_t *msg)
 		      key.uid, key.job_id, key.fname, req->block_no);
 	}
 
+	/*
+	 * A cached block arrives without data. A miss must be answered before
+	 * anything is registered, sbcast resends the whole block to this node.
+	 */
+	if (req->flags & FILE_BCAST_CACHED) {
+		xfree(req->block);
+		if ((rc = bcast_cache_get(key.uid, req->block_hash,
+					  req->uncomp_len, &req->block)))
+			goto done;
+		req->block_len = req->uncomp_len;
+		req->compress = COMPRESS_OFF;
+	}
+
 	/* first block must register the file and open fd/mmap */
 	if (req->block_no == 1) {
 		if ((rc = _file_bcast_register_file(msg, cred_arg, &key))) {
@@ -4067,10 +4178,26 @@ static void _rpc_file_bcast(slurm_msg_t *msg)
 		goto done;
 	}
 
+	/*
+	 * Blocks after the first may arrive out of order when sbcast keeps
+	 * several of them in flight, so write each one at its own offset.
+	 * Senders not flagging that must send them in order.
+	 */
+	if (!(req->flags & FILE_BCAST_PIPELINE) &&
+	    (req->block_offset != file_info->next_offset)) {
+		error("sbcast: uid:%u block %u of `%s` at offset %"PRIu64" out of order, expected offset %"PRIu64,
+		      key.uid, req->block_no, key.fname, req->block_offset,
+		      file_info->next_offset);
+		slurm_rwlock_unlock(&file_bcast_lock);
+		rc = SLURM_ERROR;
+		goto done;
+	}
+
 	offset = 0;
 	while (req->block_len - offset) {
-		inx = write(file_info->fd, &req->block[offset],
-			    (req->block_len - offset));
+		inx = pwrite(file_info->fd, &req->block[offset],
+			     (req->block_len - offset),
+			     (req->block_offset + offset));
 		if (inx == -1) {
 			if ((errno == EINTR) || (errno == EAGAIN))
 				continue;
@@ -4083,6 +4210,9 @@ static void _rpc_file_bcast(slurm_msg_t *msg)
 		offset += inx;
 	}
 
+	/* Pipelined blocks are written concurrently under the read lock */
+	if (!(req->flags & FILE_BCAST_PIPELINE))
+		file_info->next_offset = req->block_offset + req->block_len;
 	file_info->last_update = time(NULL);
 
 	if ((req->flags & FILE_BCAST_LAST_BLOCK) &&
@@ -4115,6 +4245,11 @@ static void _rpc_file_bcast(slurm_msg_t *msg)
 
 done:
 	slurm_send_rc_msg(msg, rc);
+
+	/* Hashing and writing the block must not delay the reply */
+	if (!rc && req->block_hash && !(req->flags & FILE_BCAST_CACHED))
+		bcast_cache_put(key.uid, req->block_hash, req->block,
+				req->block_len);
 }
 
 static int _file_bcast_register_file(slurm_msg_t *msg,
@@ -5499,6 +5634,7 @@ static slurmd_rpc_t slurmd_rpcs[] = {
 		.msg_type = REQUEST_PING,
 		.from_slurmctld = true,
 		.func = _rpc_ping,
+		.keep_alive = true,
 	},
 	{
 		.msg_type = REQUEST_HEALTH_CHECK,
@@ -5517,6 +5653,7 @@ static slurmd_rpc_t slurmd_rpcs[] = {
 		.from_slurmctld = true,
 		.func = _rpc_acct_gather_update,
 		.new_thread = true,
+		.keep_alive = true,
 	},
 	{
 		.msg_type = REQUEST_ACCT_GATHER_ENERGY,
@@ -55,6 +55,12 @@ typedef struct {
 	 * intentionally unbounded.
 	 */
 	bool new_thread;
+	/*
+	 * Handler returns promptly after replying, so the connection can be
+	 * handed back to conmgr to read the next RPC when the client asks to
+	 * keep it alive (SLURM_MSG_KEEP_ALIVE).
+	 */
+	bool keep_alive;
 } slurmd_rpc_t;
 
 /*
@@ -78,6 +84,15 @@ extern slurmd_rpc_t *find_rpc(slurm_msg_type_t msg_type);
  */
 extern int send_slurmd_conf_lite(int fd, slurmd_conf_t *cf);
 
+/*
+ * Start a slurmstepd for the slurmstepd pool. It is sent the slurmd_conf and
+ * then waits for a step to be sent to it over to_stepd_fd.
+ * OUT to_stepd_fd - write side of the slurmstepd's stdin
+ * OUT to_slurmd_fd - read side of the slurmstepd's stdout
+ * RET SLURM_SUCCESS or SLURM_ERROR
+ */
+extern int prefork_slurmstepd(int *to_stepd_fd, int *to_slurmd_fd);
+
 /* Add record for every launched job so we know they are ready for suspend */
 extern void record_launched_jobs(void);
 
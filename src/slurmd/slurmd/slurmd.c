@@ -71,6 +71,7 @@
 
 #include "src/common/assoc_mgr.h"
 #include "src/common/bitstring.h"
+#include "src/common/conn_pool.h"
 #include "src/common/cpu_frequency.h"
 #include "src/common/daemonize.h"
 #include "src/common/events.h"
@@ -143,6 +144,7 @@
 #include "src/slurmd/slurmd/job_mem_limit.h"
 #include "src/slurmd/slurmd/req.h"
 #include "src/slurmd/slurmd/slurmd.h"
+#include "src/slurmd/slurmd/stepd_pool.h"
 
 decl_static_data(usage_txt);
 
@@ -232,6 +234,9 @@ static pthread_mutex_t listen_mutex = PTHREAD_MUTEX_INITIALIZER;
 static conmgr_fd_ref_t *listener = NULL;
 static bool unquiesce_listener = false;
 
+/* Timeouts for connections kept alive after replying to an RPC */
+static conmgr_timeouts_t keep_alive_timeouts = { { 0 } };
+
 static char *ca_cert_file = NULL;
 
 static int       _convert_spec_cores(void);
@@ -242,6 +247,7 @@ static void      _destroy_conf(void);
 static void _fill_registration_msg(slurm_node_registration_status_msg_t *);
 static int _increment_thd_count(bool block);
 static void      _init_conf(void);
+static void _keep_alive_con(slurm_msg_t *msg);
 static int       _memory_spec_init(void);
 static void _notify_parent_of_success(void);
 static void      _print_conf(void);
@@ -533,6 +539,7 @@ main (int argc, char **argv)
 		      __func__, conf->binary);
 
 	forward_init();
+	stepd_pool_init();
 
 	plugins_registered = true;
 
@@ -611,6 +618,7 @@ main (int argc, char **argv)
 	 * failure.
 	 */
 	run_command_shutdown();
+	stepd_pool_fini();
 	_slurmd_fini();
 	_destroy_conf();
 	cred_g_fini();	/* must be after _destroy_conf() */
@@ -868,6 +876,7 @@ static void _service_msg(conmgr_callback_args_t conmgr_args, void *arg)
 		 __func__, (uint32_t) msg->msg_type,
 		 rpc_num2string(msg->msg_type));
 
+	_keep_alive_con(msg);
 	FREE_NULL_CONN(msg->conn);
 	FREE_NULL_MSG(msg);
 
@@ -906,6 +915,7 @@ static void *_service_msg_thread(void *arg)
 		 __func__, (uint32_t) msg->msg_type,
 		 rpc_num2string(msg->msg_type));
 
+	_keep_alive_con(msg);
 	FREE_NULL_CONN(msg->conn);
 	FREE_NULL_MSG(msg);
 
@@ -1514,6 +1524,9 @@ extern void build_conf_buf(void)
 		tres_packed = false;
 
 	slurm_mutex_unlock(&conf->config_mutex);
+
+	/* Pooled slurmstepds were sent the old configuration */
+	stepd_pool_flush();
 }
 
 static int _reconfig_stepd(void *x, void *y)
@@ -1545,6 +1558,9 @@ extern void update_stepd_logging(bool reconfig)
 	steps = stepd_available(conf->spooldir, conf->node_name);
 	list_for_each(steps, _reconfig_stepd, &reconfig);
 	FREE_NULL_LIST(steps);
+
+	/* Pooled slurmstepds must reopen their logs too */
+	stepd_pool_flush();
 }
 
 static void _notify_parent_of_success(void)
@@ -2235,6 +2251,9 @@ static int _on_msg(conmgr_callback_args_t conmgr_args, slurm_msg_t *msg,
 	service_msg_args_t *args = NULL;
 	int rc = SLURM_SUCCESS;
 
+	/* Only set by this daemon once RPC is known to allow keep alive */
+	msg->flags &= ~SLURM_MSG_KEPT_ALIVE;
+
 	if ((unpack_rc == SLURM_PROTOCOL_AUTHENTICATION_ERROR) ||
 	    !msg->auth_ids_set) {
 		/*
@@ -2267,6 +2286,9 @@ static int _on_msg(conmgr_callback_args_t conmgr_args, slurm_msg_t *msg,
 		goto cleanup;
 	}
 
+	if ((msg->flags & SLURM_MSG_KEEP_ALIVE) && this_rpc->keep_alive)
+		msg->flags |= SLURM_MSG_KEPT_ALIVE;
+
 	args = xmalloc(sizeof(*args));
 	*args = (service_msg_args_t) {
 		.magic = SERVICE_MSG_ARGS_MAGIC,
@@ -2308,20 +2330,66 @@ static int _on_data(conmgr_callback_args_t conmgr_args, void *arg)
 	return http_switch_on_data(conmgr_args, on_http_connection);
 }
 
+static const conmgr_events_t events = {
+	.on_listen_connect = _on_listen_connect,
+	.on_listen_finish = _on_listen_finish,
+	.on_connection = _on_connection,
+	.on_msg = _on_msg,
+	.on_data = _on_data,
+	.on_finish = _on_finish,
+};
+static const conmgr_con_flags_t con_flags =
+	(CON_FLAG_RPC_RECV_FORWARD | CON_FLAG_RPC_KEEP_BUFFER |
+	 CON_FLAG_QUIESCE);
+
+/*
+ * Hand connection back to conmgr to read the next RPC from the same client
+ * after replying with SLURM_MSG_KEPT_ALIVE set. Clears msg->conn if taken.
+ */
+static void _keep_alive_con(slurm_msg_t *msg)
+{
+	conmgr_con_flags_t flags = con_flags;
+	conn_t *conn = msg->conn;
+	void *tls_conn = NULL;
+	int fd, rc;
+
+	if (!conn || !(msg->flags & SLURM_MSG_KEPT_ALIVE) ||
+	    ((fd = conn_g_get_fd(conn)) < 0))
+		return;
+
+	if (conn_tls_enabled()) {
+		/* conmgr adopts TLS state of the connection */
+		tls_conn = conn;
+		flags |= CON_FLAG_TLS_SERVER;
+	}
+
+	if ((rc = conmgr_process_fd(CON_TYPE_RPC, &keep_alive_timeouts, fd, fd,
+				    &events, flags, &msg->address,
+				    sizeof(msg->address), tls_conn, NULL))) {
+		log_flag(NET, "%s: [%pA] unable to keep connection alive: %s",
+			 __func__, &msg->address, slurm_strerror(rc));
+		return;
+	}
+
+	log_flag(NET, "%s: [%pA] keeping connection alive after %s on fd %d",
+		 __func__, &msg->address, rpc_num2string(msg->msg_type), fd);
+
+	if (!tls_conn)
+		conn_g_destroy(conn, false);
+	msg->conn = NULL;
+}
+
 static void _create_msg_socket(void)
 {
-	static const conmgr_events_t events = {
-		.on_listen_connect = _on_listen_connect,
-		.on_listen_finish = _on_listen_finish,
-		.on_connection = _on_connection,
-		.on_msg = _on_msg,
-		.on_data = _on_data,
-		.on_finish = _on_finish,
-	};
 	int rc;
-	static const conmgr_con_flags_t flags =
-		(CON_FLAG_RPC_RECV_FORWARD | CON_FLAG_RPC_KEEP_BUFFER |
-		 CON_FLAG_QUIESCE);
+
+	/*
+	 * Client closes idle connections after conn_pool_idle_timeout which
+	 * must happen before this side gives up on reading the next RPC.
+	 */
+	keep_alive_timeouts.read.tv_sec =
+		(conn_pool_idle_timeout() + slurm_conf.msg_timeout);
+	conmgr_timeouts_init_default(&keep_alive_timeouts);
 
 	if (getenv("SLURMD_RECONF_LISTEN_FD")) {
 		conf->lfd = atoi(getenv("SLURMD_RECONF_LISTEN_FD"));
@@ -2332,7 +2400,7 @@ static void _create_msg_socket(void)
 
 	if ((rc = conmgr_process_fd_listen(conf->lfd, http_switch_con_type(),
 					   NULL, &events,
-					   (flags | http_switch_con_flags()),
+					   (con_flags | http_switch_con_flags()),
 					   NULL)))
 		fatal("%s: unable to process fd:%d error:%s",
 		      __func__, conf->lfd, slurm_strerror(rc));
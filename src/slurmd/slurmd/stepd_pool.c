@@ -0,0 +1,286 @@
+/*****************************************************************************\
+ *  stepd_pool.c - pool of pre-started slurmstepd processes
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "src/common/assoc_mgr.h"
+#include "src/common/fd.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/probes.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_time.h"
+#include "src/common/threadpool.h"
+#include "src/common/timers.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmd/common/slurmstepd_init.h"
+#include "src/slurmd/slurmd/req.h"
+#include "src/slurmd/slurmd/stepd_pool.h"
+
+#define STEPD_POOL_MAX 64
+/* Wait before starting another slurmstepd after a failure */
+#define STEPD_POOL_RETRY 10
+
+typedef struct {
+	int to_stepd;
+	int to_slurmd;
+} pooled_stepd_t;
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t pool_thread = 0;
+static bool pool_shutdown = false;
+static pooled_stepd_t *pool = NULL;
+static int pool_cnt = 0;
+static int pool_size = 0;
+/* Incremented by flush, slurmstepds started before it are discarded */
+static uint32_t pool_gen = 0;
+
+static struct {
+	/* histogram of step launches that forked a new slurmstepd */
+	latency_histogram_t forked;
+	/* histogram of step launches handed to a pooled slurmstepd */
+	latency_histogram_t pooled;
+} launch_stats = {
+	.forked = LATENCY_HISTOGRAM_INITIALIZER,
+	.pooled = LATENCY_HISTOGRAM_INITIALIZER,
+};
+
+static void _close_stepd(pooled_stepd_t *stepd)
+{
+	fd_close(&stepd->to_stepd);
+	fd_close(&stepd->to_slurmd);
+}
+
+/*
+ * An idle slurmstepd never writes to slurmd, so anything to read on its
+ * stdout means it has exited.
+ */
+static bool _stepd_alive(pooled_stepd_t *stepd)
+{
+	struct pollfd pfd = {
+		.fd = stepd->to_slurmd,
+		.events = POLLIN,
+	};
+
+	return !poll(&pfd, 1, 0);
+}
+
+static void _pool_wait(int sec)
+{
+	struct timespec ts = { .tv_sec = time(NULL) + sec };
+
+	slurm_cond_timedwait(&pool_cond, &pool_mutex, &ts);
+}
+
+static void *_pool_agent(void *arg)
+{
+	slurm_mutex_lock(&pool_mutex);
+	while (!pool_shutdown) {
+		pooled_stepd_t stepd = { -1, -1 };
+		uint32_t gen = pool_gen;
+		int rc;
+
+		if (pool_cnt >= pool_size) {
+			slurm_cond_wait(&pool_cond, &pool_mutex);
+			continue;
+		}
+
+		/* send_slurmd_conf_lite() blocks until registration is done */
+		if (!assoc_mgr_tres_list) {
+			_pool_wait(1);
+			continue;
+		}
+
+		slurm_mutex_unlock(&pool_mutex);
+		rc = prefork_slurmstepd(&stepd.to_stepd, &stepd.to_slurmd);
+		slurm_mutex_lock(&pool_mutex);
+
+		if (rc) {
+			error("%s: unable to start pooled slurmstepd, retrying in %d seconds",
+			      __func__, STEPD_POOL_RETRY);
+			_pool_wait(STEPD_POOL_RETRY);
+			continue;
+		}
+
+		if (pool_shutdown || (gen != pool_gen) ||
+		    (pool_cnt >= pool_size)) {
+			_close_stepd(&stepd);
+			continue;
+		}
+
+		pool[pool_cnt++] = stepd;
+		log_flag(STEPS, "%s: %d of %d pooled slurmstepd ready",
+			 __func__, pool_cnt, pool_size);
+	}
+	slurm_mutex_unlock(&pool_mutex);
+
+	return NULL;
+}
+
+static probe_status_t _probe(probe_log_t *log, void *arg)
+{
+	char histogram[LATENCY_METRIC_HISTOGRAM_STR_LEN] = { 0 };
+
+	if (!log)
+		return PROBE_RC_READY;
+
+	slurm_mutex_lock(&pool_mutex);
+	probe_log(log, "state: pool_size:%d idle:%d", pool_size, pool_cnt);
+	slurm_mutex_unlock(&pool_mutex);
+
+	(void) latency_histogram_print_labels(histogram, sizeof(histogram));
+	probe_log(log, "histogram: %s", histogram);
+
+	(void) latency_histogram_print(&launch_stats.forked, histogram,
+				       sizeof(histogram));
+	probe_log(log, "forked histogram: %s", histogram);
+
+	(void) latency_histogram_print(&launch_stats.pooled, histogram,
+				       sizeof(histogram));
+	probe_log(log, "pooled histogram: %s", histogram);
+
+	return PROBE_RC_READY;
+}
+
+extern void stepd_pool_init(void)
+{
+	char *tmp_ptr;
+
+	probe_register("stepd-launch", _probe, NULL);
+
+	if (!(tmp_ptr = xstrcasestr(slurm_conf.slurmd_params, "stepd_pool=")))
+		return;
+
+	pool_size = atoi(tmp_ptr + 11);
+	if ((pool_size < 0) || (pool_size > STEPD_POOL_MAX)) {
+		error("Invalid SlurmdParameters stepd_pool: %d, must be between 0 and %d",
+		      pool_size, STEPD_POOL_MAX);
+		pool_size = 0;
+		return;
+	}
+	if (!pool_size)
+		return;
+
+	/* The job's namespace is joined before slurmstepd is exec'ed */
+	if (slurm_conf.namespace_plugin && slurm_conf.namespace_plugin[0]) {
+		info("SlurmdParameters stepd_pool is not supported with NamespaceType, disabling it");
+		pool_size = 0;
+		return;
+	}
+
+	if (SLURMSTEPD_MEMCHECK) {
+		pool_size = 0;
+		return;
+	}
+
+	pool = xcalloc(pool_size, sizeof(*pool));
+	slurm_thread_create(NULL, &pool_thread, _pool_agent, NULL);
+	debug("%s: keeping %d slurmstepd ready", __func__, pool_size);
+}
+
+extern void stepd_pool_fini(void)
+{
+	slurm_mutex_lock(&pool_mutex);
+	pool_shutdown = true;
+	slurm_cond_broadcast(&pool_cond);
+	slurm_mutex_unlock(&pool_mutex);
+
+	if (pool_thread)
+		slurm_thread_join(pool_thread);
+
+	/* Idle slurmstepds exit when their stdin is closed */
+	stepd_pool_flush();
+	xfree(pool);
+}
+
+extern void stepd_pool_flush(void)
+{
+	slurm_mutex_lock(&pool_mutex);
+	for (int i = 0; i < pool_cnt; i++)
+		_close_stepd(&pool[i]);
+	pool_cnt = 0;
+	pool_gen++;
+	slurm_cond_broadcast(&pool_cond);
+	slurm_mutex_unlock(&pool_mutex);
+}
+
+extern bool stepd_pool_get(int *to_stepd_fd, int *to_slurmd_fd)
+{
+	bool found = false;
+
+	if (!pool_size)
+		return false;
+
+	slurm_mutex_lock(&pool_mutex);
+	while (pool_cnt && !found) {
+		pooled_stepd_t *stepd = &pool[--pool_cnt];
+
+		if (_stepd_alive(stepd)) {
+			*to_stepd_fd = stepd->to_stepd;
+			*to_slurmd_fd = stepd->to_slurmd;
+			found = true;
+		} else {
+			log_flag(STEPS, "%s: discarding pooled slurmstepd that exited",
+				 __func__);
+			_close_stepd(stepd);
+		}
+	}
+	slurm_cond_broadcast(&pool_cond);
+	slurm_mutex_unlock(&pool_mutex);
+
+	if (!found)
+		log_flag(STEPS, "%s: no pooled slurmstepd available", __func__);
+
+	return found;
+}
+
+extern void stepd_pool_record_launch(bool pooled, timespec_t start)
+{
+	timespec_t end = timespec_now();
+
+	latency_metric_add_histogram_value(
+		(pooled ? &launch_stats.pooled : &launch_stats.forked),
+		timespec_rem(end, start));
+
+	log_flag(STEPS, "%s: %s slurmstepd ready in %s",
+		 __func__, (pooled ? "pooled" : "forked"),
+		 timer_duration_str(start, end).str);
+}
@@ -0,0 +1,73 @@
+/*****************************************************************************\
+ *  stepd_pool.h - pool of pre-started slurmstepd processes
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _STEPD_POOL_H
+#define _STEPD_POOL_H
+
+#include <stdbool.h>
+
+#include "src/common/slurm_time.h"
+
+/*
+ * Register the "stepd-launch" probe and start keeping
+ * SlurmdParameters=stepd_pool=# slurmstepd processes ready to be handed a
+ * step.
+ */
+extern void stepd_pool_init(void);
+extern void stepd_pool_fini(void);
+
+/*
+ * Terminate idle slurmstepd processes and start new ones. Must be called
+ * whenever the configuration sent to slurmstepd changes.
+ */
+extern void stepd_pool_flush(void);
+
+/*
+ * Take an idle slurmstepd out of the pool
+ * OUT to_stepd_fd - write side of the slurmstepd's stdin
+ * OUT to_slurmd_fd - read side of the slurmstepd's stdout
+ * RET true if a slurmstepd was available
+ */
+extern bool stepd_pool_get(int *to_stepd_fd, int *to_slurmd_fd);
+
+/*
+ * Add the time it took for a slurmstepd to report it was ready to the step
+ * launch latency histograms
+ * IN pooled - slurmstepd came from the pool
+ * IN start - when the launch request was handled
+ */
+extern void stepd_pool_record_launch(bool pooled, timespec_t start);
+
+#endif
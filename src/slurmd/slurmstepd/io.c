@@ -56,6 +56,7 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -89,14 +90,27 @@
 
 #define STDIO_FILE_RETRIES 10
 
+/* Most queued messages and bytes sent to a client in one write */
+#define STDIO_MAX_IOV 64
+#define STDIO_MAX_WRITE (256 * 1024)
+
 struct io_buf {
 	int ref_count;
 	uint32_t length;
+	uint32_t size; /* payload bytes allocated after the header */
 	void *data;
 };
 
+/*
+ * Largest payload of the stdout/stderr messages built from task output. It
+ * drops to SLURM_IO_MAX_MSG_LEN for good once a client older than 26.11
+ * connects, as messages are shared by all clients.
+ */
+static uint32_t io_msg_len = SLURM_IO_MAX_MSG_LEN_LARGE;
+
 static struct io_buf *_alloc_io_buf(void);
 static void _free_io_buf(struct io_buf *buf);
+static void _io_buf_reserve(struct io_buf *buf, uint32_t len);
 
 /**********************************************************************
  * IO client socket declarations
@@ -138,6 +152,7 @@ struct client_io_info {
 
 	/* true if writing to a file, false if writing to a socket */
 	bool is_local_file;
+	uint32_t max_msg_len; /* largest payload the client accepts */
 
 	/*
 	 * The sattach client this I/O client was created for by an attach, or
@@ -312,6 +327,10 @@ _client_writable(eio_obj_t *obj)
 		client->msg_queue = list_create(NULL); /* need destructor */
 		msgs = list_iterator_create(step->outgoing_cache);
 		while ((msg = list_next(msgs))) {
+			/* Built before an older client lowered io_msg_len */
+			if ((msg->length - IO_HDR_PACKET_BYTES) >
+			    client->max_msg_len)
+				continue;
 			msg->ref_count++;
 			list_enqueue(client->msg_queue, msg);
 		}
@@ -363,9 +382,15 @@ static int _client_read(eio_obj_t *obj, list_t *objs)
 			return SLURM_SUCCESS;
 		}
 		debug5("client->header.length = %u", client->header.length);
-		if (client->header.length > SLURM_IO_MAX_MSG_LEN)
+		if (client->header.length > SLURM_IO_MAX_MSG_LEN) {
 			error("Message length of %u exceeds maximum of %u",
 			      client->header.length, SLURM_IO_MAX_MSG_LEN);
+			client->in_eof = true;
+			_attached_client_gone(obj);
+			list_enqueue(step->free_incoming, client->in_msg);
+			client->in_msg = NULL;
+			return SLURM_SUCCESS;
+		}
 		client->in_remaining = client->header.length;
 		client->in_msg->length = client->header.length;
 	}
@@ -470,14 +495,46 @@ static int _client_read(eio_obj_t *obj, list_t *objs)
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Fill iov with the unsent part of client->out_msg followed by as many
+ * queued messages as fit in one write.
+ * RET number of iov entries used
+ */
+static int _client_fill_iov(struct client_io_info *client, struct iovec *iov)
+{
+	list_itr_t *itr;
+	struct io_buf *msg;
+	size_t bytes = client->out_remaining;
+	int cnt = 0;
+
+	iov[cnt].iov_base = client->out_msg->data +
+		(client->out_msg->length - client->out_remaining);
+	iov[cnt++].iov_len = client->out_remaining;
+
+	itr = list_iterator_create(client->msg_queue);
+	while ((cnt < STDIO_MAX_IOV) && (bytes < STDIO_MAX_WRITE) &&
+	       (msg = list_next(itr))) {
+		iov[cnt].iov_base = msg->data;
+		iov[cnt++].iov_len = msg->length;
+		bytes += msg->length;
+	}
+	list_iterator_destroy(itr);
+
+	return cnt;
+}
+
 /*
  * Write outgoing packed messages to the client socket.
+ *
+ * Messages queued behind the current one are sent in the same write, which
+ * keeps a busy task from costing one syscall per message.
  */
 static int _client_write(eio_obj_t *obj, list_t *objs)
 {
 	struct client_io_info *client = obj->arg;
-	void *buf;
-	int n;
+	struct iovec iov[STDIO_MAX_IOV];
+	ssize_t n;
+	int cnt;
 
 	xassert(client->magic == CLIENT_IO_MAGIC);
 
@@ -501,15 +558,14 @@ static int _client_write(eio_obj_t *obj, list_t *objs)
 	debug5("  client->out_remaining = %d", client->out_remaining);
 
 	/*
-	 * Write message to socket.
+	 * Write messages to socket.
 	 */
-	buf = client->out_msg->data +
-		(client->out_msg->length - client->out_remaining);
+	cnt = _client_fill_iov(client, iov);
 again:
 	if (obj->conn) {
-		n = conn_g_send(obj->conn, buf, client->out_remaining);
+		n = conn_g_sendv(obj->conn, iov, cnt);
 	} else {
-		n = write(obj->fd, buf, client->out_remaining);
+		n = writev(obj->fd, iov, cnt);
 	}
 	if (n < 0) {
 		if (errno == EINTR) {
@@ -533,17 +589,23 @@ again:
 			return SLURM_SUCCESS;
 		}
 	}
-	if (n < client->out_remaining) {
-		error("Only wrote %d of %d bytes to socket",
-		      n, client->out_remaining);
-	} else
-		debug5("Wrote %d bytes to socket", n);
-	client->out_remaining -= n;
-	if (client->out_remaining > 0)
-		return SLURM_SUCCESS;
+	debug5("Wrote %zd bytes in %d messages to socket", n, cnt);
 
-	_free_outgoing_msg(client->out_msg);
-	client->out_msg = NULL;
+	/* Release every message sent in full, in queue order */
+	while (n > 0) {
+		if (n < client->out_remaining) {
+			client->out_remaining -= n;
+			break;
+		}
+		n -= client->out_remaining;
+		_free_outgoing_msg(client->out_msg);
+		client->out_msg = NULL;
+		if (n == 0)
+			break;
+		client->out_msg = list_dequeue(client->msg_queue);
+		xassert(client->out_msg);
+		client->out_remaining = client->out_msg->length;
+	}
 
 	return SLURM_SUCCESS;
 }
@@ -764,7 +826,8 @@ static eio_obj_t *_create_task_out_eio(int fd, uint16_t type,
 	out->type = type;
 	out->gtaskid = task->gtid;
 	out->ltaskid = task->id;
-	out->buf = cbuf_create(SLURM_IO_MAX_MSG_LEN * 4, false);
+	/* Room for two of the largest messages */
+	out->buf = cbuf_create(SLURM_IO_MAX_MSG_LEN_LARGE * 2, false);
 	out->eof = false;
 	out->eof_msg_sent = false;
 
@@ -1638,6 +1701,7 @@ extern int io_create_local_client(const char *filename, int file_flags,
 	client->ltaskid_stderr = stderr_tasks;
 	client->labelio = labelio;
 	client->is_local_file = true;
+	client->max_msg_len = SLURM_IO_MAX_MSG_LEN_LARGE;
 
 	client->taskid_width = 1;
 	tmp = step->node_tasks - 1;
@@ -1653,6 +1717,23 @@ extern int io_create_local_client(const char *filename, int file_flags,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Largest payload a client accepts. An older client also limits the
+ * messages built from now on, as they are shared by every client.
+ */
+static uint32_t _client_max_msg_len(srun_info_t *srun)
+{
+	if (srun->protocol_version >= SLURM_26_11_PROTOCOL_VERSION)
+		return SLURM_IO_MAX_MSG_LEN_LARGE;
+
+	if (io_msg_len > SLURM_IO_MAX_MSG_LEN)
+		debug("%s: client protocol %hu limits stdio messages to %u bytes",
+		      __func__, srun->protocol_version, SLURM_IO_MAX_MSG_LEN);
+	io_msg_len = SLURM_IO_MAX_MSG_LEN;
+
+	return SLURM_IO_MAX_MSG_LEN;
+}
+
 /*
  * Create the initial TCP connection back to a waiting client (e.g. srun).
  *
@@ -1707,6 +1788,7 @@ extern int io_initial_client_connect(srun_info_t *srun, int stdout_tasks,
 	client->labelio = false;
 	client->taskid_width = 0;
 	client->is_local_file = false;
+	client->max_msg_len = _client_max_msg_len(srun);
 
 	obj = eio_obj_create(sock, &client_ops, (void *)client);
 	obj->conn = conn;
@@ -1763,6 +1845,7 @@ extern int io_client_connect(srun_info_t *srun)
 	client->labelio = false;
 	client->taskid_width = 0;
 	client->is_local_file = false;
+	client->max_msg_len = _client_max_msg_len(srun);
 	client->srun = srun;
 
 	/* client object adds itself to step->clients in _client_writable */
@@ -1917,7 +2000,7 @@ static struct io_buf *_task_build_message(struct task_read_info *out,
 	bool must_truncate = false;
 	int avail;
 	io_hdr_t header;
-	int n;
+	int n, len;
 	bool buffered_stdio = step->flags & LAUNCH_BUFFERED_IO;
 
 	debug4("%s: Entering...", __func__);
@@ -1928,13 +2011,19 @@ static struct io_buf *_task_build_message(struct task_read_info *out,
 		return NULL;
 	}
 
+	/*
+	 * Size the message to the output waiting, so a task writing a line
+	 * at a time keeps using small buffers.
+	 */
+	len = MIN(cbuf_used(cbuf) + 1, io_msg_len);
+	_io_buf_reserve(msg, len);
 	ptr = msg->data + IO_HDR_PACKET_BYTES;
 
 	if (buffered_stdio) {
-		avail = cbuf_peek_line(cbuf, ptr, SLURM_IO_MAX_MSG_LEN, 1);
-		if (avail >= SLURM_IO_MAX_MSG_LEN)
+		avail = cbuf_peek_line(cbuf, ptr, len, 1);
+		if (avail >= io_msg_len)
 			must_truncate = true;
-		else if (avail == 0 && cbuf_used(cbuf) >= SLURM_IO_MAX_MSG_LEN)
+		else if (avail == 0 && cbuf_used(cbuf) >= io_msg_len)
 			must_truncate = true;
 	}
 
@@ -1949,9 +2038,9 @@ static struct io_buf *_task_build_message(struct task_read_info *out,
 	 * Hence the "|| out->eof".
 	 */
 	if (must_truncate || !buffered_stdio || out->eof) {
-		n = cbuf_read(cbuf, ptr, SLURM_IO_MAX_MSG_LEN);
+		n = cbuf_read(cbuf, ptr, len);
 	} else {
-		n = cbuf_read_line(cbuf, ptr, SLURM_IO_MAX_MSG_LEN, -1);
+		n = cbuf_read_line(cbuf, ptr, len, -1);
 		if (n == 0) {
 			debug5("  partial line in buffer, ignoring");
 			debug4("Leaving  _task_build_message");
@@ -1989,6 +2078,7 @@ static struct io_buf *_alloc_io_buf(void)
 
 	buf->ref_count = 0;
 	buf->length = 0;
+	buf->size = SLURM_IO_MAX_MSG_LEN;
 	/* The following "+ 1" is just temporary so I can stick a \0 at
 	   the end and do a printf of the data pointer */
 	buf->data = xmalloc(SLURM_IO_MAX_MSG_LEN + IO_HDR_PACKET_BYTES + 1);
@@ -1996,6 +2086,16 @@ static struct io_buf *_alloc_io_buf(void)
 	return buf;
 }
 
+/* Make room for a payload of len bytes, buffers only ever grow */
+static void _io_buf_reserve(struct io_buf *buf, uint32_t len)
+{
+	if (len <= buf->size)
+		return;
+
+	buf->size = len;
+	xrealloc_nz(buf->data, buf->size + IO_HDR_PACKET_BYTES + 1);
+}
+
 static void _free_io_buf(struct io_buf *buf)
 {
 	if (buf) {
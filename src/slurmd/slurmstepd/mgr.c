@@ -47,6 +47,10 @@
 #  include <sys/prctl.h>
 #endif
 
+#ifdef HAVE_LINUX_SCHED_H
+#  include <linux/sched.h>
+#endif
+
 #include <fcntl.h>
 #include <grp.h>
 #include <limits.h>
@@ -59,6 +63,7 @@
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/utsname.h>
 #include <sys/wait.h>
@@ -97,6 +102,7 @@
 #include "src/common/xstring.h"
 
 #include "src/interfaces/acct_gather_profile.h"
+#include "src/interfaces/cgroup.h"
 #include "src/interfaces/cred.h"
 #include "src/interfaces/gpu.h"
 #include "src/interfaces/gres.h"
@@ -2144,6 +2150,293 @@ static void _prepare_stdio(stepd_step_task_info_t *task)
 	io_dup_stdio(task);
 }
 
+/* Add the time since *start to *usec and start timing the next phase */
+static void _fork_phase_end(timespec_t *start, long *usec)
+{
+	timespec_t now = timespec_now();
+
+	*usec += timer_get_duration(start, &now);
+	*start = now;
+}
+
+/*
+ * Prepare the child of task i and exec it once the parent lets it.
+ * Does not return.
+ */
+static void _task_child(int i, struct exec_wait_info *ei,
+			struct priv_state *sprivs)
+{
+	int rc;
+	sigset_t mask;
+
+	/*
+	 * Unblock SIGCHLD since this is blocked early by the
+	 * slurmstepd
+	 */
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	if (pthread_sigmask(SIG_UNBLOCK, &mask, NULL) == -1) {
+		error("pthread_sigmask() failed: %m");
+		_exit(1);
+	}
+
+	/* jobacctinfo_endpoll();
+	 * closing jobacct files here causes deadlock */
+
+	if (slurm_conf.propagate_prio_process)
+		_set_prio_process();
+
+	/*
+	 * Reclaim privileges for the child and call any plugin
+	 * hooks that may require elevated privs
+	 * sprivs->gid_list is already set from the
+	 * drop_privileges call in _fork_all_tasks(), no not reinitialize.
+	 * NOTE: Only put things in here that are self contained
+	 * and belong in the child.
+	 */
+	if ((rc = _pre_task_child_privileged(i, sprivs)))
+		fatal("%s: _pre_task_child_privileged() failed: %s",
+		      __func__, slurm_strerror(rc));
+
+	if (_become_user(sprivs) < 0) {
+		error("_become_user failed: %m");
+		/* child process, should not return */
+		_exit(1);
+	}
+
+	/* log_fini(); */ /* note: moved into exec_task() */
+
+	/*
+	 *  Need to setup stdio before setpgid() is called
+	 *   in case we are setting up a tty. (login_tty()
+	 *   must be called before setpgid() or it is
+	 *   effectively disabled).
+	 */
+	_prepare_stdio(step->task[i]);
+
+	/* Close profiling file descriptors */
+	acct_gather_profile_g_child_forked();
+
+	/*
+	 *  Block until parent notifies us that it is ok to
+	 *   proceed. This allows the parent to place all
+	 *   children in any process groups or containers
+	 *   before they make a call to exec(2).
+	 */
+	if (_exec_wait_child_wait_for_parent(ei) < 0)
+		_exit(1);
+
+	exec_task(i);
+	_exit(1);
+}
+
+/* Record task i started in the parent */
+static void _task_started(int i, struct exec_wait_info *ei,
+			  list_t *exec_wait_list, uint32_t task_offset)
+{
+	char time_stamp[256];
+
+	list_append(exec_wait_list, ei);
+
+	log_timestamp(time_stamp, sizeof(time_stamp));
+	verbose("task %lu (%lu) started %s",
+		(unsigned long) step->task[i]->gtid + task_offset,
+		(unsigned long) ei->pid, time_stamp);
+
+	step->task[i]->pid = ei->pid;
+	if (i == 0)
+		step->pgid = ei->pid;
+}
+
+static void _close_task_cgroups(int **fds)
+{
+	if (!*fds)
+		return;
+
+	for (int i = 0; i < step->node_tasks; i++)
+		close((*fds)[i]);
+	xfree(*fds);
+}
+
+#if defined(CLONE_INTO_CGROUP) && defined(SYS_clone3)
+/*
+ * Open the cgroup of every task, to spawn them straight into it.
+ * Must be called with privileges to create the task cgroups.
+ * RET xmalloc'ed array of fds, or NULL if the tasks must be forked.
+ */
+static int *_open_task_cgroups(uint32_t task_offset)
+{
+	int *fds;
+
+	/* Tasks only get their own cgroup from these plugins */
+	if (!xstrstr(slurm_conf.task_plugin, "task/cgroup") &&
+	    xstrcmp(slurm_conf.job_acct_gather_type, "jobacct_gather/cgroup"))
+		return NULL;
+
+	fds = xcalloc(step->node_tasks, sizeof(*fds));
+	for (int i = 0; i < step->node_tasks; i++) {
+		if ((fds[i] = cgroup_g_task_open(step->task[i]->gtid +
+						 task_offset)) < 0) {
+			while (i--)
+				close(fds[i]);
+			xfree(fds);
+			return NULL;
+		}
+	}
+
+	return fds;
+}
+
+/*
+ * Clone every task straight into its cgroup, reporting the pid of each one or
+ * -errno on failure to fd. Does not return.
+ *
+ * clone3() skips the locking glibc surrounds fork() with, so this runs in a
+ * single threaded process forked from slurmstepd. CLONE_PARENT makes the
+ * tasks children of slurmstepd, with the exit signal of this process.
+ */
+static void _spawn_tasks_helper(int *cg_fds, struct exec_wait_info **eis,
+				int fd, struct priv_state *sprivs)
+{
+	uid_t euid = geteuid();
+	pid_t pid;
+
+	/* Joining a cgroup needs write access to it */
+	if (seteuid(sprivs->saved_uid) < 0) {
+		pid = -errno;
+		safe_write(fd, &pid, sizeof(pid));
+		_exit(0);
+	}
+
+	for (int i = 0; i < step->node_tasks; i++) {
+		struct clone_args args = {
+			.flags = CLONE_PARENT | CLONE_INTO_CGROUP,
+			.cgroup = cg_fds[i],
+		};
+
+		if (!(pid = syscall(SYS_clone3, &args, sizeof(args)))) {
+			close(fd);
+			if (seteuid(euid) < 0)
+				_exit(1);
+			for (int j = 0; j < step->node_tasks; j++) {
+				if (j != i)
+					_exec_wait_info_destroy(eis[j]);
+			}
+			close(eis[i]->parentfd);
+			eis[i]->parentfd = -1;
+
+			_task_child(i, eis[i], sprivs);
+		}
+
+		if (pid < 0)
+			pid = -errno;
+		safe_write(fd, &pid, sizeof(pid));
+		if (pid < 0)
+			break;
+	}
+
+rwfail:
+	_exit(0);
+}
+
+/*
+ * Spawn all tasks into the cgroups from _open_task_cgroups(), saving the move
+ * of every task into its cgroup after fork().
+ * RET SLURM_SUCCESS, or ESLURM_NOT_SUPPORTED if no task is left running and
+ *     the tasks must be forked instead.
+ */
+static int _spawn_tasks_into_cgroups(int *cg_fds, list_t *exec_wait_list,
+				     struct priv_state *sprivs,
+				     uint32_t task_offset)
+{
+	struct exec_wait_info **eis;
+	int fds[2], cnt = 0, rc = ESLURM_NOT_SUPPORTED;
+	pid_t helper, pid;
+
+	if (pipe2(fds, O_CLOEXEC) < 0) {
+		error("%s: pipe: %m", __func__);
+		return rc;
+	}
+
+	eis = xcalloc(step->node_tasks, sizeof(*eis));
+	for (int i = 0; i < step->node_tasks; i++) {
+		if (!(eis[i] = _exec_wait_info_create(i)))
+			goto done;
+	}
+
+	if ((helper = fork()) < 0) {
+		error("%s: fork: %m", __func__);
+		goto done;
+	} else if (!helper) {
+		close(fds[0]);
+		_spawn_tasks_helper(cg_fds, eis, fds[1], sprivs);
+	}
+	close(fds[1]);
+	fds[1] = -1;
+
+	while (cnt < step->node_tasks) {
+		safe_read(fds[0], &pid, sizeof(pid));
+		if (pid < 0) {
+			errno = -pid;
+			debug("%s: clone3(CLONE_INTO_CGROUP) of task %d failed: %m, forking tasks instead",
+			      __func__, cnt);
+			break;
+		}
+		eis[cnt++]->pid = pid;
+	}
+
+rwfail:
+	while ((waitpid(helper, NULL, 0) < 0) && (errno == EINTR))
+		;
+
+	if (cnt < step->node_tasks) {
+		for (int i = 0; i < cnt; i++) {
+			kill(eis[i]->pid, SIGKILL);
+			while ((waitpid(eis[i]->pid, NULL, 0) < 0) &&
+			       (errno == EINTR))
+				;
+		}
+		goto done;
+	}
+
+	for (int i = 0; i < step->node_tasks; i++) {
+		uint32_t task_id = step->task[i]->gtid + task_offset;
+
+		close(eis[i]->childfd);
+		eis[i]->childfd = -1;
+
+		acct_gather_profile_g_task_start(i);
+		if (cgroup_g_task_spawned(eis[i]->pid, task_id))
+			error("%s: task %u spawned into unknown cgroup",
+			      __func__, task_id);
+		_task_started(i, eis[i], exec_wait_list, task_offset);
+		eis[i] = NULL;
+	}
+	rc = SLURM_SUCCESS;
+
+done:
+	for (int i = 0; i < step->node_tasks; i++)
+		_exec_wait_info_destroy(eis[i]);
+	xfree(eis);
+	close(fds[0]);
+	if (fds[1] >= 0)
+		close(fds[1]);
+	return rc;
+}
+#else
+static int *_open_task_cgroups(uint32_t task_offset)
+{
+	return NULL;
+}
+
+static int _spawn_tasks_into_cgroups(int *cg_fds, list_t *exec_wait_list,
+				     struct priv_state *sprivs,
+				     uint32_t task_offset)
+{
+	return ESLURM_NOT_SUPPORTED;
+}
+#endif
+
 /*
  * fork and exec N tasks
  */
@@ -2156,6 +2449,11 @@ static int _fork_all_tasks(bool *io_initialized)
 	list_t *exec_wait_list = NULL;
 	uint32_t node_offset = 0, task_offset = 0;
 	char saved_cwd[PATH_MAX];
+	timespec_t phase_ts = timespec_now();
+	long setup_usec = 0, fork_usec = 0, track_usec = 0, acct_usec = 0;
+	long task_usec = 0, spank_usec = 0, release_usec = 0;
+	int *task_cg_fds = NULL;
+	bool spawned = false;
 
 	if (step->het_job_node_offset != NO_VAL)
 		node_offset = step->het_job_node_offset;
@@ -2247,6 +2545,8 @@ static int _fork_all_tasks(bool *io_initialized)
 		}
 	}
 
+	task_cg_fds = _open_task_cgroups(task_offset);
+
 	/*
 	 * Temporarily drop effective privileges
 	 */
@@ -2288,15 +2588,19 @@ static int _fork_all_tasks(bool *io_initialized)
 		}
 	}
 
+	_fork_phase_end(&phase_ts, &setup_usec);
+
 	exec_wait_list = list_create ((ListDelF) _exec_wait_info_destroy);
 
 	/*
 	 * Fork all of the task processes.
 	 */
 	verbose("starting %u tasks", step->node_tasks);
-	for (i = 0; i < step->node_tasks; i++) {
-		char time_stamp[256];
-		pid_t pid;
+	if (task_cg_fds &&
+	    !_spawn_tasks_into_cgroups(task_cg_fds, exec_wait_list, &sprivs,
+				       task_offset))
+		spawned = true;
+	for (i = 0; !spawned && (i < step->node_tasks); i++) {
 		struct exec_wait_info *ei;
 
 		acct_gather_profile_g_task_start(i);
@@ -2305,10 +2609,7 @@ static int _fork_all_tasks(bool *io_initialized)
 			exec_wait_kill_children(exec_wait_list);
 			rc = SLURM_ERROR;
 			goto fail4;
-		} else if ((pid = _exec_wait_get_pid(ei)) == 0) { /* child */
-			int rc;
-			sigset_t mask;
-
+		} else if (_exec_wait_get_pid(ei) == 0) { /* child */
 			/*
 			 *  Destroy exec_wait_list in the child.
 			 *   Only exec_wait_info for previous tasks have been
@@ -2317,80 +2618,13 @@ static int _fork_all_tasks(bool *io_initialized)
 			 */
 			FREE_NULL_LIST(exec_wait_list);
 
-			/*
-			 * Unblock SIGCHLD since this is blocked early by the
-			 * slurmstepd
-			 */
-			sigemptyset(&mask);
-			sigaddset(&mask, SIGCHLD);
-			if (pthread_sigmask(SIG_UNBLOCK, &mask, NULL) == -1) {
-				error("pthread_sigmask() failed: %m");
-				_exit(1);
-			}
-
-			/* jobacctinfo_endpoll();
-			 * closing jobacct files here causes deadlock */
-
-			if (slurm_conf.propagate_prio_process)
-				_set_prio_process();
-
-			/*
-			 * Reclaim privileges for the child and call any plugin
-			 * hooks that may require elevated privs
-			 * sprivs.gid_list is already set from the
-			 * drop_privileges call above, no not reinitialize.
-			 * NOTE: Only put things in here that are self contained
-			 * and belong in the child.
-			 */
-			if ((rc = _pre_task_child_privileged(i, &sprivs)))
-				fatal("%s: _pre_task_child_privileged() failed: %s",
-				      __func__, slurm_strerror(rc));
-
-			if (_become_user(&sprivs) < 0) {
-				error("_become_user failed: %m");
-				/* child process, should not return */
-				_exit(1);
-			}
-
-			/* log_fini(); */ /* note: moved into exec_task() */
-
-			/*
-			 *  Need to setup stdio before setpgid() is called
-			 *   in case we are setting up a tty. (login_tty()
-			 *   must be called before setpgid() or it is
-			 *   effectively disabled).
-			 */
-			_prepare_stdio(step->task[i]);
-
-			/* Close profiling file descriptors */
-			acct_gather_profile_g_child_forked();
-
-			/*
-			 *  Block until parent notifies us that it is ok to
-			 *   proceed. This allows the parent to place all
-			 *   children in any process groups or containers
-			 *   before they make a call to exec(2).
-			 */
-			if (_exec_wait_child_wait_for_parent(ei) < 0)
-				_exit(1);
-
-			exec_task(i);
+			_task_child(i, ei, &sprivs);
 		}
 
 		/*
 		 * Parent continues:
 		 */
-
-		list_append(exec_wait_list, ei);
-
-		log_timestamp(time_stamp, sizeof(time_stamp));
-		verbose("task %lu (%lu) started %s",
-			(unsigned long) step->task[i]->gtid + task_offset,
-			(unsigned long) pid, time_stamp);
-
-		step->task[i]->pid = pid;
-		if (i == 0)
-			step->pgid = pid;
+		_task_started(i, ei, exec_wait_list, task_offset);
 	}
 
 	/*
@@ -2410,6 +2644,9 @@ static int _fork_all_tasks(bool *io_initialized)
 		error ("Unable to return to working directory");
 	}
 
+	_close_task_cgroups(&task_cg_fds);
+	_fork_phase_end(&phase_ts, &fork_usec);
+
 	for (i = 0; i < step->node_tasks; i++) {
 		/*
 		 * Put this task in the step process group
@@ -2429,6 +2666,8 @@ static int _fork_all_tasks(bool *io_initialized)
 			rc = SLURM_ERROR;
 			goto fail2;
 		}
+		_fork_phase_end(&phase_ts, &track_usec);
+
 		jobacct_id.nodeid = step->nodeid + node_offset;
 		jobacct_id.taskid = step->task[i]->gtid + task_offset;
 		jobacct_id.step = step;
@@ -2443,6 +2682,7 @@ static int _fork_all_tasks(bool *io_initialized)
 			jobacct_gather_add_task(step->task[i]->pid, &jobacct_id,
 						0);
 		}
+		_fork_phase_end(&phase_ts, &acct_usec);
 
 		/*
 		 * Affinity must be set after cgroup is set, or moving pids from
@@ -2453,6 +2693,7 @@ static int _fork_all_tasks(bool *io_initialized)
 			rc = SLURM_ERROR;
 			goto fail2;
 		}
+		_fork_phase_end(&phase_ts, &task_usec);
 
 		if (_run_spank_func(SPANK_STEP_TASK_POST_FORK, i, NULL) < 0) {
 			error ("spank task %d post-fork failed", i);
@@ -2476,6 +2717,7 @@ static int _fork_all_tasks(bool *io_initialized)
 
 			goto fail2;
 		}
+		_fork_phase_end(&phase_ts, &spank_usec);
 	}
 //	jobacct_gather_set_proctrack_container_id(step->cont_id);
 
@@ -2495,6 +2737,12 @@ static int _fork_all_tasks(bool *io_initialized)
 			goto fail2;
 		}
 	}
+	_fork_phase_end(&phase_ts, &release_usec);
+
+	debug("%s: %s %u tasks, usec setup:%ld fork:%ld proctrack:%ld jobacct:%ld task_plugins:%ld spank_post_fork:%ld release:%ld",
+	      __func__, (spawned ? "spawned into cgroups" : "forked"),
+	      step->node_tasks, setup_usec, fork_usec, track_usec,
+	      acct_usec, task_usec, spank_usec, release_usec);
 	END_TIMER2(__func__);
 	return rc;
 
@@ -2508,6 +2756,7 @@ fail3:
 		/* Don't bother erroring out here */
 	}
 fail2:
+	_close_task_cgroups(&task_cg_fds);
 	FREE_NULL_LIST(exec_wait_list);
 	io_close_task_fds();
 fail1:
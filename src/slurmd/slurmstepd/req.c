@@ -85,6 +85,7 @@
 #include "src/slurmd/slurmstepd/req.h"
 #include "src/slurmd/slurmstepd/slurmstepd.h"
 #include "src/slurmd/slurmstepd/slurmstepd_job.h"
+#include "src/slurmd/slurmstepd/stat_shm.h"
 #include "src/slurmd/slurmstepd/step_terminate_monitor.h"
 #include "src/slurmd/slurmstepd/ulimits.h"
 
@@ -2397,9 +2398,7 @@ rwfail:	if (lock_set) {
 
 static int _handle_stat_jobacct(int fd, uid_t uid, pid_t remote_pid)
 {
-	bool update_data = true;
 	jobacctinfo_t *jobacct = NULL;
-	jobacctinfo_t *temp_jobacct = NULL;
 	int num_tasks = 0;
 	uint64_t msg_timeout_us;
 	DEF_TIMERS;
@@ -2410,32 +2409,7 @@ static int _handle_stat_jobacct(int fd, uid_t uid, pid_t remote_pid)
 	jobacct = jobacctinfo_create(NULL);
 	debug3("num tasks = %d", step->node_tasks);
 
-	/*
-	 * Extern step has pid = -1 so it would be skipped, deal with it
-	 * differently
-	 */
-	if (step->step_id.step_id == SLURM_EXTERN_CONT) {
-		/*
-		 * We only have one task in the extern step on each node,
-		 * despite many pids may have been adopted.
-		 */
-		jobacct_gather_stat_all_task(jobacct);
-		jobacctinfo_aggregate(jobacct, step->jobacct);
-		num_tasks = 1;
-	} else {
-		for (int i = 0; i < step->node_tasks; i++) {
-			temp_jobacct =
-				jobacct_gather_stat_task(step->task[i]->pid,
-							 update_data);
-
-			update_data = false;
-			if (temp_jobacct) {
-				jobacctinfo_aggregate(jobacct, temp_jobacct);
-				jobacctinfo_destroy(temp_jobacct);
-				num_tasks++;
-			}
-		}
-	}
+	num_tasks = stat_shm_aggregate(jobacct, true);
 
 	jobacctinfo_setinfo(jobacct, JOBACCT_DATA_PIPE, &fd,
 			    SLURM_PROTOCOL_VERSION);
@@ -98,6 +98,7 @@
 #include "src/slurmd/slurmstepd/req.h"
 #include "src/slurmd/slurmstepd/slurmstepd.h"
 #include "src/slurmd/slurmstepd/slurmstepd_job.h"
+#include "src/slurmd/slurmstepd/stat_shm.h"
 
 #include "src/stepmgr/stepmgr.h"
 
@@ -753,6 +754,8 @@ extern int main(int argc, char **argv)
 		goto ending;
 	}
 
+	stat_shm_init();
+
 	if (step->step_id.step_id != SLURM_EXTERN_CONT)
 		close_slurmd_conn(rc);
 
@@ -831,6 +834,8 @@ extern void stepd_cleanup(slurm_msg_t *msg, slurm_addr_t *cli, int rc,
 		slurm_thread_join(step->msgid);
 	}
 
+	stat_shm_fini();
+
 	/*
 	 * This call is only done once per step since stepd_cleanup is protected
 	 * against multiple and concurrent calls.
@@ -1226,6 +1231,35 @@ rwfail:
 #endif
 }
 
+/*
+ * Wait for slurmd to send the step type. A pooled slurmstepd can wait here
+ * until slurmd is stopped, which is not an error.
+ */
+static bool _wait_for_step(int sock, int *step_type)
+{
+	char *ptr = (char *) step_type;
+	size_t remaining = sizeof(*step_type);
+
+	while (remaining > 0) {
+		ssize_t rc = read(sock, ptr, remaining);
+
+		if ((rc < 0) && ((errno == EINTR) || (errno == EAGAIN)))
+			continue;
+		if (!rc && (remaining == sizeof(*step_type))) {
+			debug2("%s: slurmd closed connection before sending a step",
+			       __func__);
+			return false;
+		}
+		if (rc <= 0)
+			fatal("Error reading initialization data from slurmd: %m");
+
+		ptr += rc;
+		remaining -= rc;
+	}
+
+	return true;
+}
+
 static void _set_job_log_prefix(slurm_step_id_t *step_id)
 {
 	char *buf;
@@ -1278,8 +1312,49 @@ _init_from_slurmd(int sock, char **argv, slurm_addr_t **_cli,
 	/* receive conf_hashtbl from slurmd */
 	read_conf_recv_stepd(sock);
 
+	/*
+	 * Init switch before unpack_msg to only init the default. These only
+	 * need the slurm.conf, so they are loaded before a slurmstepd from
+	 * the slurmd's stepd_pool waits for its step.
+	 */
+	if (switch_g_init(true) != SLURM_SUCCESS)
+		fatal("failed to initialize switch plugin");
+
+	if (cred_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize credential plugin");
+
+	if (gres_init() != SLURM_SUCCESS)
+		fatal("failed to initialize gres plugins");
+
+	if (cgroup_read_state(sock) != SLURM_SUCCESS)
+		fatal("Failed to read cgroup state from slurmd");
+
+	/*
+	 * The cgroup state, cgroup.conf and acct_gather.conf are the same for
+	 * every step on the node, so the plugins needing only those are loaded
+	 * before waiting for the step too. The mpi, runtime and namespace
+	 * plugins depend on the step and are loaded once it is received.
+	 */
+	if ((cgroup_g_init() != SLURM_SUCCESS) ||
+	    (acct_gather_conf_init() != SLURM_SUCCESS))
+		fatal("Couldn't load all plugins");
+
+	/* receive cgroup conf from slurmd */
+	if (cgroup_read_conf(sock) != SLURM_SUCCESS)
+		fatal("Failed to read cgroup conf from slurmd");
+
+	/* receive acct_gather conf from slurmd */
+	if (acct_gather_read_conf(sock) != SLURM_SUCCESS)
+		fatal("Failed to read acct_gather conf from slurmd");
+
+	if ((proctrack_g_init() != SLURM_SUCCESS) ||
+	    (task_g_init() != SLURM_SUCCESS) ||
+	    (jobacct_gather_init() != SLURM_SUCCESS))
+		fatal("Couldn't load all plugins");
+
 	/* receive job type from slurmd */
-	safe_read(sock, &step_type, sizeof(int));
+	if (!_wait_for_step(sock, &step_type))
+		exit(0);
 	debug3("step_type = %d", step_type);
 
 	/* receive reverse-tree info from slurmd */
@@ -1345,16 +1420,6 @@ _init_from_slurmd(int sock, char **argv, slurm_addr_t **_cli,
 		break;
 	}
 
-	/* Init switch before unpack_msg to only init the default */
-	if (switch_g_init(true) != SLURM_SUCCESS)
-		fatal("failed to initialize switch plugin");
-
-	if (cred_g_init() != SLURM_SUCCESS)
-		fatal("failed to initialize credential plugin");
-
-	if (gres_init() != SLURM_SUCCESS)
-		fatal("failed to initialize gres plugins");
-
 	if (unpack_msg(msg, buffer) == SLURM_ERROR)
 		fatal("slurmstepd: we didn't unpack the request correctly");
 	FREE_NULL_BUFFER(buffer);
@@ -1412,22 +1477,15 @@ _init_from_slurmd(int sock, char **argv, slurm_addr_t **_cli,
 
 	_set_job_log_prefix(&step_id);
 
-	if (cgroup_read_state(sock) != SLURM_SUCCESS)
-		fatal("Failed to read cgroup state from slurmd");
-
 	/*
-	 * Init all plugins after receiving the slurm.conf from the slurmd.
+	 * Init the remaining plugins after receiving the slurm.conf from the
+	 * slurmd.
 	 */
 	if ((auth_g_init() != SLURM_SUCCESS) ||
 	    (certgen_g_init() != SLURM_SUCCESS) ||
 	    (conn_g_init() != SLURM_SUCCESS) ||
-	    (cgroup_g_init() != SLURM_SUCCESS) ||
 	    (hash_g_init() != SLURM_SUCCESS) ||
-	    (acct_gather_conf_init() != SLURM_SUCCESS) ||
 	    (prep_g_init(NULL) != SLURM_SUCCESS) ||
-	    (proctrack_g_init() != SLURM_SUCCESS) ||
-	    (task_g_init() != SLURM_SUCCESS) ||
-	    (jobacct_gather_init() != SLURM_SUCCESS) ||
 	    (acct_gather_profile_init() != SLURM_SUCCESS) ||
 	    (namespace_g_init() != SLURM_SUCCESS) ||
 	    (topology_g_init() != SLURM_SUCCESS) ||
@@ -1435,17 +1493,9 @@ _init_from_slurmd(int sock, char **argv, slurm_addr_t **_cli,
 		fatal("Couldn't load all plugins");
 
 	/*
-	 * Receive all secondary conf files from the slurmd.
+	 * Receive the remaining secondary conf files from the slurmd.
 	 */
 
-	/* receive cgroup conf from slurmd */
-	if (cgroup_read_conf(sock) != SLURM_SUCCESS)
-		fatal("Failed to read cgroup conf from slurmd");
-
-	/* receive acct_gather conf from slurmd */
-	if (acct_gather_read_conf(sock) != SLURM_SUCCESS)
-		fatal("Failed to read acct_gather conf from slurmd");
-
 	/* Receive job_container information from slurmd */
 	if (namespace_g_recv_stepd(sock) != SLURM_SUCCESS)
 		fatal("Failed to read job_container.conf from slurmd.");
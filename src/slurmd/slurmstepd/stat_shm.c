@@ -0,0 +1,205 @@
+/*****************************************************************************\
+ *  stat_shm.c - publish step accounting in shared memory
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "src/common/fd.h"
+#include "src/common/macros.h"
+#include "src/common/pack.h"
+#include "src/common/read_config.h"
+#include "src/common/stepd_api.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/slurmd/slurmstepd/slurmstepd.h"
+#include "src/slurmd/slurmstepd/stat_shm.h"
+
+static pthread_mutex_t shm_lock = PTHREAD_MUTEX_INITIALIZER;
+static stepd_stat_shm_t *shm = NULL;
+static char *shm_path = NULL;
+
+extern int stat_shm_aggregate(jobacctinfo_t *jobacct, bool update_data)
+{
+	jobacctinfo_t *temp_jobacct = NULL;
+	int num_tasks = 0;
+
+	/*
+	 * Extern step has pid = -1 so it would be skipped, deal with it
+	 * differently
+	 */
+	if (step->step_id.step_id == SLURM_EXTERN_CONT) {
+		/*
+		 * We only have one task in the extern step on each node,
+		 * despite many pids may have been adopted.
+		 */
+		jobacct_gather_stat_all_task(jobacct, update_data);
+		jobacctinfo_aggregate(jobacct, step->jobacct);
+		return 1;
+	}
+
+	for (int i = 0; i < step->node_tasks; i++) {
+		temp_jobacct = jobacct_gather_stat_task(step->task[i]->pid,
+							update_data);
+
+		update_data = false;
+		if (temp_jobacct) {
+			jobacctinfo_aggregate(jobacct, temp_jobacct);
+			jobacctinfo_destroy(temp_jobacct);
+			num_tasks++;
+		}
+	}
+
+	return num_tasks;
+}
+
+/* Called by jobacct_gather once the tasks have been polled */
+static void _publish(void)
+{
+	jobacctinfo_t *jobacct = NULL;
+	buf_t *buffer = NULL;
+	uint32_t seq, len;
+	int num_tasks;
+
+	slurm_mutex_lock(&shm_lock);
+
+	if (!shm || !(jobacct = jobacctinfo_create(NULL)))
+		goto done;
+
+	num_tasks = stat_shm_aggregate(jobacct, false);
+
+	buffer = init_buf(BUF_SIZE);
+	jobacctinfo_pack(jobacct, SLURM_PROTOCOL_VERSION, PROTOCOL_TYPE_SLURM,
+			 buffer);
+	len = get_buf_offset(buffer);
+	if (len > (STEPD_STAT_SHM_SIZE - sizeof(*shm))) {
+		log_flag(JAG, "%s: %u bytes of accounting do not fit in %s",
+			 __func__, len, shm_path);
+		goto done;
+	}
+
+	seq = shm->seq;
+	__atomic_store_n(&shm->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	memcpy(shm->data, get_buf_data(buffer), len);
+	shm->len = len;
+	shm->num_tasks = num_tasks;
+	shm->update_time = time(NULL);
+
+	__atomic_store_n(&shm->seq, seq + 2, __ATOMIC_RELEASE);
+
+done:
+	slurm_mutex_unlock(&shm_lock);
+	FREE_NULL_BUFFER(buffer);
+	jobacctinfo_destroy(jobacct);
+}
+
+extern void stat_shm_init(void)
+{
+	char *tmp_path = NULL;
+	void *addr = MAP_FAILED;
+	int fd = -1;
+
+	if (!xstrcasestr(slurm_conf.job_acct_gather_params, "StatSnapshot"))
+		return;
+
+	shm_path = stepd_stat_shm_path(conf->spooldir, conf->node_name,
+				       &step->step_id);
+
+	/*
+	 * Size and initialize the file before it becomes visible, a reader
+	 * mapping it while still empty would get SIGBUS.
+	 */
+	tmp_path = xstrdup_printf("%s.new", shm_path);
+	(void) unlink(tmp_path);
+	if ((fd = open(tmp_path, (O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC),
+		       0600)) < 0) {
+		error("%s: open(%s): %m", __func__, tmp_path);
+		goto fail;
+	}
+	if (ftruncate(fd, STEPD_STAT_SHM_SIZE)) {
+		error("%s: ftruncate(%s): %m", __func__, tmp_path);
+		goto fail;
+	}
+	if ((addr = mmap(NULL, STEPD_STAT_SHM_SIZE, (PROT_READ | PROT_WRITE),
+			 MAP_SHARED, fd, 0)) == MAP_FAILED) {
+		error("%s: mmap(%s): %m", __func__, tmp_path);
+		goto fail;
+	}
+	fd_close(&fd);
+
+	((stepd_stat_shm_t *) addr)->magic = STEPD_STAT_SHM_MAGIC;
+	((stepd_stat_shm_t *) addr)->protocol_version = SLURM_PROTOCOL_VERSION;
+
+	if (rename(tmp_path, shm_path)) {
+		error("%s: rename(%s, %s): %m", __func__, tmp_path, shm_path);
+		goto fail;
+	}
+	xfree(tmp_path);
+
+	slurm_mutex_lock(&shm_lock);
+	shm = addr;
+	slurm_mutex_unlock(&shm_lock);
+
+	jobacct_gather_set_poll_callback(_publish);
+	debug("%s: publishing accounting of %ps in %s",
+	      __func__, &step->step_id, shm_path);
+	return;
+
+fail:
+	if (addr != MAP_FAILED)
+		munmap(addr, STEPD_STAT_SHM_SIZE);
+	fd_close(&fd);
+	if (tmp_path)
+		(void) unlink(tmp_path);
+	xfree(tmp_path);
+	xfree(shm_path);
+}
+
+extern void stat_shm_fini(void)
+{
+	jobacct_gather_set_poll_callback(NULL);
+
+	slurm_mutex_lock(&shm_lock);
+	if (shm) {
+		munmap(shm, STEPD_STAT_SHM_SIZE);
+		shm = NULL;
+		if (unlink(shm_path))
+			error("%s: unlink(%s): %m", __func__, shm_path);
+	}
+	xfree(shm_path);
+	slurm_mutex_unlock(&shm_lock);
+}
@@ -0,0 +1,59 @@
+/*****************************************************************************\
+ *  stat_shm.h - publish step accounting in shared memory
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _STAT_SHM_H
+#define _STAT_SHM_H
+
+#include <stdbool.h>
+
+#include "src/interfaces/jobacct_gather.h"
+
+/*
+ * If JobAcctGatherParams=StatSnapshot is set, create the accounting snapshot
+ * of this step (see stepd_stat_shm_t) and refresh it after every
+ * JobAcctGatherFrequency poll.
+ */
+extern void stat_shm_init(void);
+extern void stat_shm_fini(void);
+
+/*
+ * Aggregate the usage of all the tasks of this step into jobacct.
+ *
+ * IN update_data - poll the tasks first instead of using the last poll
+ * RET number of tasks aggregated
+ */
+extern int stat_shm_aggregate(jobacctinfo_t *jobacct, bool update_data);
+
+#endif
@@ -1104,14 +1104,11 @@ static int _get_instances(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 	return rc;
 }
 
-static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
-			  buf_t **out_buffer)
+/* Checks common to all the job queries, fills in out_buffer on failure */
+static int _validate_job_cond(slurmdbd_conn_t *slurmdbd_conn,
+			      slurmdb_job_cond_t *job_cond,
+			      slurmdbd_msg_type_t msg_type, buf_t **out_buffer)
 {
-	dbd_cond_msg_t *cond_msg = msg->data;
-	dbd_list_msg_t list_msg = { NULL };
-	slurmdb_job_cond_t *job_cond = cond_msg->cond;
-	int rc = SLURM_SUCCESS;
-
 	/* fail early if requesting runaways and not super user */
 	if ((job_cond->flags & JOBCOND_FLAG_RUNAWAY) &&
 	    !_validate_operator(slurmdbd_conn)) {
@@ -1121,7 +1118,7 @@ static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 			slurmdbd_conn->pcon,
 			ESLURM_ACCESS_DENIED,
 			"You must have an AdminLevel>=Operator to fix runaway jobs",
-			DBD_GET_JOBS_COND);
+			msg_type);
 		return SLURM_ERROR;
 	}
 	/* fail early if too wide a query */
@@ -1142,11 +1139,26 @@ static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 			*out_buffer = slurm_persist_make_rc_msg(slurmdbd_conn->pcon,
 								ESLURM_DB_QUERY_TOO_WIDE,
 								slurm_strerror(ESLURM_DB_QUERY_TOO_WIDE),
-								DBD_GET_JOBS_COND);
+								msg_type);
 			return SLURM_ERROR;
 		}
 	}
 
+	return SLURM_SUCCESS;
+}
+
+static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
+			  buf_t **out_buffer)
+{
+	dbd_cond_msg_t *cond_msg = msg->data;
+	dbd_list_msg_t list_msg = { NULL };
+	slurmdb_job_cond_t *job_cond = cond_msg->cond;
+	int rc = SLURM_SUCCESS;
+
+	if (_validate_job_cond(slurmdbd_conn, job_cond, DBD_GET_JOBS_COND,
+			       out_buffer) != SLURM_SUCCESS)
+		return SLURM_ERROR;
+
 	list_msg.my_list = jobacct_storage_g_get_jobs_cond(
 		slurmdbd_conn->db_conn, slurmdbd_conn->pcon->auth_uid,
 		job_cond);
@@ -1179,6 +1191,109 @@ static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 	return rc;
 }
 
+static int _get_jobs_columns(slurmdbd_conn_t *slurmdbd_conn,
+			     persist_msg_t *msg, buf_t **out_buffer)
+{
+	dbd_cond_msg_t *cond_msg = msg->data;
+	dbd_list_msg_t list_msg = { NULL };
+	slurmdb_job_cond_t *job_cond = cond_msg->cond;
+	int rc = SLURM_SUCCESS;
+
+	if (_validate_job_cond(slurmdbd_conn, job_cond, DBD_GET_JOBS_COLUMNS,
+			       out_buffer) != SLURM_SUCCESS)
+		return SLURM_ERROR;
+
+	/*
+	 * A NULL list means the projection could not be served, the client
+	 * is expected to fall back to DBD_GET_JOBS_COND.
+	 */
+	if (!(list_msg.my_list = jobacct_storage_g_get_jobs_columns(
+		      slurmdbd_conn->db_conn, slurmdbd_conn->pcon->auth_uid,
+		      job_cond))) {
+		rc = errno ? errno : ESLURM_NOT_SUPPORTED;
+		*out_buffer = slurm_persist_make_rc_msg(slurmdbd_conn->pcon,
+							rc, slurm_strerror(rc),
+							DBD_GET_JOBS_COLUMNS);
+		return SLURM_ERROR;
+	}
+
+	*out_buffer = init_buf(1024);
+	pack16((uint16_t) DBD_GOT_JOBS_COLUMNS, *out_buffer);
+	slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->pcon->version,
+			       DBD_GOT_JOBS_COLUMNS, *out_buffer);
+	if (list_msg.return_code == ESLURM_RESULT_TOO_LARGE) {
+		free_buf(*out_buffer);
+		*out_buffer = slurm_persist_make_rc_msg(
+			slurmdbd_conn->pcon, ESLURM_RESULT_TOO_LARGE,
+			slurm_strerror(ESLURM_RESULT_TOO_LARGE),
+			DBD_GET_JOBS_COLUMNS);
+		rc = SLURM_ERROR;
+	}
+
+	FREE_NULL_LIST(list_msg.my_list);
+
+	return rc;
+}
+
+/* Send one DBD_GOT_JOBS_CHUNK of a DBD_GET_JOBS_STREAM response */
+static int _send_jobs_chunk(list_t *job_list, void *arg)
+{
+	slurmdbd_conn_t *slurmdbd_conn = arg;
+	dbd_list_msg_t list_msg = {
+		.my_list = job_list,
+	};
+	buf_t *buffer = init_buf(1024);
+	int rc;
+
+	pack16((uint16_t) DBD_GOT_JOBS_CHUNK, buffer);
+	slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->pcon->version,
+			       DBD_GOT_JOBS_CHUNK, buffer);
+	if (list_msg.return_code == ESLURM_RESULT_TOO_LARGE)
+		rc = ESLURM_RESULT_TOO_LARGE;
+	else
+		rc = slurm_persist_send_msg(slurmdbd_conn->pcon, buffer);
+	FREE_NULL_BUFFER(buffer);
+
+	return rc;
+}
+
+/*
+ * Same as _get_jobs_cond() but the jobs are sent as soon as each page is
+ * read from the database instead of all at once. The response is any number
+ * of DBD_GOT_JOBS_CHUNK messages ended by an empty DBD_GOT_JOBS, or a
+ * PERSIST_RC on error.
+ */
+static int _get_jobs_stream(slurmdbd_conn_t *slurmdbd_conn,
+			    persist_msg_t *msg, buf_t **out_buffer)
+{
+	dbd_cond_msg_t *cond_msg = msg->data;
+	dbd_list_msg_t list_msg = { NULL };
+	slurmdb_job_cond_t *job_cond = cond_msg->cond;
+	int rc;
+
+	if (_validate_job_cond(slurmdbd_conn, job_cond, DBD_GET_JOBS_STREAM,
+			       out_buffer) != SLURM_SUCCESS)
+		return SLURM_ERROR;
+
+	if ((rc = jobacct_storage_g_get_jobs_stream(
+		     slurmdbd_conn->db_conn, slurmdbd_conn->pcon->auth_uid,
+		     job_cond, _send_jobs_chunk, slurmdbd_conn))) {
+		*out_buffer = slurm_persist_make_rc_msg(slurmdbd_conn->pcon,
+							rc, slurm_strerror(rc),
+							DBD_GET_JOBS_STREAM);
+		return SLURM_ERROR;
+	}
+
+	list_msg.my_list = list_create(NULL);
+	*out_buffer = init_buf(1024);
+	pack16((uint16_t) DBD_GOT_JOBS, *out_buffer);
+	slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->pcon->version,
+			       DBD_GOT_JOBS, *out_buffer);
+	FREE_NULL_LIST(list_msg.my_list);
+
+	return SLURM_SUCCESS;
+}
+
 static int _get_probs(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 		      buf_t **out_buffer)
 {
@@ -3258,6 +3373,12 @@ extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer)
 	case DBD_GET_JOBS_COND:
 		rc = _get_jobs_cond(slurmdbd_conn, msg, out_buffer);
 		break;
+	case DBD_GET_JOBS_COLUMNS:
+		rc = _get_jobs_columns(slurmdbd_conn, msg, out_buffer);
+		break;
+	case DBD_GET_JOBS_STREAM:
+		rc = _get_jobs_stream(slurmdbd_conn, msg, out_buffer);
+		break;
 	case DBD_GET_PROBS:
 		rc = _get_probs(slurmdbd_conn, msg, out_buffer);
 		break;
@@ -114,6 +114,8 @@ static void _clear_slurmdbd_conf(void)
 		xfree(slurmdbd_conf->serializer_plugins);
 		xfree(slurmdbd_conf->storage_loc);
 		xfree(slurmdbd_conf->storage_pass_script);
+		xfree(slurmdbd_conf->storage_replica_host);
+		slurmdbd_conf->storage_replica_max_lag = 0;
 		xfree(slurmdbd_conf->storage_user);
 		slurmdbd_conf->track_wckey = 0;
 		slurmdbd_conf->track_ctld = 0;
@@ -196,6 +198,8 @@ extern int read_slurmdbd_conf(void)
 		{"StoragePass", S_P_STRING},
 		{"StoragePassScript", S_P_STRING},
 		{"StoragePort", S_P_UINT16},
+		{"StorageReplicaHost", S_P_STRING},
+		{"StorageReplicaMaxLag", S_P_UINT32},
 		{"StorageType", S_P_STRING},
 		{"StorageUser", S_P_STRING},
 		{"TCPTimeout", S_P_UINT16},
@@ -668,6 +672,12 @@ extern int read_slurmdbd_conf(void)
 			       "StoragePassScript", tbl);
 		s_p_get_uint16(&slurm_conf.accounting_storage_port,
 		               "StoragePort", tbl);
+		s_p_get_string(&slurmdbd_conf->storage_replica_host,
+			       "StorageReplicaHost", tbl);
+		if (!s_p_get_uint32(&slurmdbd_conf->storage_replica_max_lag,
+				    "StorageReplicaMaxLag", tbl))
+			slurmdbd_conf->storage_replica_max_lag =
+				DEFAULT_STORAGE_REPLICA_MAX_LAG;
 		s_p_get_string(&slurm_conf.accounting_storage_type,
 		               "StorageType", tbl);
 		s_p_get_string(&slurmdbd_conf->storage_user, "StorageUser", tbl);
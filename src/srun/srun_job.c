@@ -2277,6 +2277,13 @@ static void _file_bcast(slurm_opt_t *opt_local, srun_job_t *job)
 		params->compress = parse_compress_type(tmp);
 		xfree(tmp);
 	}
+	if ((tmp = conf_get_opt_str(slurm_conf.bcast_parameters,
+				    "Pipeline="))) {
+		if (parse_uint32(tmp, &params->pipeline))
+			error("Invalid BcastParameters=Pipeline=%s, ignored",
+			      tmp);
+		xfree(tmp);
+	}
 	params->exclude = xstrdup(srun_opt->bcast_exclude);
 	if (srun_opt->bcast_file && (srun_opt->bcast_file[0] == '/')) {
 		params->dst_fname = xstrdup(srun_opt->bcast_file);
@@ -0,0 +1,86 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import pytest
+
+import atf
+
+JOB_CNT = 5
+# Rows of the job table slurmdbd streams per page
+JOB_PAGE_ROWS = 1000
+ARRAY_CNT = JOB_PAGE_ROWS + 100
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version((26, 11), component="bin/sacct")
+    atf.require_version((26, 11), component="sbin/slurmdbd")
+    atf.require_accounting()
+    atf.require_config_parameter("MaxArraySize", str(ARRAY_CNT + 1))
+    atf.require_config_parameter("MaxJobCount", "10000")
+    atf.require_slurm_running()
+
+
+@pytest.fixture(scope="module")
+def job_ids():
+    ids = []
+    for _ in range(JOB_CNT):
+        job_id = atf.submit_job_sbatch('--wrap "true"', fatal=True)
+        ids.append(job_id)
+    for job_id in ids:
+        atf.wait_for_job_state(job_id, "COMPLETED", fatal=True)
+        atf.wait_for_job_accounted(job_id, "End", fatal=True)
+    return ids
+
+
+def _sacct_jobs(job_ids, opts=""):
+    jobs = ",".join(str(job_id) for job_id in job_ids)
+    output = atf.run_command_output(
+        f"sacct {opts} -n -P -j {jobs} -o jobid,state", fatal=True
+    )
+    return output.splitlines()
+
+
+def test_stream_allocations(job_ids):
+    """Verify sacct --stream -X prints the same jobs as sacct -X"""
+
+    streamed = _sacct_jobs(job_ids, "-X --stream")
+    assert len(streamed) == JOB_CNT, "Each job should be printed once"
+    assert sorted(streamed) == sorted(_sacct_jobs(job_ids, "-X"))
+
+
+def test_stream_steps(job_ids):
+    """Verify sacct --stream prints the same jobs and steps as sacct"""
+
+    streamed = _sacct_jobs(job_ids, "--stream")
+    assert len(streamed) > JOB_CNT, "Steps should be printed too"
+    assert sorted(streamed) == sorted(_sacct_jobs(job_ids))
+
+
+@pytest.fixture(scope="module")
+def array_job_id():
+    """Submit an array with one job table row per task, over a page of rows"""
+
+    job_id = atf.submit_job_sbatch(
+        f'--array=0-{ARRAY_CNT - 1} -o /dev/null --wrap "true"', fatal=True
+    )
+    atf.repeat_until(
+        lambda: _sacct_jobs([job_id], "-X -s CD"),
+        lambda jobs: len(jobs) == ARRAY_CNT,
+        timeout=600,
+        fatal=True,
+    )
+    return job_id
+
+
+def test_stream_page_boundary(array_job_id):
+    """Verify no job is lost or duplicated across the stream page boundary"""
+
+    streamed = _sacct_jobs([array_job_id], "-X --stream")
+    assert len(streamed) == ARRAY_CNT, "Each array task should be printed once"
+    assert len(set(streamed)) == ARRAY_CNT, "No array task should be duplicated"
+    assert sorted(streamed) == sorted(_sacct_jobs([array_job_id], "-X"))
+
+    streamed = _sacct_jobs([array_job_id], "--stream")
+    assert len(streamed) == len(set(streamed)), "No step should be duplicated"
+    assert sorted(streamed) == sorted(_sacct_jobs([array_job_id]))
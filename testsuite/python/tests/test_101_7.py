@@ -0,0 +1,77 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import pytest
+
+import atf
+
+test_user = atf.properties["test-user"]
+slurm_user = atf.properties["slurm-user"]
+
+# Fields that sacct can get from the columnar job query
+columns = "JobID,JobName,User,Account,Partition,State,ExitCode,Elapsed,AllocCPUS,NNodes,NodeList,Timelimit"
+# A field that needs full job records, forcing the original query path
+row_only_field = "AveCPU"
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11), "bin/sacct", reason="Columnar job query added in 26.11"
+    )
+
+    atf.require_accounting()
+    atf.require_config_parameter("PrivateData", "jobs", source="slurmdbd")
+    atf.require_nodes(1)
+    atf.require_slurm_running()
+
+
+@pytest.fixture(scope="module")
+def jobs():
+    job_ids = [
+        atf.submit_job_sbatch("--wrap 'true'", user=slurm_user, fatal=True),
+        atf.submit_job_sbatch("--wrap 'true'", user=test_user, fatal=True),
+    ]
+    for job_id in job_ids:
+        atf.wait_for_job_accounted(job_id, "End", fatal=True)
+
+    return job_ids
+
+
+def _sacct(user, job_ids, fields):
+    """Return the sacct -X lines of job_ids as seen by user, and its stderr"""
+
+    result = atf.run_command(
+        f"sacct -vv -X -P -n -j {','.join(map(str, job_ids))} -o {fields}",
+        user=user,
+        fatal=True,
+    )
+    return result["stdout"].splitlines(), result["stderr"]
+
+
+@pytest.mark.parametrize(
+    "user,visible",
+    [
+        (slurm_user, [0, 1]),
+        (test_user, [1]),
+    ],
+    ids=["operator", "private_data_user"],
+)
+def test_columnar_matches_rows(jobs, user, visible):
+    """Verify the columnar path prints the same jobs and values as full records"""
+
+    col_lines, col_err = _sacct(user, jobs, columns)
+    row_lines, row_err = _sacct(user, jobs, f"{columns},{row_only_field}")
+
+    assert (
+        "columnar job query not available" not in col_err
+    ), "sacct should use the columnar job query for these fields"
+
+    # Drop the row only field to compare the rest of the output
+    row_lines = [line.rsplit("|", 1)[0] for line in row_lines]
+    assert col_lines == row_lines, "Columnar and full record output should match"
+
+    job_ids = [line.split("|", 1)[0] for line in col_lines]
+    assert job_ids == [
+        str(jobs[i]) for i in visible
+    ], f"User {user} should only see jobs {[jobs[i] for i in visible]}"
@@ -0,0 +1,123 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import os
+import re
+
+import pytest
+
+import atf
+
+node_cnt = 3
+# Blocks smaller than 64 KiB are never cached
+block_size = 64 * 1024
+file_blocks = 64
+cache_dir = "/tmp/test_106_5_cache"
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11),
+        "sbin/slurmd",
+        reason="sbcast block cache added in 26.11",
+    )
+    atf.require_config_parameter_includes(
+        "BcastParameters", ("BlockCacheDir", cache_dir)
+    )
+    atf.require_nodes(node_cnt)
+    atf.require_slurm_running()
+
+
+def _make_file(name, data=None):
+    """Write a file readable by every user, random unless data is given"""
+
+    path = atf.module_tmp_path / name
+    with open(path, "wb") as f:
+        f.write(data or os.urandom(block_size * file_blocks))
+    os.chmod(path, 0o644)
+    return path
+
+
+def _start_job(user):
+    job_id = atf.submit_job_sbatch(
+        f"-N{node_cnt} --wrap 'sleep 300'", user=user, fatal=True
+    )
+    atf.wait_for_job_state(job_id, "RUNNING", fatal=True)
+    return job_id
+
+
+def _sbcast(job_id, src, dest, user, pipeline=1):
+    """Broadcast src and return the bytes supplied by the node caches"""
+
+    result = atf.run_command(
+        f"sbcast -v --force --size={block_size} --pipeline={pipeline} "
+        f"-j {job_id} {src} {dest}",
+        user=user,
+        fatal=True,
+    )
+    match = re.search(r"Node caches supplied (\d+) of (\d+) bytes", result["stderr"])
+    return int(match.group(1)) if match else 0
+
+
+def _check_copies(job_id, src, dest, user):
+    local = atf.run_command_output(f"md5sum < {src}", fatal=True).split()[0]
+    output = atf.run_command_output(
+        f"srun --jobid={job_id} -N{node_cnt} --ntasks-per-node=1 "
+        f"bash -c 'md5sum < {dest}'",
+        user=user,
+        fatal=True,
+    )
+    sums = output.split()[::2]
+    assert len(sums) == node_cnt, "Not every node checked its copy"
+    assert all(s == local for s in sums), "Broadcast copy differs from source"
+
+
+def test_cache_per_user():
+    """Verify that a file broadcast again is read from the node caches, but
+    not when another user broadcasts the same file"""
+
+    user = atf.get_user_name()
+    other_user = atf.properties["test-user"]
+    src = _make_file("cache_src")
+    total = os.path.getsize(src) * node_cnt
+
+    job_id = _start_job(user)
+    dest = atf.module_tmp_path / "cache_dest"
+    assert _sbcast(job_id, src, dest, user) == 0, "New file was found in cache"
+    assert _sbcast(job_id, src, dest, user) == total, "File was sent again"
+    _check_copies(job_id, src, dest, user)
+
+    other_job_id = _start_job(other_user)
+    other_dest = atf.module_tmp_path / "cache_other_dest"
+    assert (
+        _sbcast(other_job_id, src, other_dest, other_user) == 0
+    ), "Blocks of another user were used"
+    _check_copies(other_job_id, src, other_dest, other_user)
+
+    atf.cancel_all_jobs()
+
+
+def test_pipelined_cached_blocks():
+    """Verify that a changed file is copied right when cached and sent blocks
+    alternate and are pipelined down the tree"""
+
+    user = atf.get_user_name()
+    src = _make_file("pipeline_src")
+    dest = atf.module_tmp_path / "pipeline_dest"
+
+    job_id = _start_job(user)
+    assert _sbcast(job_id, src, dest, user, pipeline=16) == 0
+    _check_copies(job_id, src, dest, user)
+
+    # Change every other block, so cached and sent blocks alternate
+    data = bytearray(open(src, "rb").read())
+    for block in range(0, file_blocks, 2):
+        data[block * block_size] ^= 0xFF
+    changed = _make_file("pipeline_changed", bytes(data))
+
+    cached = _sbcast(job_id, changed, dest, user, pipeline=16)
+    assert cached == (file_blocks // 2) * block_size * node_cnt
+    _check_copies(job_id, changed, dest, user)
+
+    atf.cancel_all_jobs()
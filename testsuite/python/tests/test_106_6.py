@@ -0,0 +1,64 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import os
+
+import pytest
+
+import atf
+
+node_cnt = 4
+# Many small blocks give many chances to arrive out of order
+block_size = 4 * 1024
+file_blocks = 1024
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11),
+        "sbin/slurmd",
+        reason="sbcast pipelining added in 26.11",
+    )
+    # Relay blocks through other nodes too
+    atf.require_config_parameter("TreeWidth", 2)
+    atf.require_nodes(node_cnt)
+    atf.require_slurm_running()
+
+
+@pytest.fixture(scope="module")
+def job_id():
+    job_id = atf.submit_job_sbatch(f"-N{node_cnt} --wrap 'sleep 300'", fatal=True)
+    atf.wait_for_job_state(job_id, "RUNNING", fatal=True)
+
+    yield job_id
+
+    atf.cancel_all_jobs()
+
+
+@pytest.mark.parametrize("pipeline", [1, 2, 16, 64])
+def test_pipelined_blocks(job_id, pipeline):
+    """Verify that blocks pipelined down the tree, which may be written out of
+    order, make an identical copy on every node"""
+
+    src = atf.module_tmp_path / f"src_{pipeline}"
+    dest = atf.module_tmp_path / f"dest_{pipeline}"
+    with open(src, "wb") as f:
+        f.write(os.urandom(block_size * file_blocks))
+
+    result = atf.run_command(
+        f"sbcast -v --size={block_size} --pipeline={pipeline} "
+        f"-j {job_id} {src} {dest}",
+        fatal=True,
+    )
+    assert f"{pipeline} blocks in flight" in result["stderr"]
+
+    local = atf.run_command_output(f"md5sum < {src}", fatal=True).split()[0]
+    output = atf.run_command_output(
+        f"srun --jobid={job_id} -N{node_cnt} --ntasks-per-node=1 "
+        f"bash -c 'md5sum < {dest}'",
+        fatal=True,
+    )
+    sums = output.split()[::2]
+    assert len(sums) == node_cnt, "Not every node checked its copy"
+    assert all(s == local for s in sums), "Broadcast copy differs from source"
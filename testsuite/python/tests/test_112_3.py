@@ -0,0 +1,98 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import re
+
+import pytest
+import requests
+
+import atf
+
+ping_path = "slurm/v0.0.46/ping"
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11),
+        "sbin/slurmctld",
+        reason="Verified auth/jwt token cache added in 26.11",
+    )
+    atf.require_config_parameter_includes("AuthAltTypes", "auth/jwt")
+    atf.require_config_parameter_excludes("AuthAltParameters", "verify_cache_size=0")
+    atf.require_slurmrestd("slurmctld", "v0.0.46")
+    atf.require_slurm_running()
+
+
+def _cache_stats():
+    output = atf.run_command_output("sdiag", fatal=True)
+    section = output.split("Verified authentication token cache", 1)[1]
+    return {
+        name: int(re.search(rf"{name}: (\d+)", section).group(1))
+        for name in ("Hits", "Misses")
+    }
+
+
+def _ping(token, username):
+    return requests.get(
+        f"{atf.properties['slurmrestd_url']}{ping_path}",
+        headers={"X-SLURM-USER-NAME": username, "X-SLURM-USER-TOKEN": token},
+    )
+
+
+@pytest.fixture(scope="module")
+def user_token():
+    """Token of the unprivileged test user"""
+
+    user = atf.properties["test-user"]
+    output = atf.run_command_output(
+        f"scontrol token username={user} lifespan=600",
+        user=atf.properties["slurm-user"],
+        fatal=True,
+    )
+    return user, output.strip().replace("SLURM_JWT=", "")
+
+
+def test_cached_token_hits(user_token):
+    """Verify that a token sent again is found in the cache"""
+
+    user, token = user_token
+
+    assert _ping(token, user).status_code == 200
+    before = _cache_stats()
+    assert _ping(token, user).status_code == 200
+    after = _cache_stats()
+
+    assert after["Hits"] > before["Hits"], "Token sent again was verified again"
+
+
+def test_cached_token_claims_checked(user_token):
+    """Verify that a cached token can not be used as another user"""
+
+    user, token = user_token
+
+    # Make sure the token is cached
+    assert _ping(token, user).status_code == 200
+
+    # Only SlurmUser or root tokens may ask for another user
+    resp = _ping(token, atf.properties["slurm-user"])
+    assert resp.status_code != 200, "Cached token was accepted for another user"
+
+    # The rejection did not drop or change the cached claims
+    assert _ping(token, user).status_code == 200
+
+
+def test_other_token_misses(user_token):
+    """Verify that a different token is never taken from the cache"""
+
+    user, token = user_token
+
+    assert _ping(token, user).status_code == 200
+    before = _cache_stats()
+
+    # Same header and claims, different signature
+    forged = token[:-4] + ("AAAA" if not token.endswith("AAAA") else "BBBB")
+    assert _ping(forged, user).status_code != 200, "Forged token was accepted"
+
+    after = _cache_stats()
+    assert after["Misses"] > before["Misses"]
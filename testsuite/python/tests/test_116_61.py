@@ -0,0 +1,82 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+"""Measure srun stdout throughput through slurmstepd and check it is intact."""
+
+import logging
+import time
+
+import pytest
+
+import atf
+
+output_mb = 64
+line = "0123456789abcdef" * 4 + "\n"
+
+
+# Setup
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_slurm_running()
+
+
+@pytest.fixture(scope="module")
+def writer():
+    """Script writing output_mb MiB of fixed size lines to stdout"""
+    script = atf.module_tmp_path / "writer.sh"
+    count = (output_mb * 1024 * 1024) // len(line)
+    atf.make_bash_script(
+        script,
+        f"""yes '{line.rstrip()}' | head -n {count}""",
+    )
+    return script, count
+
+
+def _throughput(seconds):
+    return output_mb / seconds if seconds else float("inf")
+
+
+@pytest.mark.parametrize("unbuffered", [False, True])
+def test_stdout_to_srun(writer, unbuffered):
+    """Output sent back to srun over the I/O socket"""
+
+    script, count = writer
+    out_file = atf.module_tmp_path / f"srun_out_{unbuffered}"
+    flags = "-u" if unbuffered else ""
+
+    start = time.time()
+    atf.run_command(
+        f"srun -n1 {flags} {script} > {out_file}", fatal=True, timeout=300
+    )
+    elapsed = time.time() - start
+    logging.info(
+        f"srun stdout {'unbuffered' if unbuffered else 'buffered'}: "
+        f"{output_mb} MiB in {elapsed:.2f}s, {_throughput(elapsed):.1f} MiB/s"
+    )
+
+    lines = atf.run_command_output(
+        f"grep -c -x '{line.rstrip()}' {out_file}", fatal=True
+    )
+    assert int(lines) == count, f"Expected {count} intact lines, got {lines}"
+
+
+def test_labelled_stdout_to_file(writer):
+    """Output labelled and written to a file by slurmstepd"""
+
+    script, count = writer
+    out_file = atf.module_tmp_path / "labelled_out"
+
+    start = time.time()
+    atf.run_command(
+        f"srun -n1 -l -o {out_file} {script}", fatal=True, timeout=300
+    )
+    elapsed = time.time() - start
+    logging.info(
+        f"stepd labelled file: {output_mb} MiB in {elapsed:.2f}s, "
+        f"{_throughput(elapsed):.1f} MiB/s"
+    )
+
+    lines = atf.run_command_output(
+        f"grep -c -x '0: {line.rstrip()}' {out_file}", fatal=True
+    )
+    assert int(lines) == count, f"Expected {count} labelled lines, got {lines}"
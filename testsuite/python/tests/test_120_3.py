@@ -0,0 +1,87 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import re
+
+import pytest
+
+import atf
+
+task_cnt = 4
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11),
+        "sbin/slurmd",
+        reason="Spawning tasks into their cgroup/v2 cgroup added in 26.11",
+    )
+    atf.require_auto_config("wants to change the task and jobacct_gather plugins")
+    atf.require_config_parameter("CgroupPlugin", "cgroup/v2", source="cgroup")
+    atf.require_config_parameter("ProctrackType", "proctrack/cgroup")
+    atf.require_config_parameter("SlurmdDebug", "debug")
+    atf.require_nodes(1, [("CPUs", task_cnt)])
+    atf.require_slurm_running()
+
+
+def _launch_line(node, job_id):
+    log_file = atf.get_config_parameter("SlurmdLogFile", live=False, quiet=True)
+    output = atf.run_command_output(
+        f"cat {log_file.replace('%n', node)}", user="root", quiet=True
+    )
+    for line in output.splitlines():
+        if f"[{job_id}.0]" in line and "_fork_all_tasks: " in line:
+            return line
+    return ""
+
+
+@pytest.mark.parametrize(
+    "task_plugin,jobacct_gather,spawned",
+    [
+        ("task/cgroup,task/affinity", "jobacct_gather/cgroup", True),
+        ("task/affinity", "jobacct_gather/cgroup", True),
+        ("task/cgroup,task/affinity", "jobacct_gather/linux", True),
+        # No plugin gives the tasks their own cgroup
+        ("task/affinity", "jobacct_gather/linux", False),
+    ],
+    ids=["task_jobacct", "jobacct_only", "task_only", "fallback"],
+)
+def test_task_cgroup(task_plugin, jobacct_gather, spawned):
+    """Verify that tasks start in their own task cgroup, or are forked"""
+
+    atf.set_config_parameter("TaskPlugin", task_plugin, restart=True)
+    atf.set_config_parameter("JobAcctGatherType", jobacct_gather, restart=True)
+
+    file_out = (
+        atf.module_tmp_path / f"cgroup_{task_plugin.count('cgroup')}_{jobacct_gather[15:]}"
+    )
+    job_id = atf.submit_job_sbatch(
+        f"-N1 -n{task_cnt} --output={file_out} --wrap 'srun bash -c "
+        f'"echo \\$SLURM_PROCID \\$(cut -d: -f3 /proc/self/cgroup)"\'',
+        fatal=True,
+    )
+    atf.wait_for_job_state(job_id, "COMPLETED", fatal=True)
+    atf.wait_for_file(file_out, fatal=True)
+
+    cgroups = dict(
+        line.split()
+        for line in atf.run_command_output(f"cat {file_out}").splitlines()
+        if line.strip()
+    )
+    assert len(cgroups) == task_cnt, "Not every task ran"
+
+    node = atf.get_job_parameter(job_id, "NodeList")
+    launch = _launch_line(node, job_id)
+    assert launch, "Task launch was not logged"
+
+    if spawned:
+        assert "spawned into cgroups" in launch
+        for task_id, cgroup in cgroups.items():
+            assert re.search(
+                rf"/step_0/user/task_{task_id}$", cgroup
+            ), f"Task {task_id} started in {cgroup}"
+    else:
+        assert "forked" in launch
+        for task_id, cgroup in cgroups.items():
+            assert "/step_0/" in cgroup, f"Task {task_id} not in the step cgroup"
@@ -0,0 +1,132 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import re
+
+import pytest
+
+import atf
+
+# More than one batch of decay_apply_weighted_factors_batched()
+job_cnt = 1100
+batch_size = 1000
+
+checked_pattern = "checked priority of"
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11),
+        "sbin/slurmctld",
+        reason="Batched priority updates added in 26.11",
+    )
+    atf.require_config_parameter("PriorityType", "priority/multifactor")
+    atf.require_config_parameter("PriorityCalcPeriod", "1")
+    atf.require_config_parameter("PriorityWeightAge", "0")
+    atf.require_config_parameter("PriorityWeightFairshare", "0")
+    atf.require_config_parameter("PriorityWeightTRES", "CPU=1000")
+    atf.require_config_parameter("MaxJobCount", "10000")
+    atf.require_config_parameter("SlurmctldDebug", "debug2")
+    atf.require_config_parameter_includes("DebugFlags", "Priority")
+    atf.require_slurm_running()
+
+
+def _logfile():
+    return atf.get_config_parameter("SlurmctldLogFile", live=False, quiet=True)
+
+
+def _grep(pattern):
+    return atf.run_command_output(
+        f'grep -F -- "{pattern}" {_logfile()} || true',
+        user=atf.properties["slurm-user"],
+        quiet=True,
+    ).splitlines()
+
+
+def _wait_for_decay_cycles(cycles):
+    """Wait until the decay thread checked all job priorities cycles more times"""
+
+    start = len(_grep(checked_pattern))
+    atf.repeat_until(
+        lambda: len(_grep(checked_pattern)),
+        lambda cnt: cnt >= start + cycles,
+        timeout=60 * (cycles + 1),
+        fatal=True,
+    )
+
+
+@pytest.fixture(scope="module")
+def pending_jobs():
+    """Submit job_cnt identical jobs that stay pending"""
+
+    output = atf.run_command_output(
+        f"for i in $(seq {job_cnt}); do "
+        f"sbatch --parsable --begin=now+1hour -o /dev/null --wrap 'true'; done",
+        timeout=600,
+        fatal=True,
+    )
+    job_ids = [int(job_id) for job_id in output.split()]
+    assert len(job_ids) == job_cnt, "Not all jobs were submitted"
+
+    yield job_ids
+
+    atf.cancel_all_jobs()
+
+
+def _priorities(job_ids):
+    output = atf.run_command_output(
+        f"squeue -h -t PD -o '%i %Q' -j {','.join(map(str, job_ids))}",
+        fatal=True,
+    )
+    return {
+        int(job_id): int(prio)
+        for job_id, prio in (line.split() for line in output.splitlines())
+    }
+
+
+def test_batched_update(pending_jobs):
+    """Verify that the jobs are checked in batches without losing any"""
+
+    _wait_for_decay_cycles(1)
+
+    match = re.search(
+        rf"{checked_pattern} (\d+) jobs in batches of (\d+)",
+        _grep(checked_pattern)[-1],
+    )
+    assert match is not None, "Batched priority update was not logged"
+    assert int(match.group(1)) >= job_cnt, "Not every pending job was checked"
+    assert int(match.group(2)) == batch_size
+
+    priorities = _priorities(pending_jobs)
+    assert len(priorities) == job_cnt
+    assert len(set(priorities.values())) == 1, "Identical jobs differ in priority"
+    assert 0 not in priorities.values()
+
+
+def test_unchanged_factors_skipped(pending_jobs):
+    """Verify that jobs whose factors did not change are not recalculated"""
+
+    first, last = pending_jobs[0], pending_jobs[-1]
+    before = _priorities([first, last])
+
+    _wait_for_decay_cycles(2)
+
+    # Only logged by decay_apply_weighted_factors() when not skipped
+    assert not _grep(f"priority for job {first} is now")
+    assert not _grep(f"priority for job {last} is now")
+    assert _priorities([first, last]) == before
+
+
+def test_tres_weight_change(pending_jobs):
+    """Verify that a new TRES weight is applied to jobs with cached factors"""
+
+    first, last = pending_jobs[0], pending_jobs[-1]
+    before = _priorities([first, last])
+
+    atf.set_config_parameter("PriorityWeightTRES", "CPU=2000")
+    _wait_for_decay_cycles(1)
+
+    after = _priorities([first, last])
+    assert after[first] > before[first], "Priority ignored the new TRES weight"
+    assert after[first] == after[last]
@@ -0,0 +1,100 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import re
+
+import pytest
+
+import atf
+
+pool_size = 2
+step_cnt = 4
+
+namespace_yaml = """
+---
+defaults:
+  auto_base_path: true
+  base_path: "/tmp/test_156_2_ns_%n"
+  dirs: "/var/tmp,/dev/shm"
+..."""
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11),
+        "sbin/slurmd",
+        reason="SlurmdParameters=stepd_pool added in 26.11",
+    )
+    atf.require_auto_config("wants to set SlurmdParameters and NamespaceType")
+    atf.require_config_parameter_includes(
+        "SlurmdParameters", f"stepd_pool={pool_size}"
+    )
+    atf.require_config_parameter_includes("DebugFlags", "Steps")
+    atf.require_config_parameter("SlurmdDebug", "debug")
+    atf.require_config_file("namespace.yaml", namespace_yaml)
+    atf.require_nodes(1)
+    atf.require_slurm_running()
+
+
+def _slurmd_log(node):
+    log_file = atf.get_config_parameter("SlurmdLogFile", live=False, quiet=True)
+    return atf.run_command_output(
+        f"cat {log_file.replace('%n', node)}", user="root", quiet=True
+    )
+
+
+def _refills(node):
+    ready = f"{pool_size} of {pool_size} pooled slurmstepd ready"
+    return _slurmd_log(node).count(ready)
+
+
+def _launches(node):
+    return re.findall(r"(pooled|forked) slurmstepd ready in", _slurmd_log(node))
+
+
+def test_pool_refill():
+    """Verify that steps use a pooled slurmstepd and the pool is refilled"""
+
+    node = atf.get_nodes(quiet=True).popitem()[0]
+    assert atf.repeat_until(
+        lambda: _refills(node), lambda n: n > 0
+    ), "The stepd_pool was never filled"
+
+    for i in range(step_cnt):
+        refills = _refills(node)
+        launches = len(_launches(node))
+
+        output = atf.run_command_output(
+            f"srun -w {node} -N1 echo step_{i}", fatal=True
+        )
+        assert f"step_{i}" in output, f"Step {i} did not run"
+
+        new_launches = _launches(node)[launches:]
+        assert new_launches, f"Launch of step {i} was not logged"
+        assert "pooled" in new_launches, f"Step {i} did not use a pooled slurmstepd"
+
+        assert atf.repeat_until(
+            lambda: _refills(node), lambda n: n > refills
+        ), f"The stepd_pool was not refilled after step {i}"
+
+
+def test_namespace_bypass():
+    """Verify that NamespaceType disables the stepd_pool"""
+
+    atf.set_config_parameter("NamespaceType", "namespace/linux")
+    atf.set_config_parameter("PrologFlags", "Contain", restart=True)
+
+    node = atf.get_nodes(quiet=True).popitem()[0]
+    assert atf.repeat_until(
+        lambda: _slurmd_log(node),
+        lambda log: "stepd_pool is not supported with NamespaceType" in log,
+    ), "stepd_pool was not disabled with NamespaceType"
+
+    launches = len(_launches(node))
+    output = atf.run_command_output(f"srun -w {node} -N1 echo ns_step", fatal=True)
+    assert "ns_step" in output, "Step did not run with NamespaceType"
+
+    new_launches = _launches(node)[launches:]
+    assert new_launches, "Launch was not logged"
+    assert "pooled" not in new_launches, "A pooled slurmstepd was used"
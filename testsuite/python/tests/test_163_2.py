@@ -0,0 +1,71 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import pytest
+
+import atf
+
+task_pids_msg = "using cgroup counters, reading only the task processes"
+no_io_msg = "io controller not available, reading all the processes of the step"
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11),
+        "sbin/slurmd",
+        reason="Reading only the task pids with cgroup/v2 added in 26.11",
+    )
+    atf.require_auto_config("wants to toggle the io controller")
+    atf.require_config_parameter("CgroupPlugin", "cgroup/v2", source="cgroup")
+    atf.require_config_parameter("JobAcctGatherType", "jobacct_gather/cgroup")
+    atf.require_config_parameter("JobAcctGatherFrequency", "task=1")
+    atf.require_config_parameter_excludes("JobAcctGatherParams", "ProcScan")
+    atf.require_config_parameter_includes("DebugFlags", "JAG")
+    atf.require_config_parameter("SlurmdDebug", "debug")
+    atf.require_nodes(1)
+    atf.require_slurm_running()
+
+
+def _slurmd_log(node):
+    log_file = atf.get_config_parameter("SlurmdLogFile", live=False, quiet=True)
+    return atf.run_command_output(
+        f"cat {log_file.replace('%n', node)}", user="root", quiet=True
+    )
+
+
+@pytest.mark.parametrize("extra_controllers", ["io", None], ids=["io", "no_io"])
+def test_task_pids_only(extra_controllers):
+    """Verify that only the task pids are read when the io controller is used"""
+
+    atf.set_config_parameter(
+        "EnableExtraControllers", extra_controllers, source="cgroup", restart=True
+    )
+
+    # Report whether the step cgroup has the io controller
+    job_id = atf.submit_job_sbatch(
+        "-N1 -n1 --wrap 'srun bash -c \""
+        "cat /sys/fs/cgroup$(cut -d: -f3 /proc/self/cgroup)/cgroup.controllers; "
+        "sleep 3\"'",
+        fatal=True,
+    )
+    atf.wait_for_job_state(job_id, "COMPLETED", fatal=True)
+
+    output_file = atf.get_job_parameter(job_id, "StdOut")
+    has_io = "io" in atf.run_command_output(f"cat {output_file}").split()
+    if extra_controllers == "io":
+        assert has_io, "EnableExtraControllers=io did not enable io in the step"
+
+    node = atf.get_job_parameter(job_id, "NodeList")
+    step_lines = [
+        line for line in _slurmd_log(node).splitlines() if f"[{job_id}.0]" in line
+    ]
+    task_pids_only = any(task_pids_msg in line for line in step_lines)
+    no_io = any(no_io_msg in line for line in step_lines)
+
+    if has_io:
+        assert task_pids_only, "Only the task pids should be read with io.stat"
+        assert not no_io
+    else:
+        assert no_io, "Every process should be read without the io controller"
+        assert not task_pids_only
@@ -0,0 +1,101 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import re
+import time
+
+import pytest
+
+import atf
+
+job_mem_mib = 64
+oom_mem_mib = 256
+# Longer than the test waits, so only an early termination ends the step
+sleep_time = 300
+
+oom_kill_msg = "of task 0 OOM killed"
+poll_msg = "polling accounting"
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11),
+        "sbin/slurmd",
+        reason="cgroup/v2 memory event monitor added in 26.11",
+    )
+    atf.require_config_parameter("CgroupPlugin", "cgroup/v2", source="cgroup")
+    atf.require_config_parameter("ConstrainRAMSpace", "yes", source="cgroup")
+    atf.require_config_parameter("ConstrainSwapSpace", "yes", source="cgroup")
+    atf.require_config_parameter("AllowedSwapSpace", "0", source="cgroup")
+    atf.require_config_parameter_includes("TaskPlugin", "task/cgroup")
+    atf.require_config_parameter("SelectTypeParameters", "CR_CPU_Memory")
+    atf.require_config_parameter("JobAcctGatherType", "jobacct_gather/cgroup")
+    # The periodic poll must not be what notices the OOM
+    atf.require_config_parameter("JobAcctGatherFrequency", "task=60")
+    atf.require_config_parameter_includes("DebugFlags", "Cgroup")
+    atf.require_config_parameter("SlurmdDebug", "debug")
+    atf.require_nodes(1, [("CPUs", 2), ("RealMemory", 1024)])
+    atf.require_slurm_running()
+
+
+def _step_log(node, job_id):
+    log_file = atf.get_config_parameter("SlurmdLogFile", live=False, quiet=True)
+    output = atf.run_command_output(
+        f"cat {log_file.replace('%n', node)}", user="root", quiet=True
+    )
+    return [line for line in output.splitlines() if f"[{job_id}.0]" in line]
+
+
+@pytest.fixture(scope="module")
+def oom_job(use_memory_program):
+    """Run a step where task 0 is OOM killed while task 1 keeps sleeping"""
+
+    job_id = atf.submit_job_sbatch(
+        f"-N1 -n2 --mem={job_mem_mib}M --wrap 'srun --oom-kill-step=1 "
+        f'bash -c "if [ \\$SLURM_PROCID -eq 0 ]; then '
+        f"exec {use_memory_program} {oom_mem_mib} {sleep_time}; "
+        f'else exec sleep {sleep_time}; fi"\'',
+        fatal=True,
+    )
+    atf.wait_for_job_state(job_id, "RUNNING", fatal=True)
+    start = time.time()
+
+    # Done long before sleep_time only if the step was terminated early
+    atf.wait_for_job_state(job_id, "DONE", timeout=60, fatal=True)
+
+    yield {
+        "job_id": job_id,
+        "elapsed": time.time() - start,
+        "node": atf.get_job_parameter(job_id, "NodeList"),
+    }
+
+    atf.cancel_all_jobs()
+
+
+def test_oom_kill_terminates_step(oom_job):
+    """Verify that the step is terminated as soon as a task is OOM killed"""
+
+    assert (
+        oom_job["elapsed"] < sleep_time / 2
+    ), "Step was not terminated until the other task ended"
+
+    step_log = _step_log(oom_job["node"], oom_job["job_id"])
+    assert any(
+        oom_kill_msg in line for line in step_log
+    ), "OOM kill was not attributed to task 0"
+
+
+def test_memory_event_polls_accounting(oom_job):
+    """Verify that memory events poll accounting at most once per second"""
+
+    polls = [
+        line
+        for line in _step_log(oom_job["node"], oom_job["job_id"])
+        if poll_msg in line
+    ]
+    assert polls, "Memory events did not poll accounting"
+
+    # Log lines start with [YYYY-MM-DDTHH:MM:SS.mmm]
+    seconds = [re.match(r"\[([^\].]+)", line).group(1) for line in polls]
+    assert len(seconds) == len(set(seconds)), "Accounting polled twice in a second"
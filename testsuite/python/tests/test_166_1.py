@@ -0,0 +1,57 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import pytest
+
+import atf
+
+msg_timeout = 5
+stopped_node = "node2"
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11),
+        "sbin/slurmctld",
+        reason="Agent RPCs over the connection manager added in 26.11",
+    )
+    atf.require_auto_config("wants to stop one slurmd")
+    atf.require_config_parameter_includes("SlurmctldParameters", "enable_async_fanout")
+    atf.require_config_parameter("MessageTimeout", msg_timeout)
+    # Only failed pings, not SlurmdTimeout, mark the stopped node
+    atf.require_config_parameter("SlurmdTimeout", 600)
+    atf.require_nodes(3)
+    atf.require_slurm_running()
+
+
+@pytest.fixture
+def stopped_slurmd():
+    """Stop one slurmd so it accepts connections but never replies"""
+
+    atf.run_command(
+        f"pkill -STOP -f 'slurmd -N {stopped_node}'", user="root", fatal=True
+    )
+
+    yield stopped_node
+
+    atf.run_command(f"pkill -CONT -f 'slurmd -N {stopped_node}'", user="root")
+    atf.wait_for_node_state(stopped_node, "NOT_RESPONDING", reverse=True, timeout=120)
+
+
+def test_unresponsive_node_times_out_alone(stopped_slurmd):
+    """Verify that only the node which does not reply is marked not responding"""
+
+    others = [node for node in atf.get_nodes() if node != stopped_slurmd]
+
+    # Ping replies are collected per node, the stopped node times out alone
+    atf.wait_for_node_state(stopped_slurmd, "NOT_RESPONDING", timeout=240, fatal=True)
+    assert atf.wait_for_node_state(
+        others, "NOT_RESPONDING", reverse=True, timeout=1
+    ), "Responsive nodes were marked not responding"
+
+    # RPCs to the other nodes are not held up by the stopped node
+    job_id = atf.submit_job_sbatch(
+        f"-N{len(others)} -w {','.join(others)} --wrap 'srun true'", fatal=True
+    )
+    atf.wait_for_job_state(job_id, "COMPLETED", timeout=msg_timeout * 4, fatal=True)
@@ -0,0 +1,71 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import re
+
+import pytest
+
+import atf
+
+# Only these RPCs leave the connection open for the next one
+kept_alive_rpcs = {"REQUEST_PING", "REQUEST_ACCT_GATHER_UPDATE"}
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11),
+        "sbin/slurmd",
+        reason="slurmd connection pool added in 26.11",
+    )
+    atf.require_config_parameter_includes(
+        "CommunicationParameters", ("conn_pool_idle_timeout", 60)
+    )
+    # Pings every 10 seconds
+    atf.require_config_parameter("SlurmdTimeout", 30)
+    atf.require_config_parameter_includes("DebugFlags", "Net")
+    atf.require_config_parameter("SlurmdDebug", "debug")
+    atf.require_nodes(1)
+    atf.require_slurm_running()
+
+
+def _pool_stats():
+    output = atf.run_command_output("sdiag", fatal=True)
+    section = output.split("Connection pool to slurmd", 1)[1]
+    return {
+        name: int(re.search(rf"{name}: (\d+)", section).group(1))
+        for name in ("Connects", "Reused")
+    }
+
+
+def _kept_alive_rpcs(node):
+    log_file = atf.get_config_parameter("SlurmdLogFile", live=False, quiet=True)
+    output = atf.run_command_output(
+        f"cat {log_file.replace('%n', node)}", user="root", quiet=True
+    )
+    return re.findall(r"keeping connection alive after (\w+)", output)
+
+
+def test_pings_reuse_connections():
+    """Verify that pings to slurmd are sent over pooled connections"""
+
+    reused = _pool_stats()["Reused"]
+    assert atf.repeat_until(
+        lambda: _pool_stats()["Reused"],
+        lambda count: count > reused,
+        timeout=60,
+    ), "No idle connection was reused"
+
+
+def test_only_some_rpcs_kept_alive():
+    """Verify that slurmd only keeps connections open after pings and
+    accounting updates"""
+
+    # Launch and terminate RPCs also ask for the connection to be kept
+    job_id = atf.submit_job_sbatch("-N1 --wrap 'srun true'", fatal=True)
+    atf.wait_for_job_state(job_id, "COMPLETED", fatal=True)
+    node = atf.get_job_parameter(job_id, "NodeList")
+
+    rpcs = _kept_alive_rpcs(node)
+    assert rpcs, "slurmd did not keep any connection alive"
+    assert set(rpcs) <= kept_alive_rpcs, f"Connections kept after {set(rpcs)}"
@@ -0,0 +1,82 @@
+############################################################################
+# Copyright (C) SchedMD LLC.
+############################################################################
+import re
+import time
+from datetime import datetime
+
+import pytest
+
+import atf
+
+node_cnt = 6
+slices = 3
+slurmd_timeout = 30
+# Every node is due for a ping once per SlurmdTimeout/3
+ping_interval = slurmd_timeout // 3
+window = 6 * ping_interval
+
+
+@pytest.fixture(scope="module", autouse=True)
+def setup():
+    atf.require_version(
+        (26, 11),
+        "sbin/slurmctld",
+        reason="SlurmctldParameters=ping_slices added in 26.11",
+    )
+    atf.require_config_parameter_includes(
+        "SlurmctldParameters", ("ping_slices", slices)
+    )
+    atf.require_config_parameter("SlurmdTimeout", slurmd_timeout)
+    atf.require_config_parameter_includes("DebugFlags", "AUDIT_RPCS")
+    atf.require_config_parameter("SlurmdDebug", "debug")
+    atf.require_nodes(node_cnt)
+    atf.require_slurm_running()
+
+
+def _ping_times(node, since):
+    log_file = atf.get_config_parameter("SlurmdLogFile", live=False, quiet=True)
+    output = atf.run_command_output(
+        f"cat {log_file.replace('%n', node)}", user="root", quiet=True
+    )
+    times = [
+        datetime.strptime(stamp, "%Y-%m-%dT%H:%M:%S")
+        for stamp in re.findall(
+            r"^\[([^\].]+)[^\]]*\].*msg_type=REQUEST_PING", output, re.MULTILINE
+        )
+    ]
+    return [t for t in times if t >= since]
+
+
+def test_ping_slices():
+    """Verify that each node is pinged once per ping interval and that no node
+    is marked not responding while the pings are spread over slices"""
+
+    nodes = list(atf.get_nodes().keys())
+    since = datetime.now().replace(microsecond=0)
+
+    end = time.time() + window
+    while time.time() < end:
+        for node, params in atf.get_nodes(quiet=True).items():
+            state = params["state"]
+            assert not {"DOWN", "NOT_RESPONDING"} & set(
+                state
+            ), f"{node} was marked {state}"
+        time.sleep(1)
+
+    all_pings = set()
+    for node in nodes:
+        pings = _ping_times(node, since)
+        all_pings.update(pings)
+        assert (
+            len(pings) >= (window // ping_interval) - 2
+        ), f"{node} was pinged {len(pings)} times in {window} seconds"
+
+        # Not again before it is due, and not later than one more cycle
+        gaps = [(b - a).total_seconds() for a, b in zip(pings, pings[1:])]
+        assert all(
+            (ping_interval - 1) <= gap <= (2 * ping_interval) for gap in gaps
+        ), f"{node} pinged after {gaps} seconds"
+
+    # Nodes were not all pinged at once
+    assert len(all_pings) >= slices, "Pings were not spread over slices"
@@ -0,0 +1,195 @@
+#include <check.h>
+#include <stdlib.h>
+
+#include "src/common/assoc_mgr.h"
+#include "src/common/list.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#define NO_SUCH_USER "assoc_mgr_test_no_such_user"
+#define RENAMED_USER "assoc_mgr_test_renamed_user"
+
+static void _update_user(slurmdb_update_type_t type, char *name,
+			 char *old_name)
+{
+	slurmdb_update_object_t update = { .type = type };
+	slurmdb_user_rec_t *user = xmalloc(sizeof(*user));
+
+	user->name = xstrdup(name);
+	user->old_name = xstrdup(old_name);
+
+	update.objects = list_create(slurmdb_destroy_user_rec);
+	list_append(update.objects, user);
+	ck_assert_int_eq(assoc_mgr_update_users(&update, false),
+			 SLURM_SUCCESS);
+	FREE_NULL_LIST(update.objects);
+}
+
+static bool _found_user(uint32_t uid, char *name)
+{
+	slurmdb_user_rec_t user = { .uid = uid, .name = name };
+
+	return (assoc_mgr_fill_in_user(NULL, &user, ACCOUNTING_ENFORCE_ASSOCS,
+				       NULL, false) == SLURM_SUCCESS);
+}
+
+static void _update_qos(uint16_t type, uint32_t id, char *name)
+{
+	slurmdb_update_object_t update = { .type = type };
+	slurmdb_qos_rec_t *qos = xmalloc(sizeof(*qos));
+
+	slurmdb_init_qos_rec(qos, 0, NO_VAL);
+	qos->id = id;
+	qos->name = xstrdup(name);
+
+	update.objects = list_create(slurmdb_destroy_qos_rec);
+	list_append(update.objects, qos);
+	ck_assert_int_eq(assoc_mgr_update_qos(&update, false), SLURM_SUCCESS);
+	FREE_NULL_LIST(update.objects);
+}
+
+static uint32_t _found_qos_id(uint32_t id, char *name)
+{
+	slurmdb_qos_rec_t qos = { .id = id, .name = name };
+	slurmdb_qos_rec_t *found_qos = NULL;
+
+	if ((assoc_mgr_fill_in_qos(NULL, &qos, ACCOUNTING_ENFORCE_QOS,
+				   &found_qos, false) != SLURM_SUCCESS) ||
+	    !found_qos)
+		return 0;
+	return found_qos->id;
+}
+
+static void _setup(void)
+{
+	assoc_mgr_user_list = list_create(slurmdb_destroy_user_rec);
+	assoc_mgr_coord_list = list_create(NULL);
+	assoc_mgr_qos_list = list_create(slurmdb_destroy_qos_rec);
+}
+
+static void _teardown(void)
+{
+	assoc_mgr_fini(false);
+}
+
+START_TEST(find_added_users)
+{
+	_update_user(SLURMDB_ADD_USER, "root", NULL);
+	_update_user(SLURMDB_ADD_USER, NO_SUCH_USER, NULL);
+
+	ck_assert(_found_user(0, NULL));
+	ck_assert(_found_user(NO_VAL, "ROOT"));
+	ck_assert(_found_user(NO_VAL, NO_SUCH_USER));
+	ck_assert(!_found_user(NO_VAL, RENAMED_USER));
+	ck_assert(!_found_user(12345, NULL));
+}
+END_TEST
+
+START_TEST(find_renamed_user)
+{
+	_update_user(SLURMDB_ADD_USER, NO_SUCH_USER, NULL);
+	_update_user(SLURMDB_MODIFY_USER, RENAMED_USER, NO_SUCH_USER);
+
+	ck_assert(!_found_user(NO_VAL, NO_SUCH_USER));
+	ck_assert(_found_user(NO_VAL, RENAMED_USER));
+}
+END_TEST
+
+START_TEST(find_removed_user)
+{
+	_update_user(SLURMDB_ADD_USER, "root", NULL);
+	_update_user(SLURMDB_REMOVE_USER, "root", NULL);
+
+	ck_assert(!_found_user(0, NULL));
+	ck_assert(!_found_user(NO_VAL, "root"));
+	ck_assert_int_eq(list_count(assoc_mgr_user_list), 0);
+}
+END_TEST
+
+START_TEST(lookup_stats)
+{
+	uint64_t before[ASSOC_MGR_ENTITY_COUNT];
+	uint64_t after[ASSOC_MGR_ENTITY_COUNT];
+
+	_update_user(SLURMDB_ADD_USER, "root", NULL);
+
+	assoc_mgr_get_lookup_stats(before);
+	ck_assert(_found_user(0, NULL));
+	assoc_mgr_get_lookup_stats(after);
+#ifndef __STDC_NO_ATOMICS__
+	ck_assert(after[USER_LOCK] == (before[USER_LOCK] + 1));
+#endif
+	ck_assert(after[QOS_LOCK] == before[QOS_LOCK]);
+
+	assoc_mgr_reset_lookup_stats();
+	assoc_mgr_get_lookup_stats(after);
+	ck_assert(after[USER_LOCK] == 0);
+}
+END_TEST
+
+START_TEST(find_qos)
+{
+	_update_qos(SLURMDB_ADD_QOS, 1, "normal");
+	_update_qos(SLURMDB_ADD_QOS, 2, "high");
+
+	ck_assert_int_eq(_found_qos_id(1, NULL), 1);
+	ck_assert_int_eq(_found_qos_id(0, "HIGH"), 2);
+	ck_assert_int_eq(_found_qos_id(2, "high"), 2);
+	ck_assert_int_eq(_found_qos_id(3, NULL), 0);
+	ck_assert_int_eq(_found_qos_id(0, "low"), 0);
+
+	/* The id or the name matching is enough */
+	ck_assert_int_eq(_found_qos_id(3, "high"), 2);
+	ck_assert_int_eq(_found_qos_id(2, "low"), 2);
+}
+END_TEST
+
+START_TEST(find_qos_first_listed)
+{
+	_update_qos(SLURMDB_ADD_QOS, 1, "normal");
+	_update_qos(SLURMDB_ADD_QOS, 2, "high");
+
+	/* Id and name of different QOS, the first one listed is found */
+	ck_assert_int_eq(_found_qos_id(2, "normal"), 1);
+	ck_assert_int_eq(_found_qos_id(1, "high"), 1);
+}
+END_TEST
+
+/*****************************************************************************
+ * TEST SUITE                                                                *
+ ****************************************************************************/
+
+Suite *suite(void)
+{
+	Suite *s = suite_create("assoc_mgr");
+	TCase *tc_core = tcase_create("assoc_mgr user index");
+	tcase_add_checked_fixture(tc_core, _setup, _teardown);
+	tcase_add_test(tc_core, find_added_users);
+	tcase_add_test(tc_core, find_renamed_user);
+	tcase_add_test(tc_core, find_removed_user);
+	tcase_add_test(tc_core, lookup_stats);
+	suite_add_tcase(s, tc_core);
+
+	tc_core = tcase_create("assoc_mgr qos index");
+	tcase_add_checked_fixture(tc_core, _setup, _teardown);
+	tcase_add_test(tc_core, find_qos);
+	tcase_add_test(tc_core, find_qos_first_listed);
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+/*****************************************************************************
+ * TEST RUNNER                                                               *
+ ****************************************************************************/
+
+int main(void)
+{
+	int number_failed;
+	SRunner *sr = srunner_create(suite());
+
+	srunner_run_all(sr, CK_VERBOSE);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
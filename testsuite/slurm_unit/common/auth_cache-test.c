@@ -0,0 +1,298 @@
+/*****************************************************************************\
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include <check.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "src/common/log.h"
+#include "src/common/read_config.h"
+#include "src/common/run_in_daemon.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/interfaces/auth.h"
+
+#define CACHE_SIZE 4
+
+/* The cache is only enabled in daemons */
+uint32_t slurm_daemon = IS_SLURMCTLD;
+
+/*
+ * Every test runs in its own forked process, so each starts with an empty
+ * cache sized from AuthAltParameters.
+ */
+
+typedef struct {
+	char *username;
+} claims_t;
+
+static int freed = 0;
+
+static void _claims_free(void *data)
+{
+	claims_t *claims = data;
+
+	freed++;
+	xfree(claims->username);
+	xfree(claims);
+}
+
+static claims_t *_claims_create(const char *username)
+{
+	claims_t *claims = xmalloc(sizeof(*claims));
+
+	claims->username = xstrdup(username);
+	return claims;
+}
+
+/* Copy the cached claims as auth/jwt does before checking them */
+static void _claims_copy(void *data, void *arg)
+{
+	claims_t *claims = data, *copy = arg;
+
+	copy->username = xstrdup(claims->username);
+}
+
+static bool _find(const char *token, int plugin_id, const char *username)
+{
+	claims_t copy = { 0 };
+	bool found = auth_cache_find(plugin_id, token, _claims_copy, &copy);
+
+	if (found)
+		ck_assert_str_eq(copy.username, username);
+	else
+		ck_assert_ptr_null(copy.username);
+
+	xfree(copy.username);
+	return found;
+}
+
+static void _add(const char *token, time_t expires)
+{
+	auth_cache_add(AUTH_PLUGIN_JWT, token, expires, _claims_create(token),
+		       _claims_free);
+}
+
+static void _setup(void)
+{
+	slurm_conf.authalt_params = xstrdup_printf("verify_cache_size=%d",
+						   CACHE_SIZE);
+	freed = 0;
+}
+
+static void _teardown(void)
+{
+	xfree(slurm_conf.authalt_params);
+}
+
+START_TEST(test_hit)
+{
+	auth_cache_stats_t stats;
+	time_t expires = time(NULL) + 600;
+
+	_add("token-a", expires);
+
+	/* The claims are handed back for every message using the token */
+	for (int i = 0; i < 3; i++)
+		ck_assert(_find("token-a", AUTH_PLUGIN_JWT, "token-a"));
+
+	auth_cache_stats_get(&stats);
+	ck_assert_uint_eq(stats.hits, 3);
+	ck_assert_uint_eq(stats.misses, 0);
+	ck_assert_int_eq(freed, 0);
+
+	/* Adding the same token again keeps the first claims */
+	auth_cache_add(AUTH_PLUGIN_JWT, "token-a", expires,
+		       _claims_create("other"), _claims_free);
+	ck_assert_int_eq(freed, 1);
+	ck_assert(_find("token-a", AUTH_PLUGIN_JWT, "token-a"));
+}
+END_TEST
+
+START_TEST(test_other_token_misses)
+{
+	static const char *others[] = {
+		"token-b", "token-a ", "token-ab", "token-", "TOKEN-A", "",
+	};
+	auth_cache_stats_t stats;
+
+	_add("token-a", time(NULL) + 600);
+
+	for (int i = 0; i < ARRAY_SIZE(others); i++)
+		ck_assert(!_find(others[i], AUTH_PLUGIN_JWT, NULL));
+	ck_assert(!_find(NULL, AUTH_PLUGIN_JWT, NULL));
+
+	/* Only the plugin which verified the token may use it */
+	ck_assert(!_find("token-a", AUTH_PLUGIN_SLURM, NULL));
+
+	auth_cache_stats_get(&stats);
+	ck_assert_uint_eq(stats.hits, 0);
+	ck_assert_uint_eq(stats.misses, ARRAY_SIZE(others) + 1);
+
+	ck_assert(_find("token-a", AUTH_PLUGIN_JWT, "token-a"));
+}
+END_TEST
+
+START_TEST(test_expiry_evicts)
+{
+	auth_cache_stats_t stats;
+
+	/* Already expired tokens are never added */
+	_add("expired", time(NULL));
+	ck_assert_int_eq(freed, 1);
+	ck_assert(!_find("expired", AUTH_PLUGIN_JWT, NULL));
+
+	_add("short", time(NULL) + 1);
+	ck_assert(_find("short", AUTH_PLUGIN_JWT, "short"));
+
+	sleep(2);
+
+	ck_assert(!_find("short", AUTH_PLUGIN_JWT, NULL));
+	ck_assert_int_eq(freed, 2);
+
+	auth_cache_stats_get(&stats);
+	ck_assert_uint_eq(stats.hits, 1);
+	ck_assert_uint_eq(stats.misses, 2);
+	/* Expiring is not an eviction */
+	ck_assert_uint_eq(stats.evictions, 0);
+}
+END_TEST
+
+START_TEST(test_size_evicts_oldest)
+{
+	auth_cache_stats_t stats;
+	time_t expires = time(NULL) + 600;
+	char token[32];
+
+	for (int i = 0; i < CACHE_SIZE; i++) {
+		snprintf(token, sizeof(token), "token-%d", i);
+		_add(token, expires);
+	}
+	ck_assert_int_eq(freed, 0);
+
+	_add("token-new", expires);
+	ck_assert_int_eq(freed, 1);
+
+	ck_assert(!_find("token-0", AUTH_PLUGIN_JWT, NULL));
+	for (int i = 1; i < CACHE_SIZE; i++) {
+		snprintf(token, sizeof(token), "token-%d", i);
+		ck_assert(_find(token, AUTH_PLUGIN_JWT, token));
+	}
+	ck_assert(_find("token-new", AUTH_PLUGIN_JWT, "token-new"));
+
+	auth_cache_stats_get(&stats);
+	ck_assert_uint_eq(stats.evictions, 1);
+}
+END_TEST
+
+START_TEST(test_size_prunes_expired_first)
+{
+	auth_cache_stats_t stats;
+	time_t expires = time(NULL) + 600;
+	char token[32];
+
+	/* Oldest token outlives the one expiring */
+	_add("token-0", expires);
+	_add("short", time(NULL) + 1);
+	for (int i = 2; i < CACHE_SIZE; i++) {
+		snprintf(token, sizeof(token), "token-%d", i);
+		_add(token, expires);
+	}
+
+	sleep(2);
+
+	_add("token-new", expires);
+	ck_assert_int_eq(freed, 1);
+
+	auth_cache_stats_get(&stats);
+	ck_assert_uint_eq(stats.evictions, 0);
+
+	ck_assert(_find("token-0", AUTH_PLUGIN_JWT, "token-0"));
+	ck_assert(_find("token-new", AUTH_PLUGIN_JWT, "token-new"));
+	ck_assert(!_find("short", AUTH_PLUGIN_JWT, NULL));
+}
+END_TEST
+
+START_TEST(test_disabled)
+{
+	xfree(slurm_conf.authalt_params);
+	slurm_conf.authalt_params = xstrdup("verify_cache_size=0");
+
+	_add("token-a", time(NULL) + 600);
+	ck_assert_int_eq(freed, 1);
+	ck_assert(!_find("token-a", AUTH_PLUGIN_JWT, NULL));
+}
+END_TEST
+
+static Suite *suite_auth_cache(void)
+{
+	Suite *s = suite_create("auth_cache");
+	TCase *tc_core = tcase_create("auth_cache");
+
+	tcase_add_checked_fixture(tc_core, _setup, _teardown);
+	tcase_add_test(tc_core, test_hit);
+	tcase_add_test(tc_core, test_other_token_misses);
+	tcase_add_test(tc_core, test_expiry_evicts);
+	tcase_add_test(tc_core, test_size_evicts_oldest);
+	tcase_add_test(tc_core, test_size_prunes_expired_first);
+	tcase_add_test(tc_core, test_disabled);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+int main(void)
+{
+	int number_failed;
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	const char *debug_env = getenv("SLURM_DEBUG");
+	const char *debug_flags_env = getenv("SLURM_DEBUG_FLAGS");
+	SRunner *sr;
+
+	if (debug_env)
+		log_opts.stderr_level = log_string2num(debug_env);
+	if (debug_flags_env)
+		debug_str2flags(debug_flags_env, &slurm_conf.debug_flags);
+
+	log_init("auth_cache-test", log_opts, 0, NULL);
+
+	sr = srunner_create(suite_auth_cache());
+
+	srunner_run_all(sr, CK_ENV);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	log_fini();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
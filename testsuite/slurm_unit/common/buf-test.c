@@ -50,7 +50,8 @@
 #include "src/common/xmalloc.h"
 
 /*
- * Tests for the buf_t life cycle and accessors in src/common/pack.c.
+ * Tests for the buf_t life cycle, accessors and buffer pools in
+ * src/common/pack.c.
  * The pack*()/unpack*() serializers are covered by pack-test.c.
  */
 
@@ -560,6 +561,159 @@ START_TEST(test_xfer_buf_data)
 
 END_TEST
 
+START_TEST(test_buf_pool_size_class)
+{
+	struct {
+		uint32_t size;
+		size_t capacity;
+	} cases[] = {
+		/* Small buffers are not pooled and keep their exact size */
+		{ ((BUF_SIZE / 4) - 1), ((BUF_SIZE / 4) - 1) },
+		{ (BUF_SIZE / 4), BUF_SIZE },
+		{ BUF_SIZE, BUF_SIZE },
+		{ (BUF_SIZE + 1), (BUF_SIZE * 2) },
+		{ (BUF_SIZE * 5), (BUF_SIZE * 8) },
+		{ (BUF_SIZE << 8), (BUF_SIZE << 8) },
+		/* Nor are buffers past the largest class */
+		{ ((BUF_SIZE << 8) + 1), ((BUF_SIZE << 8) + 1) },
+	};
+
+	for (int i = 0; i < ARRAY_SIZE(cases); i++) {
+		buf_t *buf = init_buf(cases[i].size);
+
+		/* Callers only see the size they asked for */
+		_check_empty_buf(buf, cases[i].size);
+		ck_assert_msg((xsize(get_buf_data(buf)) == cases[i].capacity),
+			      "init_buf(%u) capacity %zu expected %zu",
+			      cases[i].size, xsize(get_buf_data(buf)),
+			      cases[i].capacity);
+		free_buf(buf);
+	}
+}
+
+END_TEST
+
+START_TEST(test_buf_pool_reuse)
+{
+	uint32_t sizes[] = { BUF_SIZE, (BUF_SIZE * 8) };
+	buf_stats_t before, after;
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		buf_t *buf = init_buf(sizes[i]);
+		char *head = get_buf_data(buf);
+
+		memset(head, 'x', sizes[i]);
+		set_buf_offset(buf, 10);
+		free_buf(buf);
+
+		buf_stats_get(&before);
+		buf = init_buf(sizes[i]);
+		buf_stats_get(&after);
+
+		/* Same head is reused and cleared as xmalloc() would */
+		ck_assert(get_buf_data(buf) == head);
+		_check_empty_buf(buf, sizes[i]);
+		for (uint32_t j = 0; j < sizes[i]; j++)
+			ck_assert_int_eq(head[j], 0);
+		ck_assert_int_eq((after.reused - before.reused), 1);
+
+		free_buf(buf);
+	}
+
+	/* Unpooled sizes are never reused */
+	{
+		buf_t *buf = init_buf(16);
+
+		free_buf(buf);
+		buf_stats_get(&before);
+		buf = init_buf(16);
+		buf_stats_get(&after);
+		ck_assert_int_eq((after.reused - before.reused), 0);
+		free_buf(buf);
+	}
+}
+
+END_TEST
+
+START_TEST(test_buf_pool_grow_in_place)
+{
+	buf_t *buf = init_buf(BUF_SIZE + 1);
+	char *head = get_buf_data(buf);
+	buf_stats_t before, after;
+
+	memset(head, 'x', (BUF_SIZE + 1));
+	set_buf_offset(buf, (BUF_SIZE + 1));
+
+	/* Growing within the capacity of the class keeps the same head */
+	buf_stats_get(&before);
+	grow_buf(buf, (BUF_SIZE - 1));
+	buf_stats_get(&after);
+	ck_assert(get_buf_data(buf) == head);
+	ck_assert_int_eq(size_buf(buf), (BUF_SIZE * 2));
+	ck_assert_int_eq((after.grown_in_place - before.grown_in_place), 1);
+	ck_assert_int_eq((after.reallocs - before.reallocs), 0);
+
+	/* Growing past it reallocs to the capacity of the next class */
+	buf_stats_get(&before);
+	ck_assert_int_eq(try_grow_buf(buf, 1), SLURM_SUCCESS);
+	buf_stats_get(&after);
+	ck_assert_int_eq(size_buf(buf), (BUF_SIZE * 3));
+	ck_assert_int_eq(xsize(get_buf_data(buf)), (BUF_SIZE * 4));
+	ck_assert_int_eq((after.reallocs - before.reallocs), 1);
+	ck_assert_int_eq(get_buf_offset(buf), (BUF_SIZE + 1));
+	/* Old bytes are kept and the new ones cleared */
+	head = get_buf_data(buf);
+	ck_assert_int_eq(head[BUF_SIZE], 'x');
+	for (uint32_t i = (BUF_SIZE * 2); i < (BUF_SIZE * 3); i++)
+		ck_assert_int_eq(head[i], 0);
+
+	free_buf(buf);
+}
+
+END_TEST
+
+START_TEST(test_buf_size_hint)
+{
+	const uint16_t key = 60000, other = key + 256;
+	uint32_t hint, last;
+
+	/* Nothing learned yet */
+	ck_assert_int_eq(buf_size_hint(key), BUF_SIZE);
+
+	/* Growth is followed at once, with some room to spare */
+	buf_size_hint_update(key, (BUF_SIZE * 64));
+	hint = buf_size_hint(key);
+	ck_assert_int_ge(hint, (BUF_SIZE * 64));
+	ck_assert_int_le(hint, (BUF_SIZE * 80));
+
+	/* A single small size only decays the estimate part of the way */
+	buf_size_hint_update(key, BUF_SIZE);
+	last = buf_size_hint(key);
+	ck_assert_int_lt(last, hint);
+	ck_assert_int_gt(last, (BUF_SIZE * 32));
+
+	/* Repeated small sizes keep decaying it down to them */
+	for (int i = 0; i < 64; i++) {
+		buf_size_hint_update(key, BUF_SIZE);
+		hint = buf_size_hint(key);
+		ck_assert_int_le(hint, last);
+		last = hint;
+	}
+	ck_assert_int_ge(last, BUF_SIZE);
+	ck_assert_int_le(last, (BUF_SIZE + (BUF_SIZE / 8) + 4));
+
+	/* Larger sizes again replace the estimate */
+	buf_size_hint_update(key, (BUF_SIZE * 16));
+	ck_assert_int_ge(buf_size_hint(key), (BUF_SIZE * 16));
+
+	/* A key sharing the slot evicts the other and starts from scratch */
+	buf_size_hint_update(other, (BUF_SIZE * 2));
+	ck_assert_int_eq(buf_size_hint(key), BUF_SIZE);
+	ck_assert_int_ge(buf_size_hint(other), (BUF_SIZE * 2));
+}
+
+END_TEST
+
 static Suite *suite_buf(void)
 {
 	Suite *s = suite_create("buf");
@@ -582,6 +736,10 @@ static Suite *suite_buf(void)
 	tcase_add_test(tc_core, test_buf_append_str_grow);
 	tcase_add_test(tc_core, test_assign_buf);
 	tcase_add_test(tc_core, test_xfer_buf_data);
+	tcase_add_test(tc_core, test_buf_pool_size_class);
+	tcase_add_test(tc_core, test_buf_pool_reuse);
+	tcase_add_test(tc_core, test_buf_pool_grow_in_place);
+	tcase_add_test(tc_core, test_buf_size_hint);
 
 	suite_add_tcase(s, tc_core);
 	return s;
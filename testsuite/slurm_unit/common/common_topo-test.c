@@ -0,0 +1,265 @@
+/*****************************************************************************\
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include <check.h>
+#include <stdlib.h>
+
+#include "src/common/hostlist.h"
+#include "src/common/log.h"
+#include "src/common/node_conf.h"
+#include "src/common/read_config.h"
+#include "src/common/run_in_daemon.h"
+#include "src/common/xmalloc.h"
+#include "src/plugins/topology/common/common_topo.h"
+#include "src/slurmctld/licenses.h"
+#include "src/slurmctld/locks.h"
+#include "src/slurmctld/slurmctld.h"
+
+#define SLURMD_TIMEOUT 300
+
+/* Forwarders are only picked by the slurmctld */
+uint32_t slurm_daemon = IS_SLURMCTLD;
+
+const char plugin_type[] = "topology/common-test";
+
+/*
+ * The slurmctld symbols libtopology_common needs. The tests are single
+ * threaded, so there is nothing to lock against, and the node selection
+ * functions are never called.
+ */
+extern void lock_slurmctld(slurmctld_lock_t lock_levels)
+{
+}
+
+extern void unlock_slurmctld(slurmctld_lock_t lock_levels)
+{
+}
+
+extern bool hres_select_check(hres_select_t *hres_select,
+			      uint16_t hres_leaf_idx)
+{
+	return false;
+}
+
+extern void hres_select_return(hres_select_t *hres_select,
+			       uint16_t hres_leaf_idx)
+{
+}
+
+extern uint16_t job_mgr_determine_cpus_per_core(job_details_t *details,
+						int node_inx)
+{
+	return 1;
+}
+
+static void _setup(void)
+{
+	config_record_t *config_ptr;
+	char name[8];
+
+	slurm_conf.max_node_cnt = NO_VAL;
+	slurm_conf.slurmd_timeout = SLURMD_TIMEOUT;
+
+	init_node_conf();
+	config_ptr = create_config_record();
+	for (int i = 1; i <= 6; i++) {
+		node_record_t *node_ptr = NULL;
+
+		snprintf(name, sizeof(name), "n%d", i);
+		ck_assert_int_eq(create_node_record(config_ptr, name,
+						    &node_ptr),
+				 SLURM_SUCCESS);
+		node_ptr->node_state = NODE_STATE_IDLE;
+		node_ptr->last_response = time(NULL);
+	}
+}
+
+static void _teardown(void)
+{
+	node_fini2();
+}
+
+/* Pick forwarders for a single subtree and return its hosts in order */
+static char *_pick(const char *hosts)
+{
+	hostlist_t *sp_hl[] = { hostlist_create(hosts) };
+	char *picked;
+
+	common_topo_pick_forwarders(sp_hl, 1);
+
+	picked = hostlist_deranged_string_xmalloc(sp_hl[0]);
+	hostlist_destroy(sp_hl[0]);
+	return picked;
+}
+
+START_TEST(test_head_responding)
+{
+	char *picked = _pick("n[1-3]");
+
+	ck_assert_str_eq(picked, "n1,n2,n3");
+	xfree(picked);
+}
+END_TEST
+
+START_TEST(test_head_not_responding)
+{
+	char *picked;
+
+	find_node_record("n1")->node_state |= NODE_STATE_NO_RESPOND;
+	find_node_record("n2")->node_state = NODE_STATE_DOWN;
+
+	/* The first responsive node forwards, the rest keep their order */
+	picked = _pick("n[1-4]");
+	ck_assert_str_eq(picked, "n3,n1,n2,n4");
+	xfree(picked);
+}
+END_TEST
+
+START_TEST(test_head_stale)
+{
+	char *picked;
+
+	find_node_record("n1")->last_response =
+		time(NULL) - (2 * SLURMD_TIMEOUT);
+
+	picked = _pick("n[1-3]");
+	ck_assert_str_eq(picked, "n2,n1,n3");
+	xfree(picked);
+}
+END_TEST
+
+START_TEST(test_none_responding)
+{
+	char *picked;
+
+	for (int i = 1; i <= 3; i++)
+		node_record_table_ptr[i - 1]->node_state |=
+			NODE_STATE_NO_RESPOND;
+
+	picked = _pick("n[1-3]");
+	ck_assert_str_eq(picked, "n1,n2,n3");
+	xfree(picked);
+}
+END_TEST
+
+START_TEST(test_every_subtree)
+{
+	hostlist_t *sp_hl[] = {
+		hostlist_create("n[1-2]"),
+		hostlist_create("n3"),
+		hostlist_create("n[4-6]"),
+	};
+	char *picked;
+
+	find_node_record("n1")->node_state |= NODE_STATE_NO_RESPOND;
+	find_node_record("n3")->node_state |= NODE_STATE_NO_RESPOND;
+	find_node_record("n4")->node_state = NODE_STATE_DOWN;
+
+	common_topo_pick_forwarders(sp_hl, 3);
+
+	picked = hostlist_deranged_string_xmalloc(sp_hl[0]);
+	ck_assert_str_eq(picked, "n2,n1");
+	xfree(picked);
+
+	/* A subtree of one node has nothing to pick from */
+	picked = hostlist_deranged_string_xmalloc(sp_hl[1]);
+	ck_assert_str_eq(picked, "n3");
+	xfree(picked);
+
+	picked = hostlist_deranged_string_xmalloc(sp_hl[2]);
+	ck_assert_str_eq(picked, "n5,n4,n6");
+	xfree(picked);
+
+	for (int i = 0; i < 3; i++)
+		hostlist_destroy(sp_hl[i]);
+}
+END_TEST
+
+START_TEST(test_not_slurmctld)
+{
+	char *picked;
+
+	/* Other daemons do not know the state of the nodes */
+	slurm_daemon = IS_SLURMD;
+	find_node_record("n1")->node_state = NODE_STATE_DOWN;
+
+	picked = _pick("n[1-3]");
+	ck_assert_str_eq(picked, "n1,n2,n3");
+	xfree(picked);
+
+	slurm_daemon = IS_SLURMCTLD;
+}
+END_TEST
+
+static Suite *suite_common_topo(void)
+{
+	Suite *s = suite_create("common_topo");
+	TCase *tc_core = tcase_create("pick_forwarders");
+
+	tcase_add_checked_fixture(tc_core, _setup, _teardown);
+	tcase_add_test(tc_core, test_head_responding);
+	tcase_add_test(tc_core, test_head_not_responding);
+	tcase_add_test(tc_core, test_head_stale);
+	tcase_add_test(tc_core, test_none_responding);
+	tcase_add_test(tc_core, test_every_subtree);
+	tcase_add_test(tc_core, test_not_slurmctld);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+int main(void)
+{
+	int number_failed;
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	const char *debug_env = getenv("SLURM_DEBUG");
+	const char *debug_flags_env = getenv("SLURM_DEBUG_FLAGS");
+	SRunner *sr;
+
+	if (debug_env)
+		log_opts.stderr_level = log_string2num(debug_env);
+	if (debug_flags_env)
+		debug_str2flags(debug_flags_env, &slurm_conf.debug_flags);
+
+	log_init("common_topo-test", log_opts, 0, NULL);
+
+	sr = srunner_create(suite_common_topo());
+
+	srunner_run_all(sr, CK_ENV);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	log_fini();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
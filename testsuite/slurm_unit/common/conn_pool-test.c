@@ -0,0 +1,327 @@
+/*****************************************************************************\
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include <arpa/inet.h>
+#include <check.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "src/common/conn_pool.h"
+#include "src/common/log.h"
+#include "src/common/read_config.h"
+#include "src/common/run_in_daemon.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/interfaces/conn.h"
+
+#define IDLE_TIMEOUT 1
+/* Must match CONN_POOL_MAX_IDLE_PEER */
+#define MAX_IDLE_PEER 4
+
+/* Connections are only pooled by daemons */
+uint32_t slurm_daemon = IS_SLURMCTLD;
+
+/*
+ * Every test runs in its own forked process, so each starts with an empty
+ * pool and zeroed counters.
+ */
+
+typedef struct {
+	conn_t *conn;
+	int peer_fd; /* slurmd end of the connection */
+} pair_t;
+
+static slurm_addr_t addr_a, addr_b;
+
+static void _set_comm_params(const char *comm_params)
+{
+	xfree(slurm_conf.comm_params);
+	slurm_conf.comm_params = xstrdup(comm_params);
+	/* Any change of last_update makes the pool reload the config */
+	slurm_conf.last_update++;
+}
+
+static void _set_addr(slurm_addr_t *addr, uint16_t port)
+{
+	struct sockaddr_in *in = (struct sockaddr_in *) addr;
+
+	memset(addr, 0, sizeof(*addr));
+	in->sin_family = AF_INET;
+	in->sin_port = htons(port);
+	in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+}
+
+static pair_t _connect(void)
+{
+	int fds[2];
+	conn_args_t args = {
+		.mode = CONN_CLIENT,
+	};
+	pair_t pair;
+
+	ck_assert_int_eq(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+	args.input_fd = args.output_fd = fds[0];
+	pair.conn = conn_g_create(&args);
+	ck_assert_ptr_nonnull(pair.conn);
+	pair.peer_fd = fds[1];
+
+	return pair;
+}
+
+/* Check if the pool closed its end of the connection */
+static bool _peer_closed(int peer_fd)
+{
+	struct pollfd pfd = {
+		.fd = peer_fd,
+		.events = POLLIN,
+	};
+	char c;
+
+	/* Unread data makes the close a reset instead of EOF */
+	return ((poll(&pfd, 1, 0) == 1) && (read(peer_fd, &c, 1) <= 0));
+}
+
+static void _setup(void)
+{
+	char *comm_params = xstrdup_printf("conn_pool_idle_timeout=%d",
+					   IDLE_TIMEOUT);
+
+	xfree(slurm_conf.plugindir);
+	slurm_conf.plugindir = xstrdup(TLS_PLUGIN_DIR);
+	xfree(slurm_conf.tls_type);
+	slurm_conf.tls_type = xstrdup("tls/none");
+	slurm_conf.last_update = time(NULL);
+	ck_assert_int_eq(conn_g_init(), SLURM_SUCCESS);
+
+	_set_comm_params(comm_params);
+	xfree(comm_params);
+
+	_set_addr(&addr_a, 6818);
+	_set_addr(&addr_b, 6819);
+}
+
+static void _teardown(void)
+{
+	conn_pool_flush();
+	conn_g_fini();
+	xfree(slurm_conf.comm_params);
+	xfree(slurm_conf.plugindir);
+	xfree(slurm_conf.tls_type);
+}
+
+START_TEST(test_reuse)
+{
+	pair_t pair = _connect();
+	conn_pool_stats_t stats;
+
+	ck_assert(conn_pool_enabled());
+	ck_assert_int_eq(conn_pool_idle_timeout(), IDLE_TIMEOUT);
+
+	conn_pool_put(&addr_a, pair.conn);
+
+	/* Only connections to the same peer are handed out */
+	ck_assert_ptr_null(conn_pool_get(&addr_b));
+	ck_assert_ptr_eq(conn_pool_get(&addr_a), pair.conn);
+	ck_assert_ptr_null(conn_pool_get(&addr_a));
+
+	conn_pool_stats_get(&stats);
+	ck_assert_uint_eq(stats.reused, 1);
+	ck_assert_uint_eq(stats.connects, 2);
+	ck_assert_uint_eq(stats.stale, 0);
+
+	conn_g_destroy(pair.conn, true);
+	close(pair.peer_fd);
+}
+END_TEST
+
+START_TEST(test_peer_closed)
+{
+	pair_t pair = _connect();
+	conn_pool_stats_t stats;
+
+	conn_pool_put(&addr_a, pair.conn);
+
+	/* slurmd gave up on the idle connection */
+	close(pair.peer_fd);
+
+	ck_assert_ptr_null(conn_pool_get(&addr_a));
+
+	conn_pool_stats_get(&stats);
+	ck_assert_uint_eq(stats.stale, 1);
+	ck_assert_uint_eq(stats.reused, 0);
+	ck_assert_uint_eq(stats.connects, 1);
+}
+END_TEST
+
+START_TEST(test_peer_sent_data)
+{
+	pair_t pair = _connect();
+	conn_pool_stats_t stats;
+
+	conn_pool_put(&addr_a, pair.conn);
+
+	/* Nothing is expected from an idle peer, so this is not reusable */
+	ck_assert_int_eq(write(pair.peer_fd, "x", 1), 1);
+
+	ck_assert_ptr_null(conn_pool_get(&addr_a));
+	ck_assert(_peer_closed(pair.peer_fd));
+
+	conn_pool_stats_get(&stats);
+	ck_assert_uint_eq(stats.stale, 1);
+
+	close(pair.peer_fd);
+}
+END_TEST
+
+START_TEST(test_idle_expiry)
+{
+	pair_t pair = _connect();
+	conn_pool_stats_t stats;
+
+	conn_pool_put(&addr_a, pair.conn);
+
+	/* Idle for longer than conn_pool_idle_timeout */
+	sleep(IDLE_TIMEOUT + 1);
+
+	ck_assert_ptr_null(conn_pool_get(&addr_a));
+	ck_assert(_peer_closed(pair.peer_fd));
+
+	conn_pool_stats_get(&stats);
+	ck_assert_uint_eq(stats.expired, 1);
+	ck_assert_uint_eq(stats.stale, 0);
+	ck_assert_uint_eq(stats.reused, 0);
+
+	close(pair.peer_fd);
+}
+END_TEST
+
+START_TEST(test_peer_limit)
+{
+	pair_t pairs[MAX_IDLE_PEER + 1];
+
+	for (int i = 0; i < ARRAY_SIZE(pairs); i++) {
+		pairs[i] = _connect();
+		conn_pool_put(&addr_a, pairs[i].conn);
+	}
+
+	/* The connection over the per peer limit was closed at once */
+	ck_assert(_peer_closed(pairs[MAX_IDLE_PEER].peer_fd));
+
+	/* Least recently used connection is handed out first */
+	for (int i = 0; i < MAX_IDLE_PEER; i++) {
+		conn_t *conn = conn_pool_get(&addr_a);
+
+		ck_assert_ptr_eq(conn, pairs[i].conn);
+		conn_g_destroy(conn, true);
+	}
+	ck_assert_ptr_null(conn_pool_get(&addr_a));
+
+	for (int i = 0; i < ARRAY_SIZE(pairs); i++)
+		close(pairs[i].peer_fd);
+}
+END_TEST
+
+START_TEST(test_disabled)
+{
+	pair_t pair = _connect();
+	conn_pool_stats_t stats;
+
+	conn_pool_put(&addr_a, pair.conn);
+
+	/* Disabling the pool closes the idle connections */
+	_set_comm_params(NULL);
+	ck_assert(!conn_pool_enabled());
+	ck_assert(_peer_closed(pair.peer_fd));
+	close(pair.peer_fd);
+
+	/* Nothing is kept or counted while disabled */
+	pair = _connect();
+	conn_pool_put(&addr_a, pair.conn);
+	ck_assert(_peer_closed(pair.peer_fd));
+	ck_assert_ptr_null(conn_pool_get(&addr_a));
+
+	conn_pool_stats_get(&stats);
+	ck_assert_uint_eq(stats.connects, 0);
+
+	/* Out of range values are ignored */
+	_set_comm_params("conn_pool_idle_timeout=0");
+	ck_assert(!conn_pool_enabled());
+
+	close(pair.peer_fd);
+}
+END_TEST
+
+static Suite *suite_conn_pool(void)
+{
+	Suite *s = suite_create("conn_pool");
+	TCase *tc_core = tcase_create("conn_pool");
+
+	tcase_add_checked_fixture(tc_core, _setup, _teardown);
+	tcase_add_test(tc_core, test_reuse);
+	tcase_add_test(tc_core, test_peer_closed);
+	tcase_add_test(tc_core, test_peer_sent_data);
+	tcase_add_test(tc_core, test_idle_expiry);
+	tcase_add_test(tc_core, test_peer_limit);
+	tcase_add_test(tc_core, test_disabled);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+int main(void)
+{
+	int number_failed;
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	const char *debug_env = getenv("SLURM_DEBUG");
+	const char *debug_flags_env = getenv("SLURM_DEBUG_FLAGS");
+	SRunner *sr;
+
+	if (debug_env)
+		log_opts.stderr_level = log_string2num(debug_env);
+	if (debug_flags_env)
+		debug_str2flags(debug_flags_env, &slurm_conf.debug_flags);
+
+	log_init("conn_pool-test", log_opts, 0, NULL);
+
+	sr = srunner_create(suite_conn_pool());
+
+	srunner_run_all(sr, CK_ENV);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	log_fini();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,300 @@
+/*****************************************************************************\
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <check.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "src/common/eio.h"
+#include "src/common/fd.h"
+#include "src/common/log.h"
+#include "src/common/read_config.h"
+#include "src/common/xmalloc.h"
+
+/*
+ * Tests for the eio mainloop in src/common/eio.c.
+ * Every fd is filled up front so the tests run in a single thread and the
+ * mainloop returns once no object is readable anymore.
+ */
+
+#define CHAIN_ROUNDS 20
+
+typedef struct {
+	size_t chunk;	/* bytes to read per handle_read() */
+	size_t bytes;	/* total bytes read */
+	int reads;	/* handle_read() calls that returned data */
+} reader_t;
+
+typedef struct {
+	eio_handle_t *eio;
+	size_t bytes;
+	int rounds;	/* objects created */
+	int removed;	/* objects read to EOF and removed */
+	int last_fd;
+	int fd_reused;	/* new objects that got the fd of a removed one */
+} chain_t;
+
+static const char chain_data[] = "eio object added from handle_cleanup";
+
+/* Create a pipe holding len bytes of data with the write end closed */
+static int _filled_pipe(const char *data, size_t len)
+{
+	int fds[2];
+
+	ck_assert_int_eq(pipe(fds), 0);
+	ck_assert_int_eq(write(fds[1], data, len), len);
+	close(fds[1]);
+	fd_set_nonblocking(fds[0]);
+
+	return fds[0];
+}
+
+/* Read one chunk, closing the fd at EOF */
+static ssize_t _read_chunk(eio_obj_t *obj, size_t chunk)
+{
+	char buf[4096];
+	ssize_t n;
+
+	ck_assert(chunk <= sizeof(buf));
+
+	n = read(obj->fd, buf, chunk);
+	if (!n) {
+		close(obj->fd);
+		obj->fd = -1;
+	} else {
+		ck_assert_msg((n > 0) || (errno == EAGAIN),
+			      "read(%d): %s", obj->fd, strerror(errno));
+	}
+
+	return n;
+}
+
+static bool _reader_readable(eio_obj_t *obj)
+{
+	return (obj->fd >= 0);
+}
+
+static int _reader_read(eio_obj_t *obj, list_t *objs)
+{
+	reader_t *reader = obj->arg;
+	ssize_t n;
+
+	if ((n = _read_chunk(obj, reader->chunk)) > 0) {
+		reader->bytes += n;
+		reader->reads++;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+static struct io_operations reader_ops = {
+	.readable = _reader_readable,
+	.handle_read = _reader_read,
+};
+
+static int _chain_read(eio_obj_t *obj, list_t *objs)
+{
+	chain_t *chain = obj->arg;
+	ssize_t n;
+
+	if ((n = _read_chunk(obj, 8)) > 0)
+		chain->bytes += n;
+
+	return SLURM_SUCCESS;
+}
+
+static void _chain_add(chain_t *chain);
+
+/* Replace the object by a new one once it has been read to EOF */
+static int _chain_cleanup(eio_obj_t *obj, list_t *objs, list_t *del_objs)
+{
+	chain_t *chain = obj->arg;
+
+	if (obj->fd >= 0)
+		return SLURM_SUCCESS;
+
+	ck_assert(eio_remove_obj(obj, objs));
+	chain->removed++;
+
+	if (chain->rounds < CHAIN_ROUNDS)
+		_chain_add(chain);
+
+	return SLURM_SUCCESS;
+}
+
+static struct io_operations chain_ops = {
+	.readable = _reader_readable,
+	.handle_read = _chain_read,
+	.handle_cleanup = _chain_cleanup,
+};
+
+static void _chain_add(chain_t *chain)
+{
+	int fd = _filled_pipe(chain_data, sizeof(chain_data));
+
+	if (fd == chain->last_fd)
+		chain->fd_reused++;
+	chain->last_fd = fd;
+	chain->rounds++;
+
+	eio_new_obj(chain->eio, eio_obj_create(fd, &chain_ops, chain));
+}
+
+/*
+ * Keeps the mainloop running while the chain swaps objects, as new objects
+ * only join the loop on the pass after eio_new_obj().
+ */
+static bool _sentinel_readable(eio_obj_t *obj)
+{
+	chain_t *chain = obj->arg;
+
+	return (chain->removed < CHAIN_ROUNDS);
+}
+
+static struct io_operations sentinel_ops = {
+	.readable = _sentinel_readable,
+};
+
+START_TEST(test_pipe_read)
+{
+	char data[1000];
+	reader_t reader = { .chunk = 64 };
+	eio_handle_t *eio = eio_handle_create(0);
+	int fd;
+
+	memset(data, 'p', sizeof(data));
+	fd = _filled_pipe(data, sizeof(data));
+	eio_new_initial_obj(eio, eio_obj_create(fd, &reader_ops, &reader));
+
+	ck_assert_int_eq(eio_handle_mainloop(eio), 0);
+	ck_assert_int_eq(reader.bytes, sizeof(data));
+	/* One chunk per pass, the fd has to be re-armed every time */
+	ck_assert_int_eq(reader.reads, (sizeof(data) + 63) / 64);
+
+	eio_handle_destroy(eio);
+}
+END_TEST
+
+START_TEST(test_regular_file)
+{
+	char data[10000], path[] = "/tmp/eio-test.XXXXXX";
+	reader_t file_reader = { .chunk = 512 }, pipe_reader = { .chunk = 16 };
+	eio_handle_t *eio = eio_handle_create(0);
+	int fd;
+
+	/* epoll_ctl() refuses regular files with EPERM */
+	ck_assert_int_ge((fd = mkstemp(path)), 0);
+	unlink(path);
+	memset(data, 'f', sizeof(data));
+	ck_assert_int_eq(write(fd, data, sizeof(data)), sizeof(data));
+	ck_assert_int_eq(lseek(fd, 0, SEEK_SET), 0);
+	eio_new_initial_obj(eio, eio_obj_create(fd, &reader_ops, &file_reader));
+
+	/* Pipes in the same loop must still be served */
+	fd = _filled_pipe(data, 100);
+	eio_new_initial_obj(eio, eio_obj_create(fd, &reader_ops, &pipe_reader));
+
+	ck_assert_int_eq(eio_handle_mainloop(eio), 0);
+	ck_assert_int_eq(file_reader.bytes, sizeof(data));
+	ck_assert_int_eq(pipe_reader.bytes, 100);
+
+	eio_handle_destroy(eio);
+}
+END_TEST
+
+START_TEST(test_add_remove)
+{
+	chain_t chain = { .last_fd = -1 };
+	int fds[2];
+
+	chain.eio = eio_handle_create(0);
+
+	ck_assert_int_eq(pipe(fds), 0);
+	eio_new_initial_obj(chain.eio,
+			    eio_obj_create(fds[0], &sentinel_ops, &chain));
+
+	_chain_add(&chain);
+
+	ck_assert_int_eq(eio_handle_mainloop(chain.eio), 0);
+	ck_assert_int_eq(chain.rounds, CHAIN_ROUNDS);
+	ck_assert_int_eq(chain.removed, CHAIN_ROUNDS);
+	ck_assert_int_eq(chain.bytes, CHAIN_ROUNDS * sizeof(chain_data));
+	/* A removed object's fd number is handed to the next one */
+	ck_assert_int_gt(chain.fd_reused, 0);
+
+	eio_handle_destroy(chain.eio);
+	close(fds[0]);
+	close(fds[1]);
+}
+END_TEST
+
+static Suite *suite_eio(void)
+{
+	Suite *s = suite_create("eio");
+	TCase *tc_core = tcase_create("eio");
+
+	tcase_add_test(tc_core, test_pipe_read);
+	tcase_add_test(tc_core, test_regular_file);
+	tcase_add_test(tc_core, test_add_remove);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+int main(void)
+{
+	int number_failed;
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	const char *debug_env = getenv("SLURM_DEBUG");
+	const char *debug_flags_env = getenv("SLURM_DEBUG_FLAGS");
+	SRunner *sr;
+
+	if (debug_env)
+		log_opts.stderr_level = log_string2num(debug_env);
+	if (debug_flags_env)
+		debug_str2flags(debug_flags_env, &slurm_conf.debug_flags);
+
+	log_init("eio-test", log_opts, 0, NULL);
+
+	sr = srunner_create(suite_eio());
+
+	srunner_run_all(sr, CK_ENV);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	log_fini();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,169 @@
+/*****************************************************************************\
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include <check.h>
+#include <stdlib.h>
+
+/* Built with the source to reach the static re-split of a failed subtree */
+#include "src/common/forward.c"
+
+#include "src/common/log.h"
+
+#define TREE_WIDTH 2
+
+static const char nodes[] = "n[1-20]";
+
+static int _split_depth(void)
+{
+	hostlist_t *hl = hostlist_create(nodes);
+	hostlist_t **sp_hl = NULL;
+	int count = 0, depth;
+
+	depth = hostlist_split_treewidth(hl, &sp_hl, &count, TREE_WIDTH);
+	ck_assert_int_gt(depth, 1);
+
+	for (int i = 0; i < count; i++)
+		hostlist_destroy(sp_hl[i]);
+	xfree(sp_hl);
+	hostlist_destroy(hl);
+
+	return depth;
+}
+
+START_TEST(test_resplit)
+{
+	hostlist_t *hl = hostlist_create(nodes);
+	hostlist_t **sp_hl = NULL;
+	int depth = _split_depth(), count, total = 0;
+	int node_cnt = hostlist_count(hl);
+
+	/* The new subtrees and the hop lost to the dead forwarder fit */
+	count = _resplit_hostlist(hl, TREE_WIDTH, (depth + 1), false, &sp_hl);
+	ck_assert_int_gt(count, 1);
+	ck_assert_int_le(count, TREE_WIDTH);
+
+	for (int i = 0; i < count; i++) {
+		total += hostlist_count(sp_hl[i]);
+		hostlist_destroy(sp_hl[i]);
+	}
+	xfree(sp_hl);
+
+	/* Every node is in one of the subtrees */
+	ck_assert_int_eq(total, node_cnt);
+	hostlist_destroy(hl);
+}
+END_TEST
+
+START_TEST(test_resplit_depth_budget)
+{
+	hostlist_t *hl = hostlist_create(nodes);
+	hostlist_t **sp_hl = NULL;
+	int depth = _split_depth();
+
+	/* One level short, so every node is sent to directly */
+	ck_assert_int_eq(_resplit_hostlist(hl, TREE_WIDTH, depth, false,
+					   &sp_hl), 0);
+	ck_assert(!sp_hl);
+
+	ck_assert_int_eq(_resplit_hostlist(hl, TREE_WIDTH, 0, false, &sp_hl),
+			 0);
+	ck_assert(!sp_hl);
+
+	/* The nodes are given back to the caller, in order */
+	ck_assert_int_eq(hostlist_count(hl), 20);
+	ck_assert_int_eq(hostlist_find(hl, "n1"), 0);
+	ck_assert_int_eq(hostlist_find(hl, "n20"), 19);
+	hostlist_destroy(hl);
+}
+END_TEST
+
+START_TEST(test_resplit_tree_width)
+{
+	hostlist_t *hl = hostlist_create("n[1-2]");
+	hostlist_t **sp_hl = NULL;
+	int count;
+
+	/* No more nodes than tree_width are sent to directly */
+	ck_assert_int_eq(_resplit_hostlist(hl, TREE_WIDTH, 100, false, &sp_hl),
+			 0);
+	ck_assert(!sp_hl);
+
+	hostlist_push_host(hl, "n3");
+	count = _resplit_hostlist(hl, TREE_WIDTH, 100, false, &sp_hl);
+	ck_assert_int_eq(count, TREE_WIDTH);
+
+	for (int i = 0; i < count; i++)
+		hostlist_destroy(sp_hl[i]);
+	xfree(sp_hl);
+	hostlist_destroy(hl);
+}
+END_TEST
+
+static Suite *suite_forward(void)
+{
+	Suite *s = suite_create("forward");
+	TCase *tc_core = tcase_create("forward");
+
+	tcase_add_test(tc_core, test_resplit);
+	tcase_add_test(tc_core, test_resplit_depth_budget);
+	tcase_add_test(tc_core, test_resplit_tree_width);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+int main(void)
+{
+	int number_failed;
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	const char *debug_env = getenv("SLURM_DEBUG");
+	const char *debug_flags_env = getenv("SLURM_DEBUG_FLAGS");
+	SRunner *sr;
+
+	if (debug_env)
+		log_opts.stderr_level = log_string2num(debug_env);
+	if (debug_flags_env)
+		debug_str2flags(debug_flags_env, &slurm_conf.debug_flags);
+
+	log_init("forward-test", log_opts, 0, NULL);
+
+	sr = srunner_create(suite_forward());
+
+	srunner_run_all(sr, CK_ENV);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	log_fini();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,188 @@
+/*****************************************************************************\
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Built with the plugin source so the tests can pick the number of threads
+ * _k12_parallel() uses, whatever the CPU count of the host is.
+ */
+#include "src/plugins/hash/k12/hash_k12.c"
+
+#include "src/common/read_config.h"
+
+#define MiB (1024 * 1024)
+
+static const char custom[] = "hash_k12-test";
+
+/* Plain sizes and n*8192 +/- 1 around and well past the parallel threshold */
+static const size_t sizes[] = {
+	0, 1, (K12_CHUNK_SIZE - 1), K12_CHUNK_SIZE, (K12_CHUNK_SIZE + 1),
+	((2 * K12_CHUNK_SIZE) - 1), (2 * K12_CHUNK_SIZE),
+	((2 * K12_CHUNK_SIZE) + 1),
+	((65 * K12_CHUNK_SIZE) - 1), (65 * K12_CHUNK_SIZE),
+	((65 * K12_CHUNK_SIZE) + 1),
+	((129 * K12_CHUNK_SIZE) - 1), ((129 * K12_CHUNK_SIZE) + 1),
+	((257 * K12_CHUNK_SIZE) + 1),
+	(4 * MiB), ((4 * MiB) + 1), ((9 * MiB) - 1), (16 * MiB),
+};
+
+static const int thread_cnts[] = { 2, 3, PARALLEL_MAX_THREADS };
+
+static unsigned char *input = NULL;
+static size_t input_len = 0;
+
+static void _setup(void)
+{
+	input_len = 16 * MiB;
+	input = xmalloc(input_len);
+
+	/* Deterministic, but not periodic within a chunk */
+	for (size_t i = 0; i < input_len; i++)
+		input[i] = (unsigned char) ((i * 2654435761u) >> 13);
+}
+
+static void _teardown(void)
+{
+	xfree(input);
+}
+
+static void _check_size(size_t len, const char *cs, size_t cs_len)
+{
+	slurm_hash_t expected = { 0 }, got = { 0 };
+	int rc;
+
+	ck_assert_int_eq(KangarooTwelve(input, len, expected.hash,
+					sizeof(expected.hash),
+					(unsigned char *) cs, cs_len), 0);
+
+	rc = _k12_parallel(input, len, got.hash, sizeof(got.hash),
+			   (unsigned char *) cs, cs_len);
+
+	if (len < (2 * K12_CHUNK_SIZE)) {
+		ck_assert_msg(rc == -1, "len %zu should not be split", len);
+		return;
+	}
+
+	/* Too few leaves for more than one thread falls back as well */
+	if (MIN(max_threads,
+		(((len / K12_CHUNK_SIZE) - 1) / PARALLEL_MIN_LEAVES)) < 2) {
+		ck_assert_msg(rc == -1, "len %zu should not be split", len);
+		return;
+	}
+
+	ck_assert_msg(rc == 0, "len %zu: _k12_parallel() failed", len);
+	ck_assert_msg(!memcmp(expected.hash, got.hash, sizeof(got.hash)),
+		      "len %zu threads %d: hash differs from KangarooTwelve()",
+		      len, max_threads);
+}
+
+START_TEST(test_parallel_matches_serial)
+{
+	for (int t = 0; t < ARRAY_SIZE(thread_cnts); t++) {
+		max_threads = thread_cnts[t];
+
+		for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+			_check_size(sizes[i], NULL, 0);
+			_check_size(sizes[i], custom, strlen(custom));
+		}
+	}
+}
+END_TEST
+
+START_TEST(test_compute)
+{
+	slurm_hash_t hash = { 0 }, expected = { 0 };
+
+	max_threads = PARALLEL_MAX_THREADS;
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		ck_assert_int_eq(KangarooTwelve(input, sizes[i], expected.hash,
+						sizeof(expected.hash),
+						(unsigned char *) custom,
+						strlen(custom)), 0);
+
+		memset(&hash, 0, sizeof(hash));
+		ck_assert_int_eq(hash_p_compute((char *) input, sizes[i],
+						(char *) custom, strlen(custom),
+						&hash),
+				 sizeof(hash.hash));
+		ck_assert_int_eq(hash.type, HASH_PLUGIN_K12);
+		ck_assert_msg(!memcmp(expected.hash, hash.hash,
+				      sizeof(hash.hash)),
+			      "len %zu: hash_p_compute() differs from KangarooTwelve()",
+			      sizes[i]);
+	}
+}
+END_TEST
+
+static Suite *suite_hash_k12(void)
+{
+	Suite *s = suite_create("hash_k12");
+	TCase *tc_core = tcase_create("hash_k12");
+
+	tcase_add_unchecked_fixture(tc_core, _setup, _teardown);
+	tcase_set_timeout(tc_core, 120);
+	tcase_add_test(tc_core, test_parallel_matches_serial);
+	tcase_add_test(tc_core, test_compute);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+int main(void)
+{
+	int number_failed;
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	const char *debug_env = getenv("SLURM_DEBUG");
+	const char *debug_flags_env = getenv("SLURM_DEBUG_FLAGS");
+	SRunner *sr;
+
+	if (debug_env)
+		log_opts.stderr_level = log_string2num(debug_env);
+	if (debug_flags_env)
+		debug_str2flags(debug_flags_env, &slurm_conf.debug_flags);
+
+	log_init("hash_k12-test", log_opts, 0, NULL);
+
+	sr = srunner_create(suite_hash_k12());
+
+	srunner_run_all(sr, CK_ENV);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	log_fini();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,422 @@
+/*****************************************************************************\
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/common/forward.h"
+#include "src/common/log.h"
+#include "src/common/pack.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/slurm_protocol_pack.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/interfaces/auth.h"
+#include "src/interfaces/compress.h"
+
+/*
+ * Tests for the message body compression of
+ * CommunicationParameters=compress_threshold in slurm_protocol_api.c.
+ * Messages are packed without credentials and unpacked again with
+ * slurm_unpack_received_msg(), as a receiving daemon would.
+ */
+
+#define THRESHOLD 1024
+#define BLOCK_SIZE (64 * 1024)
+/* Uncompressed size and compression type */
+#define BODY_HEAD_SIZE (sizeof(uint32_t) + sizeof(uint16_t))
+/* Compressed and uncompressed size of each block */
+#define BLOCK_HEAD_SIZE (2 * sizeof(uint32_t))
+
+typedef struct {
+	header_t header;
+	buf_t *body;
+} wire_t;
+
+static bool lz4_available = false;
+
+/* Text that LZ4 shrinks to roughly half, so large bodies need many blocks */
+static char *_make_text(size_t len)
+{
+	static const char *words[] = {
+		"slurm", "node", "job", "step", "task", "partition",
+		"account", "qos", "reservation", "license", "gres", "tres",
+		"cpu", "memory", "switch", "cluster",
+	};
+	char *text = xmalloc(len + 1);
+	uint32_t seed = 1;
+	size_t pos = 0;
+
+	while (pos < len) {
+		const char *word;
+		size_t wlen;
+
+		seed = (seed * 1103515245) + 12345;
+		word = words[(seed >> 16) % ARRAY_SIZE(words)];
+		wlen = MIN(strlen(word), (len - pos));
+		memcpy(text + pos, word, wlen);
+		pos += wlen;
+		if (pos < len)
+			text[pos++] = ((seed >> 8) & 1) ? ' ' : '\n';
+	}
+
+	return text;
+}
+
+/* Pack a REQUEST_JOB_NOTIFY carrying text as a sender would */
+static void _pack(const char *text, uint16_t flags, uint16_t version,
+		  wire_t *wire)
+{
+	job_notify_msg_t notify = {
+		.message = (char *) text,
+		.step_id = { .job_id = 1234, .step_id = NO_VAL,
+			     .step_het_comp = NO_VAL },
+	};
+	slurm_msg_t msg;
+	msg_bufs_t buffers = { 0 };
+
+	slurm_msg_t_init(&msg);
+	slurm_msg_set_r_uid(&msg, SLURM_AUTH_UID_ANY);
+	msg.msg_type = REQUEST_JOB_NOTIFY;
+	msg.protocol_version = version;
+	msg.flags = (SLURM_NO_AUTH_CRED | flags);
+	msg.data = &notify;
+
+	ck_assert_int_eq(slurm_buffers_pack_msg(&msg, &buffers, false),
+			 SLURM_SUCCESS);
+	ck_assert_ptr_null(buffers.auth);
+
+	set_buf_offset(buffers.header, 0);
+	ck_assert_int_eq(unpack_header(&wire->header, buffers.header),
+			 SLURM_SUCCESS);
+	wire->body = buffers.body;
+
+	FREE_NULL_BUFFER(buffers.header);
+}
+
+static void _wire_free(wire_t *wire)
+{
+	destroy_forward(&wire->header.forward);
+	FREE_NULL_BUFFER(wire->body);
+}
+
+/*
+ * Unpack the first body_len bytes of the body as received from the network.
+ * IN text - expected message or NULL if it must be rejected
+ */
+static void _unpack(wire_t *wire, uint32_t body_len, const char *text)
+{
+	buf_t *buffer = init_buf(BUF_SIZE + body_len);
+	slurm_msg_t msg;
+	int rc;
+
+	update_header(&wire->header, body_len);
+	pack_header(&wire->header, buffer);
+	memcpy(get_buf_data(buffer) + get_buf_offset(buffer),
+	       get_buf_data(wire->body), body_len);
+	buffer->size = get_buf_offset(buffer) + body_len;
+	set_buf_offset(buffer, 0);
+
+	slurm_msg_t_init(&msg);
+	rc = slurm_unpack_received_msg(&msg, -1, buffer);
+
+	if (!text) {
+		ck_assert_int_ne(rc, SLURM_SUCCESS);
+	} else {
+		job_notify_msg_t *notify = msg.data;
+
+		ck_assert_int_eq(rc, SLURM_SUCCESS);
+		ck_assert_int_eq(msg.msg_type, REQUEST_JOB_NOTIFY);
+		ck_assert(!(msg.flags & SLURM_MSG_COMPRESSED));
+		ck_assert_int_eq(notify->step_id.job_id, 1234);
+		ck_assert_msg(!xstrcmp(notify->message, text),
+			      "message of %zu bytes changed in transit",
+			      strlen(text));
+	}
+
+	slurm_free_msg_members(&msg);
+	FREE_NULL_BUFFER(buffer);
+}
+
+/* RET number of LZ4 blocks in a compressed body */
+static int _block_count(wire_t *wire)
+{
+	buf_t *body = create_shadow_buf(get_buf_data(wire->body),
+					get_buf_offset(wire->body));
+	uint32_t comp_len, block_len;
+	int blocks = 0;
+
+	set_buf_offset(body, BODY_HEAD_SIZE);
+	while (remaining_buf(body)) {
+		ck_assert_int_eq(unpack32(&comp_len, body), SLURM_SUCCESS);
+		ck_assert_int_eq(unpack32(&block_len, body), SLURM_SUCCESS);
+		ck_assert_uint_le(comp_len, BLOCK_SIZE);
+		set_buf_offset(body, (get_buf_offset(body) + comp_len));
+		blocks++;
+	}
+	FREE_NULL_BUFFER(body);
+
+	return blocks;
+}
+
+static void _setup(void)
+{
+	xfree(slurm_conf.comm_params);
+	slurm_conf.comm_params = xstrdup_printf("compress_threshold=%d",
+						THRESHOLD);
+	xfree(slurm_conf.plugindir);
+	slurm_conf.plugindir = xstrdup(COMPRESS_PLUGIN_DIRS);
+	slurm_conf.last_update = time(NULL);
+
+	ck_assert_int_eq(compress_g_init(), SLURM_SUCCESS);
+	lz4_available = (compress_g_type_available(COMPRESS_PLUGIN_LZ4) ==
+			 SLURM_SUCCESS);
+	if (!lz4_available)
+		info("compress/lz4 is not available, only checking that bodies are sent uncompressed");
+}
+
+static void _teardown(void)
+{
+	compress_g_fini();
+	xfree(slurm_conf.comm_params);
+	xfree(slurm_conf.plugindir);
+}
+
+START_TEST(test_round_trip)
+{
+	/* Around the threshold and the block size, and many blocks */
+	const size_t sizes[] = {
+		(THRESHOLD - 64), (THRESHOLD + 64), (BLOCK_SIZE - 1),
+		BLOCK_SIZE, (BLOCK_SIZE + 1), (2 * BLOCK_SIZE),
+		(5 * BLOCK_SIZE) + 17,
+	};
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		char *text = _make_text(sizes[i]);
+		wire_t wire = { { 0 } };
+		bool compressed;
+
+		_pack(text, SLURM_MSG_COMPRESS_OK, SLURM_PROTOCOL_VERSION,
+		      &wire);
+
+		compressed = (wire.header.flags & SLURM_MSG_COMPRESSED);
+		ck_assert_int_eq(compressed,
+				 (lz4_available && (sizes[i] > THRESHOLD)));
+		/* Replies can be compressed if compression is enabled */
+		ck_assert_int_eq(!!(wire.header.flags & SLURM_MSG_COMPRESS_OK),
+				 lz4_available);
+
+		if (compressed) {
+			uint32_t raw_len;
+			buf_t *body = create_shadow_buf(
+				get_buf_data(wire.body),
+				get_buf_offset(wire.body));
+
+			ck_assert_int_eq(unpack32(&raw_len, body),
+					 SLURM_SUCCESS);
+			ck_assert_uint_gt(raw_len, sizes[i]);
+			ck_assert_uint_lt(get_buf_offset(wire.body), raw_len);
+			FREE_NULL_BUFFER(body);
+
+			/* More than one 64KiB block of compressed data */
+			if (sizes[i] > (4 * BLOCK_SIZE))
+				ck_assert_int_gt(_block_count(&wire), 1);
+		}
+
+		_unpack(&wire, get_buf_offset(wire.body), text);
+
+		_wire_free(&wire);
+		xfree(text);
+	}
+}
+END_TEST
+
+START_TEST(test_peer_without_compress_ok)
+{
+	char *text = _make_text(4 * BLOCK_SIZE);
+	wire_t wire = { { 0 } };
+
+	/* Request or reply from a peer that can not decompress */
+	_pack(text, 0, SLURM_PROTOCOL_VERSION, &wire);
+	ck_assert(!(wire.header.flags & SLURM_MSG_COMPRESSED));
+	_unpack(&wire, get_buf_offset(wire.body), text);
+	_wire_free(&wire);
+
+	/* Peer too old to know about compression */
+	_pack(text, SLURM_MSG_COMPRESS_OK, SLURM_MIN_PROTOCOL_VERSION, &wire);
+	ck_assert(!(wire.header.flags & SLURM_MSG_COMPRESSED));
+	ck_assert(!(wire.header.flags & SLURM_MSG_COMPRESS_OK));
+	_wire_free(&wire);
+
+	xfree(text);
+}
+END_TEST
+
+START_TEST(test_truncated)
+{
+	char *text = _make_text(3 * BLOCK_SIZE);
+	wire_t wire = { { 0 } };
+	uint32_t body_len;
+
+	if (!lz4_available)
+		goto done;
+
+	_pack(text, SLURM_MSG_COMPRESS_OK, SLURM_PROTOCOL_VERSION, &wire);
+	ck_assert(wire.header.flags & SLURM_MSG_COMPRESSED);
+	body_len = get_buf_offset(wire.body);
+
+	/* Within the body head, the first block head and the last block */
+	_unpack(&wire, (BODY_HEAD_SIZE - 1), NULL);
+	_unpack(&wire, (BODY_HEAD_SIZE + BLOCK_HEAD_SIZE - 1), NULL);
+	_unpack(&wire, (BODY_HEAD_SIZE + BLOCK_HEAD_SIZE + 1), NULL);
+	_unpack(&wire, (body_len - 1), NULL);
+
+	/* The body is still fine */
+	_unpack(&wire, body_len, text);
+
+	_wire_free(&wire);
+done:
+	xfree(text);
+}
+END_TEST
+
+START_TEST(test_oversized_length)
+{
+	char *text = _make_text(3 * BLOCK_SIZE);
+	wire_t wire = { { 0 } };
+	uint32_t raw_len, body_len;
+	buf_t *body;
+
+	if (!lz4_available)
+		goto done;
+
+	_pack(text, SLURM_MSG_COMPRESS_OK, SLURM_PROTOCOL_VERSION, &wire);
+	ck_assert(wire.header.flags & SLURM_MSG_COMPRESSED);
+	body_len = get_buf_offset(wire.body);
+	body = create_shadow_buf(get_buf_data(wire.body), body_len);
+	ck_assert_int_eq(unpack32(&raw_len, body), SLURM_SUCCESS);
+
+	/* Over the maximum message size */
+	set_buf_offset(body, 0);
+	pack32((MAX_MSG_SIZE + 1), body);
+	_unpack(&wire, body_len, NULL);
+
+	/* More than the blocks hold */
+	set_buf_offset(body, 0);
+	pack32((raw_len + 1), body);
+	_unpack(&wire, body_len, NULL);
+
+	/* Less than the blocks hold */
+	set_buf_offset(body, 0);
+	pack32((raw_len - 1), body);
+	_unpack(&wire, body_len, NULL);
+
+	/* Block claiming more compressed bytes than left in the body */
+	set_buf_offset(body, 0);
+	pack32(raw_len, body);
+	set_buf_offset(body, BODY_HEAD_SIZE);
+	pack32(body_len, body);
+	_unpack(&wire, body_len, NULL);
+
+	FREE_NULL_BUFFER(body);
+	_wire_free(&wire);
+done:
+	xfree(text);
+}
+END_TEST
+
+START_TEST(test_corrupt_payload)
+{
+	char *text = _make_text(3 * BLOCK_SIZE);
+	wire_t wire = { { 0 } };
+	char *payload;
+
+	if (!lz4_available)
+		goto done;
+
+	_pack(text, SLURM_MSG_COMPRESS_OK, SLURM_PROTOCOL_VERSION, &wire);
+	ck_assert(wire.header.flags & SLURM_MSG_COMPRESSED);
+
+	/* Literal lengths running past the end of the block */
+	payload = get_buf_data(wire.body) + BODY_HEAD_SIZE + BLOCK_HEAD_SIZE;
+	memset(payload, 0xff, 32);
+	_unpack(&wire, get_buf_offset(wire.body), NULL);
+
+	_wire_free(&wire);
+done:
+	xfree(text);
+}
+END_TEST
+
+static Suite *suite_msg_compress(void)
+{
+	Suite *s = suite_create("msg_compress");
+	TCase *tc_core = tcase_create("msg_compress");
+
+	tcase_add_unchecked_fixture(tc_core, _setup, _teardown);
+	tcase_add_test(tc_core, test_round_trip);
+	tcase_add_test(tc_core, test_peer_without_compress_ok);
+	tcase_add_test(tc_core, test_truncated);
+	tcase_add_test(tc_core, test_oversized_length);
+	tcase_add_test(tc_core, test_corrupt_payload);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+int main(void)
+{
+	int number_failed;
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	const char *debug_env = getenv("SLURM_DEBUG");
+	const char *debug_flags_env = getenv("SLURM_DEBUG_FLAGS");
+	SRunner *sr;
+
+	if (debug_env)
+		log_opts.stderr_level = log_string2num(debug_env);
+	if (debug_flags_env)
+		debug_str2flags(debug_flags_env, &slurm_conf.debug_flags);
+
+	log_init("msg_compress-test", log_opts, 0, NULL);
+
+	sr = srunner_create(suite_msg_compress());
+
+	srunner_run_all(sr, CK_ENV);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	log_fini();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,124 @@
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/common/pack.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/slurm_protocol_pack.h"
+#include "src/common/xmalloc.h"
+
+#define DATA_BYTES (1024 * 1024)
+
+static buf_t *_packed_data(void)
+{
+	buf_t *data = init_buf(DATA_BYTES);
+
+	for (int i = 0; i < DATA_BYTES; i++)
+		pack8((i % 251), data);
+
+	return data;
+}
+
+START_TEST(shadow_body_not_copied)
+{
+	buf_t *data = _packed_data();
+	buf_t *packed = init_buf(BUF_SIZE);
+	buf_t *body;
+	slurm_msg_t msg;
+
+	slurm_msg_t_init(&msg);
+	msg.msg_type = RESPONSE_JOB_INFO;
+	msg.data = data;
+
+	body = pack_msg_shadow_body(&msg);
+	ck_assert(body != NULL);
+	ck_assert(body->shadow);
+	ck_assert(get_buf_data(body) == get_buf_data(data));
+	ck_assert_int_eq(get_buf_offset(body), get_buf_offset(data));
+	ck_assert_int_eq(msg.protocol_version, SLURM_PROTOCOL_VERSION);
+
+	/* Same bytes as packing the message */
+	ck_assert_int_eq(pack_msg(&msg, packed), SLURM_SUCCESS);
+	ck_assert_int_eq(get_buf_offset(packed), get_buf_offset(body));
+	ck_assert(!memcmp(get_buf_data(packed), get_buf_data(body),
+			  get_buf_offset(body)));
+
+	FREE_NULL_BUFFER(body);
+	FREE_NULL_BUFFER(packed);
+	FREE_NULL_BUFFER(data);
+}
+END_TEST
+
+START_TEST(shadow_body_other_types)
+{
+	slurm_msg_t msg;
+
+	slurm_msg_t_init(&msg);
+	msg.msg_type = REQUEST_PING;
+	ck_assert(pack_msg_shadow_body(&msg) == NULL);
+
+	/* Nothing to shadow */
+	msg.msg_type = RESPONSE_NODE_INFO;
+	ck_assert(pack_msg_shadow_body(&msg) == NULL);
+}
+END_TEST
+
+START_TEST(buffers_pack_shadow_body)
+{
+	buf_t *data = _packed_data();
+	msg_bufs_t buffers = { 0 };
+	slurm_msg_t msg;
+
+	slurm_msg_t_init(&msg);
+	slurm_msg_set_r_uid(&msg, SLURM_AUTH_UID_ANY);
+	msg.msg_type = RESPONSE_JOB_INFO;
+	msg.flags |= SLURM_NO_AUTH_CRED;
+	msg.data = data;
+
+	ck_assert_int_eq(slurm_buffers_pack_msg(&msg, &buffers, false),
+			 SLURM_SUCCESS);
+	ck_assert(buffers.header != NULL);
+	ck_assert(buffers.auth == NULL);
+	ck_assert(buffers.body->shadow);
+	ck_assert(get_buf_data(buffers.body) == get_buf_data(data));
+	ck_assert_int_eq(get_buf_offset(buffers.body), DATA_BYTES);
+
+	FREE_NULL_BUFFER(buffers.header);
+	FREE_NULL_BUFFER(buffers.body);
+
+	/* Shadow body must not have freed the data */
+	ck_assert_int_eq(get_buf_offset(data), DATA_BYTES);
+	FREE_NULL_BUFFER(data);
+}
+END_TEST
+
+/*****************************************************************************
+ * TEST SUITE                                                                *
+ ****************************************************************************/
+
+Suite *suite(void)
+{
+	Suite *s = suite_create("pack_buf_msg");
+	TCase *tc_core = tcase_create("pack_buf_msg");
+	tcase_add_test(tc_core, shadow_body_not_copied);
+	tcase_add_test(tc_core, shadow_body_other_types);
+	tcase_add_test(tc_core, buffers_pack_shadow_body);
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+/*****************************************************************************
+ * TEST RUNNER                                                               *
+ ****************************************************************************/
+
+int main(void)
+{
+	int number_failed;
+	SRunner *sr = srunner_create(suite());
+
+	srunner_run_all(sr, CK_VERBOSE);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
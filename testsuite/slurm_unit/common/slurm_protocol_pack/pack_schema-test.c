@@ -0,0 +1,623 @@
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/common/pack.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/slurm_protocol_pack.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#define FUZZ_ROUNDS 2000
+
+static const uint16_t versions[] = {
+	SLURM_PROTOCOL_VERSION,
+	SLURM_ONE_BACK_PROTOCOL_VERSION,
+	SLURM_TWO_BACK_PROTOCOL_VERSION,
+	SLURM_MIN_PROTOCOL_VERSION,
+};
+
+/* Messages packed with a schema and what the hand written code packed */
+typedef struct {
+	slurm_msg_type_t msg_type;
+	void *(*create)(void);
+	void (*pack_expected)(void *data, uint16_t protocol_version,
+			      buf_t *buffer);
+	bool (*equal)(void *a, void *b, uint16_t protocol_version);
+} schema_msg_t;
+
+static void *_create_return_code(void)
+{
+	return_code_msg_t *msg = xmalloc(sizeof(*msg));
+
+	msg->return_code = 0xdeadbeef;
+	return msg;
+}
+
+static void _pack_return_code(void *data, uint16_t protocol_version,
+			      buf_t *buffer)
+{
+	return_code_msg_t *msg = data;
+
+	pack32(msg->return_code, buffer);
+}
+
+static bool _equal_return_code(void *a, void *b, uint16_t protocol_version)
+{
+	return_code_msg_t *x = a, *y = b;
+
+	return (x->return_code == y->return_code);
+}
+
+static void *_create_ping_resp(void)
+{
+	ping_slurmd_resp_msg_t *msg = xmalloc(sizeof(*msg));
+
+	msg->cpu_load = 1234;
+	msg->free_mem = 0x0123456789abcdefULL;
+	msg->node_name = xstrdup("node0001");
+	return msg;
+}
+
+static void _pack_ping_resp(void *data, uint16_t protocol_version,
+			    buf_t *buffer)
+{
+	ping_slurmd_resp_msg_t *msg = data;
+
+	pack32(msg->cpu_load, buffer);
+	pack64(msg->free_mem, buffer);
+	if (protocol_version >= SLURM_26_05_PROTOCOL_VERSION)
+		packstr(msg->node_name, buffer);
+}
+
+static bool _equal_ping_resp(void *a, void *b, uint16_t protocol_version)
+{
+	ping_slurmd_resp_msg_t *x = a, *y = b;
+
+	if ((protocol_version >= SLURM_26_05_PROTOCOL_VERSION) &&
+	    xstrcmp(x->node_name, y->node_name))
+		return false;
+
+	return ((x->cpu_load == y->cpu_load) && (x->free_mem == y->free_mem));
+}
+
+static void *_create_kvs_get(void)
+{
+	kvs_get_msg_t *msg = xmalloc(sizeof(*msg));
+
+	msg->task_id = 7;
+	msg->size = 64;
+	msg->port = 6818;
+	msg->hostname = xstrdup("login1");
+	/* NULL strings must round trip too */
+	msg->tls_cert = NULL;
+	return msg;
+}
+
+static void _pack_kvs_get(void *data, uint16_t protocol_version,
+			  buf_t *buffer)
+{
+	kvs_get_msg_t *msg = data;
+
+	pack32(msg->task_id, buffer);
+	pack32(msg->size, buffer);
+	pack16(msg->port, buffer);
+	packstr(msg->hostname, buffer);
+	if (protocol_version >= SLURM_25_11_PROTOCOL_VERSION)
+		packstr(msg->tls_cert, buffer);
+}
+
+static bool _equal_kvs_get(void *a, void *b, uint16_t protocol_version)
+{
+	kvs_get_msg_t *x = a, *y = b;
+
+	return ((x->task_id == y->task_id) && (x->size == y->size) &&
+		(x->port == y->port) && !xstrcmp(x->hostname, y->hostname) &&
+		!xstrcmp(x->tls_cert, y->tls_cert));
+}
+
+static void *_create_slurmd_status(void)
+{
+	slurmd_status_t *msg = xmalloc(sizeof(*msg));
+
+	msg->booted = 1700000000;
+	msg->last_slurmctld_msg = 1700000100;
+	msg->slurmd_debug = 3;
+	msg->actual_cpus = 256;
+	msg->actual_boards = 1;
+	msg->actual_sockets = 2;
+	msg->actual_cores = 64;
+	msg->actual_threads = 2;
+	msg->actual_real_mem = 1024ULL * 1024 * 1024;
+	msg->actual_tmp_disk = 4096;
+	msg->pid = 4242;
+	msg->hostname = xstrdup("node0002");
+	msg->slurmd_logfile = xstrdup("/var/log/slurmd.log");
+	msg->step_list = xstrdup("");
+	msg->version = xstrdup("26.11.0");
+	return msg;
+}
+
+static void _pack_slurmd_status(void *data, uint16_t protocol_version,
+				buf_t *buffer)
+{
+	slurmd_status_t *msg = data;
+
+	pack_time(msg->booted, buffer);
+	pack_time(msg->last_slurmctld_msg, buffer);
+	pack16(msg->slurmd_debug, buffer);
+	pack16(msg->actual_cpus, buffer);
+	pack16(msg->actual_boards, buffer);
+	pack16(msg->actual_sockets, buffer);
+	pack16(msg->actual_cores, buffer);
+	pack16(msg->actual_threads, buffer);
+	pack64(msg->actual_real_mem, buffer);
+	pack32(msg->actual_tmp_disk, buffer);
+	pack32(msg->pid, buffer);
+	packstr(msg->hostname, buffer);
+	packstr(msg->slurmd_logfile, buffer);
+	packstr(msg->step_list, buffer);
+	packstr(msg->version, buffer);
+}
+
+static bool _equal_slurmd_status(void *a, void *b, uint16_t protocol_version)
+{
+	slurmd_status_t *x = a, *y = b;
+
+	return ((x->booted == y->booted) &&
+		(x->last_slurmctld_msg == y->last_slurmctld_msg) &&
+		(x->slurmd_debug == y->slurmd_debug) &&
+		(x->actual_cpus == y->actual_cpus) &&
+		(x->actual_boards == y->actual_boards) &&
+		(x->actual_sockets == y->actual_sockets) &&
+		(x->actual_cores == y->actual_cores) &&
+		(x->actual_threads == y->actual_threads) &&
+		(x->actual_real_mem == y->actual_real_mem) &&
+		(x->actual_tmp_disk == y->actual_tmp_disk) &&
+		(x->pid == y->pid) && !xstrcmp(x->hostname, y->hostname) &&
+		!xstrcmp(x->slurmd_logfile, y->slurmd_logfile) &&
+		!xstrcmp(x->step_list, y->step_list) &&
+		!xstrcmp(x->version, y->version));
+}
+
+static void *_create_control_status(void)
+{
+	control_status_msg_t *msg = xmalloc(sizeof(*msg));
+
+	msg->backup_inx = 1;
+	msg->control_time = 1700000200;
+	return msg;
+}
+
+static void _pack_control_status(void *data, uint16_t protocol_version,
+				 buf_t *buffer)
+{
+	control_status_msg_t *msg = data;
+
+	pack16(msg->backup_inx, buffer);
+	pack_time(msg->control_time, buffer);
+}
+
+static bool _equal_control_status(void *a, void *b, uint16_t protocol_version)
+{
+	control_status_msg_t *x = a, *y = b;
+
+	return ((x->backup_inx == y->backup_inx) &&
+		(x->control_time == y->control_time));
+}
+
+static void *_create_epilog_comp(void)
+{
+	epilog_complete_msg_t *msg = xmalloc(sizeof(*msg));
+
+	msg->step_id.sluid = 0x0123456789abcdefULL;
+	msg->step_id.job_id = 1234;
+	msg->step_id.step_id = SLURM_BATCH_SCRIPT;
+	msg->step_id.step_het_comp = NO_VAL;
+	msg->return_code = 9;
+	msg->node_name = xstrdup("node0003");
+	return msg;
+}
+
+static void _pack_epilog_comp(void *data, uint16_t protocol_version,
+			      buf_t *buffer)
+{
+	epilog_complete_msg_t *msg = data;
+
+	if (protocol_version >= SLURM_25_11_PROTOCOL_VERSION) {
+		pack_step_id(&msg->step_id, buffer, protocol_version);
+		pack32(msg->return_code, buffer);
+		packstr(msg->node_name, buffer);
+	} else {
+		pack32(msg->step_id.job_id, buffer);
+		pack32(msg->return_code, buffer);
+		packstr(msg->node_name, buffer);
+	}
+}
+
+/* Older peers only send the job id, the rest must be left unset */
+static bool _equal_step_id(slurm_step_id_t *x, slurm_step_id_t *y,
+			   uint16_t protocol_version)
+{
+	if (protocol_version < SLURM_25_11_PROTOCOL_VERSION)
+		return ((x->job_id == y->job_id) && !y->sluid &&
+			(y->step_id == NO_VAL) &&
+			(y->step_het_comp == NO_VAL));
+
+	return ((x->sluid == y->sluid) && (x->job_id == y->job_id) &&
+		(x->step_id == y->step_id) &&
+		(x->step_het_comp == y->step_het_comp));
+}
+
+static bool _equal_epilog_comp(void *a, void *b, uint16_t protocol_version)
+{
+	epilog_complete_msg_t *x = a, *y = b;
+
+	return (_equal_step_id(&x->step_id, &y->step_id, protocol_version) &&
+		(x->return_code == y->return_code) &&
+		!xstrcmp(x->node_name, y->node_name));
+}
+
+static void *_create_prolog_complete(void)
+{
+	prolog_complete_msg_t *msg = xmalloc(sizeof(*msg));
+
+	msg->step_id.sluid = 0xfedcba9876543210ULL;
+	msg->step_id.job_id = 5678;
+	msg->step_id.step_id = NO_VAL;
+	msg->step_id.step_het_comp = NO_VAL;
+	msg->node_name = xstrdup("node0004");
+	msg->prolog_rc = 1;
+	return msg;
+}
+
+static void _pack_prolog_complete(void *data, uint16_t protocol_version,
+				  buf_t *buffer)
+{
+	prolog_complete_msg_t *msg = data;
+
+	if (protocol_version >= SLURM_25_11_PROTOCOL_VERSION) {
+		pack_step_id(&msg->step_id, buffer, protocol_version);
+		packstr(msg->node_name, buffer);
+		pack32(msg->prolog_rc, buffer);
+	} else {
+		pack32(msg->step_id.job_id, buffer);
+		packstr(msg->node_name, buffer);
+		pack32(msg->prolog_rc, buffer);
+	}
+}
+
+static bool _equal_prolog_complete(void *a, void *b,
+				   uint16_t protocol_version)
+{
+	prolog_complete_msg_t *x = a, *y = b;
+
+	return (_equal_step_id(&x->step_id, &y->step_id, protocol_version) &&
+		!xstrcmp(x->node_name, y->node_name) &&
+		(x->prolog_rc == y->prolog_rc));
+}
+
+static const schema_msg_t schema_msgs[] = {
+	{ RESPONSE_SLURM_RC, _create_return_code, _pack_return_code,
+	  _equal_return_code },
+	{ RESPONSE_PING_SLURMD, _create_ping_resp, _pack_ping_resp,
+	  _equal_ping_resp },
+	{ PMI_KVS_GET_REQ, _create_kvs_get, _pack_kvs_get, _equal_kvs_get },
+	{ RESPONSE_SLURMD_STATUS, _create_slurmd_status, _pack_slurmd_status,
+	  _equal_slurmd_status },
+	{ RESPONSE_CONTROL_STATUS, _create_control_status,
+	  _pack_control_status, _equal_control_status },
+	{ MESSAGE_EPILOG_COMPLETE, _create_epilog_comp, _pack_epilog_comp,
+	  _equal_epilog_comp },
+	{ REQUEST_COMPLETE_PROLOG, _create_prolog_complete,
+	  _pack_prolog_complete, _equal_prolog_complete },
+};
+
+static buf_t *_pack(const schema_msg_t *m, void *data,
+		    uint16_t protocol_version)
+{
+	buf_t *buffer = init_buf(0);
+	slurm_msg_t msg;
+
+	slurm_msg_t_init(&msg);
+	msg.msg_type = m->msg_type;
+	msg.protocol_version = protocol_version;
+	msg.data = data;
+	ck_assert_int_eq(pack_msg(&msg, buffer), SLURM_SUCCESS);
+
+	return buffer;
+}
+
+/* Unpack bytes as msg_type, freeing whatever was unpacked */
+static int _unpack(const schema_msg_t *m, char *data, uint32_t bytes,
+		   uint16_t protocol_version, void **out)
+{
+	buf_t *buffer = create_buf(xmalloc(bytes ? bytes : 1), bytes);
+	slurm_msg_t msg;
+	int rc;
+
+	memcpy(get_buf_data(buffer), data, bytes);
+
+	slurm_msg_t_init(&msg);
+	msg.msg_type = m->msg_type;
+	msg.protocol_version = protocol_version;
+	rc = unpack_msg(&msg, buffer);
+
+	if (!rc)
+		ck_assert(msg.data != NULL);
+	else
+		ck_assert(msg.data == NULL);
+
+	if (out)
+		*out = msg.data;
+	else
+		slurm_free_msg_data(m->msg_type, msg.data);
+
+	FREE_NULL_BUFFER(buffer);
+	return rc;
+}
+
+START_TEST(wire_format_unchanged)
+{
+	for (int i = 0; i < ARRAY_SIZE(schema_msgs); i++) {
+		const schema_msg_t *m = &schema_msgs[i];
+		void *data = m->create();
+
+		for (int v = 0; v < ARRAY_SIZE(versions); v++) {
+			buf_t *packed = _pack(m, data, versions[v]);
+			buf_t *expected = init_buf(0);
+			void *out = NULL;
+
+			m->pack_expected(data, versions[v], expected);
+			ck_assert_int_eq(get_buf_offset(packed),
+					 get_buf_offset(expected));
+			ck_assert(!memcmp(get_buf_data(packed),
+					  get_buf_data(expected),
+					  get_buf_offset(expected)));
+
+			ck_assert_int_eq(_unpack(m, get_buf_data(packed),
+						 get_buf_offset(packed),
+						 versions[v], &out),
+					 SLURM_SUCCESS);
+			ck_assert(m->equal(data, out, versions[v]));
+
+			slurm_free_msg_data(m->msg_type, out);
+			FREE_NULL_BUFFER(packed);
+			FREE_NULL_BUFFER(expected);
+		}
+
+		slurm_free_msg_data(m->msg_type, data);
+	}
+}
+END_TEST
+
+START_TEST(empty_message_round_trip)
+{
+	for (int i = 0; i < ARRAY_SIZE(schema_msgs); i++) {
+		const schema_msg_t *m = &schema_msgs[i];
+		void *data = m->create();
+		buf_t *packed;
+		void *out = NULL;
+
+		/* All strings NULL */
+		switch (m->msg_type) {
+		case RESPONSE_PING_SLURMD:
+			xfree(((ping_slurmd_resp_msg_t *) data)->node_name);
+			break;
+		case PMI_KVS_GET_REQ:
+			xfree(((kvs_get_msg_t *) data)->hostname);
+			break;
+		case MESSAGE_EPILOG_COMPLETE:
+			xfree(((epilog_complete_msg_t *) data)->node_name);
+			break;
+		case REQUEST_COMPLETE_PROLOG:
+			xfree(((prolog_complete_msg_t *) data)->node_name);
+			break;
+		case RESPONSE_SLURMD_STATUS:
+		{
+			slurmd_status_t *msg = data;
+			xfree(msg->hostname);
+			xfree(msg->slurmd_logfile);
+			xfree(msg->step_list);
+			xfree(msg->version);
+			break;
+		}
+		default:
+			break;
+		}
+
+		packed = _pack(m, data, SLURM_PROTOCOL_VERSION);
+		ck_assert_int_eq(_unpack(m, get_buf_data(packed),
+					 get_buf_offset(packed),
+					 SLURM_PROTOCOL_VERSION, &out),
+				 SLURM_SUCCESS);
+		ck_assert(m->equal(data, out, SLURM_PROTOCOL_VERSION));
+
+		slurm_free_msg_data(m->msg_type, out);
+		slurm_free_msg_data(m->msg_type, data);
+		FREE_NULL_BUFFER(packed);
+	}
+}
+END_TEST
+
+START_TEST(truncated_messages_rejected)
+{
+	for (int i = 0; i < ARRAY_SIZE(schema_msgs); i++) {
+		const schema_msg_t *m = &schema_msgs[i];
+		void *data = m->create();
+
+		for (int v = 0; v < ARRAY_SIZE(versions); v++) {
+			buf_t *packed = _pack(m, data, versions[v]);
+			uint32_t bytes = get_buf_offset(packed);
+
+			for (uint32_t len = 0; len < bytes; len++)
+				ck_assert_int_ne(_unpack(m,
+							 get_buf_data(packed),
+							 len, versions[v],
+							 NULL),
+						 SLURM_SUCCESS);
+
+			FREE_NULL_BUFFER(packed);
+		}
+
+		slurm_free_msg_data(m->msg_type, data);
+	}
+}
+END_TEST
+
+START_TEST(string_without_terminator_rejected)
+{
+	const schema_msg_t *m = &schema_msgs[2];
+	kvs_get_msg_t *data = m->create();
+	buf_t *packed = _pack(m, data, SLURM_PROTOCOL_VERSION);
+	/* hostname is followed by the length of the NULL tls_cert */
+	char *nul = get_buf_data(packed) + get_buf_offset(packed) -
+		sizeof(uint32_t) - 1;
+
+	ck_assert_int_eq(*nul, '\0');
+	*nul = 'x';
+	ck_assert_int_ne(_unpack(m, get_buf_data(packed),
+				 get_buf_offset(packed), SLURM_PROTOCOL_VERSION,
+				 NULL),
+			 SLURM_SUCCESS);
+
+	FREE_NULL_BUFFER(packed);
+	slurm_free_msg_data(m->msg_type, data);
+}
+END_TEST
+
+START_TEST(fuzz_mutated_messages)
+{
+	unsigned int seed = 1;
+
+	for (int i = 0; i < ARRAY_SIZE(schema_msgs); i++) {
+		const schema_msg_t *m = &schema_msgs[i];
+		void *data = m->create();
+
+		for (int v = 0; v < ARRAY_SIZE(versions); v++) {
+			buf_t *packed = _pack(m, data, versions[v]);
+			uint32_t bytes = get_buf_offset(packed);
+			char *copy = xmalloc(bytes);
+
+			for (int r = 0; r < FUZZ_ROUNDS; r++) {
+				int flips = (rand_r(&seed) % 4) + 1;
+
+				memcpy(copy, get_buf_data(packed), bytes);
+				for (int f = 0; f < flips; f++)
+					copy[rand_r(&seed) % bytes] =
+						rand_r(&seed);
+
+				/* Must not crash or leak, result ignored */
+				(void) _unpack(m, copy, bytes, versions[v],
+					       NULL);
+				(void) _unpack(m, copy,
+					       (rand_r(&seed) % bytes),
+					       versions[v], NULL);
+			}
+
+			xfree(copy);
+			FREE_NULL_BUFFER(packed);
+		}
+
+		slurm_free_msg_data(m->msg_type, data);
+	}
+}
+END_TEST
+
+/*****************************************************************************
+ * BENCHMARK                                                                 *
+ ****************************************************************************/
+
+/*
+ * Set PACK_SCHEMA_BENCH=<iterations> to time pack and unpack of each message
+ */
+static void _bench(int iterations)
+{
+	for (int i = 0; i < ARRAY_SIZE(schema_msgs); i++) {
+		const schema_msg_t *m = &schema_msgs[i];
+		void *data = m->create();
+		buf_t *buffer = init_buf(BUF_SIZE);
+		struct timespec start, end;
+		double pack_usec, unpack_usec;
+		slurm_msg_t msg;
+
+		slurm_msg_t_init(&msg);
+		msg.msg_type = m->msg_type;
+		msg.protocol_version = SLURM_PROTOCOL_VERSION;
+		msg.data = data;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int n = 0; n < iterations; n++) {
+			set_buf_offset(buffer, 0);
+			(void) pack_msg(&msg, buffer);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		pack_usec = ((end.tv_sec - start.tv_sec) * 1e6) +
+			((end.tv_nsec - start.tv_nsec) / 1e3);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int n = 0; n < iterations; n++) {
+			slurm_msg_t out;
+
+			slurm_msg_t_init(&out);
+			out.msg_type = m->msg_type;
+			out.protocol_version = SLURM_PROTOCOL_VERSION;
+			set_buf_offset(buffer, 0);
+			(void) unpack_msg(&out, buffer);
+			slurm_free_msg_data(m->msg_type, out.data);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		unpack_usec = ((end.tv_sec - start.tv_sec) * 1e6) +
+			((end.tv_nsec - start.tv_nsec) / 1e3);
+
+		printf("%-24s pack %8.0f msg/ms unpack %8.0f msg/ms\n",
+		       rpc_num2string(m->msg_type),
+		       (iterations / pack_usec) * 1e3,
+		       (iterations / unpack_usec) * 1e3);
+
+		FREE_NULL_BUFFER(buffer);
+		slurm_free_msg_data(m->msg_type, data);
+	}
+}
+
+/*****************************************************************************
+ * TEST SUITE                                                                *
+ ****************************************************************************/
+
+Suite *suite(void)
+{
+	Suite *s = suite_create("pack_schema");
+	TCase *tc_core = tcase_create("pack_schema");
+	tcase_set_timeout(tc_core, 60);
+	tcase_add_test(tc_core, wire_format_unchanged);
+	tcase_add_test(tc_core, empty_message_round_trip);
+	tcase_add_test(tc_core, truncated_messages_rejected);
+	tcase_add_test(tc_core, string_without_terminator_rejected);
+	tcase_add_test(tc_core, fuzz_mutated_messages);
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+/*****************************************************************************
+ * TEST RUNNER                                                               *
+ ****************************************************************************/
+
+int main(void)
+{
+	int number_failed;
+	char *bench = getenv("PACK_SCHEMA_BENCH");
+	SRunner *sr;
+
+	if (bench) {
+		_bench(atoi(bench));
+		return EXIT_SUCCESS;
+	}
+
+	sr = srunner_create(suite());
+	srunner_run_all(sr, CK_VERBOSE);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
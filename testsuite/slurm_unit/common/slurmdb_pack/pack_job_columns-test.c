@@ -0,0 +1,184 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "src/common/slurmdb_pack.h"
+#include "src/common/xmalloc.h"
+#include "src/common/slurm_protocol_common.h"
+#include "src/common/list.h"
+#include "src/common/pack.h"
+
+START_TEST(invalid_protocol)
+{
+	int rc;
+	uint32_t x;
+	bool cols[SLURMDB_JOB_COL_CNT] = { 0 };
+
+	slurmdb_job_columns_t *pack_jc = slurmdb_create_job_columns("c", cols,
+								    0);
+	buf_t *buf = init_buf(1024);
+
+	pack32(22, buf);
+	set_buf_offset(buf, 0);
+
+	slurmdb_job_columns_t *unpack_jc;
+
+	slurmdb_pack_job_columns(pack_jc, 0, buf);
+	unpack32(&x, buf);
+	rc = slurmdb_unpack_job_columns((void **)&unpack_jc, 0, buf);
+	ck_assert_int_eq(rc, SLURM_ERROR);
+	ck_assert(x == 22);
+	free_buf(buf);
+	slurmdb_destroy_job_columns(pack_jc);
+}
+END_TEST
+
+START_TEST(pack_min_proto_job_columns)
+{
+	int rc;
+	bool cols[SLURMDB_JOB_COL_CNT] = { 0 };
+
+	cols[SLURMDB_JOB_COL_JOBID] = true;
+	cols[SLURMDB_JOB_COL_REQ_MEM] = true;
+	cols[SLURMDB_JOB_COL_ACCOUNT] = true;
+	cols[SLURMDB_JOB_COL_NODES] = true;
+
+	slurmdb_job_columns_t *pack_jc =
+		slurmdb_create_job_columns("Hannah Arendt", cols, 3);
+	pack_jc->rec_cnt = 3;
+	for (int i = 0; i < 3; i++) {
+		pack_jc->num[SLURMDB_JOB_COL_JOBID][i] = 100 + i;
+		pack_jc->num[SLURMDB_JOB_COL_REQ_MEM][i] = INFINITE64 - i;
+	}
+	pack_jc->str[SLURMDB_JOB_COL_ACCOUNT][0] = xstrdup("Simone Weil");
+	pack_jc->str[SLURMDB_JOB_COL_ACCOUNT][2] = xstrdup("Iris Murdoch");
+	pack_jc->str[SLURMDB_JOB_COL_NODES][1] = xstrdup("node[1-10]");
+
+	buf_t *buf = init_buf(1024);
+	slurmdb_pack_job_columns(pack_jc, SLURM_MIN_PROTOCOL_VERSION, buf);
+
+	set_buf_offset(buf, 0);
+
+	slurmdb_job_columns_t *unpack_jc;
+	rc = slurmdb_unpack_job_columns((void **)&unpack_jc,
+					SLURM_MIN_PROTOCOL_VERSION, buf);
+	ck_assert(rc == SLURM_SUCCESS);
+	ck_assert_str_eq(pack_jc->cluster, unpack_jc->cluster);
+	ck_assert(pack_jc->rec_cnt == unpack_jc->rec_cnt);
+	for (int c = 0; c < SLURMDB_JOB_COL_CNT; c++) {
+		ck_assert(!pack_jc->num[c] == !unpack_jc->num[c]);
+		ck_assert(!pack_jc->str[c] == !unpack_jc->str[c]);
+		for (int i = 0; i < 3; i++) {
+			if (pack_jc->num[c])
+				ck_assert(pack_jc->num[c][i] ==
+					  unpack_jc->num[c][i]);
+			if (pack_jc->str[c] && pack_jc->str[c][i])
+				ck_assert_str_eq(pack_jc->str[c][i],
+						 unpack_jc->str[c][i]);
+		}
+	}
+
+	free_buf(buf);
+	slurmdb_destroy_job_columns(pack_jc);
+	slurmdb_destroy_job_columns(unpack_jc);
+}
+END_TEST
+
+START_TEST(unpack_unknown_column)
+{
+	int rc;
+	uint64_t vals[2] = { 1, 2 };
+	char *strs[2] = { "a", "b" };
+	buf_t *buf = init_buf(1024);
+
+	packstr("Rosa Luxemburg", buf);
+	pack32(2, buf);
+	pack32(3, buf);
+	packstr("no_such_column", buf);
+	packbool(false, buf);
+	pack64_array(vals, 2, buf);
+	/* right name, wrong type */
+	packstr("jobname", buf);
+	packbool(false, buf);
+	pack64_array(vals, 2, buf);
+	packstr("jobname", buf);
+	packbool(true, buf);
+	packstr_array(strs, 2, buf);
+
+	set_buf_offset(buf, 0);
+
+	slurmdb_job_columns_t *unpack_jc;
+	rc = slurmdb_unpack_job_columns((void **)&unpack_jc,
+					SLURM_MIN_PROTOCOL_VERSION, buf);
+	ck_assert(rc == SLURM_SUCCESS);
+	ck_assert(unpack_jc->rec_cnt == 2);
+	ck_assert(!unpack_jc->num[SLURMDB_JOB_COL_JOBNAME]);
+	ck_assert_str_eq(unpack_jc->str[SLURMDB_JOB_COL_JOBNAME][1], "b");
+
+	free_buf(buf);
+	slurmdb_destroy_job_columns(unpack_jc);
+}
+END_TEST
+
+START_TEST(job_columns_2_rec)
+{
+	bool cols[SLURMDB_JOB_COL_CNT] = { 0 };
+	slurmdb_job_rec_t *job = slurmdb_create_job_rec();
+
+	cols[SLURMDB_JOB_COL_JOBID] = true;
+	cols[SLURMDB_JOB_COL_USER] = true;
+
+	slurmdb_job_columns_t *jc = slurmdb_create_job_columns("cl", cols, 1);
+	jc->rec_cnt = 1;
+	jc->num[SLURMDB_JOB_COL_JOBID][0] = 42;
+	jc->str[SLURMDB_JOB_COL_USER][0] = xstrdup("Mary Wollstonecraft");
+
+	slurmdb_job_columns_2_rec(jc, 0, job);
+	ck_assert(job->jobid == 42);
+	ck_assert_str_eq(job->user, "Mary Wollstonecraft");
+	ck_assert_str_eq(job->cluster, "cl");
+	/* untouched columns keep slurmdb_create_job_rec() defaults */
+	ck_assert(job->array_task_id == NO_VAL);
+	ck_assert(!job->account);
+
+	slurmdb_destroy_job_columns(jc);
+	ck_assert_str_eq(job->user, "Mary Wollstonecraft");
+	slurmdb_destroy_job_rec(job);
+}
+END_TEST
+
+
+/*****************************************************************************
+ * TEST SUITE                                                                *
+ ****************************************************************************/
+
+Suite *suite(void)
+{
+	Suite *s = suite_create("Pack slurmdb_job_columns_t");
+	TCase *tc_core = tcase_create("Pack slurmdb_job_columns_t");
+	tcase_add_test(tc_core, invalid_protocol);
+	tcase_add_test(tc_core, pack_min_proto_job_columns);
+	tcase_add_test(tc_core, unpack_unknown_column);
+	tcase_add_test(tc_core, job_columns_2_rec);
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+/*****************************************************************************
+ * TEST RUNNER                                                               *
+ ****************************************************************************/
+
+int main(void)
+{
+	int number_failed;
+	SRunner *sr = srunner_create(suite());
+
+	//srunner_set_fork_status(sr, CK_NOFORK);
+
+	srunner_run_all(sr, CK_VERBOSE);
+	//srunner_run_all(sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,338 @@
+/*****************************************************************************\
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include <check.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "src/common/log.h"
+#include "src/common/pack.h"
+#include "src/common/read_config.h"
+#include "src/common/stepd_api.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/interfaces/jobacct_gather.h"
+
+#define NODENAME "node1"
+#define NUM_TASKS 3
+#define USER_CPU_SEC 42
+
+static char *directory = NULL;
+static slurm_step_id_t step_id = {
+	.job_id = 1234,
+	.step_id = 0,
+	.step_het_comp = NO_VAL,
+};
+
+/* Map a snapshot of size bytes as slurmstepd does, without publishing */
+static stepd_stat_shm_t *_create(off_t size)
+{
+	char *path = stepd_stat_shm_path(directory, NODENAME, &step_id);
+	stepd_stat_shm_t *shm;
+	int fd;
+
+	fd = open(path, (O_RDWR | O_CREAT | O_TRUNC), 0600);
+	ck_assert_int_ge(fd, 0);
+	ck_assert_int_eq(ftruncate(fd, size), 0);
+	shm = mmap(NULL, STEPD_STAT_SHM_SIZE, (PROT_READ | PROT_WRITE),
+		   MAP_SHARED, fd, 0);
+	ck_assert(shm != MAP_FAILED);
+	close(fd);
+	xfree(path);
+
+	shm->magic = STEPD_STAT_SHM_MAGIC;
+	shm->protocol_version = SLURM_PROTOCOL_VERSION;
+
+	return shm;
+}
+
+/* Pack accounting into the snapshot, keeping seq as it is */
+static void _fill(stepd_stat_shm_t *shm, uint64_t user_cpu_sec,
+		  uint32_t num_tasks)
+{
+	jobacctinfo_t *jobacct = jobacctinfo_create(NULL);
+	buf_t *buffer = init_buf(BUF_SIZE);
+
+	ck_assert_ptr_nonnull(jobacct);
+	jobacct->user_cpu_sec = user_cpu_sec;
+	jobacctinfo_pack(jobacct, SLURM_PROTOCOL_VERSION, PROTOCOL_TYPE_SLURM,
+			 buffer);
+
+	memcpy(shm->data, get_buf_data(buffer), get_buf_offset(buffer));
+	shm->len = get_buf_offset(buffer);
+	shm->num_tasks = num_tasks;
+	shm->update_time = time(NULL);
+
+	FREE_NULL_BUFFER(buffer);
+	jobacctinfo_destroy(jobacct);
+}
+
+/* Read the snapshot, RET user_cpu_sec or -1 on error */
+static int64_t _read(uint32_t *num_tasks)
+{
+	job_step_stat_t resp = { 0 };
+	int64_t user_cpu_sec;
+
+	if (stepd_stat_shm_read(directory, NODENAME, &step_id, &resp)) {
+		/* Nothing was returned, so the caller asks slurmstepd */
+		ck_assert_ptr_null(resp.jobacct);
+		return -1;
+	}
+
+	ck_assert_ptr_nonnull(resp.jobacct);
+	user_cpu_sec = resp.jobacct->user_cpu_sec;
+	if (num_tasks)
+		*num_tasks = resp.num_tasks;
+	jobacctinfo_destroy(resp.jobacct);
+
+	return user_cpu_sec;
+}
+
+static void _setup(void)
+{
+	directory = xstrdup("/tmp/stepd_stat_shm-test.XXXXXX");
+	ck_assert_ptr_nonnull(mkdtemp(directory));
+}
+
+static void _teardown(void)
+{
+	char *path = stepd_stat_shm_path(directory, NODENAME, &step_id);
+
+	(void) unlink(path);
+	(void) rmdir(directory);
+	xfree(path);
+	xfree(directory);
+}
+
+START_TEST(test_read)
+{
+	stepd_stat_shm_t *shm = _create(STEPD_STAT_SHM_SIZE);
+	uint32_t num_tasks = 0;
+
+	_fill(shm, USER_CPU_SEC, NUM_TASKS);
+	shm->seq = 2;
+
+	ck_assert_int_eq(_read(&num_tasks), USER_CPU_SEC);
+	ck_assert_uint_eq(num_tasks, NUM_TASKS);
+
+	munmap(shm, STEPD_STAT_SHM_SIZE);
+}
+END_TEST
+
+START_TEST(test_unpublished)
+{
+	stepd_stat_shm_t *shm = _create(STEPD_STAT_SHM_SIZE);
+
+	/* Data is ignored until the first poll sets seq */
+	_fill(shm, USER_CPU_SEC, NUM_TASKS);
+	shm->seq = 0;
+
+	ck_assert_int_eq(_read(NULL), -1);
+
+	munmap(shm, STEPD_STAT_SHM_SIZE);
+}
+END_TEST
+
+START_TEST(test_missing)
+{
+	ck_assert_int_eq(_read(NULL), -1);
+}
+END_TEST
+
+START_TEST(test_writer_stuck)
+{
+	stepd_stat_shm_t *shm = _create(STEPD_STAT_SHM_SIZE);
+
+	/* Writer never finishes, retries give up instead of spinning */
+	_fill(shm, USER_CPU_SEC, NUM_TASKS);
+	shm->seq = 3;
+
+	ck_assert_int_eq(_read(NULL), -1);
+
+	munmap(shm, STEPD_STAT_SHM_SIZE);
+}
+END_TEST
+
+typedef struct {
+	stepd_stat_shm_t *shm;
+	bool stop;
+} writer_args_t;
+
+/* Publish as slurmstepd does with num_tasks always equal to user_cpu_sec */
+static void *_writer(void *arg)
+{
+	writer_args_t *args = arg;
+	stepd_stat_shm_t *shm = args->shm;
+
+	for (uint32_t i = 1; !__atomic_load_n(&args->stop, __ATOMIC_RELAXED);
+	     i++) {
+		uint32_t seq = shm->seq;
+
+		__atomic_store_n(&shm->seq, seq + 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+		_fill(shm, i, i);
+		__atomic_store_n(&shm->seq, seq + 2, __ATOMIC_RELEASE);
+	}
+
+	return NULL;
+}
+
+START_TEST(test_concurrent_writer)
+{
+	writer_args_t args = {
+		.shm = _create(STEPD_STAT_SHM_SIZE),
+	};
+	pthread_t tid;
+	time_t end = time(NULL) + 5;
+	int reads = 0;
+
+	_fill(args.shm, 0, 0);
+	args.shm->seq = 2;
+
+	ck_assert_int_eq(pthread_create(&tid, NULL, _writer, &args), 0);
+
+	/* Copies taken while the writer was busy are retried, never used */
+	while ((reads < 100) && (time(NULL) < end)) {
+		uint32_t num_tasks = 0;
+		int64_t user_cpu_sec = _read(&num_tasks);
+
+		if (user_cpu_sec < 0)
+			continue;
+		ck_assert_int_eq(user_cpu_sec, num_tasks);
+		reads++;
+	}
+
+	__atomic_store_n(&args.stop, true, __ATOMIC_RELAXED);
+	pthread_join(tid, NULL);
+
+	ck_assert_int_gt(reads, 0);
+
+	munmap(args.shm, STEPD_STAT_SHM_SIZE);
+}
+END_TEST
+
+START_TEST(test_bad_magic)
+{
+	stepd_stat_shm_t *shm = _create(STEPD_STAT_SHM_SIZE);
+
+	_fill(shm, USER_CPU_SEC, NUM_TASKS);
+	shm->seq = 2;
+	shm->magic = ~STEPD_STAT_SHM_MAGIC;
+
+	ck_assert_int_eq(_read(NULL), -1);
+
+	munmap(shm, STEPD_STAT_SHM_SIZE);
+}
+END_TEST
+
+START_TEST(test_short_file)
+{
+	/* Only the first page exists, mapping all of it would be a SIGBUS */
+	stepd_stat_shm_t *shm = _create(getpagesize());
+
+	_fill(shm, USER_CPU_SEC, NUM_TASKS);
+	shm->seq = 2;
+
+	ck_assert_int_eq(_read(NULL), -1);
+
+	munmap(shm, STEPD_STAT_SHM_SIZE);
+}
+END_TEST
+
+START_TEST(test_bad_header)
+{
+	stepd_stat_shm_t *shm = _create(STEPD_STAT_SHM_SIZE);
+
+	_fill(shm, USER_CPU_SEC, NUM_TASKS);
+	shm->seq = 2;
+
+	/* Length past the end of the snapshot */
+	shm->len = STEPD_STAT_SHM_SIZE;
+	ck_assert_int_eq(_read(NULL), -1);
+
+	/* Packed with a version too old to unpack */
+	_fill(shm, USER_CPU_SEC, NUM_TASKS);
+	shm->protocol_version = SLURM_MIN_PROTOCOL_VERSION - 1;
+	ck_assert_int_eq(_read(NULL), -1);
+
+	munmap(shm, STEPD_STAT_SHM_SIZE);
+}
+END_TEST
+
+static Suite *suite_stepd_stat_shm(void)
+{
+	Suite *s = suite_create("stepd_stat_shm");
+	TCase *tc_core = tcase_create("stepd_stat_shm");
+
+	tcase_add_checked_fixture(tc_core, _setup, _teardown);
+	tcase_add_test(tc_core, test_read);
+	tcase_add_test(tc_core, test_unpublished);
+	tcase_add_test(tc_core, test_missing);
+	tcase_add_test(tc_core, test_writer_stuck);
+	tcase_add_test(tc_core, test_concurrent_writer);
+	tcase_add_test(tc_core, test_bad_magic);
+	tcase_add_test(tc_core, test_short_file);
+	tcase_add_test(tc_core, test_bad_header);
+
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+int main(void)
+{
+	int number_failed;
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	const char *debug_env = getenv("SLURM_DEBUG");
+	const char *debug_flags_env = getenv("SLURM_DEBUG_FLAGS");
+	SRunner *sr;
+
+	if (debug_env)
+		log_opts.stderr_level = log_string2num(debug_env);
+	if (debug_flags_env)
+		debug_str2flags(debug_flags_env, &slurm_conf.debug_flags);
+
+	log_init("stepd_stat_shm-test", log_opts, 0, NULL);
+
+	sr = srunner_create(suite_stepd_stat_shm());
+
+	srunner_run_all(sr, CK_ENV);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	log_fini();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}